@@ -0,0 +1,76 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstddef>
+#else
+    #include <stdlib.h>
+    #include <stddef.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+
+typedef enum CRYPTO_AES_ACCEL_TAG
+{
+    CRYPTO_AES_ACCEL_NONE,
+    // AES-NI and PCLMULQDQ, one block per instruction
+    CRYPTO_AES_ACCEL_AESNI,
+    // AVX-512 VAES and VPCLMULQDQ, four blocks per instruction
+    CRYPTO_AES_ACCEL_VAES512
+} CRYPTO_AES_ACCEL;
+
+// Powers of the GCM hash key kept for the wide GHASH kernels
+#define CRYPTO_AES_ACCEL_GCM_POWERS     16
+
+// Best level this cpu supports, detected on first use
+MOCKABLE_FUNCTION(, CRYPTO_AES_ACCEL, crypto_aes_accel_detect);
+// Level the kernels currently run at, never above the detected one
+MOCKABLE_FUNCTION(, CRYPTO_AES_ACCEL, crypto_aes_accel_get_level);
+// Caps the level for every thread, meant for startup tuning and tests
+MOCKABLE_FUNCTION(, int, crypto_aes_accel_set_level, CRYPTO_AES_ACCEL, level);
+// Calls of fewer blocks run on AES-NI even at the VAES512 level, where the
+// wide kernels cannot make up their warm up.  0, the default, sends every call
+// to the wide kernels.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_get_wide_threshold);
+MOCKABLE_FUNCTION(, void, crypto_aes_accel_set_wide_threshold, size_t, block_count);
+
+// The kernels below return the number of whole blocks they processed, 0 means
+// no acceleration is available and the portable code has to do the work.
+
+// CTR over block_count blocks starting at counter, only the last 32 bits count
+// and wrap.  counter is left at the next unused block.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_ctr32, const AES_KEY_SCHEDULE*, schedule, unsigned char*, counter,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+// CBC decrypt, iv is left at the last cipher block.  input and output may be the same.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_cbc_decrypt, const AES_KEY_SCHEDULE*, schedule, unsigned char*, iv,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+// The same at an explicit level instead of the global one and its wide
+// threshold, so candidates can be timed while other threads run.  Levels above
+// the detected one process nothing.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_ctr32_at_level, CRYPTO_AES_ACCEL, level, const AES_KEY_SCHEDULE*, schedule, unsigned char*, counter,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_cbc_decrypt_at_level, CRYPTO_AES_ACCEL, level, const AES_KEY_SCHEDULE*, schedule, unsigned char*, iv,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+// Independent blocks under one schedule.  input and output may be the same.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_ecb_encrypt, const AES_KEY_SCHEDULE*, schedule,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_ecb_decrypt, const AES_KEY_SCHEDULE*, schedule,
+    const unsigned char*, input, unsigned char*, output, size_t, block_count);
+
+// Fills h_powers (CRYPTO_AES_ACCEL_GCM_POWERS blocks) from the hash key, non zero when unsupported
+MOCKABLE_FUNCTION(, int, crypto_aes_accel_gcm_init, const unsigned char*, h_value, unsigned char*, h_powers);
+// GCM bulk blocks.  counter is the last counter block used and hash the running
+// GHASH value, both in the byte order crypto_gcm keeps them.
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_gcm_encrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, h_powers,
+    unsigned char*, counter, unsigned char*, hash, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+MOCKABLE_FUNCTION(, size_t, crypto_aes_accel_gcm_decrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, h_powers,
+    unsigned char*, counter, unsigned char*, hash, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstddef>
+#else
+    #include <stdlib.h>
+    #include <stddef.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+#define AES_BLOCK_SIZE      16
+#define AES_128_KEY_SIZE    16
+#define AES_192_KEY_SIZE    24
+#define AES_256_KEY_SIZE    32
+// Blocks the batch functions run through the rounds together
+#define AES_BATCH_WIDTH     4
+
+// Enough words for the 15 round keys of a 256-bit key
+#define AES_KEY_SCHED_WORDS 60
+
+// Expanded AES key.  The schedule is computed once and can then be used for
+// any number of blocks, it holds no pointers so it can be copied freely.
+// dec_key_sched holds the round keys of the equivalent inverse cipher, in
+// the order decryption uses them.
+typedef struct AES_KEY_SCHEDULE_TAG
+{
+    unsigned char key_sched[AES_KEY_SCHED_WORDS][4];
+    unsigned char dec_key_sched[AES_KEY_SCHED_WORDS][4];
+    size_t num_rounds;
+} AES_KEY_SCHEDULE;
+
+MOCKABLE_FUNCTION(, int, crypto_aes_key_init, AES_KEY_SCHEDULE*, schedule, const unsigned char*, key, size_t, key_len);
+MOCKABLE_FUNCTION(, void, crypto_aes_block_encrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, input_block, unsigned char*, output_block);
+MOCKABLE_FUNCTION(, void, crypto_aes_block_decrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, input_block, unsigned char*, output_block);
+
+// Encrypts block_count independent blocks with one schedule, several blocks
+// are processed together.  input and output may be the same buffer.
+MOCKABLE_FUNCTION(, int, crypto_aes_ecb_encrypt_blocks, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+MOCKABLE_FUNCTION(, int, crypto_aes_ecb_decrypt_blocks, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+
+// CTR mode, the counter block counts as one 128-bit big endian number and is
+// left at the next unused value.  input and output may be the same buffer.
+MOCKABLE_FUNCTION(, int, crypto_aes_ctr_xor, const AES_KEY_SCHEDULE*, schedule, unsigned char*, counter, const unsigned char*, input, size_t, input_len, unsigned char*, output);
+
+#ifdef __cplusplus
+}
+#endif
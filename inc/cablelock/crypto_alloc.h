@@ -0,0 +1,45 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+#define CRYPTO_CACHE_LINE_SIZE      64
+
+typedef void*(*CRYPTO_MALLOC_FUNC)(void* context, size_t size);
+typedef void(*CRYPTO_FREE_FUNC)(void* context, void* ptr);
+
+// Every internal allocation goes through these hooks.  They must be set
+// before any other cablelock call, passing NULL restores the default heap.
+MOCKABLE_FUNCTION(, int, crypto_alloc_set_functions, CRYPTO_MALLOC_FUNC, malloc_func, CRYPTO_FREE_FUNC, free_func, void*, context);
+MOCKABLE_FUNCTION(, void*, crypto_alloc_malloc, size_t, size);
+MOCKABLE_FUNCTION(, void, crypto_alloc_free, void*, ptr);
+
+// Fixed size pool of cache line aligned items, all memory is taken from the
+// allocator hooks when the pool is created.  A pool is not thread safe.
+typedef struct CRYPTO_POOL_INFO_TAG* CRYPTO_POOL_HANDLE;
+
+MOCKABLE_FUNCTION(, CRYPTO_POOL_HANDLE, crypto_pool_create, size_t, item_size, size_t, item_count);
+MOCKABLE_FUNCTION(, void, crypto_pool_destroy, CRYPTO_POOL_HANDLE, handle);
+
+// Returns NULL when every item is in use
+MOCKABLE_FUNCTION(, void*, crypto_pool_acquire, CRYPTO_POOL_HANDLE, handle);
+// Items are wiped before they are returned to the pool
+MOCKABLE_FUNCTION(, void, crypto_pool_release, CRYPTO_POOL_HANDLE, handle, void*, item);
+MOCKABLE_FUNCTION(, bool, crypto_pool_owns, CRYPTO_POOL_HANDLE, handle, const void*, item);
+// Usable bytes in each item, item_size rounded up to whole cache lines
+MOCKABLE_FUNCTION(, size_t, crypto_pool_get_slot_size, CRYPTO_POOL_HANDLE, handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,96 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Jobs a worker takes off the queue at a time
+#define CRYPTO_ASYNC_BATCH_SIZE     16
+
+typedef enum CRYPTO_ASYNC_CIPHER_TAG
+{
+    // key is an AES_KEY_SCHEDULE, input_len a multiple of AES_BLOCK_SIZE
+    CRYPTO_ASYNC_AES_ECB,
+    // key is a DES_KEY_SCHEDULE, input_len a multiple of DES_BLOCK_SIZE
+    CRYPTO_ASYNC_DES_ECB,
+    // key is a CRYPTO_GCM_KEY, iv the GCM_NONCE_SIZE nonce, tag GCM_TAG_SIZE
+    CRYPTO_ASYNC_AES_GCM,
+    // key is an AES_KEY_SCHEDULE, iv the nonce and tag_len the CCM tag length
+    CRYPTO_ASYNC_AES_CCM,
+    // key is a CRYPTO_XTS_KEY, iv the XTS_TWEAK_SIZE tweak
+    CRYPTO_ASYNC_AES_XTS
+} CRYPTO_ASYNC_CIPHER;
+
+typedef struct CRYPTO_ASYNC_JOB_TAG CRYPTO_ASYNC_JOB;
+
+// Runs on the worker that finished the job, it must not block
+typedef void(*ON_CRYPTO_ASYNC_COMPLETE)(void* context, CRYPTO_ASYNC_JOB* job);
+
+// Owned by the caller and left untouched by the engine until it completes.  The
+// key context and every buffer must stay valid until then.
+struct CRYPTO_ASYNC_JOB_TAG
+{
+    CRYPTO_ASYNC_CIPHER cipher;
+    bool encrypt;
+    const void* key;
+    const unsigned char* iv;
+    size_t iv_len;
+    const unsigned char* aad;
+    size_t aad_len;
+    const unsigned char* input;
+    size_t input_len;
+    unsigned char* output;
+    // Written on encrypt and checked on decrypt for the AEAD ciphers
+    unsigned char* tag;
+    size_t tag_len;
+
+    // NULL completes the job into the ring read by crypto_async_poll
+    ON_CRYPTO_ASYNC_COMPLETE on_complete;
+    void* complete_context;
+    // Result of the cipher call, set before the job completes
+    int result;
+};
+
+// Processes a batch of jobs, setting the result of each.  The software
+// provider runs the cipher cores, an offload device can supply its own and
+// fall back to crypto_async_software_process for anything it cannot handle.
+typedef void(*CRYPTO_ASYNC_PROCESS_FUNC)(void* context, CRYPTO_ASYNC_JOB** jobs, size_t job_count);
+
+typedef struct CRYPTO_ASYNC_CONFIG_TAG
+{
+    size_t thread_count;
+    // Most jobs submitted and not yet completed, rounded up to a power of 2
+    size_t queue_depth;
+    // NULL selects the software provider
+    CRYPTO_ASYNC_PROCESS_FUNC process_func;
+    void* process_context;
+} CRYPTO_ASYNC_CONFIG;
+
+typedef struct CRYPTO_ASYNC_INFO_TAG* CRYPTO_ASYNC_HANDLE;
+
+MOCKABLE_FUNCTION(, CRYPTO_ASYNC_HANDLE, crypto_async_create, const CRYPTO_ASYNC_CONFIG*, config);
+// Waits for the workers to finish every queued job, jobs still waiting in the
+// completion ring are not reported
+MOCKABLE_FUNCTION(, void, crypto_async_destroy, CRYPTO_ASYNC_HANDLE, handle);
+
+// Never blocks, fails when queue_depth jobs are already in flight
+MOCKABLE_FUNCTION(, int, crypto_async_submit, CRYPTO_ASYNC_HANDLE, handle, CRYPTO_ASYNC_JOB*, job);
+// Moves up to max_jobs completed jobs into jobs and returns how many
+MOCKABLE_FUNCTION(, size_t, crypto_async_poll, CRYPTO_ASYNC_HANDLE, handle, CRYPTO_ASYNC_JOB**, jobs, size_t, max_jobs);
+MOCKABLE_FUNCTION(, size_t, crypto_async_get_in_flight, CRYPTO_ASYNC_HANDLE, handle);
+
+MOCKABLE_FUNCTION(, void, crypto_async_software_process, void*, context, CRYPTO_ASYNC_JOB**, jobs, size_t, job_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,76 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Fixed size unsigned integers as arrays of 64-bit limbs, least significant
+// first.  Every function takes the limb count explicitly and nothing is
+// allocated, numbers live on the caller's stack or in its structures.
+#define CRYPTO_BIGNUM_MAX_LIMBS     64
+#define CRYPTO_BIGNUM_MAX_BYTES     (CRYPTO_BIGNUM_MAX_LIMBS * 8)
+
+// An odd modulus prepared for Montgomery multiplication, R = 2^(64 * limb_count)
+typedef struct CRYPTO_MONT_CONTEXT_TAG
+{
+    size_t limb_count;
+    // -modulus^-1 mod 2^64
+    uint64_t modulus_inv;
+    uint64_t modulus[CRYPTO_BIGNUM_MAX_LIMBS];
+    // R^2 mod modulus, multiplying by it converts into Montgomery form
+    uint64_t rr[CRYPTO_BIGNUM_MAX_LIMBS];
+} CRYPTO_MONT_CONTEXT;
+
+// Big endian bytes to limbs, fails when the value does not fit in limb_count
+MOCKABLE_FUNCTION(, int, crypto_bignum_from_bytes, uint64_t*, target, size_t, limb_count, const unsigned char*, bytes, size_t, bytes_len);
+// Limbs to exactly bytes_len big endian bytes, fails when the value does not fit
+MOCKABLE_FUNCTION(, int, crypto_bignum_to_bytes, unsigned char*, bytes, size_t, bytes_len, const uint64_t*, value, size_t, limb_count);
+// -1, 0 or 1, runs in variable time
+MOCKABLE_FUNCTION(, int, crypto_bignum_compare, const uint64_t*, left, const uint64_t*, right, size_t, limb_count);
+// target = left + right and left - right, returning the carry or borrow.  target may alias either input.
+MOCKABLE_FUNCTION(, uint64_t, crypto_bignum_add, uint64_t*, target, const uint64_t*, left, const uint64_t*, right, size_t, limb_count);
+MOCKABLE_FUNCTION(, uint64_t, crypto_bignum_sub, uint64_t*, target, const uint64_t*, left, const uint64_t*, right, size_t, limb_count);
+// Schoolbook product, target holds left_count + right_count limbs and must not overlap the inputs
+MOCKABLE_FUNCTION(, void, crypto_bignum_mul, uint64_t*, target, const uint64_t*, left, size_t, left_count, const uint64_t*, right, size_t, right_count);
+
+// The modulus must be odd with a non zero top limb
+MOCKABLE_FUNCTION(, int, crypto_bignum_mont_init, CRYPTO_MONT_CONTEXT*, context, const uint64_t*, modulus, size_t, limb_count);
+// left * right / R mod modulus for inputs below the modulus, target may alias either input
+MOCKABLE_FUNCTION(, void, crypto_bignum_mont_mul, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, left, const uint64_t*, right);
+// The same on the kernel picked by mulx instead of the global setting, for
+// timing both while other threads run.  mulx is ignored when the cpu lacks it.
+MOCKABLE_FUNCTION(, void, crypto_bignum_mont_mul_kernel, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, left, const uint64_t*, right, bool, mulx);
+// left - right mod modulus for inputs below the modulus, constant time
+MOCKABLE_FUNCTION(, void, crypto_bignum_mod_sub, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, left, const uint64_t*, right);
+// wide / R mod modulus, wide holds 2 * limb_count limbs and is below modulus * R
+MOCKABLE_FUNCTION(, void, crypto_bignum_mont_reduce, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, wide);
+// wide mod modulus for the same inputs as crypto_bignum_mont_reduce
+MOCKABLE_FUNCTION(, void, crypto_bignum_mod, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, wide);
+// base^exponent mod modulus with a fixed window and constant time table
+// reads, for secret exponents.  base is below the modulus, neither is in
+// Montgomery form.
+MOCKABLE_FUNCTION(, void, crypto_bignum_mod_exp, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, base, const uint64_t*, exponent, size_t, exponent_count);
+// Square and multiply in variable time, only for public exponents
+MOCKABLE_FUNCTION(, void, crypto_bignum_mod_exp_public, const CRYPTO_MONT_CONTEXT*, context, uint64_t*, target, const uint64_t*, base, uint64_t, exponent);
+
+// Whether the cpu has MULX/ADX, whatever the setting below
+MOCKABLE_FUNCTION(, bool, crypto_bignum_detect_mulx);
+// Whether the Montgomery multiply runs on the MULX/ADX kernel
+MOCKABLE_FUNCTION(, bool, crypto_bignum_get_mulx);
+// Turns the MULX/ADX kernel off or back on, fails when the cpu lacks it.
+// Meant for startup tuning and tests.
+MOCKABLE_FUNCTION(, int, crypto_bignum_set_mulx, bool, enable);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,51 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_sha256.h"
+
+// TLS MAC header without the length: sequence number, content type and version
+#define CBC_HMAC_SEQ_HEADER_SIZE    11
+#define CBC_HMAC_MAC_SIZE           SHA256_DIGEST_SIZE
+// Explicit iv, mac and the largest padding added when sealing
+#define CBC_HMAC_MAX_OVERHEAD       (AES_BLOCK_SIZE + CBC_HMAC_MAC_SIZE + AES_BLOCK_SIZE)
+
+typedef enum CBC_HMAC_MODE_TAG
+{
+    CBC_HMAC_MAC_THEN_ENCRYPT,
+    CBC_HMAC_ENCRYPT_THEN_MAC
+} CBC_HMAC_MODE;
+
+typedef struct CRYPTO_CBC_HMAC_KEY_TAG
+{
+    AES_KEY_SCHEDULE schedule;
+    CRYPTO_HMAC_SHA256_KEY mac_key;
+} CRYPTO_CBC_HMAC_KEY;
+
+MOCKABLE_FUNCTION(, int, crypto_cbc_hmac_key_init, CRYPTO_CBC_HMAC_KEY*, cbc_key, const unsigned char*, enc_key, size_t, enc_key_len,
+    const unsigned char*, mac_key, size_t, mac_key_len);
+
+// Writes the explicit iv followed by the protected fragment to output.  The
+// input may be placed at output + AES_BLOCK_SIZE to seal in place.
+MOCKABLE_FUNCTION(, int, crypto_cbc_hmac_seal, const CRYPTO_CBC_HMAC_KEY*, cbc_key, CBC_HMAC_MODE, mode, const unsigned char*, iv,
+    const unsigned char*, seq_header, const unsigned char*, input, size_t, input_len, unsigned char*, output, size_t, output_size, size_t*, output_len);
+// fragment is the explicit iv followed by the protected data, the plain text
+// is left in place at fragment + AES_BLOCK_SIZE
+MOCKABLE_FUNCTION(, int, crypto_cbc_hmac_open, const CRYPTO_CBC_HMAC_KEY*, cbc_key, CBC_HMAC_MODE, mode, const unsigned char*, seq_header,
+    unsigned char*, fragment, size_t, fragment_len, size_t*, plain_len);
+
+#ifdef __cplusplus
+}
+#endif
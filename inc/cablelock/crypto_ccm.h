@@ -0,0 +1,36 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+
+#define CCM_MIN_NONCE_SIZE      7
+#define CCM_MAX_NONCE_SIZE      13
+#define CCM_TAG_SIZE            16
+// The CCM_8 cipher suites and most IoT profiles truncate the tag
+#define CCM_SHORT_TAG_SIZE      8
+
+// tag_len is an even number of bytes from 4 to CCM_TAG_SIZE.  input and
+// output may point to the same buffer for in place operation.
+MOCKABLE_FUNCTION(, int, crypto_ccm_encrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, nonce, size_t, nonce_len,
+    const unsigned char*, aad, size_t, aad_len, const unsigned char*, input, size_t, input_len, unsigned char*, output,
+    unsigned char*, tag, size_t, tag_len);
+// On a tag mismatch the output is cleared
+MOCKABLE_FUNCTION(, int, crypto_ccm_decrypt, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, nonce, size_t, nonce_len,
+    const unsigned char*, aad, size_t, aad_len, const unsigned char*, input, size_t, input_len, unsigned char*, output,
+    const unsigned char*, tag, size_t, tag_len);
+
+#ifdef __cplusplus
+}
+#endif
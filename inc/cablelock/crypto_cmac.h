@@ -0,0 +1,50 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+
+#define CMAC_TAG_SIZE           AES_BLOCK_SIZE
+
+// AES key schedule with the two CMAC subkeys derived from it (RFC 4493)
+typedef struct CRYPTO_CMAC_KEY_TAG
+{
+    AES_KEY_SCHEDULE schedule;
+    unsigned char subkey1[AES_BLOCK_SIZE];
+    unsigned char subkey2[AES_BLOCK_SIZE];
+} CRYPTO_CMAC_KEY;
+
+// One message of a batch, the CMAC_TAG_SIZE tag is written to tag
+typedef struct CRYPTO_MAC_MESSAGE_TAG
+{
+    const unsigned char* data;
+    size_t data_len;
+    unsigned char* tag;
+} CRYPTO_MAC_MESSAGE;
+
+MOCKABLE_FUNCTION(, int, crypto_cmac_key_init, CRYPTO_CMAC_KEY*, cmac_key, const unsigned char*, key, size_t, key_len);
+MOCKABLE_FUNCTION(, int, crypto_cmac_compute, const CRYPTO_CMAC_KEY*, cmac_key, const unsigned char*, data, size_t, data_len, unsigned char*, tag);
+
+// Computes the tags of independent messages, up to AES_BATCH_WIDTH chains are
+// advanced together and a lane that finishes picks up the next message
+MOCKABLE_FUNCTION(, int, crypto_cmac_compute_batch, const CRYPTO_CMAC_KEY*, cmac_key, const CRYPTO_MAC_MESSAGE*, messages, size_t, message_count);
+
+// Raw CBC-MAC with a zero iv, only safe for messages of one fixed length.  The
+// data must be a non empty multiple of AES_BLOCK_SIZE.
+MOCKABLE_FUNCTION(, int, crypto_cbc_mac_compute, const AES_KEY_SCHEDULE*, schedule, const unsigned char*, data, size_t, data_len, unsigned char*, tag);
+MOCKABLE_FUNCTION(, int, crypto_cbc_mac_compute_batch, const AES_KEY_SCHEDULE*, schedule, const CRYPTO_MAC_MESSAGE*, messages, size_t, message_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,59 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_des_core.h"
+
+typedef enum CRYPTO_CONTEXT_CIPHER_TAG
+{
+    CRYPTO_CONTEXT_AES,
+    // Single DES for 8 byte keys, triple DES for 24 byte keys
+    CRYPTO_CONTEXT_DES
+} CRYPTO_CONTEXT_CIPHER;
+
+// Expanded key state handed out by the pool, each one starts on its own cache line
+typedef struct CRYPTO_CIPHER_CONTEXT_TAG
+{
+    CRYPTO_CONTEXT_CIPHER cipher;
+    union
+    {
+        AES_KEY_SCHEDULE aes;
+        DES_KEY_SCHEDULE des;
+    } schedule;
+} CRYPTO_CIPHER_CONTEXT;
+
+// Shared by every thread, free contexts sit on a lock-free stack
+typedef struct CRYPTO_CONTEXT_POOL_INFO_TAG* CRYPTO_CONTEXT_POOL_HANDLE;
+// Owned by one thread, acquire and release only touch the shared stack when
+// the cache runs empty or overflows, and then move half a cache at a time
+typedef struct CRYPTO_CONTEXT_CACHE_INFO_TAG* CRYPTO_CONTEXT_CACHE_HANDLE;
+
+MOCKABLE_FUNCTION(, CRYPTO_CONTEXT_POOL_HANDLE, crypto_context_pool_create, size_t, context_count);
+// Every cache must be destroyed first
+MOCKABLE_FUNCTION(, void, crypto_context_pool_destroy, CRYPTO_CONTEXT_POOL_HANDLE, pool);
+MOCKABLE_FUNCTION(, size_t, crypto_context_pool_get_free, CRYPTO_CONTEXT_POOL_HANDLE, pool);
+
+MOCKABLE_FUNCTION(, CRYPTO_CONTEXT_CACHE_HANDLE, crypto_context_cache_create, CRYPTO_CONTEXT_POOL_HANDLE, pool, size_t, cache_size);
+// Hands the cached contexts back to the pool
+MOCKABLE_FUNCTION(, void, crypto_context_cache_destroy, CRYPTO_CONTEXT_CACHE_HANDLE, cache);
+
+// Returns a context keyed with key, or NULL when the pool is exhausted
+MOCKABLE_FUNCTION(, CRYPTO_CIPHER_CONTEXT*, crypto_context_acquire, CRYPTO_CONTEXT_CACHE_HANDLE, cache, CRYPTO_CONTEXT_CIPHER, cipher, const unsigned char*, key, size_t, key_len);
+// Wipes only the key state the cipher used, the context may go back through any cache
+MOCKABLE_FUNCTION(, void, crypto_context_release, CRYPTO_CONTEXT_CACHE_HANDLE, cache, CRYPTO_CIPHER_CONTEXT*, context);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+#define DES_BLOCK_SIZE          8
+#define DES_KEY_SIZE            8
+#define DES3_KEY_SIZE           (3 * DES_KEY_SIZE)
+#define DES_SUBKEY_SIZE         6
+#define DES_ROUNDS              16
+// Blocks the batch functions interleave, each round runs across all of them
+#define DES_BATCH_WIDTH         8
+
+// Round subkeys for both directions of one or three DES keys.  Computed once
+// per key, it holds no pointers so it can be copied freely.
+typedef struct DES_KEY_SCHEDULE_TAG
+{
+    unsigned char encrypt_keys[3][DES_ROUNDS][DES_SUBKEY_SIZE];
+    unsigned char decrypt_keys[3][DES_ROUNDS][DES_SUBKEY_SIZE];
+    size_t key_count;
+} DES_KEY_SCHEDULE;
+
+// key_len is DES_KEY_SIZE for single DES or DES3_KEY_SIZE for triple DES
+MOCKABLE_FUNCTION(, int, crypto_des_key_init, DES_KEY_SCHEDULE*, schedule, const unsigned char*, key, size_t, key_len);
+MOCKABLE_FUNCTION(, void, crypto_des_block_encrypt, const DES_KEY_SCHEDULE*, schedule, const unsigned char*, input_block, unsigned char*, output_block);
+MOCKABLE_FUNCTION(, void, crypto_des_block_decrypt, const DES_KEY_SCHEDULE*, schedule, const unsigned char*, input_block, unsigned char*, output_block);
+
+// Encrypts block_count independent blocks with one schedule.  input and
+// output may be the same buffer.
+MOCKABLE_FUNCTION(, int, crypto_des_ecb_encrypt_blocks, const DES_KEY_SCHEDULE*, schedule, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+MOCKABLE_FUNCTION(, int, crypto_des_ecb_decrypt_blocks, const DES_KEY_SCHEDULE*, schedule, const unsigned char*, input, unsigned char*, output, size_t, block_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// NIST SP 800-90A CTR_DRBG over AES-256 without the derivation function.
+// Seed material is a full entropy key plus V, additional input is at most
+// that long and is zero padded.
+#define CRYPTO_DRBG_SEED_SIZE       48
+// Largest single generate request the standard allows (2^19 bits)
+#define CRYPTO_DRBG_MAX_REQUEST     65536
+// Generate requests between automatic reseeds from the system
+#define CRYPTO_DRBG_RESEED_INTERVAL (1 << 20)
+// Output the per-thread instance produces per refill
+#define CRYPTO_DRBG_BUFFER_SIZE     4096
+
+typedef struct CRYPTO_DRBG_INFO_TAG* CRYPTO_DRBG_HANDLE;
+
+// Seeds from getrandom, personalization may be NULL
+MOCKABLE_FUNCTION(, CRYPTO_DRBG_HANDLE, crypto_drbg_create, const unsigned char*, personalization, size_t, personalization_len);
+// Seeds from caller supplied entropy of exactly CRYPTO_DRBG_SEED_SIZE bytes,
+// for known answer tests and deterministic replays
+MOCKABLE_FUNCTION(, CRYPTO_DRBG_HANDLE, crypto_drbg_create_seeded, const unsigned char*, entropy, size_t, entropy_len, const unsigned char*, personalization, size_t, personalization_len);
+MOCKABLE_FUNCTION(, void, crypto_drbg_destroy, CRYPTO_DRBG_HANDLE, handle);
+
+// Mixes fresh system entropy and the optional additional input into the state
+MOCKABLE_FUNCTION(, int, crypto_drbg_reseed, CRYPTO_DRBG_HANDLE, handle, const unsigned char*, additional, size_t, additional_len);
+// One generate request of up to CRYPTO_DRBG_MAX_REQUEST bytes, additional may be NULL
+MOCKABLE_FUNCTION(, int, crypto_drbg_generate, CRYPTO_DRBG_HANDLE, handle, const unsigned char*, additional, size_t, additional_len, unsigned char*, output, size_t, output_len);
+
+// Random bytes for IVs, nonces and keys from an instance owned by the calling
+// thread.  Output is generated a buffer at a time so most calls are a copy,
+// bytes are wiped from the buffer once handed out.  The instance reseeds
+// after fork so parent and child never share output.
+MOCKABLE_FUNCTION(, int, crypto_drbg_random_bytes, unsigned char*, output, size_t, output_len);
+
+#ifdef __cplusplus
+}
+#endif
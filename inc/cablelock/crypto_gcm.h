@@ -0,0 +1,44 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_aes_accel.h"
+
+#define GCM_NONCE_SIZE      12
+#define GCM_TAG_SIZE        16
+
+// AES key schedule plus the 4-bit multiplication table of the hash key H, and
+// the powers of H for the carry-less multiply kernels when the cpu has them
+typedef struct CRYPTO_GCM_KEY_TAG
+{
+    AES_KEY_SCHEDULE schedule;
+    uint64_t h_high[16];
+    uint64_t h_low[16];
+    unsigned char h_powers[CRYPTO_AES_ACCEL_GCM_POWERS * AES_BLOCK_SIZE];
+    bool has_powers;
+} CRYPTO_GCM_KEY;
+
+MOCKABLE_FUNCTION(, int, crypto_gcm_key_init, CRYPTO_GCM_KEY*, gcm_key, const unsigned char*, key, size_t, key_len);
+
+// input and output may point to the same buffer for in place operation
+MOCKABLE_FUNCTION(, int, crypto_gcm_encrypt, const CRYPTO_GCM_KEY*, gcm_key, const unsigned char*, nonce, const unsigned char*, aad, size_t, aad_len,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output, unsigned char*, tag);
+// The data is authenticated and decrypted in one pass, on a tag mismatch the output is cleared
+MOCKABLE_FUNCTION(, int, crypto_gcm_decrypt, const CRYPTO_GCM_KEY*, gcm_key, const unsigned char*, nonce, const unsigned char*, aad, size_t, aad_len,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output, const unsigned char*, tag);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_des_core.h"
+
+typedef enum CRYPTO_KEY_STORE_CIPHER_TAG
+{
+    CRYPTO_KEY_STORE_AES,
+    // Single DES for 8 byte keys, triple DES for 24 byte keys
+    CRYPTO_KEY_STORE_DES
+} CRYPTO_KEY_STORE_CIPHER;
+
+typedef struct CRYPTO_KEY_STORE_ENTRY_TAG
+{
+    // Caller chosen, unique within one store
+    uint64_t key_id;
+    CRYPTO_KEY_STORE_CIPHER cipher;
+    const unsigned char* key;
+    size_t key_len;
+} CRYPTO_KEY_STORE_ENTRY;
+
+// A read-only mapping of a published store
+typedef struct CRYPTO_KEY_STORE_INFO_TAG* CRYPTO_KEY_STORE_HANDLE;
+
+// Expands every key into a new POSIX shared memory segment called name (for
+// example "/cablelock-keys") which is then made read-only.  Fails if the name
+// already exists.  Meant to run once in the parent before workers start.
+MOCKABLE_FUNCTION(, int, crypto_key_store_publish, const char*, name, const CRYPTO_KEY_STORE_ENTRY*, entries, size_t, entry_count);
+// Removes the name, mappings that are already open stay valid
+MOCKABLE_FUNCTION(, int, crypto_key_store_unlink, const char*, name);
+
+// Maps a published store read-only, every process shares the same pages
+MOCKABLE_FUNCTION(, CRYPTO_KEY_STORE_HANDLE, crypto_key_store_open, const char*, name);
+MOCKABLE_FUNCTION(, void, crypto_key_store_close, CRYPTO_KEY_STORE_HANDLE, handle);
+MOCKABLE_FUNCTION(, size_t, crypto_key_store_get_count, CRYPTO_KEY_STORE_HANDLE, handle);
+
+// The schedules point into the mapping and are used in place, they stay valid
+// until the store is closed.  NULL when the id is unknown or holds the other cipher.
+MOCKABLE_FUNCTION(, const AES_KEY_SCHEDULE*, crypto_key_store_find_aes, CRYPTO_KEY_STORE_HANDLE, handle, uint64_t, key_id);
+MOCKABLE_FUNCTION(, const DES_KEY_SCHEDULE*, crypto_key_store_find_des, CRYPTO_KEY_STORE_HANDLE, handle, uint64_t, key_id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+typedef enum CRYPTO_KEYSTREAM_CIPHER_TAG
+{
+    CRYPTO_KEYSTREAM_AES,
+    // Single DES for 8 byte keys, triple DES for 24 byte keys
+    CRYPTO_KEYSTREAM_DES
+} CRYPTO_KEYSTREAM_CIPHER;
+
+typedef enum CRYPTO_KEYSTREAM_MODE_TAG
+{
+    CRYPTO_KEYSTREAM_CTR,
+    CRYPTO_KEYSTREAM_OFB
+} CRYPTO_KEYSTREAM_MODE;
+
+typedef struct CRYPTO_KEYSTREAM_CONFIG_TAG
+{
+    // Bytes of keystream kept ready, rounded up to whole cipher blocks
+    size_t depth;
+    // After a message the ring is topped up once fewer bytes than this remain,
+    // 0 leaves all refilling to crypto_keystream_refill
+    size_t low_water;
+} CRYPTO_KEYSTREAM_CONFIG;
+
+typedef struct CRYPTO_KEYSTREAM_INFO_TAG* CRYPTO_KEYSTREAM_HANDLE;
+
+// iv is the initial counter block for CTR or the iv for OFB, one cipher block long
+MOCKABLE_FUNCTION(, CRYPTO_KEYSTREAM_HANDLE, crypto_keystream_create, CRYPTO_KEYSTREAM_CIPHER, cipher, CRYPTO_KEYSTREAM_MODE, mode,
+    const unsigned char*, key, size_t, key_len, const unsigned char*, iv, const CRYPTO_KEYSTREAM_CONFIG*, config);
+MOCKABLE_FUNCTION(, void, crypto_keystream_destroy, CRYPTO_KEYSTREAM_HANDLE, handle);
+
+// Generates keystream until the ring is full, meant to be called while the
+// connection is idle.  Returns the number of bytes now ready.
+MOCKABLE_FUNCTION(, size_t, crypto_keystream_refill, CRYPTO_KEYSTREAM_HANDLE, handle);
+MOCKABLE_FUNCTION(, size_t, crypto_keystream_get_available, CRYPTO_KEYSTREAM_HANDLE, handle);
+
+// Encrypts or decrypts by XOR'ing the next input_len bytes of keystream, any
+// shortfall in the ring is generated inline.  input and output may be the same.
+MOCKABLE_FUNCTION(, int, crypto_keystream_xor, CRYPTO_KEYSTREAM_HANDLE, handle, const unsigned char*, input, size_t, input_len, unsigned char*, output);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,4 +15,69 @@ static void xor_value(unsigned char* target, const unsigned char* src, size_t le
     }
 }
 
+// Big endian (network order) load and store of integers
+static uint32_t load_be32(const unsigned char* src)
+{
+    return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | (uint32_t)src[3];
+}
+
+static void store_be32(unsigned char* target, uint32_t value)
+{
+    target[0] = (unsigned char)(value >> 24);
+    target[1] = (unsigned char)(value >> 16);
+    target[2] = (unsigned char)(value >> 8);
+    target[3] = (unsigned char)value;
+}
+
+static uint64_t load_be64(const unsigned char* src)
+{
+    return ((uint64_t)load_be32(src) << 32) | load_be32(src + 4);
+}
+
+static void store_be64(unsigned char* target, uint64_t value)
+{
+    store_be32(target, (uint32_t)(value >> 32));
+    store_be32(target + 4, (uint32_t)value);
+}
+
+// Little endian load and store, used by the modes that count in that order
+static uint64_t load_le64(const unsigned char* src)
+{
+    uint64_t result = 0;
+    for (size_t index = 8; index > 0; index--)
+    {
+        result = (result << 8) | src[index - 1];
+    }
+    return result;
+}
+
+static void store_le64(unsigned char* target, uint64_t value)
+{
+    for (size_t index = 0; index < 8; index++)
+    {
+        target[index] = (unsigned char)(value >> (index * 8));
+    }
+}
+
+// Clear key material, the volatile write keeps the compiler from removing it
+static void secure_zero(void* target, size_t length)
+{
+    volatile unsigned char* iterator = (volatile unsigned char*)target;
+    while (length--)
+    {
+        *iterator++ = 0;
+    }
+}
+
+// Compare without leaking the position of the first difference, returns 0 on match
+static int const_time_compare(const unsigned char* left, const unsigned char* right, size_t length)
+{
+    unsigned char diff = 0;
+    while (length--)
+    {
+        diff |= *left++ ^ *right++;
+    }
+    return diff;
+}
+
 #endif // _CRYPTO_MACRO_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// NIST P-256 (secp256r1).  Private keys and shared secrets are 32 byte big
+// endian numbers, public keys are uncompressed points 0x04 | X | Y and
+// signatures are r | s, 32 bytes each.
+#define P256_PRIVATE_KEY_SIZE   32
+#define P256_PUBLIC_KEY_SIZE    65
+#define P256_SHARED_SECRET_SIZE 32
+#define P256_SIGNATURE_SIZE     64
+
+// Fresh private key from the thread drbg and its public key
+MOCKABLE_FUNCTION(, int, crypto_p256_keypair, unsigned char*, private_key, unsigned char*, public_key);
+// Fixed base multiply through the precomputed comb, constant time
+MOCKABLE_FUNCTION(, int, crypto_p256_public_key, unsigned char*, public_key, const unsigned char*, private_key);
+// ECDHE, the peer key is checked to be on the curve.  The secret is the X coordinate.
+MOCKABLE_FUNCTION(, int, crypto_p256_ecdh, unsigned char*, shared_secret, const unsigned char*, private_key, const unsigned char*, peer_public_key);
+
+// ECDSA over a message digest, digests longer than 32 bytes are truncated as
+// FIPS 186 describes.  The nonce comes from the thread drbg.
+MOCKABLE_FUNCTION(, int, crypto_p256_sign, unsigned char*, signature, const unsigned char*, private_key, const unsigned char*, digest, size_t, digest_len);
+// Returns 0 only for a valid signature, runs in variable time on public data
+MOCKABLE_FUNCTION(, int, crypto_p256_verify, const unsigned char*, public_key, const unsigned char*, digest, size_t, digest_len, const unsigned char*, signature);
+
+#ifdef __cplusplus
+}
+#endif
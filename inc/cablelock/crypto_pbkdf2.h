@@ -0,0 +1,56 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Output blocks iterated side by side, one per 32-bit lane of an AVX2 register
+#define PBKDF2_SHA256_LANES     8
+
+typedef struct CRYPTO_PBKDF2_JOB_TAG
+{
+    const unsigned char* password;
+    size_t password_len;
+    const unsigned char* salt;
+    size_t salt_len;
+    unsigned char* output;
+    size_t output_len;
+} CRYPTO_PBKDF2_JOB;
+
+typedef enum CRYPTO_PBKDF2_KERNEL_TAG
+{
+    // Groups of blocks on the lanes unless the SHA extensions are faster
+    CRYPTO_PBKDF2_KERNEL_AUTO,
+    // Every block on its own, through the SHA extensions when present
+    CRYPTO_PBKDF2_KERNEL_SINGLE,
+    // Every group on the lanes, even a lone block
+    CRYPTO_PBKDF2_KERNEL_LANES
+} CRYPTO_PBKDF2_KERNEL;
+
+// RFC 8018 PBKDF2 with HMAC-SHA256.  The pads are hashed once per password
+// and every 32 byte output block runs in its own lane, so keys longer than 32
+// bytes cost little more than one block.
+MOCKABLE_FUNCTION(, int, crypto_pbkdf2_sha256, const unsigned char*, password, size_t, password_len, const unsigned char*, salt, size_t, salt_len,
+    uint32_t, iterations, unsigned char*, output, size_t, output_len);
+// Derives several keys with the same iteration count, for example one per
+// archive or one per candidate password, filling all lanes across jobs
+MOCKABLE_FUNCTION(, int, crypto_pbkdf2_sha256_batch, const CRYPTO_PBKDF2_JOB*, jobs, size_t, job_count, uint32_t, iterations);
+
+MOCKABLE_FUNCTION(, CRYPTO_PBKDF2_KERNEL, crypto_pbkdf2_get_kernel);
+// Forces the kernel for every thread, meant for startup tuning and tests.
+// The lanes fail on compilers without vector extensions.
+MOCKABLE_FUNCTION(, int, crypto_pbkdf2_set_kernel, CRYPTO_PBKDF2_KERNEL, kernel);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_alloc.h"
+
+#define TLS_RECORD_HEADER_SIZE      5
+#define TLS_MAX_PLAINTEXT_SIZE      16384
+
+#define TLS_CONTENT_CHANGE_CIPHER   20
+#define TLS_CONTENT_ALERT           21
+#define TLS_CONTENT_HANDSHAKE       22
+#define TLS_CONTENT_APPLICATION     23
+
+typedef enum CRYPTO_RECORD_VERSION_TAG
+{
+    CRYPTO_RECORD_TLS_1_2,
+    CRYPTO_RECORD_TLS_1_3
+} CRYPTO_RECORD_VERSION;
+
+typedef enum CRYPTO_RECORD_CIPHER_TAG
+{
+    CRYPTO_RECORD_AES_128_GCM,
+    CRYPTO_RECORD_AES_256_GCM,
+    CRYPTO_RECORD_AES_128_CBC_SHA256,
+    CRYPTO_RECORD_AES_256_CBC_SHA256
+} CRYPTO_RECORD_CIPHER;
+
+// One handle protects a single direction of a connection
+typedef struct CRYPTO_RECORD_INFO_TAG* CRYPTO_RECORD_HANDLE;
+
+// The handle is taken from pool when one is given, falling back to the
+// allocator once it is exhausted, and from the allocator when pool is NULL.
+// A pool is not thread safe, so every handle sharing one must be created and
+// destroyed under the caller's lock or on a single thread.  The pool must
+// outlive its handles and hold items of crypto_record_get_context_size.
+MOCKABLE_FUNCTION(, size_t, crypto_record_get_context_size);
+
+// For TLS 1.2 the iv is the 4 byte implicit salt, for TLS 1.3 the 12 byte write iv
+MOCKABLE_FUNCTION(, CRYPTO_RECORD_HANDLE, crypto_record_create, CRYPTO_RECORD_VERSION, version, CRYPTO_RECORD_CIPHER, cipher,
+    const unsigned char*, key, size_t, key_len, const unsigned char*, iv, size_t, iv_len, CRYPTO_POOL_HANDLE, pool);
+// TLS 1.2 CBC suites, encrypt_then_mac selects the RFC 7366 record format
+MOCKABLE_FUNCTION(, CRYPTO_RECORD_HANDLE, crypto_record_create_cbc, CRYPTO_RECORD_CIPHER, cipher, const unsigned char*, enc_key, size_t, enc_key_len,
+    const unsigned char*, mac_key, size_t, mac_key_len, bool, encrypt_then_mac, CRYPTO_POOL_HANDLE, pool);
+MOCKABLE_FUNCTION(, void, crypto_record_destroy, CRYPTO_RECORD_HANDLE, handle);
+
+// Bytes the caller must reserve in front of and behind the payload when sealing
+MOCKABLE_FUNCTION(, size_t, crypto_record_get_headroom, CRYPTO_RECORD_HANDLE, handle);
+MOCKABLE_FUNCTION(, size_t, crypto_record_get_tailroom, CRYPTO_RECORD_HANDLE, handle);
+
+// Returns the full length of the record starting at data, or 0 when the header is not complete
+MOCKABLE_FUNCTION(, size_t, crypto_record_get_length, const unsigned char*, data, size_t, data_len);
+
+// The payload_len bytes at record + headroom are encrypted in place and the header and tag written
+// around them, record_size is the capacity of the record buffer
+MOCKABLE_FUNCTION(, int, crypto_record_seal, CRYPTO_RECORD_HANDLE, handle, unsigned char, content_type, unsigned char*, record,
+    size_t, record_size, size_t, payload_len, size_t*, record_len);
+// Authenticates and decrypts a full record in place, payload points into the record buffer
+MOCKABLE_FUNCTION(, int, crypto_record_open, CRYPTO_RECORD_HANDLE, handle, unsigned char*, record, size_t, record_len,
+    unsigned char*, content_type, unsigned char**, payload, size_t*, payload_len);
+
+#ifdef __cplusplus
+}
+#endif
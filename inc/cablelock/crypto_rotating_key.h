@@ -0,0 +1,43 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_context_pool.h"
+
+// A key that can be replaced under load.  Readers bracket each operation with
+// enter and leave, which take no lock and never wait.  Rotation publishes a
+// freshly expanded context, waits until every reader that could still see the
+// old one has left, then wipes and frees it.
+typedef struct CRYPTO_ROTATING_KEY_INFO_TAG* CRYPTO_ROTATING_KEY_HANDLE;
+// Owned by one thread, like a context cache
+typedef struct CRYPTO_KEY_READER_INFO_TAG* CRYPTO_KEY_READER_HANDLE;
+
+MOCKABLE_FUNCTION(, CRYPTO_ROTATING_KEY_HANDLE, crypto_rotating_key_create, CRYPTO_CONTEXT_CIPHER, cipher, const unsigned char*, key, size_t, key_len);
+// Every reader must be destroyed first
+MOCKABLE_FUNCTION(, void, crypto_rotating_key_destroy, CRYPTO_ROTATING_KEY_HANDLE, handle);
+// Expands key before publishing it and returns once the old context is wiped.
+// Rotations are serialized, a reader holding on forever stalls them.
+MOCKABLE_FUNCTION(, int, crypto_rotating_key_rotate, CRYPTO_ROTATING_KEY_HANDLE, handle, const unsigned char*, key, size_t, key_len);
+// Starts at 1 and counts rotations
+MOCKABLE_FUNCTION(, uint64_t, crypto_rotating_key_get_generation, CRYPTO_ROTATING_KEY_HANDLE, handle);
+
+MOCKABLE_FUNCTION(, CRYPTO_KEY_READER_HANDLE, crypto_key_reader_create, CRYPTO_ROTATING_KEY_HANDLE, handle);
+MOCKABLE_FUNCTION(, void, crypto_key_reader_destroy, CRYPTO_KEY_READER_HANDLE, reader);
+// The context stays valid and unchanged until leave, enter does not nest
+MOCKABLE_FUNCTION(, const CRYPTO_CIPHER_CONTEXT*, crypto_key_reader_enter, CRYPTO_KEY_READER_HANDLE, reader);
+MOCKABLE_FUNCTION(, void, crypto_key_reader_leave, CRYPTO_KEY_READER_HANDLE, reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Moduli from 2048 up to 4096 bits, both primes the same number of 64-bit
+// limbs.  Public exponents are odd and fit in 64 bits.
+#define RSA_MIN_MODULUS_SIZE    256
+#define RSA_MAX_MODULUS_SIZE    512
+// Public keys whose prepared Montgomery context verification keeps around
+#define RSA_VERIFY_CACHE_SLOTS  64
+
+// Private key components as big endian byte strings, the CRT form of PKCS #1
+typedef struct RSA_PRIVATE_KEY_PARTS_TAG
+{
+    const unsigned char* modulus;
+    size_t modulus_len;
+    const unsigned char* public_exponent;
+    size_t public_exponent_len;
+    const unsigned char* prime1;
+    size_t prime1_len;
+    const unsigned char* prime2;
+    size_t prime2_len;
+    // d mod (p - 1), d mod (q - 1) and q^-1 mod p
+    const unsigned char* exponent1;
+    size_t exponent1_len;
+    const unsigned char* exponent2;
+    size_t exponent2_len;
+    const unsigned char* coefficient;
+    size_t coefficient_len;
+} RSA_PRIVATE_KEY_PARTS;
+
+typedef struct RSA_KEY_INFO_TAG* RSA_KEY_HANDLE;
+
+// Checks n = p * q and prepares both prime contexts and the blinding pair
+MOCKABLE_FUNCTION(, RSA_KEY_HANDLE, crypto_rsa_key_create, const RSA_PRIVATE_KEY_PARTS*, parts);
+MOCKABLE_FUNCTION(, void, crypto_rsa_key_destroy, RSA_KEY_HANDLE, handle);
+// Modulus size in bytes, the length of every input and output below
+MOCKABLE_FUNCTION(, size_t, crypto_rsa_key_get_size, RSA_KEY_HANDLE, handle);
+
+// Raw input^d mod n through the CRT with base blinding.  The result is
+// checked against the public exponent before it is released.
+MOCKABLE_FUNCTION(, int, crypto_rsa_private_operation, RSA_KEY_HANDLE, handle, const unsigned char*, input, unsigned char*, output);
+// RSASSA-PKCS1-v1_5 over a SHA-256 digest, signature is the modulus size
+MOCKABLE_FUNCTION(, int, crypto_rsa_sign_pkcs1_sha256, RSA_KEY_HANDLE, handle, const unsigned char*, digest, unsigned char*, signature);
+// Returns 0 only for a valid signature.  The Montgomery context of the public
+// key is cached, repeated verifications under one key skip its setup.
+MOCKABLE_FUNCTION(, int, crypto_rsa_verify_pkcs1_sha256, const unsigned char*, modulus, size_t, modulus_len, const unsigned char*, public_exponent, size_t, public_exponent_len,
+    const unsigned char*, digest, const unsigned char*, signature, size_t, signature_len);
+
+#ifdef __cplusplus
+}
+#endif
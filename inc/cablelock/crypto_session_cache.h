@@ -0,0 +1,53 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Session IDs are at most 32 bytes in every TLS version
+#define CRYPTO_SESSION_ID_MAX_SIZE      32
+// Entries per shard, a session ID hashes to exactly one shard
+#define CRYPTO_SESSION_CACHE_WAYS       8
+
+typedef struct CRYPTO_SESSION_CACHE_STATS_TAG
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} CRYPTO_SESSION_CACHE_STATS;
+
+// Fixed size session ID cache.  Memory is allocated once, every shard holds
+// CRYPTO_SESSION_CACHE_WAYS entries and evicts with the CLOCK algorithm.
+// Lookups take no lock and only touch the one shard the ID hashes to; inserts
+// claim a single entry with a compare and swap.
+typedef struct CRYPTO_SESSION_CACHE_INFO_TAG* CRYPTO_SESSION_CACHE_HANDLE;
+
+// capacity is rounded up to a power of two number of shards.  Entries hold up
+// to state_size bytes and expire lifetime_seconds after insertion, 0 never.
+MOCKABLE_FUNCTION(, CRYPTO_SESSION_CACHE_HANDLE, crypto_session_cache_create, size_t, capacity, size_t, state_size, uint32_t, lifetime_seconds);
+MOCKABLE_FUNCTION(, void, crypto_session_cache_destroy, CRYPTO_SESSION_CACHE_HANDLE, handle);
+
+// Replaces an entry with the same ID.  Fails only when every candidate entry
+// is being written by another thread at that moment.
+MOCKABLE_FUNCTION(, int, crypto_session_cache_insert, CRYPTO_SESSION_CACHE_HANDLE, handle, const unsigned char*, session_id, size_t, session_id_len,
+    const unsigned char*, state, size_t, state_len);
+// Copies the state of a live entry into state (at least state_size bytes), non zero on a miss
+MOCKABLE_FUNCTION(, int, crypto_session_cache_lookup, CRYPTO_SESSION_CACHE_HANDLE, handle, const unsigned char*, session_id, size_t, session_id_len,
+    unsigned char*, state, size_t*, state_len);
+MOCKABLE_FUNCTION(, void, crypto_session_cache_remove, CRYPTO_SESSION_CACHE_HANDLE, handle, const unsigned char*, session_id, size_t, session_id_len);
+// Counters summed over the shards, approximate while other threads run
+MOCKABLE_FUNCTION(, int, crypto_session_cache_get_stats, CRYPTO_SESSION_CACHE_HANDLE, handle, CRYPTO_SESSION_CACHE_STATS*, stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_gcm.h"
+
+// RFC 5077 style tickets: key name | nonce | AES-256-GCM(state) | tag, the
+// key name is authenticated as additional data
+#define CRYPTO_TICKET_KEY_NAME_SIZE     16
+#define CRYPTO_TICKET_KEY_SIZE          AES_256_KEY_SIZE
+#define CRYPTO_TICKET_OVERHEAD          (CRYPTO_TICKET_KEY_NAME_SIZE + GCM_NONCE_SIZE + GCM_TAG_SIZE)
+// TLS carries tickets with a 16-bit length
+#define CRYPTO_TICKET_MAX_SIZE          0xFFFF
+// The sealing key plus the previous ones, which still open their tickets
+#define CRYPTO_TICKET_KEY_SLOTS         4
+
+typedef struct CRYPTO_TICKET_KEYS_INFO_TAG* CRYPTO_TICKET_KEYS_HANDLE;
+
+// Starts with one random key
+MOCKABLE_FUNCTION(, CRYPTO_TICKET_KEYS_HANDLE, crypto_ticket_keys_create);
+MOCKABLE_FUNCTION(, void, crypto_ticket_keys_destroy, CRYPTO_TICKET_KEYS_HANDLE, handle);
+// Makes a new key the sealing key and retires the oldest one.  Servers that
+// share tickets pass the same name and key everywhere, NULL for both draws
+// them from the thread drbg.  Seal and open take no lock and are never blocked.
+MOCKABLE_FUNCTION(, int, crypto_ticket_keys_rotate, CRYPTO_TICKET_KEYS_HANDLE, handle, const unsigned char*, key_name, const unsigned char*, key, size_t, key_len);
+
+// ticket receives state_len + CRYPTO_TICKET_OVERHEAD bytes
+MOCKABLE_FUNCTION(, int, crypto_ticket_seal, CRYPTO_TICKET_KEYS_HANDLE, handle, const unsigned char*, state, size_t, state_len, unsigned char*, ticket);
+// state receives ticket_len - CRYPTO_TICKET_OVERHEAD bytes.  renew is set
+// when the ticket was sealed under a retired key and should be reissued.
+MOCKABLE_FUNCTION(, int, crypto_ticket_open, CRYPTO_TICKET_KEYS_HANDLE, handle, const unsigned char*, ticket, size_t, ticket_len, unsigned char*, state, bool*, renew);
+
+#ifdef __cplusplus
+}
+#endif
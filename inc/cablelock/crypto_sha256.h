@@ -0,0 +1,62 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+#define SHA256_BLOCK_SIZE   64
+#define SHA256_DIGEST_SIZE  32
+#define SHA256_STATE_WORDS  8
+
+typedef struct CRYPTO_SHA256_TAG
+{
+    uint32_t state[SHA256_STATE_WORDS];
+    uint64_t total_len;
+    unsigned char buffer[SHA256_BLOCK_SIZE];
+    size_t buffer_len;
+} CRYPTO_SHA256;
+
+// HMAC key stored as the hash states after the inner and outer pads so
+// the pads are only compressed once per key
+typedef struct CRYPTO_HMAC_SHA256_KEY_TAG
+{
+    uint32_t inner_state[SHA256_STATE_WORDS];
+    uint32_t outer_state[SHA256_STATE_WORDS];
+} CRYPTO_HMAC_SHA256_KEY;
+
+// Compression split into round ranges so callers can interleave it with
+// other independent work, such as AES-CBC blocks
+typedef struct CRYPTO_SHA256_ROUNDS_TAG
+{
+    uint32_t schedule[64];
+    uint32_t working[SHA256_STATE_WORDS];
+} CRYPTO_SHA256_ROUNDS;
+
+MOCKABLE_FUNCTION(, void, crypto_sha256_init, CRYPTO_SHA256*, sha);
+MOCKABLE_FUNCTION(, void, crypto_sha256_update, CRYPTO_SHA256*, sha, const unsigned char*, data, size_t, data_len);
+MOCKABLE_FUNCTION(, void, crypto_sha256_finish, CRYPTO_SHA256*, sha, unsigned char*, digest);
+// Runs the compression function over one full block
+MOCKABLE_FUNCTION(, void, crypto_sha256_compress, uint32_t*, state, const unsigned char*, block);
+MOCKABLE_FUNCTION(, void, crypto_sha256_rounds_begin, CRYPTO_SHA256_ROUNDS*, rounds, const uint32_t*, state, const unsigned char*, block);
+MOCKABLE_FUNCTION(, void, crypto_sha256_rounds_run, CRYPTO_SHA256_ROUNDS*, rounds, size_t, first_round, size_t, round_count);
+MOCKABLE_FUNCTION(, void, crypto_sha256_rounds_end, const CRYPTO_SHA256_ROUNDS*, rounds, uint32_t*, state);
+MOCKABLE_FUNCTION(, int, crypto_sha256, const unsigned char*, data, size_t, data_len, unsigned char*, digest);
+
+MOCKABLE_FUNCTION(, int, crypto_hmac_sha256_key_init, CRYPTO_HMAC_SHA256_KEY*, hmac_key, const unsigned char*, key, size_t, key_len);
+MOCKABLE_FUNCTION(, void, crypto_hmac_sha256_start, const CRYPTO_HMAC_SHA256_KEY*, hmac_key, CRYPTO_SHA256*, sha);
+MOCKABLE_FUNCTION(, void, crypto_hmac_sha256_finish, const CRYPTO_HMAC_SHA256_KEY*, hmac_key, CRYPTO_SHA256*, sha, unsigned char*, mac);
+MOCKABLE_FUNCTION(, int, crypto_hmac_sha256, const unsigned char*, key, size_t, key_len, const unsigned char*, data, size_t, data_len, unsigned char*, mac);
+
+#ifdef __cplusplus
+}
+#endif
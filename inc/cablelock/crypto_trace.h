@@ -0,0 +1,52 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+// Static tracepoints under the cablelock provider, built in with the
+// cablelock_usdt cmake option.  Each probe is a single nop until a tracer
+// attaches, for example
+//   bpftrace -e 'usdt:libcablelock.so:cablelock:cipher_exit { @[arg0, arg1] = hist(arg2); }'
+//
+//   cipher_entry(cipher, mode, length)
+//   cipher_exit(cipher, mode, length, outcome)
+//   key_setup(cipher, key_len, outcome)
+
+// cipher argument
+#define CRYPTO_TRACE_DES            1
+#define CRYPTO_TRACE_3DES           2
+#define CRYPTO_TRACE_AES_128        3
+#define CRYPTO_TRACE_AES_256        4
+#define CRYPTO_TRACE_AES            5
+
+// mode argument, a NULL init vector runs the block cipher in ECB
+#define CRYPTO_TRACE_ECB_ENCRYPT    1
+#define CRYPTO_TRACE_ECB_DECRYPT    2
+#define CRYPTO_TRACE_CBC_ENCRYPT    3
+#define CRYPTO_TRACE_CBC_DECRYPT    4
+
+// outcome argument, unlike the line numbers the functions return these stay
+// the same from one release to the next
+#define CRYPTO_TRACE_OK                 0
+#define CRYPTO_TRACE_INVALID_ARGUMENT   1
+// Input not a whole number of blocks, output too small or a bad key length
+#define CRYPTO_TRACE_INVALID_LENGTH     2
+#define CRYPTO_TRACE_ALLOC_FAILURE      3
+#define CRYPTO_TRACE_KEY_FAILURE        4
+
+#define CRYPTO_TRACE_MODE(encrypt, init_vector) \
+    ((init_vector) == NULL ? ((encrypt) ? CRYPTO_TRACE_ECB_ENCRYPT : CRYPTO_TRACE_ECB_DECRYPT) : ((encrypt) ? CRYPTO_TRACE_CBC_ENCRYPT : CRYPTO_TRACE_CBC_DECRYPT))
+
+#ifdef CABLELOCK_USDT
+    #include <sys/sdt.h>
+
+    #define CRYPTO_TRACE_CIPHER_ENTRY(cipher, mode, length) \
+        DTRACE_PROBE3(cablelock, cipher_entry, (int)(cipher), (int)(mode), (size_t)(length))
+    #define CRYPTO_TRACE_CIPHER_EXIT(cipher, mode, length, outcome) \
+        DTRACE_PROBE4(cablelock, cipher_exit, (int)(cipher), (int)(mode), (size_t)(length), (int)(outcome))
+    #define CRYPTO_TRACE_KEY_SETUP(cipher, key_len, outcome) \
+        DTRACE_PROBE3(cablelock, key_setup, (int)(cipher), (size_t)(key_len), (int)(outcome))
+#else
+    #define CRYPTO_TRACE_CIPHER_ENTRY(cipher, mode, length)
+    #define CRYPTO_TRACE_CIPHER_EXIT(cipher, mode, length, outcome)     (void)(outcome)
+    #define CRYPTO_TRACE_KEY_SETUP(cipher, key_len, outcome)            (void)(outcome)
+#endif
@@ -0,0 +1,58 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstddef>
+#else
+    #include <stdlib.h>
+    #include <stddef.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_accel.h"
+
+// Bumped whenever the measurements change meaning, older cache files are
+// then recalibrated
+#define CRYPTO_TUNE_VERSION     1
+
+// What calibration settled on for this host
+typedef struct CRYPTO_TUNE_PROFILE_TAG
+{
+    // Fastest AES kernels for bulk CTR and CBC decrypt, and the call size in
+    // blocks below which AES-NI still beats the VAES512 kernels
+    CRYPTO_AES_ACCEL aes_level;
+    size_t aes_wide_threshold;
+    // Whether the MULX/ADX Montgomery multiply beats the portable one
+    bool bignum_mulx;
+    // Bytes of independent work, XTS sectors for example, from which handing
+    // half to a second thread pays for starting it.  0 when it never did,
+    // including on single cpu hosts.
+    size_t parallel_threshold;
+} CRYPTO_TUNE_PROFILE;
+
+// Benchmarks the kernels this cpu offers, tens of milliseconds.  Candidates
+// run through explicit kernels and the global settings are never touched, so
+// other threads may keep using the library meanwhile.
+MOCKABLE_FUNCTION(, int, crypto_tune_calibrate, CRYPTO_TUNE_PROFILE*, profile);
+// Sets the AES level and wide threshold and the bignum kernel from profile
+MOCKABLE_FUNCTION(, int, crypto_tune_apply, const CRYPTO_TUNE_PROFILE*, profile);
+
+// A small text file keyed by the cpu model, cpu count and detected features,
+// so a cache copied to different hardware is recalibrated instead of trusted
+MOCKABLE_FUNCTION(, int, crypto_tune_load, const char*, path, CRYPTO_TUNE_PROFILE*, profile);
+// Written to a new mkstemp file beside path, synced and renamed over it, so a
+// reader never sees half a file
+MOCKABLE_FUNCTION(, int, crypto_tune_save, const char*, path, const CRYPTO_TUNE_PROFILE*, profile);
+
+// Startup entry point: loads cache_path when it matches this host, otherwise
+// calibrates and rewrites it, then applies the result.  cache_path may be NULL
+// to calibrate every time and profile NULL when the caller does not need it.
+MOCKABLE_FUNCTION(, int, crypto_tune_init, const char*, cache_path, CRYPTO_TUNE_PROFILE*, profile);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+
+// Private keys, public keys and shared secrets are all 32 byte little endian strings (RFC 7748)
+#define X25519_KEY_SIZE     32
+
+// Fresh private key from the thread drbg and its public key, for one ECDHE exchange
+MOCKABLE_FUNCTION(, int, crypto_x25519_keypair, unsigned char*, private_key, unsigned char*, public_key);
+// Multiplies the base point, uses precomputed multiples and no ladder
+MOCKABLE_FUNCTION(, int, crypto_x25519_public_key, unsigned char*, public_key, const unsigned char*, private_key);
+// Constant time Montgomery ladder on the peer's public key.  Fails when the
+// result is all zero, meaning the peer sent a low order point.
+MOCKABLE_FUNCTION(, int, crypto_x25519, unsigned char*, shared_secret, const unsigned char*, private_key, const unsigned char*, peer_public_key);
+
+#ifdef __cplusplus
+}
+#endif
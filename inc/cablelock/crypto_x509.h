@@ -0,0 +1,122 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_session_cache.h"
+
+#define DER_TAG_BOOLEAN             0x01
+#define DER_TAG_INTEGER             0x02
+#define DER_TAG_BIT_STRING          0x03
+#define DER_TAG_OCTET_STRING        0x04
+#define DER_TAG_NULL                0x05
+#define DER_TAG_OID                 0x06
+#define DER_TAG_UTC_TIME            0x17
+#define DER_TAG_GENERALIZED_TIME    0x18
+#define DER_TAG_SEQUENCE            0x30
+#define DER_TAG_SET                 0x31
+
+// Points into the buffer that was parsed, nothing is copied
+typedef struct DER_ELEMENT_TAG
+{
+    // Tag, length and value
+    const unsigned char* encoding;
+    size_t encoding_len;
+    const unsigned char* value;
+    size_t value_len;
+    unsigned char tag;
+} DER_ELEMENT;
+
+// TBSCertificate fields in encoding order
+typedef enum X509_FIELD_TAG
+{
+    // Explicit [0], absent in version 1 certificates
+    X509_FIELD_VERSION,
+    X509_FIELD_SERIAL_NUMBER,
+    X509_FIELD_SIGNATURE_ALGORITHM,
+    X509_FIELD_ISSUER,
+    X509_FIELD_VALIDITY,
+    X509_FIELD_SUBJECT,
+    X509_FIELD_PUBLIC_KEY_INFO,
+    // The SEQUENCE inside explicit [3], absent before version 3
+    X509_FIELD_EXTENSIONS,
+    X509_FIELD_COUNT
+} X509_FIELD;
+
+typedef enum X509_KEY_TYPE_TAG
+{
+    X509_KEY_TYPE_RSA,
+    X509_KEY_TYPE_P256
+} X509_KEY_TYPE;
+
+typedef struct X509_PUBLIC_KEY_TAG
+{
+    X509_KEY_TYPE type;
+    // RSA
+    const unsigned char* modulus;
+    size_t modulus_len;
+    const unsigned char* public_exponent;
+    size_t public_exponent_len;
+    // P-256, uncompressed point
+    const unsigned char* point;
+    size_t point_len;
+} X509_PUBLIC_KEY;
+
+// Caller owned, parsing allocates nothing and the DER buffer must outlive it.
+// Only the outer structure is checked up front, TBS fields are located the
+// first time one of them is asked for and remembered.  Accessors update the
+// structure, so one certificate belongs to one thread at a time.
+typedef struct X509_CERTIFICATE_TAG
+{
+    DER_ELEMENT certificate;
+    DER_ELEMENT tbs;
+    DER_ELEMENT signature_algorithm;
+    DER_ELEMENT signature;
+    DER_ELEMENT fields[X509_FIELD_COUNT];
+    uint32_t found_fields;
+    // Where the walk over the TBS stopped
+    size_t tbs_offset;
+    X509_FIELD next_field;
+    bool tbs_done;
+    bool tbs_invalid;
+} X509_CERTIFICATE;
+
+// One DER element at the start of data, strict DER only: definite minimal
+// lengths and single byte tags
+MOCKABLE_FUNCTION(, int, crypto_der_read, DER_ELEMENT*, element, const unsigned char*, data, size_t, data_len);
+// Next element inside a constructed parent, offset starts at 0 and is advanced
+MOCKABLE_FUNCTION(, int, crypto_der_read_child, DER_ELEMENT*, child, const DER_ELEMENT*, parent, size_t*, offset);
+
+MOCKABLE_FUNCTION(, int, crypto_x509_parse, X509_CERTIFICATE*, certificate, const unsigned char*, der, size_t, der_len);
+MOCKABLE_FUNCTION(, int, crypto_x509_get_field, X509_CERTIFICATE*, certificate, X509_FIELD, field, DER_ELEMENT*, element);
+// Seconds since the Unix epoch
+MOCKABLE_FUNCTION(, int, crypto_x509_get_validity, X509_CERTIFICATE*, certificate, int64_t*, not_before, int64_t*, not_after);
+// RSA and P-256 keys, the key points into the certificate
+MOCKABLE_FUNCTION(, int, crypto_x509_get_public_key, X509_CERTIFICATE*, certificate, X509_PUBLIC_KEY*, key);
+// extension receives the extnValue OCTET STRING, oid is the encoded value without tag and length
+MOCKABLE_FUNCTION(, int, crypto_x509_find_extension, X509_CERTIFICATE*, certificate, const unsigned char*, oid, size_t, oid_len,
+    DER_ELEMENT*, extension, bool*, critical);
+
+// Checks the signature of certificate under the key of issuer, which may be
+// the same certificate.  sha256WithRSAEncryption and ecdsa-with-SHA256 only.
+MOCKABLE_FUNCTION(, int, crypto_x509_verify_signature, X509_CERTIFICATE*, certificate, X509_CERTIFICATE*, issuer);
+
+// Verified pairs are remembered under SHA-256(certificate || issuer key) in a
+// session cache, so a chain seen before costs one hash per link instead of a
+// signature check.  Failures are never cached.
+MOCKABLE_FUNCTION(, CRYPTO_SESSION_CACHE_HANDLE, crypto_x509_verify_cache_create, size_t, capacity, uint32_t, lifetime_seconds);
+MOCKABLE_FUNCTION(, int, crypto_x509_verify_cached, CRYPTO_SESSION_CACHE_HANDLE, cache, X509_CERTIFICATE*, certificate, X509_CERTIFICATE*, issuer);
+
+#ifdef __cplusplus
+}
+#endif
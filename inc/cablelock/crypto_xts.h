@@ -0,0 +1,48 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+    #include <cstdlib>
+    #include <cstdint>
+#else
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+#endif
+
+#include "umock_c/umock_c_prod.h"
+#include "cablelock/crypto_aes_core.h"
+
+#define XTS_TWEAK_SIZE          16
+#define XTS_AES_128_KEY_SIZE    (2 * AES_128_KEY_SIZE)
+#define XTS_AES_256_KEY_SIZE    (2 * AES_256_KEY_SIZE)
+
+typedef struct CRYPTO_XTS_KEY_TAG
+{
+    AES_KEY_SCHEDULE data_key;
+    AES_KEY_SCHEDULE tweak_key;
+} CRYPTO_XTS_KEY;
+
+// key is the data key followed by the tweak key, the two halves must differ
+MOCKABLE_FUNCTION(, int, crypto_xts_key_init, CRYPTO_XTS_KEY*, xts_key, const unsigned char*, key, size_t, key_len);
+
+// Process one data unit of at least AES_BLOCK_SIZE bytes, lengths that are not
+// block aligned use ciphertext stealing.  input and output may be the same buffer.
+MOCKABLE_FUNCTION(, int, crypto_xts_encrypt, const CRYPTO_XTS_KEY*, xts_key, const unsigned char*, tweak,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output);
+MOCKABLE_FUNCTION(, int, crypto_xts_decrypt, const CRYPTO_XTS_KEY*, xts_key, const unsigned char*, tweak,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output);
+
+// Process consecutive sectors, the tweak of each is its sector number as a
+// 128-bit little endian value (IEEE 1619 data unit sequence number).  Sectors
+// are independent so callers may split a large range across threads.
+MOCKABLE_FUNCTION(, int, crypto_xts_encrypt_sectors, const CRYPTO_XTS_KEY*, xts_key, uint64_t, sector_num, size_t, sector_size,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output);
+MOCKABLE_FUNCTION(, int, crypto_xts_decrypt_sectors, const CRYPTO_XTS_KEY*, xts_key, uint64_t, sector_num, size_t, sector_size,
+    const unsigned char*, input, size_t, input_len, unsigned char*, output);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,397 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Load generator that replays a record size mix through the public cipher
+// API on 1..N threads and reports per call latency percentiles and
+// aggregate throughput for each thread count.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_record.h"
+
+#define MAX_MIX_ENTRIES         16
+#define MAX_RECORD_SIZE         TLS_MAX_PLAINTEXT_SIZE
+// Room for padding, the record header and tag around the largest record
+#define RECORD_BUFFER_SIZE      (MAX_RECORD_SIZE + 64)
+#define DEFAULT_MIX             "64:50,512:30,1400:15,16384:5"
+#define DEFAULT_RECORD_COUNT    20000
+#define DEFAULT_CONNECTION_LEN  100
+#define NSEC_PER_SEC            1000000000ULL
+
+typedef enum BENCH_CIPHER_TAG
+{
+    BENCH_AES_128_CBC,
+    BENCH_AES_256_CBC,
+    BENCH_DES_CBC,
+    BENCH_3DES_CBC,
+    BENCH_TLS13_GCM
+} BENCH_CIPHER;
+
+typedef struct RECORD_MIX_TAG
+{
+    size_t sizes[MAX_MIX_ENTRIES];
+    unsigned int weights[MAX_MIX_ENTRIES];
+    unsigned int total_weight;
+    size_t count;
+} RECORD_MIX;
+
+typedef struct BENCH_CONFIG_TAG
+{
+    BENCH_CIPHER cipher;
+    RECORD_MIX mix;
+    size_t max_threads;
+    size_t record_count;
+    size_t connection_len;
+} BENCH_CONFIG;
+
+typedef struct BENCH_THREAD_TAG
+{
+    pthread_t thread;
+    const BENCH_CONFIG* config;
+    uint64_t seed;
+    uint64_t* latencies;
+    uint64_t bytes;
+    size_t failures;
+} BENCH_THREAD;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+// xorshift64, good enough to pick sizes and fill keys
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 7;
+    value ^= value << 17;
+    *state = value;
+    return value;
+}
+
+static void fill_random(uint64_t* state, unsigned char* target, size_t length)
+{
+    for (size_t index = 0; index < length; index++)
+    {
+        target[index] = (unsigned char)next_random(state);
+    }
+}
+
+static size_t pick_record_size(const RECORD_MIX* mix, uint64_t* state)
+{
+    unsigned int pick = (unsigned int)(next_random(state) % mix->total_weight);
+    size_t index = 0;
+    while (pick >= mix->weights[index])
+    {
+        pick -= mix->weights[index];
+        index++;
+    }
+    return mix->sizes[index];
+}
+
+static int parse_mix(const char* text, RECORD_MIX* mix)
+{
+    int result = 0;
+    const char* iterator = text;
+    memset(mix, 0, sizeof(RECORD_MIX));
+    while (result == 0 && *iterator != '\0')
+    {
+        char* end;
+        unsigned long size = strtoul(iterator, &end, 10);
+        unsigned long weight;
+        if (*end != ':' || size == 0 || size > MAX_RECORD_SIZE || mix->count == MAX_MIX_ENTRIES)
+        {
+            result = __LINE__;
+        }
+        else if ((weight = strtoul(end + 1, &end, 10)) == 0 || (*end != ',' && *end != '\0'))
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            mix->sizes[mix->count] = size;
+            mix->weights[mix->count] = (unsigned int)weight;
+            mix->total_weight += (unsigned int)weight;
+            mix->count++;
+            iterator = *end == ',' ? end + 1 : end;
+        }
+    }
+    if (result == 0 && mix->count == 0)
+    {
+        result = __LINE__;
+    }
+    return result;
+}
+
+static size_t cipher_block_size(BENCH_CIPHER cipher)
+{
+    return (cipher == BENCH_DES_CBC || cipher == BENCH_3DES_CBC) ? 8 : 16;
+}
+
+static int run_cipher_call(BENCH_CIPHER cipher, const unsigned char* key, const unsigned char* iv, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    int result;
+    switch (cipher)
+    {
+        case BENCH_AES_128_CBC:
+            result = crypto_aes_encrypt_128(input, input_len, output, RECORD_BUFFER_SIZE, key, iv, false);
+            break;
+        case BENCH_AES_256_CBC:
+            result = crypto_aes_encrypt_256(input, input_len, output, RECORD_BUFFER_SIZE, key, iv, false);
+            break;
+        case BENCH_DES_CBC:
+            result = crypto_des_encrypt(input, input_len, output, RECORD_BUFFER_SIZE, key, iv, false);
+            break;
+        case BENCH_3DES_CBC:
+        default:
+            result = crypto_3des_encrypt(input, input_len, output, RECORD_BUFFER_SIZE, key, iv, false);
+            break;
+    }
+    return result;
+}
+
+static void* bench_thread_func(void* parameter)
+{
+    BENCH_THREAD* bench = (BENCH_THREAD*)parameter;
+    const BENCH_CONFIG* config = bench->config;
+    unsigned char key[32];
+    unsigned char iv[16];
+    unsigned char* input = (unsigned char*)malloc(RECORD_BUFFER_SIZE);
+    unsigned char* output = (unsigned char*)malloc(RECORD_BUFFER_SIZE);
+    CRYPTO_RECORD_HANDLE record = NULL;
+    size_t block_size = cipher_block_size(config->cipher);
+
+    if (input == NULL || output == NULL)
+    {
+        bench->failures = config->record_count;
+    }
+    else
+    {
+        fill_random(&bench->seed, input, RECORD_BUFFER_SIZE);
+        for (size_t index = 0; index < config->record_count; index++)
+        {
+            size_t record_len = pick_record_size(&config->mix, &bench->seed);
+            uint64_t start;
+            int call_result;
+
+            // Every connection brings a new key
+            if (index % config->connection_len == 0)
+            {
+                fill_random(&bench->seed, key, sizeof(key));
+                fill_random(&bench->seed, iv, sizeof(iv));
+                if (config->cipher == BENCH_TLS13_GCM)
+                {
+                    crypto_record_destroy(record);
+                    record = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, key, 16, iv, 12, NULL);
+                }
+            }
+
+            if (config->cipher == BENCH_TLS13_GCM)
+            {
+                size_t sealed_len;
+                start = get_time_ns();
+                call_result = record == NULL ? __LINE__ : crypto_record_seal(record, TLS_CONTENT_APPLICATION, output, RECORD_BUFFER_SIZE, record_len, &sealed_len);
+            }
+            else
+            {
+                // The block cipher API takes whole blocks only
+                record_len = (record_len + block_size - 1) / block_size * block_size;
+                start = get_time_ns();
+                call_result = run_cipher_call(config->cipher, key, iv, input, record_len, output);
+            }
+            bench->latencies[index] = get_time_ns() - start;
+
+            if (call_result != 0)
+            {
+                bench->failures++;
+            }
+            else
+            {
+                bench->bytes += record_len;
+            }
+        }
+    }
+    crypto_record_destroy(record);
+    free(output);
+    free(input);
+    return NULL;
+}
+
+static int compare_latency(const void* left, const void* right)
+{
+    uint64_t left_value = *(const uint64_t*)left;
+    uint64_t right_value = *(const uint64_t*)right;
+    return left_value < right_value ? -1 : (left_value > right_value ? 1 : 0);
+}
+
+static double percentile_us(const uint64_t* sorted, size_t count, double percent)
+{
+    size_t index = (size_t)(percent * (double)(count - 1));
+    return (double)sorted[index] / 1000.0;
+}
+
+static int run_thread_count(const BENCH_CONFIG* config, size_t thread_count, uint64_t* all_latencies)
+{
+    int result = 0;
+    BENCH_THREAD* threads = (BENCH_THREAD*)calloc(thread_count, sizeof(BENCH_THREAD));
+    if (threads == NULL)
+    {
+        printf("Failed to allocate thread data\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t total_bytes = 0;
+        size_t total_failures = 0;
+        size_t started = 0;
+        uint64_t start = get_time_ns();
+        uint64_t elapsed;
+
+        for (size_t index = 0; index < thread_count; index++)
+        {
+            threads[index].config = config;
+            threads[index].seed = 0x9e3779b97f4a7c15ULL * (index + 1);
+            threads[index].latencies = all_latencies + (index * config->record_count);
+            if (pthread_create(&threads[index].thread, NULL, bench_thread_func, &threads[index]) != 0)
+            {
+                printf("Failed to start thread %d\r\n", (int)index);
+                result = __LINE__;
+                break;
+            }
+            started++;
+        }
+        for (size_t index = 0; index < started; index++)
+        {
+            pthread_join(threads[index].thread, NULL);
+            total_bytes += threads[index].bytes;
+            total_failures += threads[index].failures;
+        }
+        elapsed = get_time_ns() - start;
+
+        if (result == 0)
+        {
+            size_t total_calls = thread_count * config->record_count;
+            qsort(all_latencies, total_calls, sizeof(uint64_t), compare_latency);
+            printf("%7d %10d %10.2f %10.2f %10.2f %12.1f %8d\r\n", (int)thread_count, (int)total_calls,
+                percentile_us(all_latencies, total_calls, 0.50), percentile_us(all_latencies, total_calls, 0.99),
+                percentile_us(all_latencies, total_calls, 0.999), ((double)total_bytes / (1024.0 * 1024.0)) / ((double)elapsed / NSEC_PER_SEC),
+                (int)total_failures);
+        }
+        free(threads);
+    }
+    return result;
+}
+
+static int parse_cipher(const char* text, BENCH_CIPHER* cipher)
+{
+    int result = 0;
+    if (strcmp(text, "aes128") == 0)
+    {
+        *cipher = BENCH_AES_128_CBC;
+    }
+    else if (strcmp(text, "aes256") == 0)
+    {
+        *cipher = BENCH_AES_256_CBC;
+    }
+    else if (strcmp(text, "des") == 0)
+    {
+        *cipher = BENCH_DES_CBC;
+    }
+    else if (strcmp(text, "3des") == 0)
+    {
+        *cipher = BENCH_3DES_CBC;
+    }
+    else if (strcmp(text, "gcm") == 0)
+    {
+        *cipher = BENCH_TLS13_GCM;
+    }
+    else
+    {
+        result = __LINE__;
+    }
+    return result;
+}
+
+static void print_usage(const char* name)
+{
+    printf("Usage: %s [-c aes128|aes256|des|3des|gcm] [-t max_threads] [-n records_per_thread]\r\n", name);
+    printf("          [-k records_per_connection] [-m size:weight,...]\r\n");
+    printf("Default mix is %s\r\n", DEFAULT_MIX);
+}
+
+int main(int argc, char* argv[])
+{
+    int result = 0;
+    int option;
+    BENCH_CONFIG config;
+    const char* mix_text = DEFAULT_MIX;
+
+    memset(&config, 0, sizeof(config));
+    config.cipher = BENCH_AES_128_CBC;
+    config.max_threads = 4;
+    config.record_count = DEFAULT_RECORD_COUNT;
+    config.connection_len = DEFAULT_CONNECTION_LEN;
+
+    while (result == 0 && (option = getopt(argc, argv, "c:t:n:k:m:h")) != -1)
+    {
+        switch (option)
+        {
+            case 'c':
+                result = parse_cipher(optarg, &config.cipher);
+                break;
+            case 't':
+                config.max_threads = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                config.record_count = strtoul(optarg, NULL, 10);
+                break;
+            case 'k':
+                config.connection_len = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                mix_text = optarg;
+                break;
+            default:
+                result = __LINE__;
+                break;
+        }
+    }
+
+    if (result != 0 || config.max_threads == 0 || config.record_count == 0 || config.connection_len == 0 || parse_mix(mix_text, &config.mix) != 0)
+    {
+        print_usage(argv[0]);
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t* all_latencies = (uint64_t*)malloc(config.max_threads * config.record_count * sizeof(uint64_t));
+        if (all_latencies == NULL)
+        {
+            printf("Failed to allocate latency samples\r\n");
+            result = __LINE__;
+        }
+        else
+        {
+            printf("Record mix %s, %d records per thread, key change every %d records\r\n", mix_text, (int)config.record_count, (int)config.connection_len);
+            printf("%7s %10s %10s %10s %10s %12s %8s\r\n", "threads", "calls", "p50 us", "p99 us", "p999 us", "MB/s", "failed");
+            for (size_t thread_count = 1; result == 0 && thread_count <= config.max_threads; thread_count++)
+            {
+                result = run_thread_count(&config, thread_count, all_latencies);
+            }
+            free(all_latencies);
+        }
+    }
+    return result == 0 ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_drbg.h"
 
 static void printout_bites(const char* text, unsigned char* data, size_t data_len)
 {
@@ -20,14 +21,19 @@ int main(int argc, char* argv[])
     bool use_padding = false;
     //unsigned char* key = "password";
     unsigned char* key = "twentyfourcharacterinput";
-    unsigned char* init_vector = NULL;//"initialz";
+    // Every message gets a fresh unpredictable IV, sent along with the cipher text
+    unsigned char init_vector[8];
     unsigned char* input = "abcdefghijklmnop";
     unsigned char* output;
     unsigned char* check_data;
 
     size_t out_len, input_len, check_len;
     check_len = out_len = input_len = strlen(input);
-    if ((output = (unsigned char*)malloc(out_len)) == NULL)
+    if (crypto_drbg_random_bytes(init_vector, sizeof(init_vector)) != 0)
+    {
+        printf("Failed to generate an IV\r\n");
+    }
+    else if ((output = (unsigned char*)malloc(out_len)) == NULL)
     {
         printf("Failed to allocate output\r\n");
     }
@@ -45,6 +51,7 @@ int main(int argc, char* argv[])
         else
         {
             printf("Initial data: %s\r\n", input);
+            printout_bites("IV: ", init_vector, sizeof(init_vector));
             printout_bites("Output data: ", output, out_len);
             if (crypto_3des_decrypt(output, out_len, check_data, check_len, key, init_vector, use_padding) )
             {
@@ -0,0 +1,634 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Encrypts files of any size with AES-GCM.  The input is mapped and split
+// into fixed size chunks, each sealed under its own nonce with its own tag by
+// the async engine on every core, while a writer thread flushes the previous
+// batch.  Any chunk can be decrypted on its own.
+//
+// File layout, all integers big endian:
+//   magic "CLKF" | version | 3 reserved | chunk size (4) | plain text size (8) | file nonce (12)
+//   then for every chunk: cipher text | 16 byte tag
+// The header is the associated data of every chunk.  The nonce of chunk i is
+// the file nonce with i xor'ed into its last 8 bytes.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cablelock/crypto_async.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_gcm.h"
+
+#define FILE_MAGIC              "CLKF"
+#define FILE_VERSION            1
+#define FILE_HEADER_SIZE        32
+#define FILE_NONCE_OFFSET       20
+#define DEFAULT_CHUNK_SIZE      (1024 * 1024)
+#define MAX_CHUNK_SIZE          (256 * 1024 * 1024)
+// Chunks each worker gets per batch, a batch is one pipeline buffer
+#define CHUNKS_PER_THREAD       2
+#define MAX_KEY_SIZE            32
+
+typedef enum BUFFER_STATE_TAG
+{
+    BUFFER_FREE,
+    BUFFER_FULL
+} BUFFER_STATE;
+
+typedef struct OUTPUT_BUFFER_TAG
+{
+    unsigned char* data;
+    size_t length;
+    BUFFER_STATE state;
+} OUTPUT_BUFFER;
+
+// Two buffers, the workers fill one while the writer drains the other
+typedef struct PIPELINE_TAG
+{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    OUTPUT_BUFFER buffers[2];
+    int output_fd;
+    bool finished;
+    bool write_failed;
+} PIPELINE;
+
+typedef struct FILE_CONFIG_TAG
+{
+    bool encrypt;
+    const char* input_path;
+    const char* output_path;
+    unsigned char key[MAX_KEY_SIZE];
+    size_t key_len;
+    size_t chunk_size;
+    size_t thread_count;
+    // Decrypt only this range of chunks, count 0 means to the end
+    uint64_t first_chunk;
+    uint64_t chunk_count;
+} FILE_CONFIG;
+
+typedef struct FILE_HEADER_TAG
+{
+    unsigned char raw[FILE_HEADER_SIZE];
+    size_t chunk_size;
+    uint64_t plain_size;
+    uint64_t total_chunks;
+} FILE_HEADER;
+
+static void store_be(unsigned char* target, uint64_t value, size_t length)
+{
+    for (size_t index = length; index > 0; index--)
+    {
+        target[index - 1] = (unsigned char)value;
+        value >>= 8;
+    }
+}
+
+static uint64_t load_be(const unsigned char* source, size_t length)
+{
+    uint64_t result = 0;
+    for (size_t index = 0; index < length; index++)
+    {
+        result = (result << 8) | source[index];
+    }
+    return result;
+}
+
+static uint64_t count_chunks(uint64_t plain_size, size_t chunk_size)
+{
+    // An empty file still has one empty chunk so the header gets authenticated
+    return plain_size == 0 ? 1 : (plain_size + chunk_size - 1) / chunk_size;
+}
+
+static size_t chunk_length(const FILE_HEADER* header, uint64_t chunk)
+{
+    uint64_t offset = chunk * header->chunk_size;
+    uint64_t remaining = header->plain_size - offset;
+    return remaining < header->chunk_size ? (size_t)remaining : header->chunk_size;
+}
+
+static void chunk_nonce(const FILE_HEADER* header, uint64_t chunk, unsigned char nonce[GCM_NONCE_SIZE])
+{
+    unsigned char index_bytes[8];
+    memcpy(nonce, header->raw + FILE_NONCE_OFFSET, GCM_NONCE_SIZE);
+    store_be(index_bytes, chunk, sizeof(index_bytes));
+    for (size_t index = 0; index < sizeof(index_bytes); index++)
+    {
+        nonce[GCM_NONCE_SIZE - sizeof(index_bytes) + index] ^= index_bytes[index];
+    }
+}
+
+static int build_header(FILE_HEADER* header, size_t chunk_size, uint64_t plain_size)
+{
+    int result;
+    memset(header, 0, sizeof(FILE_HEADER));
+    memcpy(header->raw, FILE_MAGIC, 4);
+    header->raw[4] = FILE_VERSION;
+    store_be(header->raw + 8, chunk_size, 4);
+    store_be(header->raw + 12, plain_size, 8);
+    if (crypto_drbg_random_bytes(header->raw + FILE_NONCE_OFFSET, GCM_NONCE_SIZE) != 0)
+    {
+        printf("Failed to generate a random file nonce\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        header->chunk_size = chunk_size;
+        header->plain_size = plain_size;
+        header->total_chunks = count_chunks(plain_size, chunk_size);
+        result = 0;
+    }
+    return result;
+}
+
+static int parse_header(FILE_HEADER* header, const unsigned char* data, uint64_t file_size)
+{
+    int result;
+    memset(header, 0, sizeof(FILE_HEADER));
+    if (file_size < FILE_HEADER_SIZE || memcmp(data, FILE_MAGIC, 4) != 0 || data[4] != FILE_VERSION)
+    {
+        printf("Input is not a cablelock file\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        memcpy(header->raw, data, FILE_HEADER_SIZE);
+        header->chunk_size = (size_t)load_be(data + 8, 4);
+        header->plain_size = load_be(data + 12, 8);
+        if (header->chunk_size == 0 || header->chunk_size > MAX_CHUNK_SIZE)
+        {
+            printf("Invalid chunk size %lu\r\n", (unsigned long)header->chunk_size);
+            result = __LINE__;
+        }
+        else
+        {
+            header->total_chunks = count_chunks(header->plain_size, header->chunk_size);
+            // Catches truncation and appended data before any chunk is opened
+            if (header->plain_size > file_size - FILE_HEADER_SIZE || (file_size - FILE_HEADER_SIZE - header->plain_size) / GCM_TAG_SIZE != header->total_chunks ||
+                (file_size - FILE_HEADER_SIZE - header->plain_size) % GCM_TAG_SIZE != 0)
+            {
+                printf("File size does not match its header\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+static int write_all(int fd, const unsigned char* data, size_t length)
+{
+    int result = 0;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (written <= 0)
+        {
+            result = __LINE__;
+            break;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return result;
+}
+
+static void* writer_thread_func(void* parameter)
+{
+    PIPELINE* pipeline = (PIPELINE*)parameter;
+    size_t next = 0;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;)
+    {
+        OUTPUT_BUFFER* buffer = &pipeline->buffers[next];
+        if (buffer->state == BUFFER_FULL)
+        {
+            bool failed;
+            pthread_mutex_unlock(&pipeline->lock);
+            failed = write_all(pipeline->output_fd, buffer->data, buffer->length) != 0;
+            pthread_mutex_lock(&pipeline->lock);
+            buffer->state = BUFFER_FREE;
+            pipeline->write_failed |= failed;
+            pthread_cond_broadcast(&pipeline->changed);
+            next ^= 1;
+        }
+        else if (pipeline->finished)
+        {
+            break;
+        }
+        else
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+static int acquire_buffer(PIPELINE* pipeline, OUTPUT_BUFFER* buffer)
+{
+    int result;
+    pthread_mutex_lock(&pipeline->lock);
+    while (buffer->state != BUFFER_FREE)
+    {
+        pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+    }
+    result = pipeline->write_failed ? __LINE__ : 0;
+    pthread_mutex_unlock(&pipeline->lock);
+    return result;
+}
+
+static void submit_buffer(PIPELINE* pipeline, OUTPUT_BUFFER* buffer, size_t length)
+{
+    pthread_mutex_lock(&pipeline->lock);
+    buffer->length = length;
+    buffer->state = BUFFER_FULL;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+// Runs one batch of chunks through the engine into buffer, returns the bytes produced
+static int process_batch(const FILE_CONFIG* config, const FILE_HEADER* header, const CRYPTO_GCM_KEY* gcm_key, CRYPTO_ASYNC_HANDLE async_handle,
+    const unsigned char* input_map, uint64_t first_chunk, size_t count, CRYPTO_ASYNC_JOB* jobs, unsigned char (*nonces)[GCM_NONCE_SIZE],
+    OUTPUT_BUFFER* buffer, size_t* produced)
+{
+    int result = 0;
+    size_t completed = 0;
+    size_t offset = 0;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        uint64_t chunk = first_chunk + index;
+        size_t length = chunk_length(header, chunk);
+        CRYPTO_ASYNC_JOB* job = &jobs[index];
+
+        chunk_nonce(header, chunk, nonces[index]);
+        memset(job, 0, sizeof(CRYPTO_ASYNC_JOB));
+        job->cipher = CRYPTO_ASYNC_AES_GCM;
+        job->encrypt = config->encrypt;
+        job->key = gcm_key;
+        job->iv = nonces[index];
+        job->iv_len = GCM_NONCE_SIZE;
+        job->aad = header->raw;
+        job->aad_len = FILE_HEADER_SIZE;
+        job->input_len = length;
+        job->tag_len = GCM_TAG_SIZE;
+        job->output = buffer->data + offset;
+        if (config->encrypt)
+        {
+            job->input = input_map + (chunk * header->chunk_size);
+            job->tag = job->output + length;
+            offset += length + GCM_TAG_SIZE;
+        }
+        else
+        {
+            job->input = input_map + FILE_HEADER_SIZE + (chunk * (header->chunk_size + GCM_TAG_SIZE));
+            job->tag = (unsigned char*)job->input + length;
+            offset += length;
+        }
+
+        if (crypto_async_submit(async_handle, job) != 0)
+        {
+            printf("Failed to queue chunk %llu\r\n", (unsigned long long)chunk);
+            result = __LINE__;
+            break;
+        }
+    }
+
+    // Wait for everything submitted, even after a failure the buffers stay in use until then
+    while (completed < count && (result == 0 || crypto_async_get_in_flight(async_handle) > 0))
+    {
+        CRYPTO_ASYNC_JOB* done[CRYPTO_ASYNC_BATCH_SIZE];
+        size_t done_count = crypto_async_poll(async_handle, done, CRYPTO_ASYNC_BATCH_SIZE);
+        for (size_t index = 0; index < done_count; index++)
+        {
+            if (done[index]->result != 0 && result == 0)
+            {
+                printf("Chunk %llu failed to %s\r\n", (unsigned long long)(first_chunk + (size_t)(done[index] - jobs)),
+                    config->encrypt ? "encrypt" : "authenticate");
+                result = __LINE__;
+            }
+        }
+        completed += done_count;
+        if (done_count == 0)
+        {
+            sched_yield();
+        }
+    }
+    *produced = offset;
+    return result;
+}
+
+static int run_pipeline(const FILE_CONFIG* config, const FILE_HEADER* header, const unsigned char* input_map, int output_fd,
+    uint64_t first_chunk, uint64_t end_chunk)
+{
+    int result = 0;
+    CRYPTO_GCM_KEY gcm_key;
+    PIPELINE pipeline;
+    pthread_t writer;
+    size_t batch_chunks = config->thread_count * CHUNKS_PER_THREAD;
+    size_t buffer_size = batch_chunks * (header->chunk_size + GCM_TAG_SIZE);
+    CRYPTO_ASYNC_CONFIG async_config = { config->thread_count, batch_chunks, NULL, NULL };
+    CRYPTO_ASYNC_HANDLE async_handle = NULL;
+    CRYPTO_ASYNC_JOB* jobs = (CRYPTO_ASYNC_JOB*)malloc(batch_chunks * sizeof(CRYPTO_ASYNC_JOB));
+    unsigned char (*nonces)[GCM_NONCE_SIZE] = (unsigned char (*)[GCM_NONCE_SIZE])malloc(batch_chunks * GCM_NONCE_SIZE);
+
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.output_fd = output_fd;
+    pipeline.buffers[0].data = (unsigned char*)malloc(buffer_size);
+    pipeline.buffers[1].data = (unsigned char*)malloc(buffer_size);
+
+    if (jobs == NULL || nonces == NULL || pipeline.buffers[0].data == NULL || pipeline.buffers[1].data == NULL)
+    {
+        printf("Failed to allocate %lu byte pipeline buffers\r\n", (unsigned long)buffer_size);
+        result = __LINE__;
+    }
+    else if (crypto_gcm_key_init(&gcm_key, config->key, config->key_len) != 0)
+    {
+        printf("Failed to initialize key\r\n");
+        result = __LINE__;
+    }
+    else if ((async_handle = crypto_async_create(&async_config)) == NULL)
+    {
+        printf("Failed to start %d workers\r\n", (int)config->thread_count);
+        result = __LINE__;
+    }
+    else if (pthread_mutex_init(&pipeline.lock, NULL) != 0 || pthread_cond_init(&pipeline.changed, NULL) != 0)
+    {
+        printf("Failed to initialize pipeline\r\n");
+        result = __LINE__;
+    }
+    else if (pthread_create(&writer, NULL, writer_thread_func, &pipeline) != 0)
+    {
+        printf("Failed to start writer\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        size_t current = 0;
+        for (uint64_t chunk = first_chunk; result == 0 && chunk < end_chunk; chunk += batch_chunks)
+        {
+            OUTPUT_BUFFER* buffer = &pipeline.buffers[current];
+            size_t count = end_chunk - chunk < batch_chunks ? (size_t)(end_chunk - chunk) : batch_chunks;
+            size_t produced;
+
+            if (acquire_buffer(&pipeline, buffer) != 0)
+            {
+                printf("Failed writing output\r\n");
+                result = __LINE__;
+            }
+            else if (process_batch(config, header, &gcm_key, async_handle, input_map, chunk, count, jobs, nonces, buffer, &produced) != 0)
+            {
+                // Nothing from a failed batch reaches the output
+                result = __LINE__;
+            }
+            else
+            {
+                submit_buffer(&pipeline, buffer, produced);
+                current ^= 1;
+            }
+        }
+
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.finished = true;
+        pthread_cond_broadcast(&pipeline.changed);
+        pthread_mutex_unlock(&pipeline.lock);
+        pthread_join(writer, NULL);
+        if (result == 0 && pipeline.write_failed)
+        {
+            printf("Failed writing output\r\n");
+            result = __LINE__;
+        }
+        pthread_cond_destroy(&pipeline.changed);
+        pthread_mutex_destroy(&pipeline.lock);
+    }
+
+    crypto_async_destroy(async_handle);
+    memset(&gcm_key, 0, sizeof(gcm_key));
+    free(pipeline.buffers[1].data);
+    free(pipeline.buffers[0].data);
+    free(nonces);
+    free(jobs);
+    return result;
+}
+
+static int process_file(const FILE_CONFIG* config)
+{
+    int result;
+    struct stat input_stat;
+    int input_fd = open(config->input_path, O_RDONLY);
+    int output_fd = -1;
+    unsigned char* input_map = NULL;
+    uint64_t input_size = 0;
+
+    if (input_fd < 0 || fstat(input_fd, &input_stat) != 0)
+    {
+        printf("Failed to open %s\r\n", config->input_path);
+        result = __LINE__;
+    }
+    else if ((input_size = (uint64_t)input_stat.st_size) > 0 &&
+        (input_map = (unsigned char*)mmap(NULL, (size_t)input_size, PROT_READ, MAP_PRIVATE, input_fd, 0)) == MAP_FAILED)
+    {
+        printf("Failed to map %s\r\n", config->input_path);
+        input_map = NULL;
+        result = __LINE__;
+    }
+    else if ((output_fd = open(config->output_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0)
+    {
+        printf("Failed to create %s\r\n", config->output_path);
+        result = __LINE__;
+    }
+    else
+    {
+        FILE_HEADER header;
+        if (config->encrypt)
+        {
+            if (input_map != NULL)
+            {
+                (void)posix_madvise(input_map, (size_t)input_size, POSIX_MADV_SEQUENTIAL);
+            }
+            if (build_header(&header, config->chunk_size, input_size) != 0 || write_all(output_fd, header.raw, FILE_HEADER_SIZE) != 0)
+            {
+                printf("Failed to write header\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                result = run_pipeline(config, &header, input_map, output_fd, 0, header.total_chunks);
+            }
+        }
+        else if (parse_header(&header, input_map, input_size) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (config->first_chunk >= header.total_chunks ||
+            (config->chunk_count > 0 && config->chunk_count > header.total_chunks - config->first_chunk))
+        {
+            printf("Chunk range is outside the %llu chunks in the file\r\n", (unsigned long long)header.total_chunks);
+            result = __LINE__;
+        }
+        else
+        {
+            uint64_t end_chunk = config->chunk_count > 0 ? config->first_chunk + config->chunk_count : header.total_chunks;
+            if (config->first_chunk != 0 || end_chunk != header.total_chunks)
+            {
+                // Only the requested chunks are paged in
+                (void)posix_madvise(input_map, (size_t)input_size, POSIX_MADV_RANDOM);
+            }
+            result = run_pipeline(config, &header, input_map, output_fd, config->first_chunk, end_chunk);
+        }
+    }
+
+    if (output_fd >= 0)
+    {
+        close(output_fd);
+        if (result != 0)
+        {
+            (void)unlink(config->output_path);
+        }
+    }
+    if (input_map != NULL)
+    {
+        munmap(input_map, (size_t)input_size);
+    }
+    if (input_fd >= 0)
+    {
+        close(input_fd);
+    }
+    return result;
+}
+
+static int parse_key(const char* text, FILE_CONFIG* config)
+{
+    int result = 0;
+    size_t text_len = strlen(text);
+    if (text_len != 32 && text_len != 64)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        config->key_len = text_len / 2;
+        for (size_t index = 0; result == 0 && index < config->key_len; index++)
+        {
+            char pair[3] = { text[index * 2], text[(index * 2) + 1], '\0' };
+            char* end;
+            config->key[index] = (unsigned char)strtoul(pair, &end, 16);
+            if (*end != '\0')
+            {
+                result = __LINE__;
+            }
+        }
+    }
+    return result;
+}
+
+static int parse_range(const char* text, FILE_CONFIG* config)
+{
+    int result = 0;
+    char* end;
+    config->first_chunk = strtoull(text, &end, 10);
+    if (*end == ':')
+    {
+        config->chunk_count = strtoull(end + 1, &end, 10);
+        if (config->chunk_count == 0)
+        {
+            result = __LINE__;
+        }
+    }
+    else
+    {
+        config->chunk_count = 1;
+    }
+    if (*end != '\0')
+    {
+        result = __LINE__;
+    }
+    return result;
+}
+
+static void print_usage(const char* name)
+{
+    printf("Usage: %s -e|-d -k hex_key -i input -o output [-c chunk_size] [-t threads] [-r chunk[:count]]\r\n", name);
+    printf("  -k  16 or 32 byte AES key as hex\r\n");
+    printf("  -c  plain text bytes per chunk when encrypting, default %d\r\n", DEFAULT_CHUNK_SIZE);
+    printf("  -r  decrypt only the given chunks\r\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int result = 0;
+    int option;
+    bool mode_set = false;
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE_CONFIG config;
+
+    memset(&config, 0, sizeof(config));
+    config.chunk_size = DEFAULT_CHUNK_SIZE;
+    config.thread_count = online_cpus > 0 ? (size_t)online_cpus : 1;
+
+    while (result == 0 && (option = getopt(argc, argv, "edk:i:o:c:t:r:h")) != -1)
+    {
+        switch (option)
+        {
+            case 'e':
+            case 'd':
+                config.encrypt = option == 'e';
+                mode_set = true;
+                break;
+            case 'k':
+                result = parse_key(optarg, &config);
+                break;
+            case 'i':
+                config.input_path = optarg;
+                break;
+            case 'o':
+                config.output_path = optarg;
+                break;
+            case 'c':
+                config.chunk_size = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                config.thread_count = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                result = parse_range(optarg, &config);
+                break;
+            default:
+                result = __LINE__;
+                break;
+        }
+    }
+
+    if (result != 0 || !mode_set || config.key_len == 0 || config.input_path == NULL || config.output_path == NULL ||
+        config.chunk_size == 0 || config.chunk_size > MAX_CHUNK_SIZE || config.thread_count == 0 || (config.encrypt && config.chunk_count > 0))
+    {
+        print_usage(argv[0]);
+        result = __LINE__;
+    }
+    else
+    {
+        result = process_file(&config);
+    }
+    memset(config.key, 0, sizeof(config.key));
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,999 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_aes_accel.h"
+
+// The kernels are built with per function target attributes so the rest of
+// the library keeps the baseline instruction set and old cpus never run them
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define AES_ACCEL_X86
+    #if (defined(__clang__) && __clang_major__ >= 7) || (!defined(__clang__) && __GNUC__ >= 8)
+        #define AES_ACCEL_VAES
+    #endif
+    #include <immintrin.h>
+#endif
+
+#ifdef AES_ACCEL_X86
+
+#define AESNI_TARGET    __attribute__((target("aes,pclmul,ssse3,sse4.1")))
+#define VAES_TARGET     __attribute__((target("aes,pclmul,ssse3,sse4.1,avx2,avx512f,avx512bw,avx512vl,vaes,vpclmulqdq")))
+
+#define AES_MAX_ROUNDS      14
+// Blocks each wide iteration keeps in flight, four per zmm register
+#define VAES_GROUP_BLOCKS   16
+
+static int g_detected_level = -1;
+static int g_level_cap = CRYPTO_AES_ACCEL_VAES512;
+// Calls shorter than this stay on AES-NI even when the wide kernels are allowed
+static size_t g_wide_threshold = 0;
+
+static CRYPTO_AES_ACCEL detect_level(void)
+{
+    CRYPTO_AES_ACCEL result = CRYPTO_AES_ACCEL_NONE;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+    {
+        result = CRYPTO_AES_ACCEL_AESNI;
+#ifdef AES_ACCEL_VAES
+        // The avx512 checks include the OS saving the zmm state
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") &&
+            __builtin_cpu_supports("vaes") && __builtin_cpu_supports("vpclmulqdq"))
+        {
+            result = CRYPTO_AES_ACCEL_VAES512;
+        }
+#endif
+    }
+    return result;
+}
+
+static CRYPTO_AES_ACCEL current_level(void)
+{
+    int detected = __atomic_load_n(&g_detected_level, __ATOMIC_RELAXED);
+    int cap = __atomic_load_n(&g_level_cap, __ATOMIC_RELAXED);
+    if (detected < 0)
+    {
+        // Every thread detects the same value, racing here is harmless
+        detected = (int)detect_level();
+        __atomic_store_n(&g_detected_level, detected, __ATOMIC_RELAXED);
+    }
+    return (CRYPTO_AES_ACCEL)(detected < cap ? detected : cap);
+}
+
+static CRYPTO_AES_ACCEL kernel_level(size_t block_count)
+{
+    CRYPTO_AES_ACCEL result = current_level();
+    if (result == CRYPTO_AES_ACCEL_VAES512 && block_count < __atomic_load_n(&g_wide_threshold, __ATOMIC_RELAXED))
+    {
+        result = CRYPTO_AES_ACCEL_AESNI;
+    }
+    return result;
+}
+
+/* AES-NI, one block per instruction */
+
+AESNI_TARGET static __m128i byte_swap_mask(void)
+{
+    return _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+
+AESNI_TARGET static void load_encrypt_keys(const AES_KEY_SCHEDULE* schedule, __m128i keys[AES_MAX_ROUNDS + 1])
+{
+    for (size_t index = 0; index <= schedule->num_rounds; index++)
+    {
+        keys[index] = _mm_loadu_si128((const __m128i*)schedule->key_sched[index * 4]);
+    }
+}
+
+// aesdec takes the equivalent inverse cipher keys the schedule already holds
+AESNI_TARGET static void load_decrypt_keys(const AES_KEY_SCHEDULE* schedule, __m128i keys[AES_MAX_ROUNDS + 1])
+{
+    for (size_t index = 0; index <= schedule->num_rounds; index++)
+    {
+        keys[index] = _mm_loadu_si128((const __m128i*)schedule->dec_key_sched[index * 4]);
+    }
+}
+
+AESNI_TARGET static void encrypt4(const __m128i* keys, size_t num_rounds, __m128i blocks[4])
+{
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm_xor_si128(blocks[lane], keys[0]);
+    }
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm_aesenc_si128(blocks[lane], keys[round]);
+        }
+    }
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm_aesenclast_si128(blocks[lane], keys[num_rounds]);
+    }
+}
+
+AESNI_TARGET static __m128i encrypt1(const __m128i* keys, size_t num_rounds, __m128i block)
+{
+    block = _mm_xor_si128(block, keys[0]);
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        block = _mm_aesenc_si128(block, keys[round]);
+    }
+    return _mm_aesenclast_si128(block, keys[num_rounds]);
+}
+
+AESNI_TARGET static void decrypt4(const __m128i* keys, size_t num_rounds, __m128i blocks[4])
+{
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm_xor_si128(blocks[lane], keys[0]);
+    }
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm_aesdec_si128(blocks[lane], keys[round]);
+        }
+    }
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm_aesdeclast_si128(blocks[lane], keys[num_rounds]);
+    }
+}
+
+AESNI_TARGET static __m128i decrypt1(const __m128i* keys, size_t num_rounds, __m128i block)
+{
+    block = _mm_xor_si128(block, keys[0]);
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        block = _mm_aesdec_si128(block, keys[round]);
+    }
+    return _mm_aesdeclast_si128(block, keys[num_rounds]);
+}
+
+// Carry-less product of two byte swapped field elements, accumulated without
+// reduction so several products can share one reduce_product
+AESNI_TARGET static void clmul_accumulate(__m128i left, __m128i right, __m128i* low, __m128i* middle, __m128i* high)
+{
+    *low = _mm_xor_si128(*low, _mm_clmulepi64_si128(left, right, 0x00));
+    *high = _mm_xor_si128(*high, _mm_clmulepi64_si128(left, right, 0x11));
+    *middle = _mm_xor_si128(*middle, _mm_xor_si128(_mm_clmulepi64_si128(left, right, 0x01), _mm_clmulepi64_si128(left, right, 0x10)));
+}
+
+// Reduces a 256-bit product modulo the GCM polynomial, following Intel's
+// carry-less multiplication white paper: shift left by one for the bit
+// reflected order then fold the low half back in
+AESNI_TARGET static __m128i reduce_product(__m128i low, __m128i middle, __m128i high)
+{
+    __m128i carry_low;
+    __m128i carry_high;
+    __m128i carry_cross;
+    __m128i fold;
+
+    low = _mm_xor_si128(low, _mm_slli_si128(middle, 8));
+    high = _mm_xor_si128(high, _mm_srli_si128(middle, 8));
+
+    carry_low = _mm_srli_epi32(low, 31);
+    carry_high = _mm_srli_epi32(high, 31);
+    low = _mm_slli_epi32(low, 1);
+    high = _mm_slli_epi32(high, 1);
+    carry_cross = _mm_srli_si128(carry_low, 12);
+    carry_high = _mm_slli_si128(carry_high, 4);
+    carry_low = _mm_slli_si128(carry_low, 4);
+    low = _mm_or_si128(low, carry_low);
+    high = _mm_or_si128(high, carry_high);
+    high = _mm_or_si128(high, carry_cross);
+
+    fold = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    carry_cross = _mm_srli_si128(fold, 4);
+    low = _mm_xor_si128(low, _mm_slli_si128(fold, 12));
+
+    fold = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    fold = _mm_xor_si128(fold, carry_cross);
+    low = _mm_xor_si128(low, fold);
+    return _mm_xor_si128(high, low);
+}
+
+AESNI_TARGET static __m128i gf_multiply(__m128i left, __m128i right)
+{
+    __m128i low = _mm_setzero_si128();
+    __m128i middle = _mm_setzero_si128();
+    __m128i high = _mm_setzero_si128();
+    clmul_accumulate(left, right, &low, &middle, &high);
+    return reduce_product(low, middle, high);
+}
+
+// h_powers holds H^16 down to H^1, so H^n is entry 16 - n
+AESNI_TARGET static __m128i load_power(const unsigned char* h_powers, size_t power)
+{
+    return _mm_loadu_si128((const __m128i*)(h_powers + ((CRYPTO_AES_ACCEL_GCM_POWERS - power) * AES_BLOCK_SIZE)));
+}
+
+AESNI_TARGET static size_t aesni_ctr32(const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m128i blocks[4];
+    const __m128i swap = byte_swap_mask();
+    // Byte swapped, the 32-bit counter is the lowest lane and adds directly
+    __m128i count = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)counter), swap);
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_encrypt_keys(schedule, keys);
+    while (block_count - done >= 4)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm_shuffle_epi8(count, swap);
+            count = _mm_add_epi32(count, one);
+        }
+        encrypt4(keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)(input + ((done + lane) * AES_BLOCK_SIZE)));
+            _mm_storeu_si128((__m128i*)(output + ((done + lane) * AES_BLOCK_SIZE)), _mm_xor_si128(data, blocks[lane]));
+        }
+        done += 4;
+    }
+    for (; done < block_count; done++)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)(input + (done * AES_BLOCK_SIZE)));
+        __m128i block = encrypt1(keys, num_rounds, _mm_shuffle_epi8(count, swap));
+        count = _mm_add_epi32(count, one);
+        _mm_storeu_si128((__m128i*)(output + (done * AES_BLOCK_SIZE)), _mm_xor_si128(data, block));
+    }
+    _mm_storeu_si128((__m128i*)counter, _mm_shuffle_epi8(count, swap));
+    return done;
+}
+
+AESNI_TARGET static size_t aesni_cbc_decrypt(const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m128i blocks[4];
+    __m128i cipher[4];
+    __m128i previous = _mm_loadu_si128((const __m128i*)iv);
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_decrypt_keys(schedule, keys);
+    while (block_count - done >= 4)
+    {
+        // All cipher blocks are read before any output is written
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            cipher[lane] = _mm_loadu_si128((const __m128i*)(input + ((done + lane) * AES_BLOCK_SIZE)));
+            blocks[lane] = cipher[lane];
+        }
+        decrypt4(keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            _mm_storeu_si128((__m128i*)(output + ((done + lane) * AES_BLOCK_SIZE)), _mm_xor_si128(blocks[lane], previous));
+            previous = cipher[lane];
+        }
+        done += 4;
+    }
+    for (; done < block_count; done++)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)(input + (done * AES_BLOCK_SIZE)));
+        _mm_storeu_si128((__m128i*)(output + (done * AES_BLOCK_SIZE)), _mm_xor_si128(decrypt1(keys, num_rounds, data), previous));
+        previous = data;
+    }
+    _mm_storeu_si128((__m128i*)iv, previous);
+    return done;
+}
+
+AESNI_TARGET static size_t aesni_ecb(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m128i blocks[4];
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    if (encrypt)
+    {
+        load_encrypt_keys(schedule, keys);
+    }
+    else
+    {
+        load_decrypt_keys(schedule, keys);
+    }
+    while (block_count - done >= 4)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm_loadu_si128((const __m128i*)(input + ((done + lane) * AES_BLOCK_SIZE)));
+        }
+        if (encrypt)
+        {
+            encrypt4(keys, num_rounds, blocks);
+        }
+        else
+        {
+            decrypt4(keys, num_rounds, blocks);
+        }
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            _mm_storeu_si128((__m128i*)(output + ((done + lane) * AES_BLOCK_SIZE)), blocks[lane]);
+        }
+        done += 4;
+    }
+    for (; done < block_count; done++)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)(input + (done * AES_BLOCK_SIZE)));
+        data = encrypt ? encrypt1(keys, num_rounds, data) : decrypt1(keys, num_rounds, data);
+        _mm_storeu_si128((__m128i*)(output + (done * AES_BLOCK_SIZE)), data);
+    }
+    return done;
+}
+
+AESNI_TARGET static int aesni_gcm_init(const unsigned char* h_value, unsigned char* h_powers)
+{
+    const __m128i swap = byte_swap_mask();
+    __m128i hash_key = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)h_value), swap);
+    __m128i power = hash_key;
+    for (size_t index = 1; index <= CRYPTO_AES_ACCEL_GCM_POWERS; index++)
+    {
+        _mm_storeu_si128((__m128i*)(h_powers + ((CRYPTO_AES_ACCEL_GCM_POWERS - index) * AES_BLOCK_SIZE)), power);
+        power = gf_multiply(power, hash_key);
+    }
+    return 0;
+}
+
+AESNI_TARGET static size_t aesni_gcm(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m128i blocks[4];
+    __m128i powers[4];
+    const __m128i swap = byte_swap_mask();
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+    __m128i count = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)counter), swap);
+    __m128i state = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hash), swap);
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_encrypt_keys(schedule, keys);
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        powers[lane] = load_power(h_powers, 4 - lane);
+    }
+    while (block_count - done >= 4)
+    {
+        __m128i low = _mm_setzero_si128();
+        __m128i middle = _mm_setzero_si128();
+        __m128i high = _mm_setzero_si128();
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            count = _mm_add_epi32(count, one);
+            blocks[lane] = _mm_shuffle_epi8(count, swap);
+        }
+        encrypt4(keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)(input + ((done + lane) * AES_BLOCK_SIZE)));
+            __m128i result = _mm_xor_si128(data, blocks[lane]);
+            __m128i cipher_block = _mm_shuffle_epi8(encrypt ? result : data, swap);
+            _mm_storeu_si128((__m128i*)(output + ((done + lane) * AES_BLOCK_SIZE)), result);
+            if (lane == 0)
+            {
+                cipher_block = _mm_xor_si128(cipher_block, state);
+            }
+            // Four blocks fold into one reduction: (X ^ C0)H^4 ^ C1H^3 ^ C2H^2 ^ C3H
+            clmul_accumulate(cipher_block, powers[lane], &low, &middle, &high);
+        }
+        state = reduce_product(low, middle, high);
+        done += 4;
+    }
+    for (; done < block_count; done++)
+    {
+        __m128i data = _mm_loadu_si128((const __m128i*)(input + (done * AES_BLOCK_SIZE)));
+        __m128i result;
+        count = _mm_add_epi32(count, one);
+        result = _mm_xor_si128(data, encrypt1(keys, num_rounds, _mm_shuffle_epi8(count, swap)));
+        _mm_storeu_si128((__m128i*)(output + (done * AES_BLOCK_SIZE)), result);
+        state = gf_multiply(_mm_xor_si128(state, _mm_shuffle_epi8(encrypt ? result : data, swap)), powers[3]);
+    }
+    _mm_storeu_si128((__m128i*)counter, _mm_shuffle_epi8(count, swap));
+    _mm_storeu_si128((__m128i*)hash, _mm_shuffle_epi8(state, swap));
+    return done;
+}
+
+#ifdef AES_ACCEL_VAES
+
+/* AVX-512 VAES, four blocks per zmm register and four registers per iteration */
+
+VAES_TARGET static void vaes_broadcast_keys(const __m128i* keys, size_t num_rounds, __m512i wide_keys[AES_MAX_ROUNDS + 1])
+{
+    for (size_t index = 0; index <= num_rounds; index++)
+    {
+        wide_keys[index] = _mm512_broadcast_i32x4(keys[index]);
+    }
+}
+
+VAES_TARGET static void vaes_encrypt(const __m512i* keys, size_t num_rounds, __m512i blocks[4])
+{
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm512_xor_si512(blocks[lane], keys[0]);
+    }
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm512_aesenc_epi128(blocks[lane], keys[round]);
+        }
+    }
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm512_aesenclast_epi128(blocks[lane], keys[num_rounds]);
+    }
+}
+
+VAES_TARGET static void vaes_decrypt(const __m512i* keys, size_t num_rounds, __m512i blocks[4])
+{
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm512_xor_si512(blocks[lane], keys[0]);
+    }
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm512_aesdec_epi128(blocks[lane], keys[round]);
+        }
+    }
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm512_aesdeclast_epi128(blocks[lane], keys[num_rounds]);
+    }
+}
+
+// Counter blocks for the next 16 blocks, each 128-bit lane one block apart
+VAES_TARGET static void vaes_counters(__m512i* count, __m512i swap, __m512i blocks[4])
+{
+    const __m512i four = _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4);
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        blocks[lane] = _mm512_shuffle_epi8(*count, swap);
+        *count = _mm512_add_epi32(*count, four);
+    }
+}
+
+VAES_TARGET static __m512i vaes_counter_start(__m128i count)
+{
+    return _mm512_add_epi32(_mm512_broadcast_i32x4(count), _mm512_set_epi32(0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0));
+}
+
+VAES_TARGET static __m128i vaes_fold_lanes(__m512i value)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm512_extracti32x4_epi32(value, 0), _mm512_extracti32x4_epi32(value, 1)),
+        _mm_xor_si128(_mm512_extracti32x4_epi32(value, 2), _mm512_extracti32x4_epi32(value, 3)));
+}
+
+VAES_TARGET static size_t vaes_ctr32(const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m512i wide_keys[AES_MAX_ROUNDS + 1];
+    __m512i blocks[4];
+    const __m128i swap = byte_swap_mask();
+    const __m512i wide_swap = _mm512_broadcast_i32x4(swap);
+    __m128i start = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)counter), swap);
+    __m512i count = vaes_counter_start(start);
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_encrypt_keys(schedule, keys);
+    vaes_broadcast_keys(keys, num_rounds, wide_keys);
+    while (block_count - done >= VAES_GROUP_BLOCKS)
+    {
+        vaes_counters(&count, wide_swap, blocks);
+        vaes_encrypt(wide_keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            const unsigned char* source = input + ((done + (lane * 4)) * AES_BLOCK_SIZE);
+            unsigned char* target = output + ((done + (lane * 4)) * AES_BLOCK_SIZE);
+            _mm512_storeu_si512((void*)target, _mm512_xor_si512(_mm512_loadu_si512((const void*)source), blocks[lane]));
+        }
+        done += VAES_GROUP_BLOCKS;
+    }
+    _mm_storeu_si128((__m128i*)counter, _mm_shuffle_epi8(_mm512_castsi512_si128(count), swap));
+    // The tail is narrower than a group
+    return done + aesni_ctr32(schedule, counter, input + (done * AES_BLOCK_SIZE), output + (done * AES_BLOCK_SIZE), block_count - done);
+}
+
+VAES_TARGET static size_t vaes_cbc_decrypt(const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m512i wide_keys[AES_MAX_ROUNDS + 1];
+    __m512i blocks[4];
+    __m512i cipher[4];
+    // Only the top lane matters, it is shifted in front of the first block
+    __m512i previous = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)iv));
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_decrypt_keys(schedule, keys);
+    vaes_broadcast_keys(keys, num_rounds, wide_keys);
+    while (block_count - done >= VAES_GROUP_BLOCKS)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            cipher[lane] = _mm512_loadu_si512((const void*)(input + ((done + (lane * 4)) * AES_BLOCK_SIZE)));
+            blocks[lane] = cipher[lane];
+        }
+        vaes_decrypt(wide_keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            // Each block is XOR'd with the cipher block before it: the top lane
+            // of the previous register followed by the lower three of this one
+            __m512i chain = _mm512_alignr_epi64(cipher[lane], previous, 6);
+            _mm512_storeu_si512((void*)(output + ((done + (lane * 4)) * AES_BLOCK_SIZE)), _mm512_xor_si512(blocks[lane], chain));
+            previous = cipher[lane];
+        }
+        done += VAES_GROUP_BLOCKS;
+    }
+    _mm_storeu_si128((__m128i*)iv, _mm512_extracti32x4_epi32(previous, 3));
+    return done + aesni_cbc_decrypt(schedule, iv, input + (done * AES_BLOCK_SIZE), output + (done * AES_BLOCK_SIZE), block_count - done);
+}
+
+VAES_TARGET static size_t vaes_ecb(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m512i wide_keys[AES_MAX_ROUNDS + 1];
+    __m512i blocks[4];
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    if (encrypt)
+    {
+        load_encrypt_keys(schedule, keys);
+    }
+    else
+    {
+        load_decrypt_keys(schedule, keys);
+    }
+    vaes_broadcast_keys(keys, num_rounds, wide_keys);
+    while (block_count - done >= VAES_GROUP_BLOCKS)
+    {
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            blocks[lane] = _mm512_loadu_si512((const void*)(input + ((done + (lane * 4)) * AES_BLOCK_SIZE)));
+        }
+        if (encrypt)
+        {
+            vaes_encrypt(wide_keys, num_rounds, blocks);
+        }
+        else
+        {
+            vaes_decrypt(wide_keys, num_rounds, blocks);
+        }
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            _mm512_storeu_si512((void*)(output + ((done + (lane * 4)) * AES_BLOCK_SIZE)), blocks[lane]);
+        }
+        done += VAES_GROUP_BLOCKS;
+    }
+    return done + aesni_ecb(encrypt, schedule, input + (done * AES_BLOCK_SIZE), output + (done * AES_BLOCK_SIZE), block_count - done);
+}
+
+VAES_TARGET static size_t vaes_gcm(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    __m128i keys[AES_MAX_ROUNDS + 1];
+    __m512i wide_keys[AES_MAX_ROUNDS + 1];
+    __m512i powers[4];
+    __m512i blocks[4];
+    const __m128i swap = byte_swap_mask();
+    const __m512i wide_swap = _mm512_broadcast_i32x4(swap);
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+    __m128i start = _mm_add_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)counter), swap), one);
+    __m512i count = vaes_counter_start(start);
+    __m128i state = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hash), swap);
+    size_t num_rounds = schedule->num_rounds;
+    size_t done = 0;
+
+    load_encrypt_keys(schedule, keys);
+    vaes_broadcast_keys(keys, num_rounds, wide_keys);
+    // Block j of a group is multiplied by H^(16 - j), the table is already in that order
+    for (size_t lane = 0; lane < 4; lane++)
+    {
+        powers[lane] = _mm512_loadu_si512((const void*)(h_powers + (lane * 4 * AES_BLOCK_SIZE)));
+    }
+    while (block_count - done >= VAES_GROUP_BLOCKS)
+    {
+        __m512i low = _mm512_setzero_si512();
+        __m512i middle = _mm512_setzero_si512();
+        __m512i high = _mm512_setzero_si512();
+
+        vaes_counters(&count, wide_swap, blocks);
+        vaes_encrypt(wide_keys, num_rounds, blocks);
+        for (size_t lane = 0; lane < 4; lane++)
+        {
+            size_t offset = (done + (lane * 4)) * AES_BLOCK_SIZE;
+            __m512i data = _mm512_loadu_si512((const void*)(input + offset));
+            __m512i result = _mm512_xor_si512(data, blocks[lane]);
+            __m512i cipher_block = _mm512_shuffle_epi8(encrypt ? result : data, wide_swap);
+            _mm512_storeu_si512((void*)(output + offset), result);
+            if (lane == 0)
+            {
+                // The running hash joins the first block only
+                cipher_block = _mm512_xor_si512(cipher_block, _mm512_maskz_broadcast_i32x4(0x000F, state));
+            }
+            low = _mm512_xor_si512(low, _mm512_clmulepi64_epi128(cipher_block, powers[lane], 0x00));
+            high = _mm512_xor_si512(high, _mm512_clmulepi64_epi128(cipher_block, powers[lane], 0x11));
+            middle = _mm512_xor_si512(middle, _mm512_xor_si512(_mm512_clmulepi64_epi128(cipher_block, powers[lane], 0x01),
+                _mm512_clmulepi64_epi128(cipher_block, powers[lane], 0x10)));
+        }
+        state = reduce_product(vaes_fold_lanes(low), vaes_fold_lanes(middle), vaes_fold_lanes(high));
+        done += VAES_GROUP_BLOCKS;
+    }
+    // Back to the last counter used for the narrower tail
+    _mm_storeu_si128((__m128i*)counter, _mm_shuffle_epi8(_mm_sub_epi32(_mm512_castsi512_si128(count), one), swap));
+    _mm_storeu_si128((__m128i*)hash, _mm_shuffle_epi8(state, swap));
+    return done + aesni_gcm(encrypt, schedule, h_powers, counter, hash, input + (done * AES_BLOCK_SIZE), output + (done * AES_BLOCK_SIZE), block_count - done);
+}
+
+#endif // AES_ACCEL_VAES
+
+static size_t ctr32_blocks(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    switch (level)
+    {
+#ifdef AES_ACCEL_VAES
+        case CRYPTO_AES_ACCEL_VAES512:
+            result = vaes_ctr32(schedule, counter, input, output, block_count);
+            break;
+#endif
+        case CRYPTO_AES_ACCEL_AESNI:
+            result = aesni_ctr32(schedule, counter, input, output, block_count);
+            break;
+        default:
+            result = 0;
+            break;
+    }
+    return result;
+}
+
+static size_t cbc_decrypt_blocks(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    switch (level)
+    {
+#ifdef AES_ACCEL_VAES
+        case CRYPTO_AES_ACCEL_VAES512:
+            result = vaes_cbc_decrypt(schedule, iv, input, output, block_count);
+            break;
+#endif
+        case CRYPTO_AES_ACCEL_AESNI:
+            result = aesni_cbc_decrypt(schedule, iv, input, output, block_count);
+            break;
+        default:
+            result = 0;
+            break;
+    }
+    return result;
+}
+
+static size_t ecb_blocks(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    switch (kernel_level(block_count))
+    {
+#ifdef AES_ACCEL_VAES
+        case CRYPTO_AES_ACCEL_VAES512:
+            result = vaes_ecb(encrypt, schedule, input, output, block_count);
+            break;
+#endif
+        case CRYPTO_AES_ACCEL_AESNI:
+            result = aesni_ecb(encrypt, schedule, input, output, block_count);
+            break;
+        default:
+            result = 0;
+            break;
+    }
+    return result;
+}
+
+static size_t gcm_blocks(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    switch (kernel_level(block_count))
+    {
+#ifdef AES_ACCEL_VAES
+        case CRYPTO_AES_ACCEL_VAES512:
+            result = vaes_gcm(encrypt, schedule, h_powers, counter, hash, input, output, block_count);
+            break;
+#endif
+        case CRYPTO_AES_ACCEL_AESNI:
+            result = aesni_gcm(encrypt, schedule, h_powers, counter, hash, input, output, block_count);
+            break;
+        default:
+            result = 0;
+            break;
+    }
+    return result;
+}
+
+static int gcm_init(const unsigned char* h_value, unsigned char* h_powers)
+{
+    int result;
+    // Prepared whenever the cpu can use it, a later cap does not matter
+    if (detect_level() == CRYPTO_AES_ACCEL_NONE)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = aesni_gcm_init(h_value, h_powers);
+    }
+    return result;
+}
+
+#else
+
+static CRYPTO_AES_ACCEL detect_level(void)
+{
+    return CRYPTO_AES_ACCEL_NONE;
+}
+
+static CRYPTO_AES_ACCEL current_level(void)
+{
+    return CRYPTO_AES_ACCEL_NONE;
+}
+
+static size_t ctr32_blocks(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    (void)level;
+    (void)schedule;
+    (void)counter;
+    (void)input;
+    (void)output;
+    (void)block_count;
+    return 0;
+}
+
+static size_t cbc_decrypt_blocks(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    (void)level;
+    (void)schedule;
+    (void)iv;
+    (void)input;
+    (void)output;
+    (void)block_count;
+    return 0;
+}
+
+static size_t ecb_blocks(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    (void)encrypt;
+    (void)schedule;
+    (void)input;
+    (void)output;
+    (void)block_count;
+    return 0;
+}
+
+static size_t gcm_blocks(bool encrypt, const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    (void)encrypt;
+    (void)schedule;
+    (void)h_powers;
+    (void)counter;
+    (void)hash;
+    (void)input;
+    (void)output;
+    (void)block_count;
+    return 0;
+}
+
+static int gcm_init(const unsigned char* h_value, unsigned char* h_powers)
+{
+    (void)h_value;
+    (void)h_powers;
+    return __LINE__;
+}
+
+#endif // AES_ACCEL_X86
+
+CRYPTO_AES_ACCEL crypto_aes_accel_detect(void)
+{
+    return detect_level();
+}
+
+CRYPTO_AES_ACCEL crypto_aes_accel_get_level(void)
+{
+    return current_level();
+}
+
+int crypto_aes_accel_set_level(CRYPTO_AES_ACCEL level)
+{
+    int result;
+    if (level != CRYPTO_AES_ACCEL_NONE && level != CRYPTO_AES_ACCEL_AESNI && level != CRYPTO_AES_ACCEL_VAES512)
+    {
+        log_error("Failure invalid parameter specified level: %d", (int)level);
+        result = __LINE__;
+    }
+    else if (level > detect_level())
+    {
+        log_error("Failure acceleration level %d is not supported on this cpu", (int)level);
+        result = __LINE__;
+    }
+    else
+    {
+#ifdef AES_ACCEL_X86
+        __atomic_store_n(&g_level_cap, (int)level, __ATOMIC_RELAXED);
+#endif
+        result = 0;
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_get_wide_threshold(void)
+{
+#ifdef AES_ACCEL_X86
+    return __atomic_load_n(&g_wide_threshold, __ATOMIC_RELAXED);
+#else
+    return 0;
+#endif
+}
+
+void crypto_aes_accel_set_wide_threshold(size_t block_count)
+{
+#ifdef AES_ACCEL_X86
+    __atomic_store_n(&g_wide_threshold, block_count, __ATOMIC_RELAXED);
+#else
+    (void)block_count;
+#endif
+}
+
+size_t crypto_aes_accel_ctr32(const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || counter == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, counter: %p, input: %p, output: %p", schedule, counter, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = ctr32_blocks(kernel_level(block_count), schedule, counter, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_cbc_decrypt(const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || iv == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, iv: %p, input: %p, output: %p", schedule, iv, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = cbc_decrypt_blocks(kernel_level(block_count), schedule, iv, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_ctr32_at_level(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* counter,
+    const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (level > detect_level() || schedule == NULL || counter == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified level: %d, schedule: %p, counter: %p, input: %p, output: %p", (int)level, schedule, counter, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = ctr32_blocks(level, schedule, counter, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_cbc_decrypt_at_level(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* iv,
+    const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (level > detect_level() || schedule == NULL || iv == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified level: %d, schedule: %p, iv: %p, input: %p, output: %p", (int)level, schedule, iv, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = cbc_decrypt_blocks(level, schedule, iv, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_ecb_encrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, input: %p, output: %p", schedule, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = ecb_blocks(true, schedule, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_ecb_decrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, input: %p, output: %p", schedule, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = ecb_blocks(false, schedule, input, output, block_count);
+    }
+    return result;
+}
+
+int crypto_aes_accel_gcm_init(const unsigned char* h_value, unsigned char* h_powers)
+{
+    int result;
+    if (h_value == NULL || h_powers == NULL)
+    {
+        log_error("Failure invalid parameter specified h_value: %p, h_powers: %p", h_value, h_powers);
+        result = __LINE__;
+    }
+    else
+    {
+        result = gcm_init(h_value, h_powers);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_gcm_encrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || h_powers == NULL || counter == NULL || hash == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, h_powers: %p, input: %p, output: %p", schedule, h_powers, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = gcm_blocks(true, schedule, h_powers, counter, hash, input, output, block_count);
+    }
+    return result;
+}
+
+size_t crypto_aes_accel_gcm_decrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* h_powers,
+    unsigned char* counter, unsigned char* hash, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    size_t result;
+    if (schedule == NULL || h_powers == NULL || counter == NULL || hash == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, h_powers: %p, input: %p, output: %p", schedule, h_powers, input, output);
+        result = 0;
+    }
+    else
+    {
+        result = gcm_blocks(false, schedule, h_powers, counter, hash, input, output, block_count);
+    }
+    return result;
+}
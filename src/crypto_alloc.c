@@ -0,0 +1,191 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+typedef struct CRYPTO_POOL_INFO_TAG
+{
+    unsigned char* slab;
+    size_t slot_size;
+    size_t item_count;
+    // Free items are chained through their first bytes
+    void* free_list;
+} CRYPTO_POOL_INFO;
+
+static void* default_malloc(void* context, size_t size)
+{
+    (void)context;
+    return malloc(size);
+}
+
+static void default_free(void* context, void* ptr)
+{
+    (void)context;
+    free(ptr);
+}
+
+static CRYPTO_MALLOC_FUNC g_malloc_func = default_malloc;
+static CRYPTO_FREE_FUNC g_free_func = default_free;
+static void* g_alloc_context = NULL;
+
+int crypto_alloc_set_functions(CRYPTO_MALLOC_FUNC malloc_func, CRYPTO_FREE_FUNC free_func, void* context)
+{
+    int result;
+    if ((malloc_func == NULL) != (free_func == NULL))
+    {
+        log_error("Failure invalid parameter specified malloc_func: %p, free_func: %p", malloc_func, free_func);
+        result = __LINE__;
+    }
+    else if (malloc_func == NULL)
+    {
+        g_malloc_func = default_malloc;
+        g_free_func = default_free;
+        g_alloc_context = NULL;
+        result = 0;
+    }
+    else
+    {
+        g_malloc_func = malloc_func;
+        g_free_func = free_func;
+        g_alloc_context = context;
+        result = 0;
+    }
+    return result;
+}
+
+void* crypto_alloc_malloc(size_t size)
+{
+    return g_malloc_func(g_alloc_context, size);
+}
+
+void crypto_alloc_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        g_free_func(g_alloc_context, ptr);
+    }
+}
+
+CRYPTO_POOL_HANDLE crypto_pool_create(size_t item_size, size_t item_count)
+{
+    CRYPTO_POOL_INFO* result;
+    // Round every slot to whole cache lines so neighbouring contexts never share one
+    size_t slot_size = (item_size + CRYPTO_CACHE_LINE_SIZE - 1) & ~((size_t)CRYPTO_CACHE_LINE_SIZE - 1);
+    if (item_size == 0 || item_count == 0)
+    {
+        log_error("Failure invalid parameter specified item_size: %d, item_count: %d", (int)item_size, (int)item_count);
+        result = NULL;
+    }
+    else if (slot_size < item_size || item_count > (SIZE_MAX - sizeof(CRYPTO_POOL_INFO) - CRYPTO_CACHE_LINE_SIZE) / slot_size)
+    {
+        log_error("Failure pool size overflows item_size: %d, item_count: %d", (int)item_size, (int)item_count);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_POOL_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_POOL_INFO) + CRYPTO_CACHE_LINE_SIZE - 1 + (slot_size * item_count))) == NULL)
+    {
+        log_error("Failure allocating pool");
+    }
+    else
+    {
+        uintptr_t slab_start = (uintptr_t)(result + 1);
+        slab_start = (slab_start + CRYPTO_CACHE_LINE_SIZE - 1) & ~((uintptr_t)CRYPTO_CACHE_LINE_SIZE - 1);
+
+        result->slab = (unsigned char*)slab_start;
+        result->slot_size = slot_size;
+        result->item_count = item_count;
+        result->free_list = NULL;
+        memset(result->slab, 0, slot_size * item_count);
+
+        // Chain from the back so the first acquire hands out the first slot
+        for (size_t index = item_count; index > 0; index--)
+        {
+            void* item = result->slab + ((index - 1) * slot_size);
+            memcpy(item, &result->free_list, sizeof(void*));
+            result->free_list = item;
+        }
+    }
+    return result;
+}
+
+void crypto_pool_destroy(CRYPTO_POOL_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        secure_zero(handle->slab, handle->slot_size * handle->item_count);
+        crypto_alloc_free(handle);
+    }
+}
+
+void* crypto_pool_acquire(CRYPTO_POOL_HANDLE handle)
+{
+    void* result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = NULL;
+    }
+    else if ((result = handle->free_list) != NULL)
+    {
+        memcpy(&handle->free_list, result, sizeof(void*));
+        memset(result, 0, sizeof(void*));
+    }
+    return result;
+}
+
+void crypto_pool_release(CRYPTO_POOL_HANDLE handle, void* item)
+{
+    if (handle == NULL || item == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, item: %p", handle, item);
+    }
+    else if (!crypto_pool_owns(handle, item))
+    {
+        log_error("Failure item %p does not belong to the pool", item);
+    }
+    else
+    {
+        secure_zero(item, handle->slot_size);
+        memcpy(item, &handle->free_list, sizeof(void*));
+        handle->free_list = item;
+    }
+}
+
+bool crypto_pool_owns(CRYPTO_POOL_HANDLE handle, const void* item)
+{
+    bool result;
+    if (handle == NULL || item == NULL)
+    {
+        result = false;
+    }
+    else
+    {
+        uintptr_t offset = (uintptr_t)item - (uintptr_t)handle->slab;
+        result = (uintptr_t)item >= (uintptr_t)handle->slab && offset < handle->slot_size * handle->item_count && (offset % handle->slot_size) == 0;
+    }
+    return result;
+}
+
+size_t crypto_pool_get_slot_size(CRYPTO_POOL_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->slot_size;
+    }
+    return result;
+}
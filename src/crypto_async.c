@@ -0,0 +1,514 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_async.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_des_core.h"
+#include "cablelock/crypto_gcm.h"
+#include "cablelock/crypto_ccm.h"
+#include "cablelock/crypto_xts.h"
+#include "cablelock/crypto_alloc.h"
+
+// Bounded multi producer, multi consumer ring of job pointers.  Every slot
+// carries a sequence number telling producers and consumers whose turn it is,
+// so neither side takes a lock.
+typedef struct ASYNC_SLOT_TAG
+{
+    size_t sequence;
+    CRYPTO_ASYNC_JOB* job;
+} ASYNC_SLOT;
+
+typedef struct ASYNC_RING_TAG
+{
+    ASYNC_SLOT* slots;
+    size_t mask;
+    // Producers and consumers each get their own cache line
+    unsigned char pad_head[CRYPTO_CACHE_LINE_SIZE];
+    size_t enqueue_pos;
+    unsigned char pad_middle[CRYPTO_CACHE_LINE_SIZE];
+    size_t dequeue_pos;
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+} ASYNC_RING;
+
+typedef struct CRYPTO_ASYNC_INFO_TAG
+{
+    ASYNC_RING submit_ring;
+    ASYNC_RING complete_ring;
+    size_t capacity;
+    size_t in_flight;
+
+    CRYPTO_ASYNC_PROCESS_FUNC process_func;
+    void* process_context;
+
+    pthread_t* workers;
+    size_t worker_count;
+    // Only idle workers touch the lock, submit signals when one is asleep
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    size_t sleepers;
+    bool running;
+} CRYPTO_ASYNC_INFO;
+
+static size_t round_up_power_of_2(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+static int ring_init(ASYNC_RING* ring, size_t capacity)
+{
+    int result;
+    if ((ring->slots = (ASYNC_SLOT*)crypto_alloc_malloc(capacity * sizeof(ASYNC_SLOT))) == NULL)
+    {
+        log_error("Failure allocating job ring");
+        result = __LINE__;
+    }
+    else
+    {
+        for (size_t index = 0; index < capacity; index++)
+        {
+            ring->slots[index].sequence = index;
+            ring->slots[index].job = NULL;
+        }
+        ring->mask = capacity - 1;
+        ring->enqueue_pos = 0;
+        ring->dequeue_pos = 0;
+        result = 0;
+    }
+    return result;
+}
+
+static bool ring_push(ASYNC_RING* ring, CRYPTO_ASYNC_JOB* job)
+{
+    bool result;
+    ASYNC_SLOT* slot;
+    size_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        slot = &ring->slots[pos & ring->mask];
+        intptr_t diff = (intptr_t)__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                result = true;
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Slot still holds a job from the previous lap
+            result = false;
+            break;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    if (result)
+    {
+        slot->job = job;
+        __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    }
+    return result;
+}
+
+static CRYPTO_ASYNC_JOB* ring_pop(ASYNC_RING* ring)
+{
+    CRYPTO_ASYNC_JOB* result;
+    ASYNC_SLOT* slot;
+    size_t pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        slot = &ring->slots[pos & ring->mask];
+        intptr_t diff = (intptr_t)__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->dequeue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            slot = NULL;
+            break;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    if (slot == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = slot->job;
+        // Hand the slot to the producer one lap ahead
+        __atomic_store_n(&slot->sequence, pos + ring->mask + 1, __ATOMIC_RELEASE);
+    }
+    return result;
+}
+
+static void complete_job(CRYPTO_ASYNC_INFO* async_info, CRYPTO_ASYNC_JOB* job)
+{
+    if (job->on_complete != NULL)
+    {
+        job->on_complete(job->complete_context, job);
+        __atomic_fetch_sub(&async_info->in_flight, 1, __ATOMIC_ACQ_REL);
+    }
+    else if (!ring_push(&async_info->complete_ring, job))
+    {
+        // Cannot happen, in_flight never exceeds the ring capacity
+        log_error("Failure completion ring is full");
+    }
+}
+
+// Sleeps until work arrives or the engine stops, returns false to exit
+static bool wait_for_work(CRYPTO_ASYNC_INFO* async_info)
+{
+    bool result;
+    pthread_mutex_lock(&async_info->lock);
+    __atomic_fetch_add(&async_info->sleepers, 1, __ATOMIC_SEQ_CST);
+    for (;;)
+    {
+        if (__atomic_load_n(&async_info->submit_ring.enqueue_pos, __ATOMIC_SEQ_CST) != __atomic_load_n(&async_info->submit_ring.dequeue_pos, __ATOMIC_SEQ_CST))
+        {
+            result = true;
+            break;
+        }
+        else if (!async_info->running)
+        {
+            result = false;
+            break;
+        }
+        pthread_cond_wait(&async_info->wake, &async_info->lock);
+    }
+    __atomic_fetch_sub(&async_info->sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&async_info->lock);
+    return result;
+}
+
+static void* worker_func(void* parameter)
+{
+    CRYPTO_ASYNC_INFO* async_info = (CRYPTO_ASYNC_INFO*)parameter;
+    CRYPTO_ASYNC_JOB* batch[CRYPTO_ASYNC_BATCH_SIZE];
+
+    do
+    {
+        size_t count;
+        do
+        {
+            count = 0;
+            while (count < CRYPTO_ASYNC_BATCH_SIZE && (batch[count] = ring_pop(&async_info->submit_ring)) != NULL)
+            {
+                count++;
+            }
+            if (count > 0)
+            {
+                async_info->process_func(async_info->process_context, batch, count);
+                for (size_t index = 0; index < count; index++)
+                {
+                    complete_job(async_info, batch[index]);
+                }
+            }
+        } while (count > 0);
+    } while (wait_for_work(async_info));
+    return NULL;
+}
+
+static void stop_workers(CRYPTO_ASYNC_INFO* async_info, size_t started)
+{
+    pthread_mutex_lock(&async_info->lock);
+    async_info->running = false;
+    pthread_cond_broadcast(&async_info->wake);
+    pthread_mutex_unlock(&async_info->lock);
+    for (size_t index = 0; index < started; index++)
+    {
+        pthread_join(async_info->workers[index], NULL);
+    }
+}
+
+static int process_job(CRYPTO_ASYNC_JOB* job)
+{
+    int result;
+    switch (job->cipher)
+    {
+        case CRYPTO_ASYNC_AES_ECB:
+            if (job->input_len % AES_BLOCK_SIZE != 0)
+            {
+                log_error("Failure aes ecb input length %d is not a multiple of the block size", (int)job->input_len);
+                result = __LINE__;
+            }
+            else if (job->encrypt)
+            {
+                result = crypto_aes_ecb_encrypt_blocks((const AES_KEY_SCHEDULE*)job->key, job->input, job->output, job->input_len / AES_BLOCK_SIZE);
+            }
+            else
+            {
+                result = crypto_aes_ecb_decrypt_blocks((const AES_KEY_SCHEDULE*)job->key, job->input, job->output, job->input_len / AES_BLOCK_SIZE);
+            }
+            break;
+        case CRYPTO_ASYNC_DES_ECB:
+            if (job->input_len % DES_BLOCK_SIZE != 0)
+            {
+                log_error("Failure des ecb input length %d is not a multiple of the block size", (int)job->input_len);
+                result = __LINE__;
+            }
+            else if (job->encrypt)
+            {
+                result = crypto_des_ecb_encrypt_blocks((const DES_KEY_SCHEDULE*)job->key, job->input, job->output, job->input_len / DES_BLOCK_SIZE);
+            }
+            else
+            {
+                result = crypto_des_ecb_decrypt_blocks((const DES_KEY_SCHEDULE*)job->key, job->input, job->output, job->input_len / DES_BLOCK_SIZE);
+            }
+            break;
+        case CRYPTO_ASYNC_AES_GCM:
+            if (job->iv_len != GCM_NONCE_SIZE || job->tag_len != GCM_TAG_SIZE)
+            {
+                log_error("Failure invalid gcm nonce length %d or tag length %d", (int)job->iv_len, (int)job->tag_len);
+                result = __LINE__;
+            }
+            else if (job->encrypt)
+            {
+                result = crypto_gcm_encrypt((const CRYPTO_GCM_KEY*)job->key, job->iv, job->aad, job->aad_len, job->input, job->input_len, job->output, job->tag);
+            }
+            else
+            {
+                result = crypto_gcm_decrypt((const CRYPTO_GCM_KEY*)job->key, job->iv, job->aad, job->aad_len, job->input, job->input_len, job->output, job->tag);
+            }
+            break;
+        case CRYPTO_ASYNC_AES_CCM:
+            if (job->encrypt)
+            {
+                result = crypto_ccm_encrypt((const AES_KEY_SCHEDULE*)job->key, job->iv, job->iv_len, job->aad, job->aad_len, job->input, job->input_len, job->output, job->tag, job->tag_len);
+            }
+            else
+            {
+                result = crypto_ccm_decrypt((const AES_KEY_SCHEDULE*)job->key, job->iv, job->iv_len, job->aad, job->aad_len, job->input, job->input_len, job->output, job->tag, job->tag_len);
+            }
+            break;
+        case CRYPTO_ASYNC_AES_XTS:
+            if (job->iv_len != XTS_TWEAK_SIZE)
+            {
+                log_error("Failure invalid xts tweak length %d", (int)job->iv_len);
+                result = __LINE__;
+            }
+            else if (job->encrypt)
+            {
+                result = crypto_xts_encrypt((const CRYPTO_XTS_KEY*)job->key, job->iv, job->input, job->input_len, job->output);
+            }
+            else
+            {
+                result = crypto_xts_decrypt((const CRYPTO_XTS_KEY*)job->key, job->iv, job->input, job->input_len, job->output);
+            }
+            break;
+        default:
+            log_error("Failure unsupported async cipher %d", (int)job->cipher);
+            result = __LINE__;
+            break;
+    }
+    return result;
+}
+
+CRYPTO_ASYNC_HANDLE crypto_async_create(const CRYPTO_ASYNC_CONFIG* config)
+{
+    CRYPTO_ASYNC_INFO* result;
+    if (config == NULL || config->thread_count == 0 || config->queue_depth == 0 || config->queue_depth > (SIZE_MAX / 2) / sizeof(ASYNC_SLOT))
+    {
+        log_error("Failure invalid parameter specified config: %p", config);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_ASYNC_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_ASYNC_INFO))) == NULL)
+    {
+        log_error("Failure allocating async engine");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_ASYNC_INFO));
+        result->capacity = round_up_power_of_2(config->queue_depth);
+        result->process_func = config->process_func != NULL ? config->process_func : crypto_async_software_process;
+        result->process_context = config->process_context;
+        result->running = true;
+
+        if (ring_init(&result->submit_ring, result->capacity) != 0)
+        {
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (ring_init(&result->complete_ring, result->capacity) != 0)
+        {
+            crypto_alloc_free(result->submit_ring.slots);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if ((result->workers = (pthread_t*)crypto_alloc_malloc(config->thread_count * sizeof(pthread_t))) == NULL)
+        {
+            log_error("Failure allocating async workers");
+            crypto_alloc_free(result->complete_ring.slots);
+            crypto_alloc_free(result->submit_ring.slots);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (pthread_mutex_init(&result->lock, NULL) != 0)
+        {
+            log_error("Failure initializing async lock");
+            crypto_alloc_free(result->workers);
+            crypto_alloc_free(result->complete_ring.slots);
+            crypto_alloc_free(result->submit_ring.slots);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (pthread_cond_init(&result->wake, NULL) != 0)
+        {
+            log_error("Failure initializing async condition");
+            pthread_mutex_destroy(&result->lock);
+            crypto_alloc_free(result->workers);
+            crypto_alloc_free(result->complete_ring.slots);
+            crypto_alloc_free(result->submit_ring.slots);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else
+        {
+            for (result->worker_count = 0; result->worker_count < config->thread_count; result->worker_count++)
+            {
+                if (pthread_create(&result->workers[result->worker_count], NULL, worker_func, result) != 0)
+                {
+                    break;
+                }
+            }
+            if (result->worker_count != config->thread_count)
+            {
+                log_error("Failure starting async worker %d", (int)result->worker_count);
+                crypto_async_destroy(result);
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+void crypto_async_destroy(CRYPTO_ASYNC_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        stop_workers(handle, handle->worker_count);
+        pthread_cond_destroy(&handle->wake);
+        pthread_mutex_destroy(&handle->lock);
+        crypto_alloc_free(handle->workers);
+        crypto_alloc_free(handle->complete_ring.slots);
+        crypto_alloc_free(handle->submit_ring.slots);
+        crypto_alloc_free(handle);
+    }
+}
+
+int crypto_async_submit(CRYPTO_ASYNC_HANDLE handle, CRYPTO_ASYNC_JOB* job)
+{
+    int result;
+    if (handle == NULL || job == NULL || job->key == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, job: %p", handle, job);
+        result = __LINE__;
+    }
+    else
+    {
+        // Reserve room in both rings before queueing
+        size_t in_flight = __atomic_load_n(&handle->in_flight, __ATOMIC_RELAXED);
+        do
+        {
+            if (in_flight == handle->capacity)
+            {
+                break;
+            }
+        } while (!__atomic_compare_exchange_n(&handle->in_flight, &in_flight, in_flight + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+        if (in_flight == handle->capacity)
+        {
+            log_error("Failure async queue is full");
+            result = __LINE__;
+        }
+        else if (!ring_push(&handle->submit_ring, job))
+        {
+            __atomic_fetch_sub(&handle->in_flight, 1, __ATOMIC_ACQ_REL);
+            log_error("Failure queueing async job");
+            result = __LINE__;
+        }
+        else
+        {
+            // Order the push before reading sleepers, wait_for_work does the reverse
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&handle->sleepers, __ATOMIC_SEQ_CST) > 0)
+            {
+                pthread_mutex_lock(&handle->lock);
+                pthread_cond_signal(&handle->wake);
+                pthread_mutex_unlock(&handle->lock);
+            }
+            result = 0;
+        }
+    }
+    return result;
+}
+
+size_t crypto_async_poll(CRYPTO_ASYNC_HANDLE handle, CRYPTO_ASYNC_JOB** jobs, size_t max_jobs)
+{
+    size_t result = 0;
+    if (handle == NULL || (jobs == NULL && max_jobs > 0))
+    {
+        log_error("Failure invalid parameter specified handle: %p, jobs: %p", handle, jobs);
+    }
+    else
+    {
+        while (result < max_jobs && (jobs[result] = ring_pop(&handle->complete_ring)) != NULL)
+        {
+            result++;
+        }
+        if (result > 0)
+        {
+            __atomic_fetch_sub(&handle->in_flight, result, __ATOMIC_ACQ_REL);
+        }
+    }
+    return result;
+}
+
+size_t crypto_async_get_in_flight(CRYPTO_ASYNC_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = __atomic_load_n(&handle->in_flight, __ATOMIC_ACQUIRE);
+    }
+    return result;
+}
+
+void crypto_async_software_process(void* context, CRYPTO_ASYNC_JOB** jobs, size_t job_count)
+{
+    (void)context;
+    for (size_t index = 0; index < job_count; index++)
+    {
+        jobs[index]->result = process_job(jobs[index]);
+    }
+}
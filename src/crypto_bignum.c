@@ -0,0 +1,577 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_bignum.h"
+#include "cablelock/crypto_macro.h"
+
+// The MULX/ADX kernel is inline assembly that only runs after the cpu check,
+// the rest of the library keeps the baseline instruction set
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define BIGNUM_MULX
+#endif
+
+// Exponent bits consumed per table lookup, the table holds 2^5 powers
+#define WINDOW_BITS         5
+#define WINDOW_SIZE         (1 << WINDOW_BITS)
+
+typedef unsigned __int128 uint128;
+
+static int g_mulx_detected = -1;
+static int g_mulx_enabled = 1;
+
+static bool detect_mulx(void)
+{
+    bool result;
+#ifdef BIGNUM_MULX
+    __builtin_cpu_init();
+    result = __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+#else
+    result = false;
+#endif
+    return result;
+}
+
+static bool mulx_detected(void)
+{
+    int detected = __atomic_load_n(&g_mulx_detected, __ATOMIC_RELAXED);
+    if (detected < 0)
+    {
+        // Every thread detects the same value, racing here is harmless
+        detected = detect_mulx() ? 1 : 0;
+        __atomic_store_n(&g_mulx_detected, detected, __ATOMIC_RELAXED);
+    }
+    return detected != 0;
+}
+
+static bool use_mulx(void)
+{
+    return __atomic_load_n(&g_mulx_enabled, __ATOMIC_RELAXED) != 0 && mulx_detected();
+}
+
+// target = left - right, returns the borrow
+static uint64_t limbs_sub(uint64_t* target, const uint64_t* left, const uint64_t* right, size_t limb_count)
+{
+    uint64_t borrow = 0;
+    for (size_t index = 0; index < limb_count; index++)
+    {
+        uint128 diff = (uint128)left[index] - right[index] - borrow;
+        target[index] = (uint64_t)diff;
+        borrow = (uint64_t)(diff >> 64) & 1;
+    }
+    return borrow;
+}
+
+static void limbs_cmov(uint64_t* target, const uint64_t* src, size_t limb_count, uint64_t move)
+{
+    uint64_t mask = (uint64_t)0 - move;
+    for (size_t index = 0; index < limb_count; index++)
+    {
+        target[index] ^= mask & (target[index] ^ src[index]);
+    }
+}
+
+static void limbs_set_word(uint64_t* target, size_t limb_count, uint64_t word)
+{
+    memset(target, 0, limb_count * sizeof(uint64_t));
+    target[0] = word;
+}
+
+// Keeps value - modulus when value (with its carry bit) is at least modulus
+static void reduce_once(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* value, uint64_t carry)
+{
+    uint64_t reduced[CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t borrow = limbs_sub(reduced, value, context->modulus, context->limb_count);
+    memmove(target, value, context->limb_count * sizeof(uint64_t));
+    limbs_cmov(target, reduced, context->limb_count, carry | (borrow ^ 1));
+}
+
+static void mod_double(const CRYPTO_MONT_CONTEXT* context, uint64_t* value)
+{
+    uint64_t carry = 0;
+    for (size_t index = 0; index < context->limb_count; index++)
+    {
+        uint64_t next = value[index] >> 63;
+        value[index] = (value[index] << 1) | carry;
+        carry = next;
+    }
+    reduce_once(context, value, value, carry);
+}
+
+// Word by word Montgomery multiplication (CIOS)
+static void mont_mul_portable(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    size_t limb_count = context->limb_count;
+    const uint64_t* modulus = context->modulus;
+    uint64_t acc[CRYPTO_BIGNUM_MAX_LIMBS + 2];
+    memset(acc, 0, (limb_count + 2) * sizeof(uint64_t));
+    for (size_t outer = 0; outer < limb_count; outer++)
+    {
+        uint128 product;
+        uint64_t carry = 0;
+        uint64_t factor;
+        for (size_t inner = 0; inner < limb_count; inner++)
+        {
+            product = ((uint128)left[inner] * right[outer]) + acc[inner] + carry;
+            acc[inner] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        product = (uint128)acc[limb_count] + carry;
+        acc[limb_count] = (uint64_t)product;
+        acc[limb_count + 1] = (uint64_t)(product >> 64);
+
+        // Adding factor * modulus clears the low word, which then shifts out
+        factor = acc[0] * context->modulus_inv;
+        product = ((uint128)factor * modulus[0]) + acc[0];
+        carry = (uint64_t)(product >> 64);
+        for (size_t inner = 1; inner < limb_count; inner++)
+        {
+            product = ((uint128)factor * modulus[inner]) + acc[inner] + carry;
+            acc[inner - 1] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        product = (uint128)acc[limb_count] + carry;
+        acc[limb_count - 1] = (uint64_t)product;
+        acc[limb_count] = acc[limb_count + 1] + (uint64_t)(product >> 64);
+    }
+    reduce_once(context, target, acc, acc[limb_count]);
+}
+
+#ifdef BIGNUM_MULX
+// window[0..count+1] += src[0..count-1] * word, four limbs per iteration.
+// MULX leaves the flags alone, so the low halves accumulate on the CF chain
+// (ADCX) and the high halves on the OF chain (ADOX) through the whole row.
+// Compilers spill the flags between intrinsics, which is why the row is one
+// asm block; the loop is steered with LEA and JRCXZ because they do not
+// touch either flag.
+static void mulx_row(uint64_t* window, const uint64_t* src, uint64_t word, size_t count)
+{
+    uint64_t low;
+    uint64_t high;
+    uint64_t temp;
+    uint64_t previous;
+    uint64_t zero;
+    size_t quads = count / 4;
+    __asm__ volatile(
+        "xorl %k[zero], %k[zero]\n\t"
+        "xorl %k[previous], %k[previous]\n\t"
+        "1:\n\t"
+        "mulx (%[src]), %[low], %[high]\n\t"
+        "movq (%[window]), %[temp]\n\t"
+        "adcx %[low], %[temp]\n\t"
+        "adox %[previous], %[temp]\n\t"
+        "movq %[temp], (%[window])\n\t"
+        "movq %[high], %[previous]\n\t"
+        "mulx 8(%[src]), %[low], %[high]\n\t"
+        "movq 8(%[window]), %[temp]\n\t"
+        "adcx %[low], %[temp]\n\t"
+        "adox %[previous], %[temp]\n\t"
+        "movq %[temp], 8(%[window])\n\t"
+        "movq %[high], %[previous]\n\t"
+        "mulx 16(%[src]), %[low], %[high]\n\t"
+        "movq 16(%[window]), %[temp]\n\t"
+        "adcx %[low], %[temp]\n\t"
+        "adox %[previous], %[temp]\n\t"
+        "movq %[temp], 16(%[window])\n\t"
+        "movq %[high], %[previous]\n\t"
+        "mulx 24(%[src]), %[low], %[high]\n\t"
+        "movq 24(%[window]), %[temp]\n\t"
+        "adcx %[low], %[temp]\n\t"
+        "adox %[previous], %[temp]\n\t"
+        "movq %[temp], 24(%[window])\n\t"
+        "movq %[high], %[previous]\n\t"
+        "leaq 32(%[src]), %[src]\n\t"
+        "leaq 32(%[window]), %[window]\n\t"
+        "leaq -1(%[count]), %[count]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "movq (%[window]), %[temp]\n\t"
+        "adcx %[zero], %[temp]\n\t"
+        "adox %[previous], %[temp]\n\t"
+        "movq %[temp], (%[window])\n\t"
+        "movq 8(%[window]), %[temp]\n\t"
+        "adcx %[zero], %[temp]\n\t"
+        "adox %[zero], %[temp]\n\t"
+        "movq %[temp], 8(%[window])\n\t"
+        : [window] "+r" (window), [src] "+r" (src), [count] "+c" (quads),
+          [low] "=&r" (low), [high] "=&r" (high), [temp] "=&r" (temp), [previous] "=&r" (previous), [zero] "=&r" (zero)
+        : "d" (word)
+        : "cc", "memory");
+}
+
+// CIOS over mulx_row.  Instead of shifting the accumulator down after every
+// reduction the window slides up one word.
+static void mont_mul_mulx(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    size_t limb_count = context->limb_count;
+    uint64_t acc[(2 * CRYPTO_BIGNUM_MAX_LIMBS) + 2];
+    memset(acc, 0, ((2 * limb_count) + 2) * sizeof(uint64_t));
+    for (size_t outer = 0; outer < limb_count; outer++)
+    {
+        uint64_t* window = acc + outer;
+        mulx_row(window, left, right[outer], limb_count);
+        // Adding factor * modulus clears the low word
+        mulx_row(window, context->modulus, window[0] * context->modulus_inv, limb_count);
+    }
+    reduce_once(context, target, acc + limb_count, acc[2 * limb_count]);
+}
+#endif
+
+static void mont_mul_kernel(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right, bool mulx)
+{
+#ifdef BIGNUM_MULX
+    // The kernel takes four limbs per step, which every RSA size satisfies
+    if (context->limb_count % 4 == 0 && mulx)
+    {
+        mont_mul_mulx(context, target, left, right);
+    }
+    else
+#else
+    (void)mulx;
+#endif
+    {
+        mont_mul_portable(context, target, left, right);
+    }
+}
+
+static void mont_mul(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mont_mul_kernel(context, target, left, right, use_mulx());
+}
+
+// Constant time read of one window's table entry, every entry is touched
+static void select_power(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t table[WINDOW_SIZE][CRYPTO_BIGNUM_MAX_LIMBS], uint64_t digit)
+{
+    memset(target, 0, context->limb_count * sizeof(uint64_t));
+    for (size_t entry = 0; entry < WINDOW_SIZE; entry++)
+    {
+        uint64_t diff = (uint64_t)entry ^ digit;
+        uint64_t mask = ((diff | ((uint64_t)0 - diff)) >> 63) - 1;
+        for (size_t index = 0; index < context->limb_count; index++)
+        {
+            target[index] |= table[entry][index] & mask;
+        }
+    }
+}
+
+static uint64_t exponent_window(const uint64_t* exponent, size_t exponent_count, size_t bit)
+{
+    size_t limb = bit / 64;
+    size_t shift = bit % 64;
+    uint64_t bits = exponent[limb] >> shift;
+    if (shift > 64 - WINDOW_BITS && limb + 1 < exponent_count)
+    {
+        bits |= exponent[limb + 1] << (64 - shift);
+    }
+    return bits & (WINDOW_SIZE - 1);
+}
+
+int crypto_bignum_from_bytes(uint64_t* target, size_t limb_count, const unsigned char* bytes, size_t bytes_len)
+{
+    int result;
+    if (target == NULL || (bytes == NULL && bytes_len > 0))
+    {
+        log_error("Failure invalid parameter specified target: %p, bytes: %p", target, bytes);
+        result = __LINE__;
+    }
+    else
+    {
+        // Leading zero bytes beyond the limbs are allowed
+        size_t capacity = limb_count * 8;
+        size_t skip = 0;
+        while (bytes_len - skip > capacity && bytes[skip] == 0)
+        {
+            skip++;
+        }
+        if (bytes_len - skip > capacity)
+        {
+            log_error("Failure value of %d bytes does not fit %d limbs", (int)bytes_len, (int)limb_count);
+            result = __LINE__;
+        }
+        else
+        {
+            memset(target, 0, limb_count * sizeof(uint64_t));
+            for (size_t index = 0; index < bytes_len - skip; index++)
+            {
+                target[index / 8] |= (uint64_t)bytes[bytes_len - 1 - index] << ((index % 8) * 8);
+            }
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_bignum_to_bytes(unsigned char* bytes, size_t bytes_len, const uint64_t* value, size_t limb_count)
+{
+    int result;
+    if (bytes == NULL || value == NULL)
+    {
+        log_error("Failure invalid parameter specified bytes: %p, value: %p", bytes, value);
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t overflow = 0;
+        for (size_t index = bytes_len; index < limb_count * 8; index++)
+        {
+            overflow |= (value[index / 8] >> ((index % 8) * 8)) & 0xff;
+        }
+        if (overflow != 0)
+        {
+            log_error("Failure value does not fit %d bytes", (int)bytes_len);
+            result = __LINE__;
+        }
+        else
+        {
+            for (size_t index = 0; index < bytes_len; index++)
+            {
+                bytes[bytes_len - 1 - index] = index < limb_count * 8 ? (unsigned char)(value[index / 8] >> ((index % 8) * 8)) : 0;
+            }
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_bignum_compare(const uint64_t* left, const uint64_t* right, size_t limb_count)
+{
+    int result = 0;
+    for (size_t index = limb_count; index > 0 && result == 0; index--)
+    {
+        if (left[index - 1] != right[index - 1])
+        {
+            result = left[index - 1] < right[index - 1] ? -1 : 1;
+        }
+    }
+    return result;
+}
+
+uint64_t crypto_bignum_add(uint64_t* target, const uint64_t* left, const uint64_t* right, size_t limb_count)
+{
+    uint64_t carry = 0;
+    for (size_t index = 0; index < limb_count; index++)
+    {
+        uint128 sum = (uint128)left[index] + right[index] + carry;
+        target[index] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    return carry;
+}
+
+uint64_t crypto_bignum_sub(uint64_t* target, const uint64_t* left, const uint64_t* right, size_t limb_count)
+{
+    return limbs_sub(target, left, right, limb_count);
+}
+
+void crypto_bignum_mul(uint64_t* target, const uint64_t* left, size_t left_count, const uint64_t* right, size_t right_count)
+{
+    memset(target, 0, (left_count + right_count) * sizeof(uint64_t));
+    for (size_t outer = 0; outer < right_count; outer++)
+    {
+        uint64_t carry = 0;
+        for (size_t inner = 0; inner < left_count; inner++)
+        {
+            uint128 product = ((uint128)left[inner] * right[outer]) + target[outer + inner] + carry;
+            target[outer + inner] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        target[outer + left_count] = carry;
+    }
+}
+
+int crypto_bignum_mont_init(CRYPTO_MONT_CONTEXT* context, const uint64_t* modulus, size_t limb_count)
+{
+    int result;
+    if (context == NULL || modulus == NULL || limb_count == 0 || limb_count > CRYPTO_BIGNUM_MAX_LIMBS ||
+        (modulus[0] & 1) == 0 || modulus[limb_count - 1] == 0)
+    {
+        log_error("Failure invalid parameter specified context: %p, modulus: %p, limb_count: %d", context, modulus, (int)limb_count);
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t inverse = modulus[0];
+        size_t top_bit = (64 * limb_count) - (size_t)__builtin_clzll(modulus[limb_count - 1]) - 1;
+        size_t shift = 64 * limb_count;
+        size_t squarings = 0;
+
+        memset(context, 0, sizeof(CRYPTO_MONT_CONTEXT));
+        context->limb_count = limb_count;
+        memcpy(context->modulus, modulus, limb_count * sizeof(uint64_t));
+
+        // Newton iteration, each step doubles the correct low bits of m^-1
+        for (size_t step = 0; step < 5; step++)
+        {
+            inverse *= 2 - (modulus[0] * inverse);
+        }
+        context->modulus_inv = (uint64_t)0 - inverse;
+
+        // R^2 as R * 2^shift from a few doublings, then Montgomery squarings
+        // that double the shift until it reaches the width of R
+        while (shift % 2 == 0 && shift > 64)
+        {
+            shift /= 2;
+            squarings++;
+        }
+        context->rr[top_bit / 64] = (uint64_t)1 << (top_bit % 64);
+        for (size_t bit = top_bit; bit < (64 * limb_count) + shift; bit++)
+        {
+            mod_double(context, context->rr);
+        }
+        for (size_t step = 0; step < squarings; step++)
+        {
+            mont_mul(context, context->rr, context->rr, context->rr);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+void crypto_bignum_mont_mul(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mont_mul(context, target, left, right);
+}
+
+void crypto_bignum_mont_mul_kernel(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right, bool mulx)
+{
+    mont_mul_kernel(context, target, left, right, mulx && mulx_detected());
+}
+
+void crypto_bignum_mod_sub(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    uint64_t masked[CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t mask = (uint64_t)0 - limbs_sub(target, left, right, context->limb_count);
+    for (size_t index = 0; index < context->limb_count; index++)
+    {
+        masked[index] = context->modulus[index] & mask;
+    }
+    (void)crypto_bignum_add(target, target, masked, context->limb_count);
+}
+
+void crypto_bignum_mont_reduce(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* wide)
+{
+    size_t limb_count = context->limb_count;
+    uint64_t acc[2 * CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t top_carry = 0;
+    memcpy(acc, wide, 2 * limb_count * sizeof(uint64_t));
+    for (size_t outer = 0; outer < limb_count; outer++)
+    {
+        uint64_t factor = acc[outer] * context->modulus_inv;
+        uint64_t carry = 0;
+        uint128 sum;
+        for (size_t inner = 0; inner < limb_count; inner++)
+        {
+            uint128 product = ((uint128)factor * context->modulus[inner]) + acc[outer + inner] + carry;
+            acc[outer + inner] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        // The carry out of this word lands one word higher on the next pass
+        sum = (uint128)acc[outer + limb_count] + carry + top_carry;
+        acc[outer + limb_count] = (uint64_t)sum;
+        top_carry = (uint64_t)(sum >> 64);
+    }
+    reduce_once(context, target, acc + limb_count, top_carry);
+    secure_zero(acc, sizeof(acc));
+}
+
+void crypto_bignum_mod(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* wide)
+{
+    crypto_bignum_mont_reduce(context, target, wide);
+    mont_mul(context, target, target, context->rr);
+}
+
+void crypto_bignum_mod_exp(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* base, const uint64_t* exponent, size_t exponent_count)
+{
+    size_t limb_count = context->limb_count;
+    uint64_t table[WINDOW_SIZE][CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t acc[CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t power[CRYPTO_BIGNUM_MAX_LIMBS];
+    size_t bit = ((exponent_count * 64) + WINDOW_BITS - 1) / WINDOW_BITS * WINDOW_BITS;
+
+    // table[i] = base^i in Montgomery form
+    limbs_set_word(power, limb_count, 1);
+    mont_mul(context, table[0], power, context->rr);
+    mont_mul(context, table[1], base, context->rr);
+    for (size_t entry = 2; entry < WINDOW_SIZE; entry++)
+    {
+        mont_mul(context, table[entry], table[entry - 1], table[1]);
+    }
+
+    // The window count only depends on the exponent length
+    memcpy(acc, table[0], limb_count * sizeof(uint64_t));
+    while (bit > 0)
+    {
+        bit -= WINDOW_BITS;
+        for (size_t step = 0; step < WINDOW_BITS; step++)
+        {
+            mont_mul(context, acc, acc, acc);
+        }
+        select_power(context, power, (const uint64_t(*)[CRYPTO_BIGNUM_MAX_LIMBS])table, exponent_window(exponent, exponent_count, bit));
+        mont_mul(context, acc, acc, power);
+    }
+
+    limbs_set_word(power, limb_count, 1);
+    mont_mul(context, target, acc, power);
+    secure_zero(table, sizeof(table));
+    secure_zero(acc, sizeof(acc));
+    secure_zero(power, sizeof(power));
+}
+
+void crypto_bignum_mod_exp_public(const CRYPTO_MONT_CONTEXT* context, uint64_t* target, const uint64_t* base, uint64_t exponent)
+{
+    size_t limb_count = context->limb_count;
+    uint64_t base_mont[CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t acc[CRYPTO_BIGNUM_MAX_LIMBS];
+    uint64_t one[CRYPTO_BIGNUM_MAX_LIMBS];
+
+    limbs_set_word(one, limb_count, 1);
+    mont_mul(context, acc, one, context->rr);
+    mont_mul(context, base_mont, base, context->rr);
+    for (size_t bit = 64; bit > 0; bit--)
+    {
+        if ((exponent >> (bit - 1)) != 0)
+        {
+            mont_mul(context, acc, acc, acc);
+            if ((exponent >> (bit - 1)) & 1)
+            {
+                mont_mul(context, acc, acc, base_mont);
+            }
+        }
+    }
+    mont_mul(context, target, acc, one);
+}
+
+bool crypto_bignum_detect_mulx(void)
+{
+    return mulx_detected();
+}
+
+bool crypto_bignum_get_mulx(void)
+{
+    return use_mulx();
+}
+
+int crypto_bignum_set_mulx(bool enable)
+{
+    int result;
+    if (enable && !mulx_detected())
+    {
+        log_error("Failure MULX/ADX is not supported on this cpu");
+        result = __LINE__;
+    }
+    else
+    {
+        __atomic_store_n(&g_mulx_enabled, enable ? 1 : 0, __ATOMIC_RELAXED);
+        result = 0;
+    }
+    return result;
+}
@@ -0,0 +1,529 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_cbc_hmac.h"
+#include "cablelock/crypto_macro.h"
+
+// One SHA-256 block is compressed for every four AES blocks
+#define STITCH_CHUNK_SIZE       SHA256_BLOCK_SIZE
+#define STITCH_AES_BLOCKS       (STITCH_CHUNK_SIZE / AES_BLOCK_SIZE)
+#define SHA256_ROUNDS           64
+#define STITCH_ROUNDS_PER_BLOCK (SHA256_ROUNDS / STITCH_AES_BLOCKS)
+#define TLS_MAX_PADDING_CHECK   256
+#define SHA256_LENGTH_SIZE      8
+#define SIZE_T_BITS             (sizeof(size_t) * 8)
+
+typedef struct STITCH_STATE_TAG
+{
+    CRYPTO_SHA256 sha;
+    unsigned char pending[SHA256_BLOCK_SIZE];
+    bool has_pending;
+    unsigned char chain[AES_BLOCK_SIZE];
+} STITCH_STATE;
+
+static size_t padding_length(size_t data_len)
+{
+    // TLS padding always adds the length byte
+    return (AES_BLOCK_SIZE - ((data_len + 1) % AES_BLOCK_SIZE)) % AES_BLOCK_SIZE;
+}
+
+static void stitch_start(const CRYPTO_CBC_HMAC_KEY* cbc_key, STITCH_STATE* stitch, const unsigned char* seq_header, size_t mac_data_len, const unsigned char* iv)
+{
+    unsigned char length[2];
+
+    length[0] = (unsigned char)(mac_data_len >> 8);
+    length[1] = (unsigned char)mac_data_len;
+    crypto_hmac_sha256_start(&cbc_key->mac_key, &stitch->sha);
+    crypto_sha256_update(&stitch->sha, seq_header, CBC_HMAC_SEQ_HEADER_SIZE);
+    crypto_sha256_update(&stitch->sha, length, sizeof(length));
+    stitch->has_pending = false;
+    memcpy(stitch->chain, iv, AES_BLOCK_SIZE);
+}
+
+// Queue a chunk of mac data, the hash block it completes is compressed
+// alongside the next run of AES blocks
+static void stitch_stage(STITCH_STATE* stitch, const unsigned char* chunk)
+{
+    size_t buffered = stitch->sha.buffer_len;
+    size_t fill = SHA256_BLOCK_SIZE - buffered;
+
+    memcpy(stitch->pending, stitch->sha.buffer, buffered);
+    memcpy(stitch->pending + buffered, chunk, fill);
+    memcpy(stitch->sha.buffer, chunk + fill, STITCH_CHUNK_SIZE - fill);
+    stitch->sha.total_len += STITCH_CHUNK_SIZE;
+    stitch->has_pending = true;
+}
+
+static void stitch_flush(STITCH_STATE* stitch)
+{
+    if (stitch->has_pending)
+    {
+        crypto_sha256_compress(stitch->sha.state, stitch->pending);
+        stitch->has_pending = false;
+    }
+}
+
+static void cbc_block(const CRYPTO_CBC_HMAC_KEY* cbc_key, STITCH_STATE* stitch, bool encrypt, const unsigned char* input, unsigned char* output)
+{
+    unsigned char block[AES_BLOCK_SIZE];
+
+    // Input and output may be the same buffer
+    memcpy(block, input, AES_BLOCK_SIZE);
+    if (encrypt)
+    {
+        xor_value(block, stitch->chain, AES_BLOCK_SIZE);
+        crypto_aes_block_encrypt(&cbc_key->schedule, block, output);
+        memcpy(stitch->chain, output, AES_BLOCK_SIZE);
+    }
+    else
+    {
+        crypto_aes_block_decrypt(&cbc_key->schedule, block, output);
+        xor_value(output, stitch->chain, AES_BLOCK_SIZE);
+        memcpy(stitch->chain, block, AES_BLOCK_SIZE);
+    }
+}
+
+// Runs four chained AES-CBC blocks with a quarter of the SHA-256 rounds of
+// the pending block after each one.  The two dependency chains are
+// independent so the CPU overlaps them instead of running two passes.
+static void stitch_chunk(const CRYPTO_CBC_HMAC_KEY* cbc_key, STITCH_STATE* stitch, bool encrypt, const unsigned char* input, unsigned char* output)
+{
+    CRYPTO_SHA256_ROUNDS rounds;
+    bool compress = stitch->has_pending;
+
+    if (compress)
+    {
+        crypto_sha256_rounds_begin(&rounds, stitch->sha.state, stitch->pending);
+    }
+    for (size_t index = 0; index < STITCH_AES_BLOCKS; index++)
+    {
+        cbc_block(cbc_key, stitch, encrypt, input, output);
+        if (compress)
+        {
+            crypto_sha256_rounds_run(&rounds, index * STITCH_ROUNDS_PER_BLOCK, STITCH_ROUNDS_PER_BLOCK);
+        }
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+    }
+    if (compress)
+    {
+        crypto_sha256_rounds_end(&rounds, stitch->sha.state);
+        stitch->has_pending = false;
+    }
+}
+
+static void seal_mac_then_encrypt(const CRYPTO_CBC_HMAC_KEY* cbc_key, const unsigned char* iv, const unsigned char* seq_header,
+    const unsigned char* input, size_t input_len, unsigned char* output, size_t* cipher_len)
+{
+    STITCH_STATE stitch;
+    unsigned char tail[STITCH_CHUNK_SIZE + CBC_HMAC_MAC_SIZE + AES_BLOCK_SIZE];
+    size_t tail_len;
+    size_t padding;
+
+    *cipher_len = 0;
+    stitch_start(cbc_key, &stitch, seq_header, input_len, iv);
+    while (input_len >= STITCH_CHUNK_SIZE)
+    {
+        // The mac covers the plain text so queue it before it is encrypted
+        stitch_stage(&stitch, input);
+        stitch_chunk(cbc_key, &stitch, true, input, output);
+        input += STITCH_CHUNK_SIZE;
+        output += STITCH_CHUNK_SIZE;
+        input_len -= STITCH_CHUNK_SIZE;
+        *cipher_len += STITCH_CHUNK_SIZE;
+    }
+    stitch_flush(&stitch);
+
+    // The remaining plain text, the mac and padding are encrypted from a local buffer
+    memcpy(tail, input, input_len);
+    crypto_sha256_update(&stitch.sha, input, input_len);
+    crypto_hmac_sha256_finish(&cbc_key->mac_key, &stitch.sha, tail + input_len);
+    tail_len = input_len + CBC_HMAC_MAC_SIZE;
+    padding = padding_length(tail_len);
+    memset(tail + tail_len, (int)padding, padding + 1);
+    tail_len += padding + 1;
+
+    for (size_t offset = 0; offset < tail_len; offset += AES_BLOCK_SIZE)
+    {
+        cbc_block(cbc_key, &stitch, true, tail + offset, output + offset);
+    }
+    *cipher_len += tail_len;
+    secure_zero(tail, sizeof(tail));
+}
+
+static void seal_encrypt_then_mac(const CRYPTO_CBC_HMAC_KEY* cbc_key, const unsigned char* iv, const unsigned char* seq_header,
+    const unsigned char* input, size_t input_len, unsigned char* output, size_t* cipher_len)
+{
+    STITCH_STATE stitch;
+    unsigned char tail[STITCH_CHUNK_SIZE];
+    size_t padding = padding_length(input_len);
+    size_t padded_len = input_len + padding + 1;
+    unsigned char* cipher_text = output;
+
+    stitch_start(cbc_key, &stitch, seq_header, AES_BLOCK_SIZE + padded_len, iv);
+    crypto_sha256_update(&stitch.sha, iv, AES_BLOCK_SIZE);
+    while (input_len >= STITCH_CHUNK_SIZE)
+    {
+        // Compresses the cipher text queued by the previous chunk
+        stitch_chunk(cbc_key, &stitch, true, input, output);
+        stitch_stage(&stitch, output);
+        input += STITCH_CHUNK_SIZE;
+        output += STITCH_CHUNK_SIZE;
+        input_len -= STITCH_CHUNK_SIZE;
+    }
+    stitch_flush(&stitch);
+
+    memcpy(tail, input, input_len);
+    memset(tail + input_len, (int)padding, padding + 1);
+    for (size_t offset = 0; offset < input_len + padding + 1; offset += AES_BLOCK_SIZE)
+    {
+        cbc_block(cbc_key, &stitch, true, tail + offset, output + offset);
+    }
+    crypto_sha256_update(&stitch.sha, output, input_len + padding + 1);
+    crypto_hmac_sha256_finish(&cbc_key->mac_key, &stitch.sha, cipher_text + padded_len);
+    *cipher_len = padded_len + CBC_HMAC_MAC_SIZE;
+    secure_zero(tail, sizeof(tail));
+}
+
+// All ones when left < right, both far below SIZE_MAX / 2
+static size_t const_time_less(size_t left, size_t right)
+{
+    return 0 - ((left - right) >> (SIZE_T_BITS - 1));
+}
+
+static size_t const_time_equal(size_t left, size_t right)
+{
+    size_t value = left ^ right;
+    return 0 - ((~value & (value - 1)) >> (SIZE_T_BITS - 1));
+}
+
+// Finishes the HMAC over data_len more bytes of data without the work
+// depending on data_len, which comes from the decrypted padding.  Every block
+// that max_len bytes could reach is compressed and the state after the real
+// final block is kept, RFC 5246 6.2.3.2 and the Lucky Thirteen attack.
+static void hmac_finish_secret_length(const CRYPTO_CBC_HMAC_KEY* cbc_key, CRYPTO_SHA256* sha, const unsigned char* data,
+    size_t data_len, size_t max_len, unsigned char* mac)
+{
+    unsigned char block[SHA256_BLOCK_SIZE];
+    unsigned char inner_digest[SHA256_DIGEST_SIZE];
+    uint32_t final_state[SHA256_STATE_WORDS] = { 0 };
+    size_t buffered = sha->buffer_len;
+    uint64_t bit_len = (sha->total_len + data_len) * 8;
+    size_t final_block = (buffered + data_len + SHA256_LENGTH_SIZE) / SHA256_BLOCK_SIZE;
+    size_t block_count = (buffered + max_len + SHA256_LENGTH_SIZE) / SHA256_BLOCK_SIZE + 1;
+
+    for (size_t block_index = 0; block_index < block_count; block_index++)
+    {
+        uint32_t is_final = (uint32_t)const_time_equal(block_index, final_block);
+        for (size_t index = 0; index < SHA256_BLOCK_SIZE; index++)
+        {
+            size_t position = (block_index * SHA256_BLOCK_SIZE) + index;
+            unsigned char value;
+            if (position < buffered)
+            {
+                value = sha->buffer[position];
+            }
+            else
+            {
+                size_t offset = position - buffered;
+                value = offset < max_len ? data[offset] : 0;
+                value &= (unsigned char)const_time_less(offset, data_len);
+                value |= 0x80 & (unsigned char)const_time_equal(offset, data_len);
+            }
+            // The bytes under the length are always past the end marker in the final block
+            if (index >= SHA256_BLOCK_SIZE - SHA256_LENGTH_SIZE)
+            {
+                value |= (unsigned char)(bit_len >> ((SHA256_BLOCK_SIZE - 1 - index) * 8)) & (unsigned char)is_final;
+            }
+            block[index] = value;
+        }
+        crypto_sha256_compress(sha->state, block);
+        for (size_t index = 0; index < SHA256_STATE_WORDS; index++)
+        {
+            final_state[index] |= sha->state[index] & is_final;
+        }
+    }
+    for (size_t index = 0; index < SHA256_STATE_WORDS; index++)
+    {
+        store_be32(inner_digest + (index * 4), final_state[index]);
+    }
+
+    memcpy(sha->state, cbc_key->mac_key.outer_state, sizeof(sha->state));
+    sha->total_len = SHA256_BLOCK_SIZE;
+    sha->buffer_len = 0;
+    crypto_sha256_update(sha, inner_digest, SHA256_DIGEST_SIZE);
+    crypto_sha256_finish(sha, mac);
+    secure_zero(block, sizeof(block));
+    secure_zero(inner_digest, sizeof(inner_digest));
+    secure_zero(final_state, sizeof(final_state));
+}
+
+// Copies the received mac out of data[scan_start, data_len) reading every
+// byte of the range, then undoes the rotation by mac_offset
+static void copy_mac(const unsigned char* data, size_t scan_start, size_t data_len, size_t mac_offset, unsigned char* mac)
+{
+    unsigned char rotated[CBC_HMAC_MAC_SIZE] = { 0 };
+    size_t rotate = (mac_offset - scan_start) % CBC_HMAC_MAC_SIZE;
+
+    for (size_t index = scan_start; index < data_len; index++)
+    {
+        size_t in_mac = ~const_time_less(index, mac_offset) & const_time_less(index, mac_offset + CBC_HMAC_MAC_SIZE);
+        rotated[(index - scan_start) % CBC_HMAC_MAC_SIZE] |= data[index] & (unsigned char)in_mac;
+    }
+    for (size_t index = 0; index < CBC_HMAC_MAC_SIZE; index++)
+    {
+        unsigned char value = 0;
+        for (size_t source = 0; source < CBC_HMAC_MAC_SIZE; source++)
+        {
+            value |= rotated[source] & (unsigned char)const_time_equal(source, (rotate + index) % CBC_HMAC_MAC_SIZE);
+        }
+        mac[index] = value;
+    }
+    secure_zero(rotated, sizeof(rotated));
+}
+
+static int open_mac_then_encrypt(const CRYPTO_CBC_HMAC_KEY* cbc_key, const unsigned char* seq_header, const unsigned char* iv,
+    unsigned char* data, size_t cipher_len, size_t* plain_len)
+{
+    int result;
+    STITCH_STATE stitch;
+    unsigned char last_block[AES_BLOCK_SIZE];
+    unsigned char computed_mac[CBC_HMAC_MAC_SIZE];
+    unsigned char received_mac[CBC_HMAC_MAC_SIZE];
+    size_t processed = 0;
+    size_t padding;
+    size_t padding_good;
+    size_t scan_len;
+    size_t scan_start;
+    size_t mac_offset;
+    unsigned char diff;
+
+    // Nothing below depends on the padding byte except through masks.  The
+    // mac may start anywhere in the last scan_len bytes before the mac size,
+    // everything before scan_start is covered whatever the padding says.
+    scan_len = cipher_len - CBC_HMAC_MAC_SIZE;
+    if (scan_len > TLS_MAX_PADDING_CHECK)
+    {
+        scan_len = TLS_MAX_PADDING_CHECK;
+    }
+    scan_start = cipher_len - CBC_HMAC_MAC_SIZE - scan_len;
+
+    // Decrypt the final block first so the length covered by the mac is known up front
+    crypto_aes_block_decrypt(&cbc_key->schedule, data + cipher_len - AES_BLOCK_SIZE, last_block);
+    xor_value(last_block, data + cipher_len - (2 * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+    padding = last_block[AES_BLOCK_SIZE - 1];
+    // Bad padding is treated as none so the mac is still computed, RFC 5246 6.2.3.2
+    padding_good = ~const_time_less(cipher_len, padding + 1 + CBC_HMAC_MAC_SIZE);
+    padding &= padding_good;
+    diff = (unsigned char)(~padding_good & 1);
+    mac_offset = cipher_len - CBC_HMAC_MAC_SIZE - padding - 1;
+
+    stitch_start(cbc_key, &stitch, seq_header, mac_offset, iv);
+    while (scan_start - processed >= STITCH_CHUNK_SIZE)
+    {
+        // Compresses the plain text queued by the previous chunk
+        stitch_chunk(cbc_key, &stitch, false, data + processed, data + processed);
+        stitch_stage(&stitch, data + processed);
+        processed += STITCH_CHUNK_SIZE;
+    }
+    stitch_flush(&stitch);
+
+    for (size_t offset = processed; offset < cipher_len; offset += AES_BLOCK_SIZE)
+    {
+        cbc_block(cbc_key, &stitch, false, data + offset, data + offset);
+    }
+    crypto_sha256_update(&stitch.sha, data + processed, scan_start - processed);
+    hmac_finish_secret_length(cbc_key, &stitch.sha, data + scan_start, mac_offset - scan_start, scan_len - 1, computed_mac);
+    copy_mac(data, scan_start, cipher_len, mac_offset, received_mac);
+    diff |= (unsigned char)const_time_compare(computed_mac, received_mac, CBC_HMAC_MAC_SIZE);
+
+    // Check every padding byte without branching on the padding length
+    for (size_t index = 0; index < scan_len; index++)
+    {
+        unsigned char in_padding = (unsigned char)const_time_less(index, padding + 1);
+        diff |= (data[cipher_len - 1 - index] ^ (unsigned char)padding) & in_padding;
+    }
+
+    if (diff != 0)
+    {
+        secure_zero(data, cipher_len);
+        log_error("Failure authenticating cbc record");
+        result = __LINE__;
+    }
+    else
+    {
+        *plain_len = mac_offset;
+        result = 0;
+    }
+    secure_zero(last_block, sizeof(last_block));
+    secure_zero(received_mac, sizeof(received_mac));
+    return result;
+}
+
+static int open_encrypt_then_mac(const CRYPTO_CBC_HMAC_KEY* cbc_key, const unsigned char* seq_header, const unsigned char* iv,
+    unsigned char* data, size_t cipher_len, size_t* plain_len)
+{
+    int result;
+    STITCH_STATE stitch;
+    unsigned char computed_mac[CBC_HMAC_MAC_SIZE];
+    size_t processed = 0;
+
+    stitch_start(cbc_key, &stitch, seq_header, AES_BLOCK_SIZE + cipher_len, iv);
+    crypto_sha256_update(&stitch.sha, iv, AES_BLOCK_SIZE);
+    while (cipher_len - processed >= STITCH_CHUNK_SIZE)
+    {
+        // Queue the cipher text before it is decrypted in place
+        stitch_stage(&stitch, data + processed);
+        stitch_chunk(cbc_key, &stitch, false, data + processed, data + processed);
+        processed += STITCH_CHUNK_SIZE;
+    }
+    stitch_flush(&stitch);
+
+    for (size_t offset = processed; offset < cipher_len; offset += AES_BLOCK_SIZE)
+    {
+        crypto_sha256_update(&stitch.sha, data + offset, AES_BLOCK_SIZE);
+        cbc_block(cbc_key, &stitch, false, data + offset, data + offset);
+    }
+    crypto_hmac_sha256_finish(&cbc_key->mac_key, &stitch.sha, computed_mac);
+
+    if (const_time_compare(computed_mac, data + cipher_len, CBC_HMAC_MAC_SIZE) != 0)
+    {
+        secure_zero(data, cipher_len);
+        log_error("Failure authenticating cbc record");
+        result = __LINE__;
+    }
+    else
+    {
+        // The mac was verified first so the padding check is no oracle
+        size_t padding = data[cipher_len - 1];
+        bool valid = padding + 1 <= cipher_len;
+        for (size_t index = 0; valid && index <= padding; index++)
+        {
+            valid = data[cipher_len - 1 - index] == padding;
+        }
+        if (!valid)
+        {
+            secure_zero(data, cipher_len);
+            log_error("Failure invalid cbc record padding");
+            result = __LINE__;
+        }
+        else
+        {
+            *plain_len = cipher_len - padding - 1;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_cbc_hmac_key_init(CRYPTO_CBC_HMAC_KEY* cbc_key, const unsigned char* enc_key, size_t enc_key_len,
+    const unsigned char* mac_key, size_t mac_key_len)
+{
+    int result;
+    if (cbc_key == NULL || enc_key == NULL || mac_key == NULL)
+    {
+        log_error("Failure invalid parameter specified cbc_key: %p, enc_key: %p, mac_key: %p", cbc_key, enc_key, mac_key);
+        result = __LINE__;
+    }
+    else if (crypto_aes_key_init(&cbc_key->schedule, enc_key, enc_key_len) != 0)
+    {
+        log_error("Failure initializing aes key schedule");
+        result = __LINE__;
+    }
+    else if (crypto_hmac_sha256_key_init(&cbc_key->mac_key, mac_key, mac_key_len) != 0)
+    {
+        log_error("Failure initializing hmac key");
+        secure_zero(cbc_key, sizeof(CRYPTO_CBC_HMAC_KEY));
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_cbc_hmac_seal(const CRYPTO_CBC_HMAC_KEY* cbc_key, CBC_HMAC_MODE mode, const unsigned char* iv,
+    const unsigned char* seq_header, const unsigned char* input, size_t input_len, unsigned char* output, size_t output_size, size_t* output_len)
+{
+    int result;
+    size_t required_len = AES_BLOCK_SIZE + input_len + CBC_HMAC_MAC_SIZE +
+        padding_length(mode == CBC_HMAC_MAC_THEN_ENCRYPT ? input_len + CBC_HMAC_MAC_SIZE : input_len) + 1;
+    if (cbc_key == NULL || iv == NULL || seq_header == NULL || (input == NULL && input_len > 0) || output == NULL || output_len == NULL)
+    {
+        log_error("Failure invalid parameter specified cbc_key: %p, iv: %p, seq_header: %p, input: %p, output: %p, output_len: %p",
+            cbc_key, iv, seq_header, input, output, output_len);
+        result = __LINE__;
+    }
+    else if (input_len > UINT16_MAX - CBC_HMAC_MAX_OVERHEAD || output_size < required_len)
+    {
+        log_error("Failure output size %d is too small for input length %d", (int)output_size, (int)input_len);
+        result = __LINE__;
+    }
+    else
+    {
+        size_t cipher_len;
+
+        // The explicit iv is in front of the cipher text, it is read before being written
+        memmove(output, iv, AES_BLOCK_SIZE);
+        if (mode == CBC_HMAC_MAC_THEN_ENCRYPT)
+        {
+            seal_mac_then_encrypt(cbc_key, output, seq_header, input, input_len, output + AES_BLOCK_SIZE, &cipher_len);
+        }
+        else
+        {
+            seal_encrypt_then_mac(cbc_key, output, seq_header, input, input_len, output + AES_BLOCK_SIZE, &cipher_len);
+        }
+        *output_len = AES_BLOCK_SIZE + cipher_len;
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_cbc_hmac_open(const CRYPTO_CBC_HMAC_KEY* cbc_key, CBC_HMAC_MODE mode, const unsigned char* seq_header,
+    unsigned char* fragment, size_t fragment_len, size_t* plain_len)
+{
+    int result;
+    if (cbc_key == NULL || seq_header == NULL || fragment == NULL || plain_len == NULL)
+    {
+        log_error("Failure invalid parameter specified cbc_key: %p, seq_header: %p, fragment: %p, plain_len: %p", cbc_key, seq_header, fragment, plain_len);
+        result = __LINE__;
+    }
+    else if (mode == CBC_HMAC_MAC_THEN_ENCRYPT)
+    {
+        size_t cipher_len = fragment_len - AES_BLOCK_SIZE;
+        // Needs the iv and at least enough blocks for the mac and a padding byte
+        if (fragment_len < AES_BLOCK_SIZE + CBC_HMAC_MAC_SIZE + AES_BLOCK_SIZE || cipher_len % AES_BLOCK_SIZE)
+        {
+            log_error("Failure invalid cbc fragment length %d", (int)fragment_len);
+            result = __LINE__;
+        }
+        else
+        {
+            result = open_mac_then_encrypt(cbc_key, seq_header, fragment, fragment + AES_BLOCK_SIZE, cipher_len, plain_len);
+        }
+    }
+    else
+    {
+        size_t cipher_len = fragment_len - AES_BLOCK_SIZE - CBC_HMAC_MAC_SIZE;
+        if (fragment_len < AES_BLOCK_SIZE + AES_BLOCK_SIZE + CBC_HMAC_MAC_SIZE || cipher_len % AES_BLOCK_SIZE)
+        {
+            log_error("Failure invalid cbc fragment length %d", (int)fragment_len);
+            result = __LINE__;
+        }
+        else
+        {
+            result = open_encrypt_then_mac(cbc_key, seq_header, fragment, fragment + AES_BLOCK_SIZE, cipher_len, plain_len);
+        }
+    }
+    return result;
+}
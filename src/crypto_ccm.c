@@ -0,0 +1,283 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_ccm.h"
+#include "cablelock/crypto_macro.h"
+
+#define CCM_FLAG_ADATA          0x40
+// Associated data shorter than this has a 2 byte length prefix (RFC 3610)
+#define CCM_AAD_SHORT_LIMIT     0xFF00
+#define CCM_MIN_TAG_SIZE        4
+
+// Both AES inputs of one step, the CTR block first and the CBC-MAC block second
+#define CCM_CTR_LANE            0
+#define CCM_MAC_LANE            AES_BLOCK_SIZE
+
+typedef struct CCM_STATE_TAG
+{
+    unsigned char counter[AES_BLOCK_SIZE];
+    unsigned char chain[AES_BLOCK_SIZE];
+    // Encrypted counter block zero, masks the tag
+    unsigned char tag_mask[AES_BLOCK_SIZE];
+    // Length of the big endian counter and message length fields
+    size_t length_size;
+} CCM_STATE;
+
+static void increment_counter(CCM_STATE* state)
+{
+    for (size_t index = AES_BLOCK_SIZE; index > AES_BLOCK_SIZE - state->length_size; index--)
+    {
+        if (++state->counter[index - 1] != 0)
+        {
+            break;
+        }
+    }
+}
+
+static void mac_block(const AES_KEY_SCHEDULE* schedule, CCM_STATE* state, const unsigned char block[AES_BLOCK_SIZE])
+{
+    xor_value(state->chain, block, AES_BLOCK_SIZE);
+    crypto_aes_block_encrypt(schedule, state->chain, state->chain);
+}
+
+// Length prefixed associated data, zero padded to whole blocks
+static void mac_aad(const AES_KEY_SCHEDULE* schedule, CCM_STATE* state, const unsigned char* aad, size_t aad_len)
+{
+    unsigned char block[AES_BLOCK_SIZE];
+    size_t used;
+
+    if (aad_len < CCM_AAD_SHORT_LIMIT)
+    {
+        block[0] = (unsigned char)(aad_len >> 8);
+        block[1] = (unsigned char)aad_len;
+        used = 2;
+    }
+    else if ((uint64_t)aad_len <= UINT32_MAX)
+    {
+        block[0] = 0xFF;
+        block[1] = 0xFE;
+        store_be32(block + 2, (uint32_t)aad_len);
+        used = 6;
+    }
+    else
+    {
+        block[0] = 0xFF;
+        block[1] = 0xFF;
+        store_be64(block + 2, (uint64_t)aad_len);
+        used = 10;
+    }
+
+    do
+    {
+        size_t chunk = AES_BLOCK_SIZE - used < aad_len ? AES_BLOCK_SIZE - used : aad_len;
+        memcpy(block + used, aad, chunk);
+        memset(block + used + chunk, 0, AES_BLOCK_SIZE - used - chunk);
+        mac_block(schedule, state, block);
+        aad += chunk;
+        aad_len -= chunk;
+        used = 0;
+    } while (aad_len > 0);
+}
+
+static int ccm_start(const AES_KEY_SCHEDULE* schedule, CCM_STATE* state, const unsigned char* nonce, size_t nonce_len,
+    const unsigned char* aad, size_t aad_len, size_t input_len, size_t tag_len)
+{
+    int result;
+    unsigned char blocks[2 * AES_BLOCK_SIZE];
+
+    state->length_size = AES_BLOCK_SIZE - 1 - nonce_len;
+    if (state->length_size < sizeof(uint64_t) && ((uint64_t)input_len >> (8 * state->length_size)) != 0)
+    {
+        log_error("Failure payload of %d bytes does not fit a %d byte nonce", (int)input_len, (int)nonce_len);
+        result = __LINE__;
+    }
+    else
+    {
+        // Counter block zero and B0 are independent, encrypt them together
+        memset(blocks, 0, sizeof(blocks));
+        blocks[CCM_CTR_LANE] = (unsigned char)(state->length_size - 1);
+        memcpy(blocks + CCM_CTR_LANE + 1, nonce, nonce_len);
+
+        blocks[CCM_MAC_LANE] = (unsigned char)((aad_len > 0 ? CCM_FLAG_ADATA : 0) | (((tag_len - 2) / 2) << 3) | (state->length_size - 1));
+        memcpy(blocks + CCM_MAC_LANE + 1, nonce, nonce_len);
+        for (size_t index = 0; index < state->length_size && index < sizeof(uint64_t); index++)
+        {
+            blocks[CCM_MAC_LANE + AES_BLOCK_SIZE - 1 - index] = (unsigned char)((uint64_t)input_len >> (8 * index));
+        }
+
+        memcpy(state->counter, blocks + CCM_CTR_LANE, AES_BLOCK_SIZE);
+        (void)crypto_aes_ecb_encrypt_blocks(schedule, blocks, blocks, 2);
+        memcpy(state->tag_mask, blocks + CCM_CTR_LANE, AES_BLOCK_SIZE);
+        memcpy(state->chain, blocks + CCM_MAC_LANE, AES_BLOCK_SIZE);
+
+        if (aad_len > 0)
+        {
+            mac_aad(schedule, state, aad, aad_len);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static bool is_valid_call(const AES_KEY_SCHEDULE* schedule, const unsigned char* nonce, size_t nonce_len,
+    const unsigned char* aad, size_t aad_len, const unsigned char* input, size_t input_len, const unsigned char* output,
+    const unsigned char* tag, size_t tag_len)
+{
+    bool result;
+    if (schedule == NULL || nonce == NULL || (aad == NULL && aad_len > 0) || (input_len > 0 && (input == NULL || output == NULL)) || tag == NULL)
+    {
+        log_error("Failure invalid parameter specified schedule: %p, nonce: %p, aad: %p, input: %p, output: %p, tag: %p", schedule, nonce, aad, input, output, tag);
+        result = false;
+    }
+    else if (nonce_len < CCM_MIN_NONCE_SIZE || nonce_len > CCM_MAX_NONCE_SIZE)
+    {
+        log_error("Failure invalid ccm nonce length %d", (int)nonce_len);
+        result = false;
+    }
+    else if (tag_len < CCM_MIN_TAG_SIZE || tag_len > CCM_TAG_SIZE || (tag_len % 2) != 0)
+    {
+        log_error("Failure invalid ccm tag length %d", (int)tag_len);
+        result = false;
+    }
+    else
+    {
+        result = true;
+    }
+    return result;
+}
+
+int crypto_ccm_encrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* nonce, size_t nonce_len,
+    const unsigned char* aad, size_t aad_len, const unsigned char* input, size_t input_len, unsigned char* output,
+    unsigned char* tag, size_t tag_len)
+{
+    int result;
+    CCM_STATE state;
+    if (!is_valid_call(schedule, nonce, nonce_len, aad, aad_len, input, input_len, output, tag, tag_len))
+    {
+        result = __LINE__;
+    }
+    else if (ccm_start(schedule, &state, nonce, nonce_len, aad, aad_len, input_len, tag_len) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char blocks[2 * AES_BLOCK_SIZE];
+        size_t remaining = input_len;
+
+        while (remaining > 0)
+        {
+            size_t block_len = remaining < AES_BLOCK_SIZE ? remaining : AES_BLOCK_SIZE;
+
+            // The MAC of this block and its key stream go through AES together
+            increment_counter(&state);
+            memcpy(blocks + CCM_CTR_LANE, state.counter, AES_BLOCK_SIZE);
+            memcpy(blocks + CCM_MAC_LANE, state.chain, AES_BLOCK_SIZE);
+            xor_value(blocks + CCM_MAC_LANE, input, block_len);
+            (void)crypto_aes_ecb_encrypt_blocks(schedule, blocks, blocks, 2);
+            memcpy(state.chain, blocks + CCM_MAC_LANE, AES_BLOCK_SIZE);
+            for (size_t index = 0; index < block_len; index++)
+            {
+                output[index] = input[index] ^ blocks[CCM_CTR_LANE + index];
+            }
+
+            input += block_len;
+            output += block_len;
+            remaining -= block_len;
+        }
+
+        xor_value(state.chain, state.tag_mask, AES_BLOCK_SIZE);
+        memcpy(tag, state.chain, tag_len);
+        secure_zero(blocks, sizeof(blocks));
+        secure_zero(&state, sizeof(state));
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_ccm_decrypt(const AES_KEY_SCHEDULE* schedule, const unsigned char* nonce, size_t nonce_len,
+    const unsigned char* aad, size_t aad_len, const unsigned char* input, size_t input_len, unsigned char* output,
+    const unsigned char* tag, size_t tag_len)
+{
+    int result;
+    CCM_STATE state;
+    if (!is_valid_call(schedule, nonce, nonce_len, aad, aad_len, input, input_len, output, tag, tag_len))
+    {
+        result = __LINE__;
+    }
+    else if (ccm_start(schedule, &state, nonce, nonce_len, aad, aad_len, input_len, tag_len) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char blocks[2 * AES_BLOCK_SIZE];
+        // Zero padded plain text of the previous block, not yet in the MAC
+        unsigned char plain_block[AES_BLOCK_SIZE];
+        bool mac_pending = false;
+        unsigned char* output_start = output;
+        size_t remaining = input_len;
+
+        while (remaining > 0)
+        {
+            size_t block_len = remaining < AES_BLOCK_SIZE ? remaining : AES_BLOCK_SIZE;
+
+            // The plain text is only known after decrypting, so the MAC runs
+            // one block behind the key stream and is paired with it
+            increment_counter(&state);
+            memcpy(blocks + CCM_CTR_LANE, state.counter, AES_BLOCK_SIZE);
+            if (mac_pending)
+            {
+                memcpy(blocks + CCM_MAC_LANE, state.chain, AES_BLOCK_SIZE);
+                xor_value(blocks + CCM_MAC_LANE, plain_block, AES_BLOCK_SIZE);
+            }
+            (void)crypto_aes_ecb_encrypt_blocks(schedule, blocks, blocks, mac_pending ? 2 : 1);
+            if (mac_pending)
+            {
+                memcpy(state.chain, blocks + CCM_MAC_LANE, AES_BLOCK_SIZE);
+            }
+
+            memset(plain_block, 0, AES_BLOCK_SIZE);
+            for (size_t index = 0; index < block_len; index++)
+            {
+                plain_block[index] = input[index] ^ blocks[CCM_CTR_LANE + index];
+            }
+            memcpy(output, plain_block, block_len);
+            mac_pending = true;
+
+            input += block_len;
+            output += block_len;
+            remaining -= block_len;
+        }
+        if (mac_pending)
+        {
+            mac_block(schedule, &state, plain_block);
+        }
+
+        xor_value(state.chain, state.tag_mask, AES_BLOCK_SIZE);
+        if (const_time_compare(state.chain, tag, tag_len) != 0)
+        {
+            // Never hand back unauthenticated plain text
+            secure_zero(output_start, input_len);
+            log_error("Failure authenticating ccm tag");
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        secure_zero(blocks, sizeof(blocks));
+        secure_zero(plain_block, sizeof(plain_block));
+        secure_zero(&state, sizeof(state));
+    }
+    return result;
+}
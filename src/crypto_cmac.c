@@ -0,0 +1,222 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_cmac.h"
+#include "cablelock/crypto_macro.h"
+
+// Reduction of x^128 in the CMAC field, x^7 + x^2 + x + 1
+#define CMAC_REDUCTION      0x87
+#define CMAC_PAD_BYTE       0x80
+
+// One in flight chain of a batch
+typedef struct MAC_LANE_TAG
+{
+    const CRYPTO_MAC_MESSAGE* message;
+    size_t offset;
+    unsigned char chain[AES_BLOCK_SIZE];
+} MAC_LANE;
+
+// Multiply by x in GF(2^128), big endian as in RFC 4493
+static void subkey_double(const unsigned char* input, unsigned char* output)
+{
+    unsigned char carry = input[0] >> 7;
+    for (size_t index = 0; index < AES_BLOCK_SIZE - 1; index++)
+    {
+        output[index] = (unsigned char)((input[index] << 1) | (input[index + 1] >> 7));
+    }
+    output[AES_BLOCK_SIZE - 1] = (unsigned char)((input[AES_BLOCK_SIZE - 1] << 1) ^ ((0 - carry) & CMAC_REDUCTION));
+}
+
+// Build the next block of a lane into block, returns true when it is the last one
+static bool next_lane_block(MAC_LANE* lane, const CRYPTO_CMAC_KEY* cmac_key, unsigned char* block)
+{
+    bool result;
+    const unsigned char* data = lane->message->data + lane->offset;
+    size_t remaining = lane->message->data_len - lane->offset;
+
+    if (remaining > AES_BLOCK_SIZE || (cmac_key == NULL && remaining != AES_BLOCK_SIZE))
+    {
+        memcpy(block, data, AES_BLOCK_SIZE);
+        result = false;
+    }
+    else if (cmac_key == NULL)
+    {
+        memcpy(block, data, AES_BLOCK_SIZE);
+        result = true;
+    }
+    else if (remaining == AES_BLOCK_SIZE)
+    {
+        memcpy(block, data, AES_BLOCK_SIZE);
+        xor_value(block, cmac_key->subkey1, AES_BLOCK_SIZE);
+        result = true;
+    }
+    else
+    {
+        // Short or empty final block is padded with 10* and uses the second subkey
+        memset(block, 0, AES_BLOCK_SIZE);
+        if (remaining > 0)
+        {
+            memcpy(block, data, remaining);
+        }
+        block[remaining] = CMAC_PAD_BYTE;
+        xor_value(block, cmac_key->subkey2, AES_BLOCK_SIZE);
+        result = true;
+    }
+    xor_value(block, lane->chain, AES_BLOCK_SIZE);
+    lane->offset += AES_BLOCK_SIZE;
+    return result;
+}
+
+static void mac_batch(const AES_KEY_SCHEDULE* schedule, const CRYPTO_CMAC_KEY* cmac_key, const CRYPTO_MAC_MESSAGE* messages, size_t message_count)
+{
+    MAC_LANE lanes[AES_BATCH_WIDTH];
+    bool last[AES_BATCH_WIDTH];
+    unsigned char blocks[AES_BATCH_WIDTH * AES_BLOCK_SIZE];
+    size_t active = 0;
+    size_t next_message = 0;
+
+    while (active > 0 || next_message < message_count)
+    {
+        // Keep every lane busy while messages remain
+        while (active < AES_BATCH_WIDTH && next_message < message_count)
+        {
+            lanes[active].message = &messages[next_message++];
+            lanes[active].offset = 0;
+            memset(lanes[active].chain, 0, AES_BLOCK_SIZE);
+            active++;
+        }
+
+        for (size_t index = 0; index < active; index++)
+        {
+            last[index] = next_lane_block(&lanes[index], cmac_key, blocks + (index * AES_BLOCK_SIZE));
+        }
+        (void)crypto_aes_ecb_encrypt_blocks(schedule, blocks, blocks, active);
+
+        // Walk backwards so finished lanes can be replaced by the last active one
+        for (size_t index = active; index > 0; index--)
+        {
+            MAC_LANE* lane = &lanes[index - 1];
+            memcpy(lane->chain, blocks + ((index - 1) * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+            if (last[index - 1])
+            {
+                memcpy(lane->message->tag, lane->chain, CMAC_TAG_SIZE);
+                *lane = lanes[--active];
+            }
+        }
+    }
+    secure_zero(lanes, sizeof(lanes));
+    secure_zero(blocks, sizeof(blocks));
+}
+
+static int validate_messages(bool cmac, const CRYPTO_MAC_MESSAGE* messages, size_t message_count)
+{
+    int result = 0;
+    for (size_t index = 0; index < message_count; index++)
+    {
+        if (messages[index].tag == NULL || (messages[index].data_len > 0 && messages[index].data == NULL))
+        {
+            log_error("Failure invalid message %d data: %p, tag: %p", (int)index, messages[index].data, messages[index].tag);
+            result = __LINE__;
+            break;
+        }
+        else if (!cmac && (messages[index].data_len == 0 || messages[index].data_len % AES_BLOCK_SIZE != 0))
+        {
+            log_error("Failure cbc-mac message %d length %d is not a multiple of the block size", (int)index, (int)messages[index].data_len);
+            result = __LINE__;
+            break;
+        }
+    }
+    return result;
+}
+
+int crypto_cmac_key_init(CRYPTO_CMAC_KEY* cmac_key, const unsigned char* key, size_t key_len)
+{
+    int result;
+    if (cmac_key == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified cmac_key: %p, key: %p", cmac_key, key);
+        result = __LINE__;
+    }
+    else if (crypto_aes_key_init(&cmac_key->schedule, key, key_len) != 0)
+    {
+        log_error("Failure initializing cmac key schedule");
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char encrypted_zero[AES_BLOCK_SIZE] = { 0 };
+        crypto_aes_block_encrypt(&cmac_key->schedule, encrypted_zero, encrypted_zero);
+        subkey_double(encrypted_zero, cmac_key->subkey1);
+        subkey_double(cmac_key->subkey1, cmac_key->subkey2);
+        secure_zero(encrypted_zero, sizeof(encrypted_zero));
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_cmac_compute(const CRYPTO_CMAC_KEY* cmac_key, const unsigned char* data, size_t data_len, unsigned char* tag)
+{
+    CRYPTO_MAC_MESSAGE message;
+    message.data = data;
+    message.data_len = data_len;
+    message.tag = tag;
+    return crypto_cmac_compute_batch(cmac_key, &message, 1);
+}
+
+int crypto_cmac_compute_batch(const CRYPTO_CMAC_KEY* cmac_key, const CRYPTO_MAC_MESSAGE* messages, size_t message_count)
+{
+    int result;
+    if (cmac_key == NULL || (message_count > 0 && messages == NULL))
+    {
+        log_error("Failure invalid parameter specified cmac_key: %p, messages: %p", cmac_key, messages);
+        result = __LINE__;
+    }
+    else if (validate_messages(true, messages, message_count) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        mac_batch(&cmac_key->schedule, cmac_key, messages, message_count);
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_cbc_mac_compute(const AES_KEY_SCHEDULE* schedule, const unsigned char* data, size_t data_len, unsigned char* tag)
+{
+    CRYPTO_MAC_MESSAGE message;
+    message.data = data;
+    message.data_len = data_len;
+    message.tag = tag;
+    return crypto_cbc_mac_compute_batch(schedule, &message, 1);
+}
+
+int crypto_cbc_mac_compute_batch(const AES_KEY_SCHEDULE* schedule, const CRYPTO_MAC_MESSAGE* messages, size_t message_count)
+{
+    int result;
+    if (schedule == NULL || (message_count > 0 && messages == NULL))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, messages: %p", schedule, messages);
+        result = __LINE__;
+    }
+    else if (validate_messages(false, messages, message_count) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        mac_batch(schedule, NULL, messages, message_count);
+        result = 0;
+    }
+    return result;
+}
@@ -0,0 +1,302 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_context_pool.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+// The stack head packs a generation count above the top index so a context
+// popped and pushed back between a load and the CAS cannot fool it (ABA)
+#define STACK_INDEX_MASK        0xFFFFFFFFULL
+#define STACK_TAG_SHIFT         32
+// Index 0 marks the end of the stack, so entries hold index + 1
+#define STACK_EMPTY             0
+
+typedef struct CRYPTO_CONTEXT_POOL_INFO_TAG
+{
+    unsigned char* slab;
+    size_t slot_size;
+    size_t context_count;
+    // Next entry below each context on the stack
+    uint32_t* next;
+    unsigned char pad_head[CRYPTO_CACHE_LINE_SIZE];
+    uint64_t head;
+    size_t free_count;
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+} CRYPTO_CONTEXT_POOL_INFO;
+
+typedef struct CRYPTO_CONTEXT_CACHE_INFO_TAG
+{
+    CRYPTO_CONTEXT_POOL_INFO* pool;
+    size_t count;
+    size_t capacity;
+    uint32_t* entries;
+    // Keeps the hot fields of neighbouring caches off each other's line
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+} CRYPTO_CONTEXT_CACHE_INFO;
+
+static CRYPTO_CIPHER_CONTEXT* context_at(CRYPTO_CONTEXT_POOL_INFO* pool, uint32_t entry)
+{
+    return (CRYPTO_CIPHER_CONTEXT*)(pool->slab + ((size_t)(entry - 1) * pool->slot_size));
+}
+
+static void stack_push(CRYPTO_CONTEXT_POOL_INFO* pool, uint32_t entry)
+{
+    uint64_t head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+    uint64_t new_head;
+    do
+    {
+        __atomic_store_n(&pool->next[entry - 1], (uint32_t)(head & STACK_INDEX_MASK), __ATOMIC_RELAXED);
+        new_head = (((head >> STACK_TAG_SHIFT) + 1) << STACK_TAG_SHIFT) | entry;
+    } while (!__atomic_compare_exchange_n(&pool->head, &head, new_head, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    __atomic_fetch_add(&pool->free_count, 1, __ATOMIC_RELAXED);
+}
+
+static uint32_t stack_pop(CRYPTO_CONTEXT_POOL_INFO* pool)
+{
+    uint32_t result;
+    uint64_t head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        uint64_t new_head;
+        result = (uint32_t)(head & STACK_INDEX_MASK);
+        if (result == STACK_EMPTY)
+        {
+            break;
+        }
+        // May read a stale link, the tag then makes the CAS fail and retry
+        new_head = (((head >> STACK_TAG_SHIFT) + 1) << STACK_TAG_SHIFT) | __atomic_load_n(&pool->next[result - 1], __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&pool->head, &head, new_head, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        {
+            __atomic_fetch_sub(&pool->free_count, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    return result;
+}
+
+// Wipe only what the key setup wrote instead of the whole context
+static void reset_context(CRYPTO_CIPHER_CONTEXT* context)
+{
+    if (context->cipher == CRYPTO_CONTEXT_AES)
+    {
+        secure_zero(context->schedule.aes.key_sched, (context->schedule.aes.num_rounds + 1) * AES_BLOCK_SIZE);
+        secure_zero(context->schedule.aes.dec_key_sched, (context->schedule.aes.num_rounds + 1) * AES_BLOCK_SIZE);
+        context->schedule.aes.num_rounds = 0;
+    }
+    else
+    {
+        size_t key_count = context->schedule.des.key_count;
+        secure_zero(context->schedule.des.encrypt_keys, key_count * sizeof(context->schedule.des.encrypt_keys[0]));
+        secure_zero(context->schedule.des.decrypt_keys, key_count * sizeof(context->schedule.des.decrypt_keys[0]));
+        context->schedule.des.key_count = 0;
+    }
+}
+
+static uint32_t entry_of(CRYPTO_CONTEXT_POOL_INFO* pool, const CRYPTO_CIPHER_CONTEXT* context)
+{
+    uint32_t result;
+    uintptr_t offset = (uintptr_t)context - (uintptr_t)pool->slab;
+    if ((uintptr_t)context < (uintptr_t)pool->slab || offset >= pool->slot_size * pool->context_count || (offset % pool->slot_size) != 0)
+    {
+        result = STACK_EMPTY;
+    }
+    else
+    {
+        result = (uint32_t)(offset / pool->slot_size) + 1;
+    }
+    return result;
+}
+
+CRYPTO_CONTEXT_POOL_HANDLE crypto_context_pool_create(size_t context_count)
+{
+    CRYPTO_CONTEXT_POOL_INFO* result;
+    size_t slot_size = (sizeof(CRYPTO_CIPHER_CONTEXT) + CRYPTO_CACHE_LINE_SIZE - 1) & ~((size_t)CRYPTO_CACHE_LINE_SIZE - 1);
+    if (context_count == 0 || (uint64_t)context_count >= STACK_INDEX_MASK ||
+        context_count > (SIZE_MAX - sizeof(CRYPTO_CONTEXT_POOL_INFO) - CRYPTO_CACHE_LINE_SIZE) / (slot_size + sizeof(uint32_t)))
+    {
+        log_error("Failure invalid parameter specified context_count: %d", (int)context_count);
+        result = NULL;
+    }
+    // Links and contexts share one allocation with the pool
+    else if ((result = (CRYPTO_CONTEXT_POOL_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_CONTEXT_POOL_INFO) + (context_count * sizeof(uint32_t)) + CRYPTO_CACHE_LINE_SIZE - 1 + (slot_size * context_count))) == NULL)
+    {
+        log_error("Failure allocating context pool");
+    }
+    else
+    {
+        uintptr_t slab_start;
+        memset(result, 0, sizeof(CRYPTO_CONTEXT_POOL_INFO));
+        result->next = (uint32_t*)(result + 1);
+        slab_start = (uintptr_t)(result->next + context_count);
+        slab_start = (slab_start + CRYPTO_CACHE_LINE_SIZE - 1) & ~((uintptr_t)CRYPTO_CACHE_LINE_SIZE - 1);
+        result->slab = (unsigned char*)slab_start;
+        result->slot_size = slot_size;
+        result->context_count = context_count;
+        memset(result->slab, 0, slot_size * context_count);
+
+        // Chained in order so the first pop hands out the first context
+        for (size_t index = 1; index <= context_count; index++)
+        {
+            result->next[index - 1] = (uint32_t)(index < context_count ? index + 1 : STACK_EMPTY);
+        }
+        result->head = 1;
+        result->free_count = context_count;
+    }
+    return result;
+}
+
+void crypto_context_pool_destroy(CRYPTO_CONTEXT_POOL_HANDLE pool)
+{
+    if (pool != NULL)
+    {
+        secure_zero(pool->slab, pool->slot_size * pool->context_count);
+        crypto_alloc_free(pool);
+    }
+}
+
+size_t crypto_context_pool_get_free(CRYPTO_CONTEXT_POOL_HANDLE pool)
+{
+    size_t result;
+    if (pool == NULL)
+    {
+        log_error("Failure invalid parameter specified pool: NULL");
+        result = 0;
+    }
+    else
+    {
+        // Contexts parked in thread caches are not counted
+        result = __atomic_load_n(&pool->free_count, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+CRYPTO_CONTEXT_CACHE_HANDLE crypto_context_cache_create(CRYPTO_CONTEXT_POOL_HANDLE pool, size_t cache_size)
+{
+    CRYPTO_CONTEXT_CACHE_INFO* result;
+    if (pool == NULL || cache_size == 0 || cache_size > pool->context_count)
+    {
+        log_error("Failure invalid parameter specified pool: %p, cache_size: %d", pool, (int)cache_size);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_CONTEXT_CACHE_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_CONTEXT_CACHE_INFO) + (cache_size * sizeof(uint32_t)))) == NULL)
+    {
+        log_error("Failure allocating context cache");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_CONTEXT_CACHE_INFO));
+        result->pool = pool;
+        result->capacity = cache_size;
+        result->entries = (uint32_t*)(result + 1);
+    }
+    return result;
+}
+
+void crypto_context_cache_destroy(CRYPTO_CONTEXT_CACHE_HANDLE cache)
+{
+    if (cache != NULL)
+    {
+        while (cache->count > 0)
+        {
+            stack_push(cache->pool, cache->entries[--cache->count]);
+        }
+        crypto_alloc_free(cache);
+    }
+}
+
+CRYPTO_CIPHER_CONTEXT* crypto_context_acquire(CRYPTO_CONTEXT_CACHE_HANDLE cache, CRYPTO_CONTEXT_CIPHER cipher, const unsigned char* key, size_t key_len)
+{
+    CRYPTO_CIPHER_CONTEXT* result;
+    if (cache == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified cache: %p, key: %p", cache, key);
+        result = NULL;
+    }
+    else if (cipher != CRYPTO_CONTEXT_AES && cipher != CRYPTO_CONTEXT_DES)
+    {
+        log_error("Failure unsupported cipher %d", (int)cipher);
+        result = NULL;
+    }
+    else
+    {
+        uint32_t entry;
+        if (cache->count == 0)
+        {
+            // Refill half the cache so the next few acquires stay local
+            size_t wanted = (cache->capacity + 1) / 2;
+            while (cache->count < wanted && (entry = stack_pop(cache->pool)) != STACK_EMPTY)
+            {
+                cache->entries[cache->count++] = entry;
+            }
+        }
+
+        if (cache->count == 0)
+        {
+            log_error("Failure context pool exhausted");
+            result = NULL;
+        }
+        else
+        {
+            int key_result;
+            entry = cache->entries[--cache->count];
+            result = context_at(cache->pool, entry);
+            result->cipher = cipher;
+            if (cipher == CRYPTO_CONTEXT_AES)
+            {
+                key_result = crypto_aes_key_init(&result->schedule.aes, key, key_len);
+            }
+            else
+            {
+                key_result = crypto_des_key_init(&result->schedule.des, key, key_len);
+            }
+
+            if (key_result != 0)
+            {
+                log_error("Failure initializing context key");
+                reset_context(result);
+                cache->entries[cache->count++] = entry;
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+void crypto_context_release(CRYPTO_CONTEXT_CACHE_HANDLE cache, CRYPTO_CIPHER_CONTEXT* context)
+{
+    uint32_t entry;
+    if (cache == NULL || context == NULL)
+    {
+        log_error("Failure invalid parameter specified cache: %p, context: %p", cache, context);
+    }
+    else if ((entry = entry_of(cache->pool, context)) == STACK_EMPTY)
+    {
+        log_error("Failure context %p does not belong to this pool", context);
+    }
+    else
+    {
+        reset_context(context);
+        if (cache->count == cache->capacity)
+        {
+            // Spill the older half so other threads can pick it up
+            size_t spill = (cache->capacity + 1) / 2;
+            for (size_t index = 0; index < spill; index++)
+            {
+                stack_push(cache->pool, cache->entries[index]);
+            }
+            memmove(cache->entries, cache->entries + spill, (cache->count - spill) * sizeof(uint32_t));
+            cache->count -= spill;
+        }
+        cache->entries[cache->count++] = entry;
+    }
+}
@@ -11,14 +11,13 @@
 #include "lib-util-c/app_logging.h"
 
 #include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_des_core.h"
+#include "cablelock/crypto_alloc.h"
 #include "cablelock/crypto_macro.h"
+#include "cablelock/crypto_trace.h"
 
-#define DES_KEY_SIZE            8
-#define DES_BLOCK_SIZE          8   // 64 bits
 #define EXPANSION_BLOCK_SIZE    6
 #define PC1_KEY_SIZE            7
-#define SUBKEY_SIZE             6
-#define ROUND_KEY_SCHEDULE_NUM  16
 
 typedef enum CRYPTO_OPERATION_TAG
 {
@@ -157,6 +156,7 @@ static const int p_table[] = {
 // specification.
 static void permute_routine(unsigned char target[], const unsigned char src[], const int permute_table[], size_t length)
 {
+    memset(target, 0, length);
     for (size_t index = 0; index < length * 8; index++)
     {
         if (GET_BIT(src, (permute_table[index] - 1)))
@@ -210,31 +210,16 @@ static void rotate_right(unsigned char* target)
     target[0] = (target[0] >> 1) | carry_left;
 }
 
-static void des_block_operate(uint32_t operation, const unsigned char plain_text[DES_BLOCK_SIZE], unsigned char cipher_text[DES_BLOCK_SIZE], const unsigned char key[DES_KEY_SIZE])
+// The subkeys depend only on the key and direction so they are computed once
+// per key instead of for every block
+static void compute_sub_keys(uint32_t operation, const unsigned char key[DES_KEY_SIZE], unsigned char sub_keys[DES_ROUNDS][DES_SUBKEY_SIZE])
 {
-    unsigned char ip_block[DES_BLOCK_SIZE];
-    unsigned char sub_block[DES_BLOCK_SIZE/2];
-    unsigned char pbox_target[DES_BLOCK_SIZE/2];
-    unsigned char recomb_box[DES_BLOCK_SIZE/2];
-
     unsigned char pc1_key[PC1_KEY_SIZE];
-    unsigned char expansion_block[EXPANSION_BLOCK_SIZE];
-    unsigned char sub_key[SUBKEY_SIZE];
-
-    // Initial Permutation
-    permute_routine(ip_block, plain_text, initial_perm_table, DES_BLOCK_SIZE);
 
-    // Key Schedule computation
     permute_routine(pc1_key, key, pc1_table, PC1_KEY_SIZE);
 
-    for (size_t index = 0; index < 16; index++)
+    for (size_t index = 0; index < DES_ROUNDS; index++)
     {
-        // "Feistel function" on the first half of the block in 'ip_block'
-        // "Expansion": This permutation only looks at the first 4 bytes (32 bits)
-        // 16 of these are repeated in "expansion_table"
-        permute_routine(expansion_block, ip_block+4, expansion_table, 6);
-
-        // Key mixing
         // Rotate both halves of the initial key
         if (operation & CRYPTO_ENCRYPT)
         {
@@ -246,7 +231,7 @@ static void des_block_operate(uint32_t operation, const unsigned char plain_text
             }
         }
 
-        permute_routine(sub_key, pc1_key, pc2_table, SUBKEY_SIZE);
+        permute_routine(sub_keys[index], pc1_key, pc2_table, DES_SUBKEY_SIZE);
 
         if (!(operation & CRYPTO_ENCRYPT))
         {
@@ -257,47 +242,182 @@ static void des_block_operate(uint32_t operation, const unsigned char plain_text
                 rotate_right(pc1_key);
             }
         }
-
-        xor_value(expansion_block, sub_key, 6);
-
-        // Update from updated expansion block to cipher block
-        memset(sub_block, 0, DES_BLOCK_SIZE/2);
-        sub_block[0] = sbox[0][(expansion_block[0] & 0xFC) >> 2] << 4;
-        sub_block[0] |= sbox[1][(expansion_block[0] & 0x03) << 4 | (expansion_block[1] & 0x0F) >> 4];
-        sub_block[1] = sbox[2][(expansion_block[1] & 0x0F) << 2 | (expansion_block[2] & 0xC0) >> 6] << 4;
-        sub_block[1] |= sbox[3][(expansion_block[2] & 0x3F)];
-        sub_block[2] = sbox[4][(expansion_block[3] & 0xFC) >> 2] << 4;
-        sub_block[2] |= sbox[5][(expansion_block[3] & 0x03) << 4 | (expansion_block[4] & 0x0F >> 4)];
-        sub_block[3] = sbox[6][(expansion_block[4] & 0x0F) << 2 | (expansion_block[5] & 0xC0) >> 6] << 4;
-        sub_block[3] |= sbox[7][(expansion_block[5] & 0x3F)];
-
-        permute_routine(pbox_target, sub_block, p_table, DES_BLOCK_SIZE / 2);
-
-        // Recombination: XOR the pbox with left half and then switch sides
-        memcpy(recomb_box, ip_block, DES_BLOCK_SIZE/2);
-        memcpy(ip_block, (ip_block+4), DES_BLOCK_SIZE/2);
-        xor_value(recomb_box, pbox_target, DES_BLOCK_SIZE/2);
-        memcpy(ip_block+4, recomb_box, DES_BLOCK_SIZE/2);
     }
+    secure_zero(pc1_key, sizeof(pc1_key));
+}
+
+// One Feistel round on a block held after the initial permutation
+static void des_round(unsigned char ip_block[DES_BLOCK_SIZE], const unsigned char sub_key[DES_SUBKEY_SIZE])
+{
+    unsigned char sub_block[DES_BLOCK_SIZE/2];
+    unsigned char pbox_target[DES_BLOCK_SIZE/2];
+    unsigned char recomb_box[DES_BLOCK_SIZE/2];
+    unsigned char expansion_block[EXPANSION_BLOCK_SIZE];
+
+    // "Feistel function" on the first half of the block in 'ip_block'
+    // "Expansion": This permutation only looks at the first 4 bytes (32 bits)
+    // 16 of these are repeated in "expansion_table"
+    permute_routine(expansion_block, ip_block+4, expansion_table, 6);
+
+    // Key mixing
+    xor_value(expansion_block, sub_key, DES_SUBKEY_SIZE);
+
+    // Update from updated expansion block to cipher block
+    memset(sub_block, 0, DES_BLOCK_SIZE/2);
+    sub_block[0] = sbox[0][(expansion_block[0] & 0xFC) >> 2] << 4;
+    sub_block[0] |= sbox[1][(expansion_block[0] & 0x03) << 4 | (expansion_block[1] & 0x0F) >> 4];
+    sub_block[1] = sbox[2][(expansion_block[1] & 0x0F) << 2 | (expansion_block[2] & 0xC0) >> 6] << 4;
+    sub_block[1] |= sbox[3][(expansion_block[2] & 0x3F)];
+    sub_block[2] = sbox[4][(expansion_block[3] & 0xFC) >> 2] << 4;
+    sub_block[2] |= sbox[5][(expansion_block[3] & 0x03) << 4 | (expansion_block[4] & 0x0F >> 4)];
+    sub_block[3] = sbox[6][(expansion_block[4] & 0x0F) << 2 | (expansion_block[5] & 0xC0) >> 6] << 4;
+    sub_block[3] |= sbox[7][(expansion_block[5] & 0x3F)];
+
+    permute_routine(pbox_target, sub_block, p_table, DES_BLOCK_SIZE / 2);
+
+    // Recombination: XOR the pbox with left half and then switch sides
+    memcpy(recomb_box, ip_block, DES_BLOCK_SIZE/2);
+    memcpy(ip_block, (ip_block+4), DES_BLOCK_SIZE/2);
+    xor_value(recomb_box, pbox_target, DES_BLOCK_SIZE/2);
+    memcpy(ip_block+4, recomb_box, DES_BLOCK_SIZE/2);
+}
 
-    // One last swap
+// Every key stage ends with one last swap of the halves
+static void des_swap_halves(unsigned char ip_block[DES_BLOCK_SIZE])
+{
+    unsigned char recomb_box[DES_BLOCK_SIZE/2];
     memcpy(recomb_box, ip_block, DES_BLOCK_SIZE/2);
     memcpy(ip_block, (ip_block+4), DES_BLOCK_SIZE/2);
     memcpy(ip_block+4, recomb_box, DES_BLOCK_SIZE/2);
+}
+
+// Runs each round across every lane before the next one, as the AES batch
+// does, so the lanes' independent rounds overlap.  Between triple DES stages
+// the final and initial permutations cancel out and are skipped.
+static void ecb_batch(bool encrypt, const DES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t count)
+{
+    unsigned char blocks[DES_BATCH_WIDTH][DES_BLOCK_SIZE];
 
+    // Initial Permutation, every input block is read before output is written
+    for (size_t lane = 0; lane < count; lane++)
+    {
+        permute_routine(blocks[lane], input + (lane * DES_BLOCK_SIZE), initial_perm_table, DES_BLOCK_SIZE);
+    }
+    for (size_t index = 0; index < schedule->key_count; index++)
+    {
+        // Triple DES keys are undone in reverse order
+        const unsigned char (*sub_keys)[DES_SUBKEY_SIZE] = encrypt ? schedule->encrypt_keys[index] : schedule->decrypt_keys[schedule->key_count - index - 1];
+        for (size_t round = 0; round < DES_ROUNDS; round++)
+        {
+            for (size_t lane = 0; lane < count; lane++)
+            {
+                des_round(blocks[lane], sub_keys[round]);
+            }
+        }
+        for (size_t lane = 0; lane < count; lane++)
+        {
+            des_swap_halves(blocks[lane]);
+        }
+    }
     // Final Permutation (undoing the initial)
-    permute_routine(cipher_text, ip_block, final_perm_table, DES_BLOCK_SIZE);
+    for (size_t lane = 0; lane < count; lane++)
+    {
+        permute_routine(output + (lane * DES_BLOCK_SIZE), blocks[lane], final_perm_table, DES_BLOCK_SIZE);
+    }
+}
+
+int crypto_des_key_init(DES_KEY_SCHEDULE* schedule, const unsigned char* key, size_t key_len)
+{
+    int result;
+    int outcome;
+    if (schedule == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified schedule: %p, key: %p", schedule, key);
+        result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_ARGUMENT;
+    }
+    else if (key_len != DES_KEY_SIZE && key_len != DES3_KEY_SIZE)
+    {
+        log_error("Failure invalid des key length %d", (int)key_len);
+        result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_LENGTH;
+    }
+    else
+    {
+        schedule->key_count = key_len / DES_KEY_SIZE;
+        for (size_t index = 0; index < schedule->key_count; index++)
+        {
+            compute_sub_keys(CRYPTO_ENCRYPT, key + (index * DES_KEY_SIZE), schedule->encrypt_keys[index]);
+            compute_sub_keys(0, key + (index * DES_KEY_SIZE), schedule->decrypt_keys[index]);
+        }
+        result = 0;
+        outcome = CRYPTO_TRACE_OK;
+    }
+    CRYPTO_TRACE_KEY_SETUP(CRYPTO_TRACE_DES, key_len, outcome);
+    return result;
+}
+
+void crypto_des_block_encrypt(const DES_KEY_SCHEDULE* schedule, const unsigned char* input_block, unsigned char* output_block)
+{
+    ecb_batch(true, schedule, input_block, output_block, 1);
+}
+
+void crypto_des_block_decrypt(const DES_KEY_SCHEDULE* schedule, const unsigned char* input_block, unsigned char* output_block)
+{
+    ecb_batch(false, schedule, input_block, output_block, 1);
+}
+
+static int ecb_operation(bool encrypt, const DES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    int result;
+    if (schedule == NULL || (block_count > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified schedule: %p, input: %p, output: %p", schedule, input, output);
+        result = __LINE__;
+    }
+    else
+    {
+        while (block_count > 0)
+        {
+            size_t count = block_count < DES_BATCH_WIDTH ? block_count : DES_BATCH_WIDTH;
+            ecb_batch(encrypt, schedule, input, output, count);
+            input += count * DES_BLOCK_SIZE;
+            output += count * DES_BLOCK_SIZE;
+            block_count -= count;
+        }
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_des_ecb_encrypt_blocks(const DES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    return ecb_operation(true, schedule, input, output, block_count);
 }
 
+int crypto_des_ecb_decrypt_blocks(const DES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output, size_t block_count)
+{
+    return ecb_operation(false, schedule, input, output, block_count);
+}
+
+// outcome receives the CRYPTO_TRACE_ value for the caller's exit probe
 static int des_operation(uint32_t operation, const unsigned char* input, size_t input_len,
-    unsigned char* output, size_t output_len, const unsigned char* key, unsigned char* init_vector)
+    unsigned char* output, size_t output_len, const unsigned char* key, unsigned char* init_vector, int* outcome)
 {
     int result;
     unsigned char input_block[DES_BLOCK_SIZE];
+    DES_KEY_SCHEDULE schedule;
     if (input_len % DES_BLOCK_SIZE || output_len < input_len)
     {
         log_error("The input len must be divisible by 8 and the result len must be > or = input len");
         result = __LINE__;
+        *outcome = CRYPTO_TRACE_INVALID_LENGTH;
+    }
+    else if (crypto_des_key_init(&schedule, key, (operation & CRYPTO_TRIPLE_DES) ? DES3_KEY_SIZE : DES_KEY_SIZE) != 0)
+    {
+        log_error("Failure computing des key schedule");
+        result = __LINE__;
+        *outcome = CRYPTO_TRACE_KEY_FAILURE;
     }
     else
     {
@@ -311,15 +431,7 @@ static int des_operation(uint32_t operation, const unsigned char* input, size_t
                     // Implement Cipher Block Chaining (CBC)
                     xor_value(input_block, init_vector, DES_BLOCK_SIZE);
                 }
-                des_block_operate(operation, input_block, output, key);
-                if (operation & CRYPTO_TRIPLE_DES)
-                {
-                    memcpy(input_block, output, DES_BLOCK_SIZE);
-                    des_block_operate(operation, input_block, output, key+DES_KEY_SIZE);
-
-                    memcpy(input_block, output, DES_BLOCK_SIZE);
-                    des_block_operate(operation, input_block, output, key+(DES_KEY_SIZE*2));
-                }
+                crypto_des_block_encrypt(&schedule, input_block, output);
                 if (init_vector != NULL)
                 {
                     // For CBC
@@ -328,14 +440,7 @@ static int des_operation(uint32_t operation, const unsigned char* input, size_t
             }
             else
             {
-                if (operation & CRYPTO_TRIPLE_DES)
-                {
-                    des_block_operate(operation, input_block, output, key+(DES_KEY_SIZE*2));
-                    memcpy(input_block, output, DES_BLOCK_SIZE);
-                    des_block_operate(operation, input_block, output, key+DES_KEY_SIZE);
-                    memcpy(input_block, output, DES_BLOCK_SIZE);
-                }
-                des_block_operate(operation, input_block, output, key);
+                crypto_des_block_decrypt(&schedule, input_block, output);
                 if (init_vector != NULL)
                 {
                     // Implement Cipher Block Chaining
@@ -347,7 +452,9 @@ static int des_operation(uint32_t operation, const unsigned char* input, size_t
             input_len -= DES_BLOCK_SIZE;
             output += DES_BLOCK_SIZE;
         }
+        secure_zero(&schedule, sizeof(schedule));
         result = 0;
+        *outcome = CRYPTO_TRACE_OK;
     }
     return result;
 }
@@ -356,13 +463,16 @@ int crypto_des_encrypt(const unsigned char* input, size_t input_len, unsigned ch
     const unsigned char* key, const unsigned char* init_vector, bool add_padding)
 {
     int result;
+    int outcome;
     (void)result_len;
+    CRYPTO_TRACE_CIPHER_ENTRY(CRYPTO_TRACE_DES, CRYPTO_TRACE_MODE(true, init_vector), input_len);
 
     int j = input_len % DES_BLOCK_SIZE;
     if (input == NULL || input_len == 0 || output == NULL || key == NULL)
     {
         log_error("Failure invalid parameter specified input: %p, cipher_len: %d, output: %p, key: %p", input, (int)input_len, output, key);
         result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_ARGUMENT;
     }
     else
     {
@@ -372,10 +482,11 @@ int crypto_des_encrypt(const unsigned char* input, size_t input_len, unsigned ch
         {
             // Adding PKCS #5 padding to the input
             padded_len = DES_BLOCK_SIZE - (input_len % DES_BLOCK_SIZE);
-            if ((padded_input = (unsigned char*)malloc(padded_len + input_len)) == NULL)
+            if ((padded_input = (unsigned char*)crypto_alloc_malloc(padded_len + input_len)) == NULL)
             {
                 log_error("Failure allocating padded text length");
                 result = __LINE__;
+                outcome = CRYPTO_TRACE_ALLOC_FAILURE;
             }
             else
             {
@@ -399,13 +510,14 @@ int crypto_des_encrypt(const unsigned char* input, size_t input_len, unsigned ch
                 iv_value = iv_item;
             }
 
-            result = des_operation(CRYPTO_ENCRYPT, padded_input, padded_len + input_len, output, result_len, key, iv_value);
+            result = des_operation(CRYPTO_ENCRYPT, padded_input, padded_len + input_len, output, result_len, key, iv_value, &outcome);
             if (add_padding)
             {
-                free(padded_input);
+                crypto_alloc_free(padded_input);
             }
         }
     }
+    CRYPTO_TRACE_CIPHER_EXIT(CRYPTO_TRACE_DES, CRYPTO_TRACE_MODE(true, init_vector), input_len, outcome);
     return result;
 }
 
@@ -413,11 +525,14 @@ int crypto_des_decrypt(const unsigned char* cipher_text, size_t cipher_len, unsi
     size_t result_len, const unsigned char* key, const unsigned char* init_vector, bool is_padded)
 {
     int result;
+    int outcome;
     (void)result_len;
+    CRYPTO_TRACE_CIPHER_ENTRY(CRYPTO_TRACE_DES, CRYPTO_TRACE_MODE(false, init_vector), cipher_len);
     if (cipher_text == NULL || cipher_len == 0 || output == NULL || key == NULL)
     {
         log_error("Failure invalid parameter specified cipher_text: %p, cipher_len: %d, output: %p, key: %p", cipher_text, (int)cipher_len, output, key);
         result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_ARGUMENT;
     }
     else
     {
@@ -429,13 +544,14 @@ int crypto_des_decrypt(const unsigned char* cipher_text, size_t cipher_len, unsi
             iv_value = iv_item;
         }
 
-        result = des_operation(0, cipher_text, cipher_len, output, result_len, key, iv_value);
+        result = des_operation(0, cipher_text, cipher_len, output, result_len, key, iv_value, &outcome);
         if (is_padded)
         {
             // Remove PKCS #5 padding
             output[cipher_len-output[cipher_len-1]] = 0x0;
         }
     }
+    CRYPTO_TRACE_CIPHER_EXIT(CRYPTO_TRACE_DES, CRYPTO_TRACE_MODE(false, init_vector), cipher_len, outcome);
     return result;
 }
 
@@ -443,13 +559,16 @@ int crypto_3des_encrypt(const unsigned char* input, size_t input_len, unsigned c
     const unsigned char* key, const unsigned char* init_vector, bool add_padding)
 {
     int result;
+    int outcome;
     (void)result_len;
+    CRYPTO_TRACE_CIPHER_ENTRY(CRYPTO_TRACE_3DES, CRYPTO_TRACE_MODE(true, init_vector), input_len);
 
     int j = input_len % DES_BLOCK_SIZE;
     if (input == NULL || input_len == 0 || output == NULL || key == NULL)
     {
         log_error("Failure invalid parameter specified input: %p, cipher_len: %d, output: %p, key: %p", input, (int)input_len, output, key);
         result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_ARGUMENT;
     }
     else
     {
@@ -459,10 +578,11 @@ int crypto_3des_encrypt(const unsigned char* input, size_t input_len, unsigned c
         {
             // Adding PKCS #5 padding to the input
             padded_len = DES_BLOCK_SIZE - (input_len % DES_BLOCK_SIZE);
-            if ((padded_input = (unsigned char*)malloc(padded_len + input_len)) == NULL)
+            if ((padded_input = (unsigned char*)crypto_alloc_malloc(padded_len + input_len)) == NULL)
             {
                 log_error("Failure allocating padded text length");
                 result = __LINE__;
+                outcome = CRYPTO_TRACE_ALLOC_FAILURE;
             }
             else
             {
@@ -486,13 +606,14 @@ int crypto_3des_encrypt(const unsigned char* input, size_t input_len, unsigned c
                 iv_value = iv_item;
             }
 
-            des_operation(CRYPTO_ENCRYPT|CRYPTO_TRIPLE_DES, padded_input, padded_len + input_len, output, result_len, key, iv_value);
+            result = des_operation(CRYPTO_ENCRYPT|CRYPTO_TRIPLE_DES, padded_input, padded_len + input_len, output, result_len, key, iv_value, &outcome);
             if (add_padding)
             {
-                free(padded_input);
+                crypto_alloc_free(padded_input);
             }
         }
     }
+    CRYPTO_TRACE_CIPHER_EXIT(CRYPTO_TRACE_3DES, CRYPTO_TRACE_MODE(true, init_vector), input_len, outcome);
     return result;
 }
 
@@ -500,10 +621,13 @@ int crypto_3des_decrypt(const unsigned char* cipher_text, size_t cipher_len, uns
     size_t result_len, const unsigned char* key, const unsigned char* init_vector, bool is_padded)
 {
     int result;
+    int outcome;
+    CRYPTO_TRACE_CIPHER_ENTRY(CRYPTO_TRACE_3DES, CRYPTO_TRACE_MODE(false, init_vector), cipher_len);
     if (cipher_text == NULL || cipher_len == 0 || output == NULL || key == NULL)
     {
         log_error("Failure invalid parameter specified cipher_text: %p, cipher_len: %d, output: %p, key: %p", cipher_text, (int)cipher_len, output, key);
         result = __LINE__;
+        outcome = CRYPTO_TRACE_INVALID_ARGUMENT;
     }
     else
     {
@@ -515,12 +639,13 @@ int crypto_3des_decrypt(const unsigned char* cipher_text, size_t cipher_len, uns
             iv_value = iv_item;
         }
 
-        result = des_operation(CRYPTO_TRIPLE_DES, cipher_text, cipher_len, output, result_len, key, iv_value);
+        result = des_operation(CRYPTO_TRIPLE_DES, cipher_text, cipher_len, output, result_len, key, iv_value, &outcome);
         if (is_padded)
         {
             // Remove PKCS #5 padding
             output[cipher_len-output[cipher_len-1]] = 0x0;
         }
     }
+    CRYPTO_TRACE_CIPHER_EXIT(CRYPTO_TRACE_3DES, CRYPTO_TRACE_MODE(false, init_vector), cipher_len, outcome);
     return result;
 }
@@ -0,0 +1,421 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+#define DRBG_KEY_SIZE       AES_256_KEY_SIZE
+
+typedef struct CRYPTO_DRBG_INFO_TAG
+{
+    AES_KEY_SCHEDULE schedule;
+    unsigned char value[AES_BLOCK_SIZE];
+    uint64_t reseed_counter;
+} CRYPTO_DRBG_INFO;
+
+// The calling thread's instance and the output it has not handed out yet
+typedef struct THREAD_DRBG_TAG
+{
+    CRYPTO_DRBG_INFO* drbg;
+    unsigned int fork_generation;
+    size_t offset;
+    unsigned char buffer[CRYPTO_DRBG_BUFFER_SIZE];
+} THREAD_DRBG;
+
+static pthread_once_t g_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_thread_key;
+static int g_thread_key_result;
+// Bumped in the child of every fork, a thread instance seeing a new value
+// drops its buffer and reseeds before producing anything
+static unsigned int g_fork_generation;
+
+static int get_system_entropy(unsigned char* output, size_t length)
+{
+    int result = 0;
+    while (length > 0 && result == 0)
+    {
+#ifdef __APPLE__
+        // getentropy hands out at most 256 bytes per call
+        size_t chunk = length < 256 ? length : 256;
+        if (getentropy(output, chunk) != 0)
+        {
+            log_error("Failure reading system entropy");
+            result = __LINE__;
+        }
+        else
+        {
+            output += chunk;
+            length -= chunk;
+        }
+#else
+        ssize_t received = getrandom(output, length, 0);
+        if (received < 0)
+        {
+            if (errno != EINTR)
+            {
+                log_error("Failure reading system entropy");
+                result = __LINE__;
+            }
+        }
+        else
+        {
+            output += received;
+            length -= (size_t)received;
+        }
+#endif
+    }
+    return result;
+}
+
+// V counts as one 128-bit big endian number
+static void increment_value(unsigned char* value)
+{
+    for (size_t index = AES_BLOCK_SIZE; index > 0; index--)
+    {
+        if (++value[index - 1] != 0)
+        {
+            break;
+        }
+    }
+}
+
+// CTR_DRBG_Update, counter is the block after the last one used, which is
+// V + 1 everywhere except straight after generating output
+static void drbg_update(CRYPTO_DRBG_INFO* drbg, unsigned char* counter, const unsigned char* provided_data)
+{
+    unsigned char temp[CRYPTO_DRBG_SEED_SIZE] = { 0 };
+    (void)crypto_aes_ctr_xor(&drbg->schedule, counter, temp, sizeof(temp), temp);
+    if (provided_data != NULL)
+    {
+        xor_value(temp, provided_data, sizeof(temp));
+    }
+    (void)crypto_aes_key_init(&drbg->schedule, temp, DRBG_KEY_SIZE);
+    memcpy(drbg->value, temp + DRBG_KEY_SIZE, AES_BLOCK_SIZE);
+    secure_zero(temp, sizeof(temp));
+}
+
+static void drbg_update_next(CRYPTO_DRBG_INFO* drbg, const unsigned char* provided_data)
+{
+    unsigned char counter[AES_BLOCK_SIZE];
+    memcpy(counter, drbg->value, AES_BLOCK_SIZE);
+    increment_value(counter);
+    drbg_update(drbg, counter, provided_data);
+    secure_zero(counter, sizeof(counter));
+}
+
+// Without the derivation function inputs shorter than the seed are zero padded
+static int pad_input(unsigned char padded[CRYPTO_DRBG_SEED_SIZE], const unsigned char* input, size_t input_len)
+{
+    int result;
+    if (input_len > CRYPTO_DRBG_SEED_SIZE || (input == NULL && input_len > 0))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        memset(padded, 0, CRYPTO_DRBG_SEED_SIZE);
+        if (input_len > 0)
+        {
+            memcpy(padded, input, input_len);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static void drbg_reseed(CRYPTO_DRBG_INFO* drbg, unsigned char seed_material[CRYPTO_DRBG_SEED_SIZE], const unsigned char padded[CRYPTO_DRBG_SEED_SIZE])
+{
+    xor_value(seed_material, padded, CRYPTO_DRBG_SEED_SIZE);
+    drbg_update_next(drbg, seed_material);
+    drbg->reseed_counter = 1;
+}
+
+static int reseed_from_system(CRYPTO_DRBG_INFO* drbg, const unsigned char* additional, size_t additional_len)
+{
+    int result;
+    unsigned char padded[CRYPTO_DRBG_SEED_SIZE];
+    unsigned char seed_material[CRYPTO_DRBG_SEED_SIZE];
+    if (pad_input(padded, additional, additional_len) != 0)
+    {
+        log_error("Failure invalid parameter specified additional: %p, additional_len: %d", additional, (int)additional_len);
+        result = __LINE__;
+    }
+    else if (get_system_entropy(seed_material, sizeof(seed_material)) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        drbg_reseed(drbg, seed_material, padded);
+        result = 0;
+    }
+    secure_zero(seed_material, sizeof(seed_material));
+    secure_zero(padded, sizeof(padded));
+    return result;
+}
+
+static CRYPTO_DRBG_INFO* instantiate(unsigned char seed_material[CRYPTO_DRBG_SEED_SIZE], const unsigned char* personalization, size_t personalization_len)
+{
+    CRYPTO_DRBG_INFO* result;
+    unsigned char padded[CRYPTO_DRBG_SEED_SIZE];
+    if (pad_input(padded, personalization, personalization_len) != 0)
+    {
+        log_error("Failure invalid parameter specified personalization: %p, personalization_len: %d", personalization, (int)personalization_len);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_DRBG_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_DRBG_INFO))) == NULL)
+    {
+        log_error("Failure allocating drbg");
+    }
+    else
+    {
+        // Key and V start at zero
+        unsigned char zero_key[DRBG_KEY_SIZE] = { 0 };
+        memset(result, 0, sizeof(CRYPTO_DRBG_INFO));
+        (void)crypto_aes_key_init(&result->schedule, zero_key, sizeof(zero_key));
+        drbg_reseed(result, seed_material, padded);
+    }
+    secure_zero(padded, sizeof(padded));
+    return result;
+}
+
+CRYPTO_DRBG_HANDLE crypto_drbg_create(const unsigned char* personalization, size_t personalization_len)
+{
+    CRYPTO_DRBG_INFO* result;
+    unsigned char seed_material[CRYPTO_DRBG_SEED_SIZE];
+    if (get_system_entropy(seed_material, sizeof(seed_material)) != 0)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = instantiate(seed_material, personalization, personalization_len);
+    }
+    secure_zero(seed_material, sizeof(seed_material));
+    return result;
+}
+
+CRYPTO_DRBG_HANDLE crypto_drbg_create_seeded(const unsigned char* entropy, size_t entropy_len, const unsigned char* personalization, size_t personalization_len)
+{
+    CRYPTO_DRBG_INFO* result;
+    if (entropy == NULL || entropy_len != CRYPTO_DRBG_SEED_SIZE)
+    {
+        log_error("Failure invalid parameter specified entropy: %p, entropy_len: %d", entropy, (int)entropy_len);
+        result = NULL;
+    }
+    else
+    {
+        unsigned char seed_material[CRYPTO_DRBG_SEED_SIZE];
+        memcpy(seed_material, entropy, CRYPTO_DRBG_SEED_SIZE);
+        result = instantiate(seed_material, personalization, personalization_len);
+        secure_zero(seed_material, sizeof(seed_material));
+    }
+    return result;
+}
+
+void crypto_drbg_destroy(CRYPTO_DRBG_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        secure_zero(handle, sizeof(CRYPTO_DRBG_INFO));
+        crypto_alloc_free(handle);
+    }
+}
+
+int crypto_drbg_reseed(CRYPTO_DRBG_HANDLE handle, const unsigned char* additional, size_t additional_len)
+{
+    int result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = __LINE__;
+    }
+    else
+    {
+        result = reseed_from_system(handle, additional, additional_len);
+    }
+    return result;
+}
+
+int crypto_drbg_generate(CRYPTO_DRBG_HANDLE handle, const unsigned char* additional, size_t additional_len, unsigned char* output, size_t output_len)
+{
+    int result;
+    unsigned char padded[CRYPTO_DRBG_SEED_SIZE];
+    bool reseed_due = handle != NULL && handle->reseed_counter > CRYPTO_DRBG_RESEED_INTERVAL;
+    if (handle == NULL || output == NULL || output_len == 0 || output_len > CRYPTO_DRBG_MAX_REQUEST ||
+        pad_input(padded, additional, additional_len) != 0)
+    {
+        log_error("Failure invalid parameter specified handle: %p, output: %p, output_len: %d, additional_len: %d", handle, output, (int)output_len, (int)additional_len);
+        result = __LINE__;
+    }
+    else if (reseed_due && reseed_from_system(handle, additional, additional_len) != 0)
+    {
+        log_error("Failure reseeding drbg");
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char counter[AES_BLOCK_SIZE];
+        // A reseed just above already mixed the additional input in
+        const unsigned char* provided_data = (additional_len > 0 && !reseed_due) ? padded : NULL;
+        if (provided_data != NULL)
+        {
+            drbg_update_next(handle, provided_data);
+        }
+
+        // The output blocks are the CTR key stream from V + 1
+        memcpy(counter, handle->value, AES_BLOCK_SIZE);
+        increment_value(counter);
+        memset(output, 0, output_len);
+        (void)crypto_aes_ctr_xor(&handle->schedule, counter, output, output_len, output);
+        drbg_update(handle, counter, provided_data);
+        handle->reseed_counter++;
+        secure_zero(counter, sizeof(counter));
+        result = 0;
+    }
+    secure_zero(padded, sizeof(padded));
+    return result;
+}
+
+static void on_fork_child(void)
+{
+    __atomic_fetch_add(&g_fork_generation, 1, __ATOMIC_RELAXED);
+}
+
+static void destroy_thread_drbg(void* value)
+{
+    THREAD_DRBG* thread_drbg = (THREAD_DRBG*)value;
+    crypto_drbg_destroy(thread_drbg->drbg);
+    secure_zero(thread_drbg->buffer, sizeof(thread_drbg->buffer));
+    crypto_alloc_free(thread_drbg);
+}
+
+static void init_thread_key(void)
+{
+    if ((g_thread_key_result = pthread_key_create(&g_thread_key, destroy_thread_drbg)) == 0)
+    {
+        g_thread_key_result = pthread_atfork(NULL, NULL, on_fork_child);
+    }
+}
+
+static THREAD_DRBG* get_thread_drbg(void)
+{
+    THREAD_DRBG* result;
+    if (pthread_once(&g_thread_once, init_thread_key) != 0 || g_thread_key_result != 0)
+    {
+        log_error("Failure creating thread drbg key");
+        result = NULL;
+    }
+    else if ((result = (THREAD_DRBG*)pthread_getspecific(g_thread_key)) == NULL)
+    {
+        // Thread and process ids personalize each instance
+        struct
+        {
+            pthread_t thread;
+            pid_t process;
+        } personalization;
+        memset(&personalization, 0, sizeof(personalization));
+        personalization.thread = pthread_self();
+        personalization.process = getpid();
+
+        if ((result = (THREAD_DRBG*)crypto_alloc_malloc(sizeof(THREAD_DRBG))) == NULL)
+        {
+            log_error("Failure allocating thread drbg");
+        }
+        else if ((result->drbg = crypto_drbg_create((const unsigned char*)&personalization, sizeof(personalization))) == NULL)
+        {
+            log_error("Failure creating thread drbg");
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (pthread_setspecific(g_thread_key, result) != 0)
+        {
+            log_error("Failure storing thread drbg");
+            crypto_drbg_destroy(result->drbg);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->fork_generation = __atomic_load_n(&g_fork_generation, __ATOMIC_RELAXED);
+            result->offset = CRYPTO_DRBG_BUFFER_SIZE;
+        }
+    }
+    return result;
+}
+
+int crypto_drbg_random_bytes(unsigned char* output, size_t output_len)
+{
+    int result;
+    THREAD_DRBG* thread_drbg;
+    unsigned int fork_generation = __atomic_load_n(&g_fork_generation, __ATOMIC_RELAXED);
+    if (output == NULL || output_len == 0)
+    {
+        log_error("Failure invalid parameter specified output: %p, output_len: %d", output, (int)output_len);
+        result = __LINE__;
+    }
+    else if ((thread_drbg = get_thread_drbg()) == NULL)
+    {
+        result = __LINE__;
+    }
+    // A forked child starts with a copy of the parent state
+    else if (thread_drbg->fork_generation != fork_generation && reseed_from_system(thread_drbg->drbg, NULL, 0) != 0)
+    {
+        log_error("Failure reseeding thread drbg after fork");
+        result = __LINE__;
+    }
+    else
+    {
+        if (thread_drbg->fork_generation != fork_generation)
+        {
+            secure_zero(thread_drbg->buffer, sizeof(thread_drbg->buffer));
+            thread_drbg->offset = CRYPTO_DRBG_BUFFER_SIZE;
+            thread_drbg->fork_generation = fork_generation;
+        }
+
+        result = 0;
+        if (output_len >= CRYPTO_DRBG_BUFFER_SIZE)
+        {
+            // Large requests gain nothing from the buffer
+            while (output_len > 0 && result == 0)
+            {
+                size_t chunk = output_len < CRYPTO_DRBG_MAX_REQUEST ? output_len : CRYPTO_DRBG_MAX_REQUEST;
+                result = crypto_drbg_generate(thread_drbg->drbg, NULL, 0, output, chunk);
+                output += chunk;
+                output_len -= chunk;
+            }
+        }
+        else
+        {
+            if (CRYPTO_DRBG_BUFFER_SIZE - thread_drbg->offset < output_len)
+            {
+                if ((result = crypto_drbg_generate(thread_drbg->drbg, NULL, 0, thread_drbg->buffer, CRYPTO_DRBG_BUFFER_SIZE)) == 0)
+                {
+                    thread_drbg->offset = 0;
+                }
+            }
+            if (result == 0)
+            {
+                memcpy(output, thread_drbg->buffer + thread_drbg->offset, output_len);
+                secure_zero(thread_drbg->buffer + thread_drbg->offset, output_len);
+                thread_drbg->offset += output_len;
+            }
+        }
+    }
+    return result;
+}
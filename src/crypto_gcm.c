@@ -0,0 +1,274 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_gcm.h"
+#include "cablelock/crypto_macro.h"
+
+// Reduction values for the 4 bits shifted out of the field element
+static const uint64_t last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+typedef struct GCM_STATE_TAG
+{
+    unsigned char counter[AES_BLOCK_SIZE];
+    unsigned char hash[AES_BLOCK_SIZE];
+} GCM_STATE;
+
+// Precompute the multiples of H needed for a 4 bits at a time multiply
+static void compute_hash_table(CRYPTO_GCM_KEY* gcm_key, const unsigned char h_value[AES_BLOCK_SIZE])
+{
+    uint64_t value_high = load_be64(h_value);
+    uint64_t value_low = load_be64(h_value + 8);
+
+    gcm_key->h_high[8] = value_high;
+    gcm_key->h_low[8] = value_low;
+    gcm_key->h_high[0] = 0;
+    gcm_key->h_low[0] = 0;
+
+    for (size_t index = 4; index > 0; index >>= 1)
+    {
+        uint64_t reduce = (value_low & 1) ? ((uint64_t)0xe1000000 << 32) : 0;
+        value_low = (value_high << 63) | (value_low >> 1);
+        value_high = (value_high >> 1) ^ reduce;
+        gcm_key->h_high[index] = value_high;
+        gcm_key->h_low[index] = value_low;
+    }
+    for (size_t index = 2; index <= 8; index *= 2)
+    {
+        for (size_t inner = 1; inner < index; inner++)
+        {
+            gcm_key->h_high[index + inner] = gcm_key->h_high[index] ^ gcm_key->h_high[inner];
+            gcm_key->h_low[index + inner] = gcm_key->h_low[index] ^ gcm_key->h_low[inner];
+        }
+    }
+}
+
+// Multiply value by H in GF(2^128) in place
+static void hash_multiply(const CRYPTO_GCM_KEY* gcm_key, unsigned char value[AES_BLOCK_SIZE])
+{
+    unsigned char nibble = value[15] & 0x0f;
+    uint64_t z_high = gcm_key->h_high[nibble];
+    uint64_t z_low = gcm_key->h_low[nibble];
+
+    for (int index = 15; index >= 0; index--)
+    {
+        unsigned char low_nibble = value[index] & 0x0f;
+        unsigned char high_nibble = (value[index] >> 4) & 0x0f;
+        unsigned char remainder;
+
+        if (index != 15)
+        {
+            remainder = (unsigned char)(z_low & 0x0f);
+            z_low = (z_high << 60) | (z_low >> 4);
+            z_high = (z_high >> 4) ^ (last4[remainder] << 48);
+            z_high ^= gcm_key->h_high[low_nibble];
+            z_low ^= gcm_key->h_low[low_nibble];
+        }
+        remainder = (unsigned char)(z_low & 0x0f);
+        z_low = (z_high << 60) | (z_low >> 4);
+        z_high = (z_high >> 4) ^ (last4[remainder] << 48);
+        z_high ^= gcm_key->h_high[high_nibble];
+        z_low ^= gcm_key->h_low[high_nibble];
+    }
+    store_be64(value, z_high);
+    store_be64(value + 8, z_low);
+}
+
+// Fold data into the hash, a trailing partial block is zero padded
+static void hash_update(const CRYPTO_GCM_KEY* gcm_key, GCM_STATE* state, const unsigned char* data, size_t length)
+{
+    while (length > 0)
+    {
+        size_t block_len = length < AES_BLOCK_SIZE ? length : AES_BLOCK_SIZE;
+        xor_value(state->hash, data, block_len);
+        hash_multiply(gcm_key, state->hash);
+        data += block_len;
+        length -= block_len;
+    }
+}
+
+static void increment_counter(unsigned char counter[AES_BLOCK_SIZE])
+{
+    // Only the last 32 bits are a counter
+    store_be32(counter + 12, load_be32(counter + 12) + 1);
+}
+
+// Whole blocks go through the wide kernels when there are any, returns the bytes done
+static size_t gcm_bulk(bool encrypt, const CRYPTO_GCM_KEY* gcm_key, GCM_STATE* state, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    size_t result = 0;
+    if (gcm_key->has_powers)
+    {
+        if (encrypt)
+        {
+            result = crypto_aes_accel_gcm_encrypt(&gcm_key->schedule, gcm_key->h_powers, state->counter, state->hash, input, output, input_len / AES_BLOCK_SIZE);
+        }
+        else
+        {
+            result = crypto_aes_accel_gcm_decrypt(&gcm_key->schedule, gcm_key->h_powers, state->counter, state->hash, input, output, input_len / AES_BLOCK_SIZE);
+        }
+    }
+    return result * AES_BLOCK_SIZE;
+}
+
+static void gcm_start(const CRYPTO_GCM_KEY* gcm_key, GCM_STATE* state, const unsigned char* nonce, const unsigned char* aad, size_t aad_len)
+{
+    memcpy(state->counter, nonce, GCM_NONCE_SIZE);
+    store_be32(state->counter + GCM_NONCE_SIZE, 1);
+    memset(state->hash, 0, AES_BLOCK_SIZE);
+    hash_update(gcm_key, state, aad, aad_len);
+}
+
+static void gcm_finish(const CRYPTO_GCM_KEY* gcm_key, GCM_STATE* state, size_t aad_len, size_t data_len, unsigned char tag[GCM_TAG_SIZE])
+{
+    unsigned char length_block[AES_BLOCK_SIZE];
+
+    store_be64(length_block, (uint64_t)aad_len * 8);
+    store_be64(length_block + 8, (uint64_t)data_len * 8);
+    hash_update(gcm_key, state, length_block, AES_BLOCK_SIZE);
+
+    // Tag is the hash masked with the first counter block
+    store_be32(state->counter + GCM_NONCE_SIZE, 1);
+    crypto_aes_block_encrypt(&gcm_key->schedule, state->counter, tag);
+    xor_value(tag, state->hash, GCM_TAG_SIZE);
+}
+
+int crypto_gcm_key_init(CRYPTO_GCM_KEY* gcm_key, const unsigned char* key, size_t key_len)
+{
+    int result;
+    if (gcm_key == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified gcm_key: %p, key: %p", gcm_key, key);
+        result = __LINE__;
+    }
+    else if (crypto_aes_key_init(&gcm_key->schedule, key, key_len) != 0)
+    {
+        log_error("Failure initializing aes key schedule");
+        result = __LINE__;
+    }
+    else
+    {
+        // H is the encryption of the zero block
+        unsigned char h_value[AES_BLOCK_SIZE] = { 0 };
+        crypto_aes_block_encrypt(&gcm_key->schedule, h_value, h_value);
+        compute_hash_table(gcm_key, h_value);
+        gcm_key->has_powers = crypto_aes_accel_gcm_init(h_value, gcm_key->h_powers) == 0;
+        secure_zero(h_value, AES_BLOCK_SIZE);
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_gcm_encrypt(const CRYPTO_GCM_KEY* gcm_key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+    const unsigned char* input, size_t input_len, unsigned char* output, unsigned char* tag)
+{
+    int result;
+    if (gcm_key == NULL || nonce == NULL || (aad == NULL && aad_len > 0) || (input_len > 0 && (input == NULL || output == NULL)) || tag == NULL)
+    {
+        log_error("Failure invalid parameter specified gcm_key: %p, nonce: %p, aad: %p, input: %p, output: %p, tag: %p", gcm_key, nonce, aad, input, output, tag);
+        result = __LINE__;
+    }
+    else
+    {
+        GCM_STATE state;
+        unsigned char key_stream[AES_BLOCK_SIZE];
+        size_t remaining = input_len;
+        size_t done;
+
+        gcm_start(gcm_key, &state, nonce, aad, aad_len);
+        done = gcm_bulk(true, gcm_key, &state, input, input_len, output);
+        input += done;
+        output += done;
+        remaining -= done;
+        while (remaining > 0)
+        {
+            size_t block_len = remaining < AES_BLOCK_SIZE ? remaining : AES_BLOCK_SIZE;
+
+            increment_counter(state.counter);
+            crypto_aes_block_encrypt(&gcm_key->schedule, state.counter, key_stream);
+            for (size_t index = 0; index < block_len; index++)
+            {
+                output[index] = input[index] ^ key_stream[index];
+            }
+            // Hash the cipher text while it is still in cache
+            hash_update(gcm_key, &state, output, block_len);
+
+            input += block_len;
+            output += block_len;
+            remaining -= block_len;
+        }
+        gcm_finish(gcm_key, &state, aad_len, input_len, tag);
+        secure_zero(key_stream, AES_BLOCK_SIZE);
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_gcm_decrypt(const CRYPTO_GCM_KEY* gcm_key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+    const unsigned char* input, size_t input_len, unsigned char* output, const unsigned char* tag)
+{
+    int result;
+    if (gcm_key == NULL || nonce == NULL || (aad == NULL && aad_len > 0) || (input_len > 0 && (input == NULL || output == NULL)) || tag == NULL)
+    {
+        log_error("Failure invalid parameter specified gcm_key: %p, nonce: %p, aad: %p, input: %p, output: %p, tag: %p", gcm_key, nonce, aad, input, output, tag);
+        result = __LINE__;
+    }
+    else
+    {
+        GCM_STATE state;
+        unsigned char key_stream[AES_BLOCK_SIZE];
+        unsigned char computed_tag[GCM_TAG_SIZE];
+        unsigned char* output_start = output;
+        size_t remaining = input_len;
+        size_t done;
+
+        gcm_start(gcm_key, &state, nonce, aad, aad_len);
+        done = gcm_bulk(false, gcm_key, &state, input, input_len, output);
+        input += done;
+        output += done;
+        remaining -= done;
+        while (remaining > 0)
+        {
+            size_t block_len = remaining < AES_BLOCK_SIZE ? remaining : AES_BLOCK_SIZE;
+
+            // Hash before decrypting, input and output may be the same buffer
+            hash_update(gcm_key, &state, input, block_len);
+            increment_counter(state.counter);
+            crypto_aes_block_encrypt(&gcm_key->schedule, state.counter, key_stream);
+            for (size_t index = 0; index < block_len; index++)
+            {
+                output[index] = input[index] ^ key_stream[index];
+            }
+
+            input += block_len;
+            output += block_len;
+            remaining -= block_len;
+        }
+        gcm_finish(gcm_key, &state, aad_len, input_len, computed_tag);
+        secure_zero(key_stream, AES_BLOCK_SIZE);
+
+        if (const_time_compare(computed_tag, tag, GCM_TAG_SIZE) != 0)
+        {
+            // Never hand back unauthenticated plain text
+            secure_zero(output_start, input_len);
+            log_error("Failure authenticating gcm tag");
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,427 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_key_store.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+#define KEY_STORE_MAGIC         0x534b4c43      // "CLKS"
+#define KEY_STORE_VERSION       1
+
+// Segment layout: header, index sorted by key id, then one cache line aligned
+// slot per schedule.  Schedules hold no pointers so they work at any address.
+typedef struct KEY_STORE_HEADER_TAG
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t entry_count;
+    uint64_t total_size;
+    // A store written by a build with different schedule layouts is rejected
+    uint32_t aes_schedule_size;
+    uint32_t des_schedule_size;
+} KEY_STORE_HEADER;
+
+typedef struct KEY_STORE_INDEX_TAG
+{
+    uint64_t key_id;
+    uint64_t offset;
+    uint32_t cipher;
+    uint32_t source;
+} KEY_STORE_INDEX;
+
+typedef struct CRYPTO_KEY_STORE_INFO_TAG
+{
+    const unsigned char* base;
+    size_t size;
+    const KEY_STORE_INDEX* index;
+    size_t entry_count;
+} CRYPTO_KEY_STORE_INFO;
+
+static size_t round_to_line(size_t value)
+{
+    return (value + CRYPTO_CACHE_LINE_SIZE - 1) & ~((size_t)CRYPTO_CACHE_LINE_SIZE - 1);
+}
+
+static size_t index_offset(void)
+{
+    return round_to_line(sizeof(KEY_STORE_HEADER));
+}
+
+static size_t schedule_size(uint32_t cipher)
+{
+    return cipher == CRYPTO_KEY_STORE_AES ? sizeof(AES_KEY_SCHEDULE) : sizeof(DES_KEY_SCHEDULE);
+}
+
+static int compare_index(const void* left, const void* right)
+{
+    uint64_t left_id = ((const KEY_STORE_INDEX*)left)->key_id;
+    uint64_t right_id = ((const KEY_STORE_INDEX*)right)->key_id;
+    return left_id < right_id ? -1 : (left_id > right_id ? 1 : 0);
+}
+
+// Sorts the entries by id and assigns each its slot, returns the segment size or 0
+static size_t build_index(const CRYPTO_KEY_STORE_ENTRY* entries, size_t entry_count, KEY_STORE_INDEX* index)
+{
+    size_t result;
+    size_t offset = round_to_line(index_offset() + (entry_count * sizeof(KEY_STORE_INDEX)));
+
+    for (size_t item = 0; item < entry_count; item++)
+    {
+        index[item].key_id = entries[item].key_id;
+        index[item].cipher = (uint32_t)entries[item].cipher;
+        index[item].source = (uint32_t)item;
+    }
+    qsort(index, entry_count, sizeof(KEY_STORE_INDEX), compare_index);
+
+    result = 0;
+    for (size_t item = 0; item < entry_count; item++)
+    {
+        const CRYPTO_KEY_STORE_ENTRY* entry = &entries[index[item].source];
+        if (item > 0 && index[item].key_id == index[item - 1].key_id)
+        {
+            log_error("Failure duplicate key id %llu", (unsigned long long)index[item].key_id);
+            break;
+        }
+        else if (entry->key == NULL || (entry->cipher != CRYPTO_KEY_STORE_AES && entry->cipher != CRYPTO_KEY_STORE_DES))
+        {
+            log_error("Failure invalid key store entry %d, key: %p, cipher: %d", (int)index[item].source, entry->key, (int)entry->cipher);
+            break;
+        }
+        index[item].offset = offset;
+        offset += round_to_line(schedule_size(index[item].cipher));
+        if (item + 1 == entry_count)
+        {
+            result = offset;
+        }
+    }
+    return result;
+}
+
+static int expand_keys(const CRYPTO_KEY_STORE_ENTRY* entries, const KEY_STORE_INDEX* index, size_t entry_count, unsigned char* base)
+{
+    int result = 0;
+    for (size_t item = 0; item < entry_count && result == 0; item++)
+    {
+        const CRYPTO_KEY_STORE_ENTRY* entry = &entries[index[item].source];
+        if (entry->cipher == CRYPTO_KEY_STORE_AES)
+        {
+            result = crypto_aes_key_init((AES_KEY_SCHEDULE*)(base + index[item].offset), entry->key, entry->key_len);
+        }
+        else
+        {
+            result = crypto_des_key_init((DES_KEY_SCHEDULE*)(base + index[item].offset), entry->key, entry->key_len);
+        }
+        if (result != 0)
+        {
+            log_error("Failure expanding key id %llu", (unsigned long long)index[item].key_id);
+        }
+    }
+    return result;
+}
+
+static int write_segment(int segment, size_t total_size, const CRYPTO_KEY_STORE_ENTRY* entries, const KEY_STORE_INDEX* index, size_t entry_count)
+{
+    int result;
+    unsigned char* base;
+    if (ftruncate(segment, (off_t)total_size) != 0)
+    {
+        log_error("Failure sizing key store segment");
+        result = __LINE__;
+    }
+    else if ((base = (unsigned char*)mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, segment, 0)) == MAP_FAILED)
+    {
+        log_error("Failure mapping key store segment");
+        result = __LINE__;
+    }
+    else
+    {
+        if (expand_keys(entries, index, entry_count, base) != 0)
+        {
+            secure_zero(base, total_size);
+            result = __LINE__;
+        }
+        else
+        {
+            KEY_STORE_HEADER* header = (KEY_STORE_HEADER*)base;
+            KEY_STORE_INDEX* stored_index = (KEY_STORE_INDEX*)(base + index_offset());
+            memcpy(stored_index, index, entry_count * sizeof(KEY_STORE_INDEX));
+            for (size_t item = 0; item < entry_count; item++)
+            {
+                // Where the caller's entry was is nobody else's business
+                stored_index[item].source = 0;
+            }
+            header->version = KEY_STORE_VERSION;
+            header->entry_count = entry_count;
+            header->total_size = total_size;
+            header->aes_schedule_size = (uint32_t)sizeof(AES_KEY_SCHEDULE);
+            header->des_schedule_size = (uint32_t)sizeof(DES_KEY_SCHEDULE);
+            // The magic goes in last so a half written store never validates
+            __atomic_store_n(&header->magic, KEY_STORE_MAGIC, __ATOMIC_RELEASE);
+            result = 0;
+        }
+        (void)munmap(base, total_size);
+    }
+    return result;
+}
+
+static const KEY_STORE_INDEX* find_entry(CRYPTO_KEY_STORE_HANDLE handle, uint64_t key_id, CRYPTO_KEY_STORE_CIPHER cipher)
+{
+    const KEY_STORE_INDEX* result = NULL;
+    size_t low = 0;
+    size_t high = handle->entry_count;
+    while (low < high)
+    {
+        size_t middle = low + ((high - low) / 2);
+        if (handle->index[middle].key_id < key_id)
+        {
+            low = middle + 1;
+        }
+        else if (handle->index[middle].key_id > key_id)
+        {
+            high = middle;
+        }
+        else
+        {
+            if (handle->index[middle].cipher == (uint32_t)cipher)
+            {
+                result = &handle->index[middle];
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+static bool validate_store(const unsigned char* base, size_t size)
+{
+    bool result = false;
+    const KEY_STORE_HEADER* header = (const KEY_STORE_HEADER*)base;
+    if (size < index_offset() || __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != KEY_STORE_MAGIC || header->version != KEY_STORE_VERSION)
+    {
+        log_error("Failure key store segment is not a published store");
+    }
+    else if (header->aes_schedule_size != sizeof(AES_KEY_SCHEDULE) || header->des_schedule_size != sizeof(DES_KEY_SCHEDULE))
+    {
+        log_error("Failure key store was written by an incompatible build");
+    }
+    else if (header->total_size != size || header->entry_count > (size - index_offset()) / sizeof(KEY_STORE_INDEX))
+    {
+        log_error("Failure key store segment size does not match its header");
+    }
+    else
+    {
+        const KEY_STORE_INDEX* index = (const KEY_STORE_INDEX*)(base + index_offset());
+        result = true;
+        for (size_t item = 0; item < header->entry_count; item++)
+        {
+            if (index[item].cipher > CRYPTO_KEY_STORE_DES || index[item].offset > size || size - index[item].offset < schedule_size(index[item].cipher) ||
+                (item > 0 && index[item].key_id <= index[item - 1].key_id))
+            {
+                log_error("Failure key store index entry %d is corrupt", (int)item);
+                result = false;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+int crypto_key_store_publish(const char* name, const CRYPTO_KEY_STORE_ENTRY* entries, size_t entry_count)
+{
+    int result;
+    KEY_STORE_INDEX* index;
+    if (name == NULL || entries == NULL || entry_count == 0 || entry_count > (SIZE_MAX / 2) / (sizeof(KEY_STORE_INDEX) + sizeof(DES_KEY_SCHEDULE) + CRYPTO_CACHE_LINE_SIZE))
+    {
+        log_error("Failure invalid parameter specified name: %p, entries: %p, entry_count: %d", name, entries, (int)entry_count);
+        result = __LINE__;
+    }
+    else if ((index = (KEY_STORE_INDEX*)crypto_alloc_malloc(entry_count * sizeof(KEY_STORE_INDEX))) == NULL)
+    {
+        log_error("Failure allocating key store index");
+        result = __LINE__;
+    }
+    else
+    {
+        size_t total_size;
+        int segment;
+        if ((total_size = build_index(entries, entry_count, index)) == 0)
+        {
+            result = __LINE__;
+        }
+        else if ((segment = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR)) < 0)
+        {
+            log_error("Failure creating key store segment %s", name);
+            result = __LINE__;
+        }
+        else
+        {
+            if (write_segment(segment, total_size, entries, index, entry_count) != 0)
+            {
+                (void)shm_unlink(name);
+                result = __LINE__;
+            }
+            else
+            {
+                // Nobody can reopen it for writing from here on
+                (void)fchmod(segment, S_IRUSR);
+                result = 0;
+            }
+            (void)close(segment);
+        }
+        crypto_alloc_free(index);
+    }
+    return result;
+}
+
+int crypto_key_store_unlink(const char* name)
+{
+    int result;
+    if (name == NULL)
+    {
+        log_error("Failure invalid parameter specified name: NULL");
+        result = __LINE__;
+    }
+    else if (shm_unlink(name) != 0)
+    {
+        log_error("Failure removing key store segment %s", name);
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+CRYPTO_KEY_STORE_HANDLE crypto_key_store_open(const char* name)
+{
+    CRYPTO_KEY_STORE_INFO* result;
+    int segment;
+    struct stat segment_info;
+    if (name == NULL)
+    {
+        log_error("Failure invalid parameter specified name: NULL");
+        result = NULL;
+    }
+    else if ((segment = shm_open(name, O_RDONLY, 0)) < 0)
+    {
+        log_error("Failure opening key store segment %s", name);
+        result = NULL;
+    }
+    else
+    {
+        if (fstat(segment, &segment_info) != 0 || segment_info.st_size <= 0)
+        {
+            log_error("Failure reading key store segment size");
+            result = NULL;
+        }
+        else if ((result = (CRYPTO_KEY_STORE_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_KEY_STORE_INFO))) == NULL)
+        {
+            log_error("Failure allocating key store");
+        }
+        else
+        {
+            size_t size = (size_t)segment_info.st_size;
+            void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, segment, 0);
+            if (base == MAP_FAILED)
+            {
+                log_error("Failure mapping key store segment");
+                crypto_alloc_free(result);
+                result = NULL;
+            }
+            else if (!validate_store((const unsigned char*)base, size))
+            {
+                (void)munmap(base, size);
+                crypto_alloc_free(result);
+                result = NULL;
+            }
+            else
+            {
+                result->base = (const unsigned char*)base;
+                result->size = size;
+                result->index = (const KEY_STORE_INDEX*)(result->base + index_offset());
+                result->entry_count = (size_t)((const KEY_STORE_HEADER*)base)->entry_count;
+            }
+        }
+        // The mapping keeps the segment alive
+        (void)close(segment);
+    }
+    return result;
+}
+
+void crypto_key_store_close(CRYPTO_KEY_STORE_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        (void)munmap((void*)handle->base, handle->size);
+        crypto_alloc_free(handle);
+    }
+}
+
+size_t crypto_key_store_get_count(CRYPTO_KEY_STORE_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->entry_count;
+    }
+    return result;
+}
+
+const AES_KEY_SCHEDULE* crypto_key_store_find_aes(CRYPTO_KEY_STORE_HANDLE handle, uint64_t key_id)
+{
+    const AES_KEY_SCHEDULE* result;
+    const KEY_STORE_INDEX* entry;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = NULL;
+    }
+    else if ((entry = find_entry(handle, key_id, CRYPTO_KEY_STORE_AES)) == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (const AES_KEY_SCHEDULE*)(handle->base + entry->offset);
+    }
+    return result;
+}
+
+const DES_KEY_SCHEDULE* crypto_key_store_find_des(CRYPTO_KEY_STORE_HANDLE handle, uint64_t key_id)
+{
+    const DES_KEY_SCHEDULE* result;
+    const KEY_STORE_INDEX* entry;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = NULL;
+    }
+    else if ((entry = find_entry(handle, key_id, CRYPTO_KEY_STORE_DES)) == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (const DES_KEY_SCHEDULE*)(handle->base + entry->offset);
+    }
+    return result;
+}
@@ -0,0 +1,273 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_keystream.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_des_core.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+typedef struct CRYPTO_KEYSTREAM_INFO_TAG
+{
+    union
+    {
+        AES_KEY_SCHEDULE aes;
+        DES_KEY_SCHEDULE des;
+    } schedule;
+    CRYPTO_KEYSTREAM_CIPHER cipher;
+    CRYPTO_KEYSTREAM_MODE mode;
+    size_t block_size;
+    // Counter block for CTR, feedback register for OFB
+    unsigned char state[AES_BLOCK_SIZE];
+
+    // Ring of ready keystream, allocated together with the handle
+    unsigned char* ring;
+    size_t capacity;
+    size_t read_pos;
+    size_t available;
+    size_t low_water;
+} CRYPTO_KEYSTREAM_INFO;
+
+static void increment_counter(unsigned char* counter, size_t length)
+{
+    for (size_t index = length; index > 0; index--)
+    {
+        if (++counter[index - 1] != 0)
+        {
+            break;
+        }
+    }
+}
+
+static void generate_block(CRYPTO_KEYSTREAM_INFO* keystream, unsigned char* output)
+{
+    if (keystream->cipher == CRYPTO_KEYSTREAM_AES)
+    {
+        crypto_aes_block_encrypt(&keystream->schedule.aes, keystream->state, output);
+    }
+    else
+    {
+        crypto_des_block_encrypt(&keystream->schedule.des, keystream->state, output);
+    }
+
+    if (keystream->mode == CRYPTO_KEYSTREAM_CTR)
+    {
+        increment_counter(keystream->state, keystream->block_size);
+    }
+    else
+    {
+        memcpy(keystream->state, output, keystream->block_size);
+    }
+}
+
+static void ring_push(CRYPTO_KEYSTREAM_INFO* keystream, const unsigned char* data, size_t length)
+{
+    size_t write_pos = (keystream->read_pos + keystream->available) % keystream->capacity;
+    for (size_t index = 0; index < length; index++)
+    {
+        keystream->ring[write_pos] = data[index];
+        if (++write_pos == keystream->capacity)
+        {
+            write_pos = 0;
+        }
+    }
+    keystream->available += length;
+}
+
+static void fill_ring(CRYPTO_KEYSTREAM_INFO* keystream)
+{
+    unsigned char block[AES_BLOCK_SIZE];
+    while (keystream->capacity - keystream->available >= keystream->block_size)
+    {
+        generate_block(keystream, block);
+        ring_push(keystream, block, keystream->block_size);
+    }
+    secure_zero(block, sizeof(block));
+}
+
+static size_t ring_capacity(size_t depth, size_t block_size)
+{
+    return ((depth + block_size - 1) / block_size) * block_size;
+}
+
+static void xor_bytes(unsigned char* output, const unsigned char* input, const unsigned char* keystream, size_t length)
+{
+    for (size_t index = 0; index < length; index++)
+    {
+        output[index] = input[index] ^ keystream[index];
+    }
+}
+
+CRYPTO_KEYSTREAM_HANDLE crypto_keystream_create(CRYPTO_KEYSTREAM_CIPHER cipher, CRYPTO_KEYSTREAM_MODE mode,
+    const unsigned char* key, size_t key_len, const unsigned char* iv, const CRYPTO_KEYSTREAM_CONFIG* config)
+{
+    CRYPTO_KEYSTREAM_INFO* result;
+    size_t block_size = cipher == CRYPTO_KEYSTREAM_AES ? AES_BLOCK_SIZE : DES_BLOCK_SIZE;
+    if (key == NULL || iv == NULL || config == NULL)
+    {
+        log_error("Failure invalid parameter specified key: %p, iv: %p, config: %p", key, iv, config);
+        result = NULL;
+    }
+    else if ((cipher != CRYPTO_KEYSTREAM_AES && cipher != CRYPTO_KEYSTREAM_DES) || (mode != CRYPTO_KEYSTREAM_CTR && mode != CRYPTO_KEYSTREAM_OFB))
+    {
+        log_error("Failure unsupported cipher %d or mode %d", (int)cipher, (int)mode);
+        result = NULL;
+    }
+    else if (config->depth == 0 || config->depth > SIZE_MAX / 2 || config->low_water > config->depth)
+    {
+        log_error("Failure invalid keystream depth %d or low water mark %d", (int)config->depth, (int)config->low_water);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_KEYSTREAM_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_KEYSTREAM_INFO) + ring_capacity(config->depth, block_size))) == NULL)
+    {
+        log_error("Failure allocating keystream");
+    }
+    else
+    {
+        int key_result;
+        memset(result, 0, sizeof(CRYPTO_KEYSTREAM_INFO));
+        if (cipher == CRYPTO_KEYSTREAM_AES)
+        {
+            key_result = crypto_aes_key_init(&result->schedule.aes, key, key_len);
+        }
+        else
+        {
+            key_result = crypto_des_key_init(&result->schedule.des, key, key_len);
+        }
+
+        if (key_result != 0)
+        {
+            log_error("Failure initializing keystream key");
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->cipher = cipher;
+            result->mode = mode;
+            result->block_size = block_size;
+            memcpy(result->state, iv, block_size);
+            result->ring = (unsigned char*)(result + 1);
+            result->capacity = ring_capacity(config->depth, block_size);
+            result->low_water = config->low_water;
+        }
+    }
+    return result;
+}
+
+void crypto_keystream_destroy(CRYPTO_KEYSTREAM_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        secure_zero(handle, sizeof(CRYPTO_KEYSTREAM_INFO) + handle->capacity);
+        crypto_alloc_free(handle);
+    }
+}
+
+size_t crypto_keystream_refill(CRYPTO_KEYSTREAM_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        fill_ring(handle);
+        result = handle->available;
+    }
+    return result;
+}
+
+size_t crypto_keystream_get_available(CRYPTO_KEYSTREAM_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->available;
+    }
+    return result;
+}
+
+int crypto_keystream_xor(CRYPTO_KEYSTREAM_HANDLE handle, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    int result;
+    if (handle == NULL || (input_len > 0 && (input == NULL || output == NULL)))
+    {
+        log_error("Failure invalid parameter specified handle: %p, input: %p, output: %p", handle, input, output);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char block[AES_BLOCK_SIZE];
+
+        // Precomputed keystream first, in at most two runs around the ring
+        while (input_len > 0 && handle->available > 0)
+        {
+            size_t chunk = handle->capacity - handle->read_pos;
+            if (chunk > handle->available)
+            {
+                chunk = handle->available;
+            }
+            if (chunk > input_len)
+            {
+                chunk = input_len;
+            }
+            xor_bytes(output, input, handle->ring + handle->read_pos, chunk);
+            secure_zero(handle->ring + handle->read_pos, chunk);
+            handle->read_pos = (handle->read_pos + chunk) % handle->capacity;
+            handle->available -= chunk;
+            input += chunk;
+            output += chunk;
+            input_len -= chunk;
+        }
+
+        // Anything the ring could not cover is generated inline
+        if (handle->cipher == CRYPTO_KEYSTREAM_AES && handle->mode == CRYPTO_KEYSTREAM_CTR && input_len >= AES_BLOCK_SIZE)
+        {
+            size_t whole = input_len - (input_len % AES_BLOCK_SIZE);
+            (void)crypto_aes_ctr_xor(&handle->schedule.aes, handle->state, input, whole, output);
+            input += whole;
+            output += whole;
+            input_len -= whole;
+        }
+        while (input_len >= handle->block_size)
+        {
+            generate_block(handle, block);
+            xor_bytes(output, input, block, handle->block_size);
+            input += handle->block_size;
+            output += handle->block_size;
+            input_len -= handle->block_size;
+        }
+        if (input_len > 0)
+        {
+            generate_block(handle, block);
+            xor_bytes(output, input, block, input_len);
+            // The unused tail stays in the ring for the next message
+            ring_push(handle, block + input_len, handle->block_size - input_len);
+        }
+        secure_zero(block, sizeof(block));
+
+        if (handle->available < handle->low_water)
+        {
+            fill_ring(handle);
+        }
+        result = 0;
+    }
+    return result;
+}
@@ -0,0 +1,1077 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_p256.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_macro.h"
+
+// Numbers are four 64-bit limbs, least significant first.  Field elements
+// live in Montgomery form (a * 2^256 mod p) so every product is one
+// multiply-and-reduce pass without a division.
+#define LIMB_COUNT              4
+#define SCALAR_SIZE             32
+// Signed radix-16 digits of a 256-bit scalar, the last one takes the carry
+#define DIGIT_COUNT             65
+// The comb holds 1..8 times 16^i times G for every digit position i, so a
+// fixed base multiply is 65 table additions and no doublings
+#define COMB_COLUMNS            8
+// wNAF widths for verification, G has a static table of odd multiples
+#define BASE_WNAF_WIDTH         7
+#define POINT_WNAF_WIDTH        5
+#define BASE_ODD_COUNT          (1 << (BASE_WNAF_WIDTH - 2))
+#define POINT_ODD_COUNT         (1 << (POINT_WNAF_WIDTH - 2))
+#define WNAF_MAX_DIGITS         258
+#define MAX_SIGN_ATTEMPTS       64
+
+typedef unsigned __int128 uint128;
+typedef uint64_t FIELD_ELEMENT[LIMB_COUNT];
+
+// Homogeneous projective coordinates x = X/Z, y = Y/Z, the identity is (0:1:0)
+typedef struct P256_POINT_TAG
+{
+    FIELD_ELEMENT x;
+    FIELD_ELEMENT y;
+    FIELD_ELEMENT z;
+} P256_POINT;
+
+typedef struct P256_AFFINE_TAG
+{
+    FIELD_ELEMENT x;
+    FIELD_ELEMENT y;
+} P256_AFFINE;
+
+static const FIELD_ELEMENT P256_P = { 0xffffffffffffffffULL, 0x00000000ffffffffULL, 0x0000000000000000ULL, 0xffffffff00000001ULL };
+static const FIELD_ELEMENT P256_N = { 0xf3b9cac2fc632551ULL, 0xbce6faada7179e84ULL, 0xffffffffffffffffULL, 0xffffffff00000000ULL };
+// -p^-1 and -n^-1 mod 2^64
+#define P256_P_INV              0x0000000000000001ULL
+#define P256_N_INV              0xccd1c8aaee00bc4fULL
+// 2^512 mod p and mod n convert into Montgomery form
+static const FIELD_ELEMENT P256_RR_P = { 0x0000000000000003ULL, 0xfffffffbffffffffULL, 0xfffffffffffffffeULL, 0x00000004fffffffdULL };
+static const FIELD_ELEMENT P256_RR_N = { 0x83244c95be79eea2ULL, 0x4699799c49bd6fa6ULL, 0x2845b2392b6bec59ULL, 0x66e12d94f3d95620ULL };
+// 1, b and the generator, all in Montgomery form
+static const FIELD_ELEMENT P256_ONE = { 0x0000000000000001ULL, 0xffffffff00000000ULL, 0xffffffffffffffffULL, 0x00000000fffffffeULL };
+static const FIELD_ELEMENT P256_B = { 0xd89cdf6229c4bddfULL, 0xacf005cd78843090ULL, 0xe5a220abf7212ed6ULL, 0xdc30061d04874834ULL };
+static const FIELD_ELEMENT P256_GX = { 0x79e730d418a9143cULL, 0x75ba95fc5fedb601ULL, 0x79fb732b77622510ULL, 0x18905f76a53755c6ULL };
+static const FIELD_ELEMENT P256_GY = { 0xddf25357ce95560aULL, 0x8b4ab8e4ba19e45cULL, 0xd2e88688dd21f325ULL, 0x8571ff1825885d85ULL };
+
+static pthread_once_t g_table_once = PTHREAD_ONCE_INIT;
+static P256_AFFINE g_comb_table[DIGIT_COUNT][COMB_COLUMNS];
+static P256_AFFINE g_base_odd[BASE_ODD_COUNT];
+
+static void limbs_copy(uint64_t* target, const uint64_t* src)
+{
+    memcpy(target, src, sizeof(FIELD_ELEMENT));
+}
+
+static void limbs_from_bytes(uint64_t* target, const unsigned char* src)
+{
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        target[LIMB_COUNT - 1 - index] = load_be64(src + (index * 8));
+    }
+}
+
+static void limbs_to_bytes(unsigned char* target, const uint64_t* src)
+{
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        store_be64(target + (index * 8), src[LIMB_COUNT - 1 - index]);
+    }
+}
+
+static uint64_t limbs_is_zero(const uint64_t* value)
+{
+    uint64_t bits = value[0] | value[1] | value[2] | value[3];
+    return ((bits | ((uint64_t)0 - bits)) >> 63) ^ 1;
+}
+
+static uint64_t limbs_equal(const uint64_t* left, const uint64_t* right)
+{
+    FIELD_ELEMENT diff;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        diff[index] = left[index] ^ right[index];
+    }
+    return limbs_is_zero(diff);
+}
+
+// target = left - right, returns the borrow
+static uint64_t limbs_sub(uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    uint64_t borrow = 0;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        uint128 diff = (uint128)left[index] - right[index] - borrow;
+        target[index] = (uint64_t)diff;
+        borrow = (uint64_t)(diff >> 64) & 1;
+    }
+    return borrow;
+}
+
+static uint64_t limbs_less_than(const uint64_t* left, const uint64_t* right)
+{
+    FIELD_ELEMENT ignored;
+    return limbs_sub(ignored, left, right);
+}
+
+static void limbs_cmov(uint64_t* target, const uint64_t* src, uint64_t move)
+{
+    uint64_t mask = (uint64_t)0 - move;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        target[index] ^= mask & (target[index] ^ src[index]);
+    }
+}
+
+// Keeps value - modulus when value (with its carry bit) is at least modulus
+static void reduce_once(uint64_t* target, const uint64_t* value, uint64_t carry, const uint64_t* modulus)
+{
+    FIELD_ELEMENT reduced;
+    uint64_t borrow = limbs_sub(reduced, value, modulus);
+    limbs_copy(target, value);
+    limbs_cmov(target, reduced, carry | (borrow ^ 1));
+}
+
+static void mod_add(uint64_t* target, const uint64_t* left, const uint64_t* right, const uint64_t* modulus)
+{
+    FIELD_ELEMENT sum;
+    uint64_t carry = 0;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        uint128 total = (uint128)left[index] + right[index] + carry;
+        sum[index] = (uint64_t)total;
+        carry = (uint64_t)(total >> 64);
+    }
+    reduce_once(target, sum, carry, modulus);
+}
+
+static void mod_sub(uint64_t* target, const uint64_t* left, const uint64_t* right, const uint64_t* modulus)
+{
+    uint64_t mask = (uint64_t)0 - limbs_sub(target, left, right);
+    uint64_t carry = 0;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        uint128 total = (uint128)target[index] + (modulus[index] & mask) + carry;
+        target[index] = (uint64_t)total;
+        carry = (uint64_t)(total >> 64);
+    }
+}
+
+// Word by word Montgomery multiplication (CIOS), returns left * right / 2^256
+static void mont_mul(uint64_t* target, const uint64_t* left, const uint64_t* right, const uint64_t* modulus, uint64_t modulus_inv)
+{
+    uint64_t acc[LIMB_COUNT + 2] = { 0 };
+    for (size_t outer = 0; outer < LIMB_COUNT; outer++)
+    {
+        uint128 product;
+        uint64_t carry = 0;
+        uint64_t factor;
+        for (size_t inner = 0; inner < LIMB_COUNT; inner++)
+        {
+            product = ((uint128)left[inner] * right[outer]) + acc[inner] + carry;
+            acc[inner] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        product = (uint128)acc[LIMB_COUNT] + carry;
+        acc[LIMB_COUNT] = (uint64_t)product;
+        acc[LIMB_COUNT + 1] = (uint64_t)(product >> 64);
+
+        // Adding factor * modulus clears the low word, which then shifts out
+        factor = acc[0] * modulus_inv;
+        product = ((uint128)factor * modulus[0]) + acc[0];
+        carry = (uint64_t)(product >> 64);
+        for (size_t inner = 1; inner < LIMB_COUNT; inner++)
+        {
+            product = ((uint128)factor * modulus[inner]) + acc[inner] + carry;
+            acc[inner - 1] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        product = (uint128)acc[LIMB_COUNT] + carry;
+        acc[LIMB_COUNT - 1] = (uint64_t)product;
+        acc[LIMB_COUNT] = acc[LIMB_COUNT + 1] + (uint64_t)(product >> 64);
+    }
+    reduce_once(target, acc, acc[LIMB_COUNT], modulus);
+}
+
+// Exponent is public, only the base is secret
+static void mont_pow(uint64_t* target, const uint64_t* base, const uint64_t* exponent, const uint64_t* one, const uint64_t* modulus, uint64_t modulus_inv)
+{
+    FIELD_ELEMENT result;
+    limbs_copy(result, one);
+    for (size_t bit = LIMB_COUNT * 64; bit > 0; bit--)
+    {
+        mont_mul(result, result, result, modulus, modulus_inv);
+        if ((exponent[(bit - 1) / 64] >> ((bit - 1) % 64)) & 1)
+        {
+            mont_mul(result, result, base, modulus, modulus_inv);
+        }
+    }
+    limbs_copy(target, result);
+}
+
+static void fe_mul(uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mont_mul(target, left, right, P256_P, P256_P_INV);
+}
+
+static void fe_sq(uint64_t* target, const uint64_t* value)
+{
+    mont_mul(target, value, value, P256_P, P256_P_INV);
+}
+
+static void fe_add(uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mod_add(target, left, right, P256_P);
+}
+
+static void fe_sub(uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mod_sub(target, left, right, P256_P);
+}
+
+static void fe_neg(uint64_t* target, const uint64_t* value)
+{
+    static const FIELD_ELEMENT zero = { 0 };
+    mod_sub(target, zero, value, P256_P);
+}
+
+static void fe_to_mont(uint64_t* target, const uint64_t* value)
+{
+    fe_mul(target, value, P256_RR_P);
+}
+
+static void fe_from_mont(uint64_t* target, const uint64_t* value)
+{
+    static const FIELD_ELEMENT plain_one = { 1, 0, 0, 0 };
+    fe_mul(target, value, plain_one);
+}
+
+// value^(p - 2), Fermat inversion in constant time
+static void fe_invert(uint64_t* target, const uint64_t* value)
+{
+    static const FIELD_ELEMENT exponent = { 0xfffffffffffffffdULL, 0x00000000ffffffffULL, 0x0000000000000000ULL, 0xffffffff00000001ULL };
+    mont_pow(target, value, exponent, P256_ONE, P256_P, P256_P_INV);
+}
+
+static void sc_mul(uint64_t* target, const uint64_t* left, const uint64_t* right)
+{
+    mont_mul(target, left, right, P256_N, P256_N_INV);
+}
+
+static void sc_to_mont(uint64_t* target, const uint64_t* value)
+{
+    sc_mul(target, value, P256_RR_N);
+}
+
+static void sc_from_mont(uint64_t* target, const uint64_t* value)
+{
+    static const FIELD_ELEMENT plain_one = { 1, 0, 0, 0 };
+    sc_mul(target, value, plain_one);
+}
+
+static void sc_invert(uint64_t* target, const uint64_t* value)
+{
+    static const FIELD_ELEMENT exponent = { 0xf3b9cac2fc63254fULL, 0xbce6faada7179e84ULL, 0xffffffffffffffffULL, 0xffffffff00000000ULL };
+    static const FIELD_ELEMENT plain_one = { 1, 0, 0, 0 };
+    FIELD_ELEMENT one;
+    sc_to_mont(one, plain_one);
+    mont_pow(target, value, exponent, one, P256_N, P256_N_INV);
+}
+
+// A scalar usable as a private key or signature half lies in [1, n - 1]
+static bool scalar_in_range(const uint64_t* scalar)
+{
+    return limbs_is_zero(scalar) == 0 && limbs_less_than(scalar, P256_N) == 1;
+}
+
+// Leftmost 256 bits of the digest, reduced once below n
+static void digest_to_scalar(uint64_t* target, const unsigned char* digest, size_t digest_len)
+{
+    unsigned char padded[SCALAR_SIZE] = { 0 };
+    size_t used = digest_len < SCALAR_SIZE ? digest_len : SCALAR_SIZE;
+    memcpy(padded + (SCALAR_SIZE - used), digest, used);
+    limbs_from_bytes(target, padded);
+    reduce_once(target, target, 0, P256_N);
+}
+
+static void point_identity(P256_POINT* point)
+{
+    memset(point, 0, sizeof(P256_POINT));
+    limbs_copy(point->y, P256_ONE);
+}
+
+static void point_cmov(P256_POINT* target, const P256_POINT* src, uint64_t move)
+{
+    limbs_cmov(target->x, src->x, move);
+    limbs_cmov(target->y, src->y, move);
+    limbs_cmov(target->z, src->z, move);
+}
+
+// Complete formulas for a = -3 (Renes, Costello, Batina 2016, algorithms
+// 4 to 6).  They hold for every input including the identity and P + P, so
+// the constant time paths need no special cases.
+static void point_double(P256_POINT* result, const P256_POINT* point)
+{
+    FIELD_ELEMENT t0, t1, t2, t3, x3, y3, z3;
+    fe_sq(t0, point->x);
+    fe_sq(t1, point->y);
+    fe_sq(t2, point->z);
+    fe_mul(t3, point->x, point->y);
+    fe_add(t3, t3, t3);
+    fe_mul(z3, point->x, point->z);
+    fe_add(z3, z3, z3);
+    fe_mul(y3, P256_B, t2);
+    fe_sub(y3, y3, z3);
+    fe_add(x3, y3, y3);
+    fe_add(y3, x3, y3);
+    fe_sub(x3, t1, y3);
+    fe_add(y3, t1, y3);
+    fe_mul(y3, x3, y3);
+    fe_mul(x3, x3, t3);
+    fe_add(t3, t2, t2);
+    fe_add(t2, t2, t3);
+    fe_mul(z3, P256_B, z3);
+    fe_sub(z3, z3, t2);
+    fe_sub(z3, z3, t0);
+    fe_add(t3, z3, z3);
+    fe_add(z3, z3, t3);
+    fe_add(t3, t0, t0);
+    fe_add(t0, t3, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t0, t0, z3);
+    fe_add(y3, y3, t0);
+    fe_mul(t0, point->y, point->z);
+    fe_add(t0, t0, t0);
+    fe_mul(z3, t0, z3);
+    fe_sub(x3, x3, z3);
+    fe_mul(z3, t0, t1);
+    fe_add(z3, z3, z3);
+    fe_add(z3, z3, z3);
+    limbs_copy(result->x, x3);
+    limbs_copy(result->y, y3);
+    limbs_copy(result->z, z3);
+}
+
+static void point_add(P256_POINT* result, const P256_POINT* left, const P256_POINT* right)
+{
+    FIELD_ELEMENT t0, t1, t2, t3, t4, x3, y3, z3;
+    fe_mul(t0, left->x, right->x);
+    fe_mul(t1, left->y, right->y);
+    fe_mul(t2, left->z, right->z);
+    fe_add(t3, left->x, left->y);
+    fe_add(t4, right->x, right->y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_add(t4, left->y, left->z);
+    fe_add(x3, right->y, right->z);
+    fe_mul(t4, t4, x3);
+    fe_add(x3, t1, t2);
+    fe_sub(t4, t4, x3);
+    fe_add(x3, left->x, left->z);
+    fe_add(y3, right->x, right->z);
+    fe_mul(x3, x3, y3);
+    fe_add(y3, t0, t2);
+    fe_sub(y3, x3, y3);
+    fe_mul(z3, P256_B, t2);
+    fe_sub(x3, y3, z3);
+    fe_add(z3, x3, x3);
+    fe_add(x3, x3, z3);
+    fe_sub(z3, t1, x3);
+    fe_add(x3, t1, x3);
+    fe_mul(y3, P256_B, y3);
+    fe_add(t1, t2, t2);
+    fe_add(t2, t1, t2);
+    fe_sub(y3, y3, t2);
+    fe_sub(y3, y3, t0);
+    fe_add(t1, y3, y3);
+    fe_add(y3, t1, y3);
+    fe_add(t1, t0, t0);
+    fe_add(t0, t1, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t1, t4, y3);
+    fe_mul(t2, t0, y3);
+    fe_mul(y3, x3, z3);
+    fe_add(y3, y3, t2);
+    fe_mul(x3, x3, t3);
+    fe_sub(x3, x3, t1);
+    fe_mul(z3, z3, t4);
+    fe_mul(t1, t3, t0);
+    fe_add(z3, z3, t1);
+    limbs_copy(result->x, x3);
+    limbs_copy(result->y, y3);
+    limbs_copy(result->z, z3);
+}
+
+// Mixed addition with an affine point, which can not be the identity
+static void point_add_affine(P256_POINT* result, const P256_POINT* left, const P256_AFFINE* right)
+{
+    FIELD_ELEMENT t0, t1, t2, t3, t4, x3, y3, z3;
+    fe_mul(t0, left->x, right->x);
+    fe_mul(t1, left->y, right->y);
+    fe_add(t3, right->x, right->y);
+    fe_add(t4, left->x, left->y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_mul(t4, right->y, left->z);
+    fe_add(t4, t4, left->y);
+    fe_mul(y3, right->x, left->z);
+    fe_add(y3, y3, left->x);
+    fe_mul(z3, P256_B, left->z);
+    fe_sub(x3, y3, z3);
+    fe_add(z3, x3, x3);
+    fe_add(x3, x3, z3);
+    fe_sub(z3, t1, x3);
+    fe_add(x3, t1, x3);
+    fe_mul(y3, P256_B, y3);
+    fe_add(t1, left->z, left->z);
+    fe_add(t2, t1, left->z);
+    fe_sub(y3, y3, t2);
+    fe_sub(y3, y3, t0);
+    fe_add(t1, y3, y3);
+    fe_add(y3, t1, y3);
+    fe_add(t1, t0, t0);
+    fe_add(t0, t1, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t1, t4, y3);
+    fe_mul(t2, t0, y3);
+    fe_mul(y3, x3, z3);
+    fe_add(y3, y3, t2);
+    fe_mul(x3, x3, t3);
+    fe_sub(x3, x3, t1);
+    fe_mul(z3, z3, t4);
+    fe_mul(t1, t3, t0);
+    fe_add(z3, z3, t1);
+    limbs_copy(result->x, x3);
+    limbs_copy(result->y, y3);
+    limbs_copy(result->z, z3);
+}
+
+// One inversion for the whole batch (Montgomery's trick), no Z may be zero
+static void points_to_affine(P256_AFFINE* result, const P256_POINT* points, size_t count)
+{
+    FIELD_ELEMENT prefix[BASE_ODD_COUNT];
+    FIELD_ELEMENT inverse, z_inverse;
+    limbs_copy(prefix[0], points[0].z);
+    for (size_t index = 1; index < count; index++)
+    {
+        fe_mul(prefix[index], prefix[index - 1], points[index].z);
+    }
+    fe_invert(inverse, prefix[count - 1]);
+    for (size_t index = count; index > 0; index--)
+    {
+        if (index > 1)
+        {
+            fe_mul(z_inverse, inverse, prefix[index - 2]);
+            fe_mul(inverse, inverse, points[index - 1].z);
+        }
+        else
+        {
+            limbs_copy(z_inverse, inverse);
+        }
+        fe_mul(result[index - 1].x, points[index - 1].x, z_inverse);
+        fe_mul(result[index - 1].y, points[index - 1].y, z_inverse);
+    }
+}
+
+// Built once per process on first use
+static void build_tables(void)
+{
+    P256_POINT row_base;
+    P256_POINT multiples[BASE_ODD_COUNT];
+    P256_POINT twice;
+
+    limbs_copy(row_base.x, P256_GX);
+    limbs_copy(row_base.y, P256_GY);
+    limbs_copy(row_base.z, P256_ONE);
+    for (size_t row = 0; row < DIGIT_COUNT; row++)
+    {
+        multiples[0] = row_base;
+        for (size_t column = 1; column < COMB_COLUMNS; column++)
+        {
+            point_add(&multiples[column], &multiples[column - 1], &row_base);
+        }
+        points_to_affine(g_comb_table[row], multiples, COMB_COLUMNS);
+        for (size_t doubling = 0; doubling < 4; doubling++)
+        {
+            point_double(&row_base, &row_base);
+        }
+    }
+
+    // G, 3G, 5G ... for the verification wNAF
+    limbs_copy(multiples[0].x, P256_GX);
+    limbs_copy(multiples[0].y, P256_GY);
+    limbs_copy(multiples[0].z, P256_ONE);
+    point_double(&twice, &multiples[0]);
+    for (size_t index = 1; index < BASE_ODD_COUNT; index++)
+    {
+        point_add(&multiples[index], &multiples[index - 1], &twice);
+    }
+    points_to_affine(g_base_odd, multiples, BASE_ODD_COUNT);
+}
+
+static int ensure_tables(void)
+{
+    int result;
+    if (pthread_once(&g_table_once, build_tables) != 0)
+    {
+        log_error("Failure building p256 base tables");
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+// Signed radix 16, every digit in [-8, 8]
+static void scalar_to_digits(signed char digits[DIGIT_COUNT], const uint64_t* scalar)
+{
+    signed char carry = 0;
+    for (size_t index = 0; index < DIGIT_COUNT - 1; index++)
+    {
+        int value = (int)((scalar[index / 16] >> ((index % 16) * 4)) & 15) + carry;
+        carry = (signed char)((value + 8) >> 4);
+        digits[index] = (signed char)(value - (carry * 16));
+    }
+    digits[DIGIT_COUNT - 1] = carry;
+}
+
+static uint64_t equal_mask(uint32_t left, uint32_t right)
+{
+    return (uint64_t)(((left ^ right) - 1) >> 31);
+}
+
+static void digit_split(signed char digit, uint32_t* magnitude, uint64_t* negative)
+{
+    int32_t sign_mask = (int32_t)digit >> 31;
+    *negative = (uint64_t)(sign_mask & 1);
+    *magnitude = (uint32_t)((digit ^ sign_mask) - sign_mask);
+}
+
+// Reads every column so the access pattern does not depend on the digit.
+// A zero digit leaves column one selected, the caller discards the sum.
+static void select_comb(P256_AFFINE* result, size_t row, signed char digit)
+{
+    FIELD_ELEMENT negated_y;
+    uint32_t magnitude;
+    uint64_t negative;
+    digit_split(digit, &magnitude, &negative);
+
+    *result = g_comb_table[row][0];
+    for (size_t column = 1; column < COMB_COLUMNS; column++)
+    {
+        uint64_t move = equal_mask(magnitude, (uint32_t)column + 1);
+        limbs_cmov(result->x, g_comb_table[row][column].x, move);
+        limbs_cmov(result->y, g_comb_table[row][column].y, move);
+    }
+    fe_neg(negated_y, result->y);
+    limbs_cmov(result->y, negated_y, negative);
+}
+
+static void base_multiply(P256_POINT* result, const uint64_t* scalar)
+{
+    signed char digits[DIGIT_COUNT];
+    P256_AFFINE entry;
+    P256_POINT sum;
+    scalar_to_digits(digits, scalar);
+
+    point_identity(result);
+    for (size_t row = 0; row < DIGIT_COUNT; row++)
+    {
+        select_comb(&entry, row, digits[row]);
+        point_add_affine(&sum, result, &entry);
+        point_cmov(result, &sum, (uint64_t)(digits[row] != 0));
+    }
+    secure_zero(digits, sizeof(digits));
+}
+
+// Fixed window over signed radix-16 digits, constant time in the scalar
+static void point_multiply(P256_POINT* result, const P256_POINT* point, const uint64_t* scalar)
+{
+    signed char digits[DIGIT_COUNT];
+    P256_POINT multiples[COMB_COLUMNS];
+    P256_POINT entry;
+    FIELD_ELEMENT negated_y;
+    scalar_to_digits(digits, scalar);
+
+    multiples[0] = *point;
+    point_double(&multiples[1], point);
+    for (size_t index = 2; index < COMB_COLUMNS; index++)
+    {
+        point_add(&multiples[index], &multiples[index - 1], point);
+    }
+
+    point_identity(result);
+    for (size_t index = DIGIT_COUNT; index > 0; index--)
+    {
+        uint32_t magnitude;
+        uint64_t negative;
+        if (index < DIGIT_COUNT)
+        {
+            for (size_t doubling = 0; doubling < 4; doubling++)
+            {
+                point_double(result, result);
+            }
+        }
+        digit_split(digits[index - 1], &magnitude, &negative);
+        point_identity(&entry);
+        for (size_t column = 0; column < COMB_COLUMNS; column++)
+        {
+            point_cmov(&entry, &multiples[column], equal_mask(magnitude, (uint32_t)column + 1));
+        }
+        fe_neg(negated_y, entry.y);
+        limbs_cmov(entry.y, negated_y, negative);
+        point_add(result, result, &entry);
+    }
+    secure_zero(digits, sizeof(digits));
+}
+
+// Width w non-adjacent form, variable time so only for public scalars
+static size_t scalar_to_wnaf(signed char* digits, const uint64_t* scalar, unsigned int width)
+{
+    uint64_t value[LIMB_COUNT + 1] = { scalar[0], scalar[1], scalar[2], scalar[3], 0 };
+    size_t length = 0;
+    memset(digits, 0, WNAF_MAX_DIGITS);
+    while ((value[0] | value[1] | value[2] | value[3] | value[4]) != 0)
+    {
+        if (value[0] & 1)
+        {
+            int digit = (int)(value[0] & ((1u << width) - 1));
+            uint64_t carry;
+            if (digit >= (1 << (width - 1)))
+            {
+                digit -= (1 << width);
+            }
+            digits[length] = (signed char)digit;
+            // value -= digit, which only touches the low word's low bits
+            // and may carry or borrow upwards
+            if (digit > 0)
+            {
+                carry = value[0] < (uint64_t)digit;
+                value[0] -= (uint64_t)digit;
+                for (size_t index = 1; index <= LIMB_COUNT && carry; index++)
+                {
+                    carry = value[index] == 0;
+                    value[index]--;
+                }
+            }
+            else
+            {
+                value[0] += (uint64_t)(-digit);
+                carry = value[0] < (uint64_t)(-digit);
+                for (size_t index = 1; index <= LIMB_COUNT && carry; index++)
+                {
+                    value[index]++;
+                    carry = value[index] == 0;
+                }
+            }
+        }
+        for (size_t index = 0; index < LIMB_COUNT; index++)
+        {
+            value[index] = (value[index] >> 1) | (value[index + 1] << 63);
+        }
+        value[LIMB_COUNT] >>= 1;
+        length++;
+    }
+    return length;
+}
+
+// u1 * G + u2 * Q with one shared run of doublings (Shamir's trick)
+static void double_multiply_vartime(P256_POINT* result, const uint64_t* u1, const P256_POINT* point, const uint64_t* u2)
+{
+    signed char base_digits[WNAF_MAX_DIGITS];
+    signed char point_digits[WNAF_MAX_DIGITS];
+    P256_POINT point_odd[POINT_ODD_COUNT];
+    P256_POINT twice;
+    size_t base_len = scalar_to_wnaf(base_digits, u1, BASE_WNAF_WIDTH);
+    size_t point_len = scalar_to_wnaf(point_digits, u2, POINT_WNAF_WIDTH);
+    size_t length = base_len > point_len ? base_len : point_len;
+
+    point_odd[0] = *point;
+    point_double(&twice, point);
+    for (size_t index = 1; index < POINT_ODD_COUNT; index++)
+    {
+        point_add(&point_odd[index], &point_odd[index - 1], &twice);
+    }
+
+    point_identity(result);
+    for (size_t index = length; index > 0; index--)
+    {
+        signed char digit;
+        point_double(result, result);
+        if ((digit = base_digits[index - 1]) != 0)
+        {
+            P256_AFFINE entry = g_base_odd[(digit < 0 ? -digit : digit) / 2];
+            if (digit < 0)
+            {
+                fe_neg(entry.y, entry.y);
+            }
+            point_add_affine(result, result, &entry);
+        }
+        if ((digit = point_digits[index - 1]) != 0)
+        {
+            P256_POINT entry = point_odd[(digit < 0 ? -digit : digit) / 2];
+            if (digit < 0)
+            {
+                fe_neg(entry.y, entry.y);
+            }
+            point_add(result, result, &entry);
+        }
+    }
+}
+
+static int decode_private_key(uint64_t* scalar, const unsigned char* private_key)
+{
+    int result;
+    limbs_from_bytes(scalar, private_key);
+    if (!scalar_in_range(scalar))
+    {
+        log_error("Failure private key out of range");
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+// Uncompressed points only, coordinates must be reduced and satisfy
+// y^2 = x^3 - 3x + b
+static int decode_public_key(P256_POINT* point, const unsigned char* public_key)
+{
+    int result;
+    FIELD_ELEMENT x, y, lhs, rhs, three_x;
+    limbs_from_bytes(x, public_key + 1);
+    limbs_from_bytes(y, public_key + 1 + SCALAR_SIZE);
+    if (public_key[0] != 0x04 || limbs_less_than(x, P256_P) == 0 || limbs_less_than(y, P256_P) == 0)
+    {
+        log_error("Failure invalid public key encoding");
+        result = __LINE__;
+    }
+    else
+    {
+        fe_to_mont(point->x, x);
+        fe_to_mont(point->y, y);
+        limbs_copy(point->z, P256_ONE);
+
+        fe_sq(lhs, point->y);
+        fe_sq(rhs, point->x);
+        fe_mul(rhs, rhs, point->x);
+        fe_add(three_x, point->x, point->x);
+        fe_add(three_x, three_x, point->x);
+        fe_sub(rhs, rhs, three_x);
+        fe_add(rhs, rhs, P256_B);
+        if (limbs_equal(lhs, rhs) == 0)
+        {
+            log_error("Failure public key is not on the curve");
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+// Plain (not Montgomery) affine X, fails for the identity
+static int point_affine_x(uint64_t* x, uint64_t* y, const P256_POINT* point)
+{
+    int result;
+    if (limbs_is_zero(point->z))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        FIELD_ELEMENT z_inverse;
+        fe_invert(z_inverse, point->z);
+        fe_mul(x, point->x, z_inverse);
+        fe_from_mont(x, x);
+        if (y != NULL)
+        {
+            fe_mul(y, point->y, z_inverse);
+            fe_from_mont(y, y);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static int decode_signature(uint64_t* r, uint64_t* s, const unsigned char* signature)
+{
+    int result;
+    limbs_from_bytes(r, signature);
+    limbs_from_bytes(s, signature + SCALAR_SIZE);
+    if (!scalar_in_range(r) || !scalar_in_range(s))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static int random_scalar(uint64_t* scalar)
+{
+    int result = __LINE__;
+    unsigned char bytes[SCALAR_SIZE];
+    // Rejection sampling, n is so close to 2^256 that a retry is very rare
+    for (size_t attempt = 0; attempt < MAX_SIGN_ATTEMPTS && result != 0; attempt++)
+    {
+        if (crypto_drbg_random_bytes(bytes, sizeof(bytes)) != 0)
+        {
+            break;
+        }
+        limbs_from_bytes(scalar, bytes);
+        if (scalar_in_range(scalar))
+        {
+            result = 0;
+        }
+    }
+    secure_zero(bytes, sizeof(bytes));
+    return result;
+}
+
+int crypto_p256_public_key(unsigned char* public_key, const unsigned char* private_key)
+{
+    int result;
+    FIELD_ELEMENT scalar;
+    if (public_key == NULL || private_key == NULL)
+    {
+        log_error("Failure invalid parameter specified public_key: %p, private_key: %p", public_key, private_key);
+        result = __LINE__;
+    }
+    else if (decode_private_key(scalar, private_key) != 0 || ensure_tables() != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        P256_POINT point;
+        FIELD_ELEMENT x, y;
+        base_multiply(&point, scalar);
+        (void)point_affine_x(x, y, &point);
+        public_key[0] = 0x04;
+        limbs_to_bytes(public_key + 1, x);
+        limbs_to_bytes(public_key + 1 + SCALAR_SIZE, y);
+        result = 0;
+    }
+    secure_zero(scalar, sizeof(scalar));
+    return result;
+}
+
+int crypto_p256_keypair(unsigned char* private_key, unsigned char* public_key)
+{
+    int result;
+    FIELD_ELEMENT scalar;
+    if (private_key == NULL || public_key == NULL)
+    {
+        log_error("Failure invalid parameter specified private_key: %p, public_key: %p", private_key, public_key);
+        result = __LINE__;
+    }
+    else if (random_scalar(scalar) != 0)
+    {
+        log_error("Failure generating private key");
+        result = __LINE__;
+    }
+    else
+    {
+        limbs_to_bytes(private_key, scalar);
+        if (crypto_p256_public_key(public_key, private_key) != 0)
+        {
+            secure_zero(private_key, P256_PRIVATE_KEY_SIZE);
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    secure_zero(scalar, sizeof(scalar));
+    return result;
+}
+
+int crypto_p256_ecdh(unsigned char* shared_secret, const unsigned char* private_key, const unsigned char* peer_public_key)
+{
+    int result;
+    FIELD_ELEMENT scalar;
+    P256_POINT peer;
+    if (shared_secret == NULL || private_key == NULL || peer_public_key == NULL)
+    {
+        log_error("Failure invalid parameter specified shared_secret: %p, private_key: %p, peer_public_key: %p", shared_secret, private_key, peer_public_key);
+        result = __LINE__;
+    }
+    else if (decode_private_key(scalar, private_key) != 0 || decode_public_key(&peer, peer_public_key) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        P256_POINT shared;
+        FIELD_ELEMENT x;
+        point_multiply(&shared, &peer, scalar);
+        if (point_affine_x(x, NULL, &shared) != 0)
+        {
+            log_error("Failure shared point is the identity");
+            result = __LINE__;
+        }
+        else
+        {
+            limbs_to_bytes(shared_secret, x);
+            result = 0;
+        }
+        secure_zero(x, sizeof(x));
+        secure_zero(&shared, sizeof(shared));
+    }
+    secure_zero(scalar, sizeof(scalar));
+    return result;
+}
+
+int crypto_p256_sign(unsigned char* signature, const unsigned char* private_key, const unsigned char* digest, size_t digest_len)
+{
+    int result;
+    FIELD_ELEMENT private_scalar;
+    if (signature == NULL || private_key == NULL || digest == NULL || digest_len == 0)
+    {
+        log_error("Failure invalid parameter specified signature: %p, private_key: %p, digest: %p, digest_len: %d", signature, private_key, digest, (int)digest_len);
+        result = __LINE__;
+    }
+    else if (decode_private_key(private_scalar, private_key) != 0 || ensure_tables() != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        FIELD_ELEMENT e_mont, d_mont, nonce, r, s, x;
+        P256_POINT point;
+        digest_to_scalar(e_mont, digest, digest_len);
+        sc_to_mont(e_mont, e_mont);
+        sc_to_mont(d_mont, private_scalar);
+
+        result = __LINE__;
+        for (size_t attempt = 0; attempt < MAX_SIGN_ATTEMPTS && result != 0; attempt++)
+        {
+            if (random_scalar(nonce) != 0)
+            {
+                log_error("Failure generating signature nonce");
+                break;
+            }
+            // r = x(k * G) mod n
+            base_multiply(&point, nonce);
+            (void)point_affine_x(x, NULL, &point);
+            reduce_once(r, x, 0, P256_N);
+            if (limbs_is_zero(r) == 0)
+            {
+                // s = k^-1 * (e + r * d) mod n
+                FIELD_ELEMENT r_mont, k_inverse;
+                sc_to_mont(nonce, nonce);
+                sc_invert(k_inverse, nonce);
+                sc_to_mont(r_mont, r);
+                sc_mul(s, r_mont, d_mont);
+                mod_add(s, s, e_mont, P256_N);
+                sc_mul(s, s, k_inverse);
+                sc_from_mont(s, s);
+                secure_zero(k_inverse, sizeof(k_inverse));
+                if (limbs_is_zero(s) == 0)
+                {
+                    limbs_to_bytes(signature, r);
+                    limbs_to_bytes(signature + SCALAR_SIZE, s);
+                    result = 0;
+                }
+            }
+        }
+        secure_zero(nonce, sizeof(nonce));
+        secure_zero(d_mont, sizeof(d_mont));
+        secure_zero(&point, sizeof(point));
+    }
+    secure_zero(private_scalar, sizeof(private_scalar));
+    return result;
+}
+
+int crypto_p256_verify(const unsigned char* public_key, const unsigned char* digest, size_t digest_len, const unsigned char* signature)
+{
+    int result;
+    FIELD_ELEMENT r, s;
+    P256_POINT point;
+    if (public_key == NULL || digest == NULL || digest_len == 0 || signature == NULL)
+    {
+        log_error("Failure invalid parameter specified public_key: %p, digest: %p, digest_len: %d, signature: %p", public_key, digest, (int)digest_len, signature);
+        result = __LINE__;
+    }
+    else if (decode_signature(r, s, signature) != 0)
+    {
+        result = __LINE__;
+    }
+    else if (decode_public_key(&point, public_key) != 0 || ensure_tables() != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        FIELD_ELEMENT e_mont, w, u1, u2, r_mont, r_field, expected;
+        P256_POINT sum;
+        digest_to_scalar(e_mont, digest, digest_len);
+        sc_to_mont(e_mont, e_mont);
+        sc_to_mont(w, s);
+        sc_invert(w, w);
+        sc_to_mont(r_mont, r);
+        sc_mul(u1, e_mont, w);
+        sc_from_mont(u1, u1);
+        sc_mul(u2, r_mont, w);
+        sc_from_mont(u2, u2);
+
+        double_multiply_vartime(&sum, u1, &point, u2);
+
+        // x(sum) mod n == r without an inversion: X == r * Z, or (r + n) * Z
+        // when r + n is still below p
+        fe_to_mont(r_field, r);
+        fe_mul(expected, r_field, sum.z);
+        if (limbs_is_zero(sum.z))
+        {
+            result = __LINE__;
+        }
+        else if (limbs_equal(expected, sum.x))
+        {
+            result = 0;
+        }
+        else
+        {
+            FIELD_ELEMENT r_plus_n;
+            uint64_t carry = 0;
+            for (size_t index = 0; index < LIMB_COUNT; index++)
+            {
+                uint128 total = (uint128)r[index] + P256_N[index] + carry;
+                r_plus_n[index] = (uint64_t)total;
+                carry = (uint64_t)(total >> 64);
+            }
+            result = __LINE__;
+            if (carry == 0 && limbs_less_than(r_plus_n, P256_P))
+            {
+                fe_to_mont(r_field, r_plus_n);
+                fe_mul(expected, r_field, sum.z);
+                if (limbs_equal(expected, sum.x))
+                {
+                    result = 0;
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,564 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_pbkdf2.h"
+#include "cablelock/crypto_sha256.h"
+#include "cablelock/crypto_macro.h"
+
+// The lane kernel uses gcc vector extensions, which lower to whatever the
+// target offers.  On x86 a second copy is built for AVX2, and cpus with the
+// SHA extensions run each block through those instead, both picked at run time.
+#if defined(__GNUC__)
+    #define PBKDF2_LANES_VECTOR
+    #if defined(__x86_64__) || defined(__i386__)
+        #define PBKDF2_X86
+        #define AVX2_TARGET     __attribute__((target("avx2")))
+        #define SHANI_TARGET    __attribute__((target("sha,sse4.1,ssse3")))
+        #include <cpuid.h>
+        #include <immintrin.h>
+    #endif
+#endif
+
+// CPUID leaf 7, EBX
+#define CPUID_SHA_BIT           (1u << 29)
+
+// Every iteration hashes a 32 byte digest after a 64 byte pad, so both
+// blocks are the digest, the 0x80 terminator and a bit length of 768
+#define DIGEST_WORDS            (SHA256_DIGEST_SIZE / 4)
+#define PADDING_WORD            0x80000000u
+#define MESSAGE_BITS            ((SHA256_BLOCK_SIZE + SHA256_DIGEST_SIZE) * 8)
+
+#define ROTR(x, n)              (((x) >> (n)) | ((x) << (32 - (n))))
+#define CHOOSE(x, y, z)         (((x) & (y)) ^ (~(x) & (z)))
+#define MAJORITY(x, y, z)       (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define BIG_SIGMA0(x)           (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define BIG_SIGMA1(x)           (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SMALL_SIGMA0(x)         (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SMALL_SIGMA1(x)         (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+static const uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// One output block of one job
+typedef struct PBKDF2_LANE_TAG
+{
+    CRYPTO_HMAC_SHA256_KEY key;
+    // Previous U and the running XOR of every U
+    uint32_t previous[DIGEST_WORDS];
+    uint32_t accumulated[DIGEST_WORDS];
+    unsigned char* output;
+    size_t output_len;
+} PBKDF2_LANE;
+
+// Walks the jobs one output block at a time
+typedef struct PBKDF2_CURSOR_TAG
+{
+    const CRYPTO_PBKDF2_JOB* jobs;
+    size_t job_count;
+    size_t job_index;
+    uint32_t block_index;
+} PBKDF2_CURSOR;
+
+static void iterate_single_portable(PBKDF2_LANE* lane, uint32_t iterations)
+{
+    unsigned char inner_block[SHA256_BLOCK_SIZE] = { 0 };
+    unsigned char outer_block[SHA256_BLOCK_SIZE] = { 0 };
+    uint32_t state[SHA256_STATE_WORDS];
+
+    inner_block[SHA256_DIGEST_SIZE] = 0x80;
+    store_be32(inner_block + SHA256_BLOCK_SIZE - 4, MESSAGE_BITS);
+    memcpy(outer_block, inner_block, sizeof(outer_block));
+
+    for (uint32_t iteration = 1; iteration < iterations; iteration++)
+    {
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            store_be32(inner_block + (index * 4), lane->previous[index]);
+        }
+        memcpy(state, lane->key.inner_state, sizeof(state));
+        crypto_sha256_compress(state, inner_block);
+
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            store_be32(outer_block + (index * 4), state[index]);
+        }
+        memcpy(state, lane->key.outer_state, sizeof(state));
+        crypto_sha256_compress(state, outer_block);
+
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            lane->previous[index] = state[index];
+            lane->accumulated[index] ^= state[index];
+        }
+    }
+    secure_zero(inner_block, sizeof(inner_block));
+    secure_zero(outer_block, sizeof(outer_block));
+    secure_zero(state, sizeof(state));
+}
+
+#ifdef PBKDF2_X86
+
+#define CPU_FEATURE_AVX2        0x01
+#define CPU_FEATURE_SHA         0x02
+
+static int g_cpu_features = -1;
+
+static int cpu_features(void)
+{
+    int result = __atomic_load_n(&g_cpu_features, __ATOMIC_RELAXED);
+    if (result < 0)
+    {
+        unsigned int eax, ebx, ecx, edx;
+        result = 0;
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            result |= CPU_FEATURE_AVX2;
+        }
+        // Older compilers have no "sha" name for __builtin_cpu_supports
+        if (__get_cpuid_max(0, NULL) >= 7 && __builtin_cpu_supports("sse4.1"))
+        {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            if ((ebx & CPUID_SHA_BIT) != 0)
+            {
+                result |= CPU_FEATURE_SHA;
+            }
+        }
+        __atomic_store_n(&g_cpu_features, result, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+static bool use_avx2(void)
+{
+    return (cpu_features() & CPU_FEATURE_AVX2) != 0;
+}
+
+static bool use_shani(void)
+{
+    return (cpu_features() & CPU_FEATURE_SHA) != 0;
+}
+
+// Compression of a digest sized message on the SHA extensions, the state is
+// regrouped as ABEF and CDGH for sha256rnds2 and back on the way out
+SHANI_TARGET static void compress_digest_shani(uint32_t* state, const uint32_t* message)
+{
+    __m128i schedule[4];
+    __m128i saved0;
+    __m128i saved1;
+    __m128i state0;
+    __m128i state1;
+    __m128i temp;
+
+    schedule[0] = _mm_loadu_si128((const __m128i*)message);
+    schedule[1] = _mm_loadu_si128((const __m128i*)(message + 4));
+    schedule[2] = _mm_set_epi32(0, 0, 0, (int)PADDING_WORD);
+    schedule[3] = _mm_set_epi32(MESSAGE_BITS, 0, 0, 0);
+
+    temp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0xB1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state + 4)), 0x1B);
+    state0 = _mm_alignr_epi8(temp, state1, 8);
+    state1 = _mm_blend_epi16(state1, temp, 0xF0);
+    saved0 = state0;
+    saved1 = state1;
+
+    for (size_t group = 0; group < 16; group++)
+    {
+        __m128i words;
+        if (group >= 4)
+        {
+            // W[t..t+3] from W[t-16..t-1], held in the other three slots
+            schedule[group & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(schedule[group & 3], schedule[(group + 1) & 3]),
+                _mm_alignr_epi8(schedule[(group + 3) & 3], schedule[(group + 2) & 3], 4)), schedule[(group + 3) & 3]);
+        }
+        words = _mm_add_epi32(schedule[group & 3], _mm_loadu_si128((const __m128i*)(round_constants + (group * 4))));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(words, 0x0E));
+    }
+
+    state0 = _mm_add_epi32(state0, saved0);
+    state1 = _mm_add_epi32(state1, saved1);
+    temp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(temp, state1, 0xF0));
+    _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(state1, temp, 8));
+}
+
+static void iterate_single_shani(PBKDF2_LANE* lane, uint32_t iterations)
+{
+    uint32_t state[SHA256_STATE_WORDS];
+    for (uint32_t iteration = 1; iteration < iterations; iteration++)
+    {
+        memcpy(state, lane->key.inner_state, sizeof(state));
+        compress_digest_shani(state, lane->previous);
+        memcpy(lane->previous, lane->key.outer_state, sizeof(state));
+        compress_digest_shani(lane->previous, state);
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            lane->accumulated[index] ^= lane->previous[index];
+        }
+    }
+    secure_zero(state, sizeof(state));
+}
+
+#endif
+
+static void iterate_single(PBKDF2_LANE* lane, uint32_t iterations)
+{
+#ifdef PBKDF2_X86
+    if (use_shani())
+    {
+        iterate_single_shani(lane, iterations);
+    }
+    else
+#endif
+    {
+        iterate_single_portable(lane, iterations);
+    }
+}
+
+#ifdef PBKDF2_LANES_VECTOR
+
+// Word i of every lane side by side
+typedef uint32_t LANE_WORDS __attribute__((vector_size(PBKDF2_SHA256_LANES * sizeof(uint32_t))));
+
+// Compression of a block that holds a 32 byte message after a 64 byte prefix
+static inline __attribute__((always_inline)) void compress_digest_lanes(LANE_WORDS* state, const LANE_WORDS* message)
+{
+    LANE_WORDS zero = { 0 };
+    LANE_WORDS schedule[16];
+    LANE_WORDS a = state[0], b = state[1], c = state[2], d = state[3];
+    LANE_WORDS e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (size_t index = 0; index < DIGEST_WORDS; index++)
+    {
+        schedule[index] = message[index];
+    }
+    schedule[8] = zero + PADDING_WORD;
+    for (size_t index = 9; index < 15; index++)
+    {
+        schedule[index] = zero;
+    }
+    schedule[15] = zero + MESSAGE_BITS;
+
+    for (size_t round = 0; round < 64; round++)
+    {
+        LANE_WORDS word;
+        LANE_WORDS temp1;
+        LANE_WORDS temp2;
+        if (round < 16)
+        {
+            word = schedule[round];
+        }
+        else
+        {
+            word = schedule[round & 15] + SMALL_SIGMA0(schedule[(round + 1) & 15]) + schedule[(round + 9) & 15] + SMALL_SIGMA1(schedule[(round + 14) & 15]);
+            schedule[round & 15] = word;
+        }
+        temp1 = h + BIG_SIGMA1(e) + CHOOSE(e, f, g) + round_constants[round] + word;
+        temp2 = BIG_SIGMA0(a) + MAJORITY(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+static inline __attribute__((always_inline)) void iterate_lanes_body(const LANE_WORDS* inner, const LANE_WORDS* outer,
+    LANE_WORDS* previous, LANE_WORDS* accumulated, uint32_t iterations)
+{
+    LANE_WORDS state[SHA256_STATE_WORDS];
+    for (uint32_t iteration = 1; iteration < iterations; iteration++)
+    {
+        memcpy(state, inner, sizeof(state));
+        compress_digest_lanes(state, previous);
+        memcpy(previous, outer, sizeof(state));
+        compress_digest_lanes(previous, state);
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            accumulated[index] ^= previous[index];
+        }
+    }
+    memset(state, 0, sizeof(state));
+}
+
+static void iterate_lanes_generic(const LANE_WORDS* inner, const LANE_WORDS* outer, LANE_WORDS* previous, LANE_WORDS* accumulated, uint32_t iterations)
+{
+    iterate_lanes_body(inner, outer, previous, accumulated, iterations);
+}
+
+#ifdef PBKDF2_X86
+AVX2_TARGET static void iterate_lanes_avx2(const LANE_WORDS* inner, const LANE_WORDS* outer, LANE_WORDS* previous, LANE_WORDS* accumulated, uint32_t iterations)
+{
+    iterate_lanes_body(inner, outer, previous, accumulated, iterations);
+}
+#endif
+
+static void iterate_group(PBKDF2_LANE* lanes, size_t lane_count, uint32_t iterations)
+{
+    LANE_WORDS inner[SHA256_STATE_WORDS];
+    LANE_WORDS outer[SHA256_STATE_WORDS];
+    LANE_WORDS previous[DIGEST_WORDS];
+    LANE_WORDS accumulated[DIGEST_WORDS];
+
+    // Idle lanes repeat the first one, their results are dropped
+    for (size_t lane = 0; lane < PBKDF2_SHA256_LANES; lane++)
+    {
+        const PBKDF2_LANE* source = &lanes[lane < lane_count ? lane : 0];
+        for (size_t index = 0; index < SHA256_STATE_WORDS; index++)
+        {
+            inner[index][lane] = source->key.inner_state[index];
+            outer[index][lane] = source->key.outer_state[index];
+        }
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            previous[index][lane] = source->previous[index];
+            accumulated[index][lane] = source->accumulated[index];
+        }
+    }
+
+#ifdef PBKDF2_X86
+    if (use_avx2())
+    {
+        iterate_lanes_avx2(inner, outer, previous, accumulated, iterations);
+    }
+    else
+#endif
+    {
+        iterate_lanes_generic(inner, outer, previous, accumulated, iterations);
+    }
+
+    for (size_t lane = 0; lane < lane_count; lane++)
+    {
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            lanes[lane].accumulated[index] = accumulated[index][lane];
+        }
+    }
+    secure_zero(inner, sizeof(inner));
+    secure_zero(outer, sizeof(outer));
+    secure_zero(previous, sizeof(previous));
+    secure_zero(accumulated, sizeof(accumulated));
+}
+
+static int g_kernel = CRYPTO_PBKDF2_KERNEL_AUTO;
+
+// A lone block is faster through the scalar compression, and the SHA
+// extensions beat eight AVX2 lanes block for block
+static bool use_lanes(size_t lane_count)
+{
+    bool result;
+    switch (__atomic_load_n(&g_kernel, __ATOMIC_RELAXED))
+    {
+        case CRYPTO_PBKDF2_KERNEL_SINGLE:
+            result = false;
+            break;
+        case CRYPTO_PBKDF2_KERNEL_LANES:
+            result = true;
+            break;
+        default:
+#ifdef PBKDF2_X86
+            result = lane_count > 1 && !use_shani();
+#else
+            result = lane_count > 1;
+#endif
+            break;
+    }
+    return result;
+}
+
+#endif
+
+// Block i of a job starts as U1 = HMAC(password, salt || INT(i))
+static int start_lane(PBKDF2_LANE* lane, const CRYPTO_PBKDF2_JOB* job, uint32_t block_index)
+{
+    int result;
+    if (crypto_hmac_sha256_key_init(&lane->key, job->password, job->password_len) != 0)
+    {
+        log_error("Failure initializing password key");
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_SHA256 sha;
+        unsigned char counter[4];
+        unsigned char first[SHA256_DIGEST_SIZE];
+        size_t offset = (size_t)(block_index - 1) * SHA256_DIGEST_SIZE;
+
+        store_be32(counter, block_index);
+        crypto_hmac_sha256_start(&lane->key, &sha);
+        crypto_sha256_update(&sha, job->salt, job->salt_len);
+        crypto_sha256_update(&sha, counter, sizeof(counter));
+        crypto_hmac_sha256_finish(&lane->key, &sha, first);
+        for (size_t index = 0; index < DIGEST_WORDS; index++)
+        {
+            lane->previous[index] = load_be32(first + (index * 4));
+            lane->accumulated[index] = lane->previous[index];
+        }
+        lane->output = job->output + offset;
+        lane->output_len = job->output_len - offset < SHA256_DIGEST_SIZE ? job->output_len - offset : SHA256_DIGEST_SIZE;
+        secure_zero(first, sizeof(first));
+        secure_zero(&sha, sizeof(sha));
+        result = 0;
+    }
+    return result;
+}
+
+static void finish_lane(PBKDF2_LANE* lane)
+{
+    unsigned char block[SHA256_DIGEST_SIZE];
+    for (size_t index = 0; index < DIGEST_WORDS; index++)
+    {
+        store_be32(block + (index * 4), lane->accumulated[index]);
+    }
+    memcpy(lane->output, block, lane->output_len);
+    secure_zero(block, sizeof(block));
+}
+
+// Fills up to PBKDF2_SHA256_LANES lanes with the next output blocks
+static int next_group(PBKDF2_CURSOR* cursor, PBKDF2_LANE* lanes, size_t* lane_count)
+{
+    int result = 0;
+    *lane_count = 0;
+    while (result == 0 && *lane_count < PBKDF2_SHA256_LANES && cursor->job_index < cursor->job_count)
+    {
+        const CRYPTO_PBKDF2_JOB* job = &cursor->jobs[cursor->job_index];
+        if ((size_t)cursor->block_index * SHA256_DIGEST_SIZE >= job->output_len)
+        {
+            cursor->job_index++;
+            cursor->block_index = 0;
+        }
+        else if ((result = start_lane(&lanes[*lane_count], job, cursor->block_index + 1)) == 0)
+        {
+            cursor->block_index++;
+            (*lane_count)++;
+        }
+    }
+    return result;
+}
+
+static bool job_valid(const CRYPTO_PBKDF2_JOB* job)
+{
+    // RFC 8018 caps the output at (2^32 - 1) blocks
+    return (job->password != NULL || job->password_len == 0) && (job->salt != NULL || job->salt_len == 0) &&
+        job->output != NULL && job->output_len > 0 && (uint64_t)job->output_len / SHA256_DIGEST_SIZE < UINT32_MAX;
+}
+
+int crypto_pbkdf2_sha256_batch(const CRYPTO_PBKDF2_JOB* jobs, size_t job_count, uint32_t iterations)
+{
+    int result;
+    bool jobs_valid = jobs != NULL && job_count > 0;
+    for (size_t index = 0; jobs_valid && index < job_count; index++)
+    {
+        jobs_valid = job_valid(&jobs[index]);
+    }
+
+    if (!jobs_valid || iterations == 0)
+    {
+        log_error("Failure invalid parameter specified jobs: %p, job_count: %d, iterations: %u", jobs, (int)job_count, iterations);
+        result = __LINE__;
+    }
+    else
+    {
+        PBKDF2_LANE lanes[PBKDF2_SHA256_LANES];
+        PBKDF2_CURSOR cursor = { jobs, job_count, 0, 0 };
+        size_t lane_count;
+        while ((result = next_group(&cursor, lanes, &lane_count)) == 0 && lane_count > 0)
+        {
+#ifdef PBKDF2_LANES_VECTOR
+            if (use_lanes(lane_count))
+            {
+                iterate_group(lanes, lane_count, iterations);
+            }
+            else
+#endif
+            {
+                for (size_t lane = 0; lane < lane_count; lane++)
+                {
+                    iterate_single(&lanes[lane], iterations);
+                }
+            }
+            for (size_t lane = 0; lane < lane_count; lane++)
+            {
+                finish_lane(&lanes[lane]);
+            }
+        }
+        secure_zero(lanes, sizeof(lanes));
+    }
+    return result;
+}
+
+int crypto_pbkdf2_sha256(const unsigned char* password, size_t password_len, const unsigned char* salt, size_t salt_len,
+    uint32_t iterations, unsigned char* output, size_t output_len)
+{
+    CRYPTO_PBKDF2_JOB job = { password, password_len, salt, salt_len, output, output_len };
+    return crypto_pbkdf2_sha256_batch(&job, 1, iterations);
+}
+
+CRYPTO_PBKDF2_KERNEL crypto_pbkdf2_get_kernel(void)
+{
+#ifdef PBKDF2_LANES_VECTOR
+    return (CRYPTO_PBKDF2_KERNEL)__atomic_load_n(&g_kernel, __ATOMIC_RELAXED);
+#else
+    return CRYPTO_PBKDF2_KERNEL_SINGLE;
+#endif
+}
+
+int crypto_pbkdf2_set_kernel(CRYPTO_PBKDF2_KERNEL kernel)
+{
+    int result;
+    if (kernel != CRYPTO_PBKDF2_KERNEL_AUTO && kernel != CRYPTO_PBKDF2_KERNEL_SINGLE && kernel != CRYPTO_PBKDF2_KERNEL_LANES)
+    {
+        log_error("Failure invalid parameter specified kernel: %d", (int)kernel);
+        result = __LINE__;
+    }
+    else
+    {
+#ifdef PBKDF2_LANES_VECTOR
+        __atomic_store_n(&g_kernel, (int)kernel, __ATOMIC_RELAXED);
+        result = 0;
+#else
+        // Without vector extensions every block already runs on its own
+        if (kernel == CRYPTO_PBKDF2_KERNEL_LANES)
+        {
+            log_error("Failure lane kernel is not built on this compiler");
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+#endif
+    }
+    return result;
+}
@@ -0,0 +1,566 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_record.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_gcm.h"
+#include "cablelock/crypto_cbc_hmac.h"
+#include "cablelock/crypto_macro.h"
+
+#define TLS_LEGACY_VERSION_MAJOR    0x03
+#define TLS_LEGACY_VERSION_MINOR    0x03
+
+#define TLS12_SALT_SIZE             4
+#define TLS12_EXPLICIT_NONCE_SIZE   8
+#define TLS12_AAD_SIZE              13
+#define TLS12_MAX_CIPHER_EXPANSION  2048
+#define TLS13_MAX_CIPHER_EXPANSION  256
+
+typedef struct CRYPTO_RECORD_INFO_TAG
+{
+    union
+    {
+        CRYPTO_GCM_KEY gcm_key;
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+    } keys;
+    CRYPTO_RECORD_VERSION version;
+    bool is_cbc;
+    CBC_HMAC_MODE cbc_mode;
+    unsigned char write_iv[GCM_NONCE_SIZE];
+    uint64_t sequence_num;
+    size_t headroom;
+    size_t tailroom;
+    // Pool the context was taken from, NULL when it came from the allocator
+    CRYPTO_POOL_HANDLE pool;
+} CRYPTO_RECORD_INFO;
+
+static CRYPTO_RECORD_INFO* allocate_record_info(CRYPTO_POOL_HANDLE pool)
+{
+    CRYPTO_RECORD_INFO* result = NULL;
+    if (pool != NULL && (result = (CRYPTO_RECORD_INFO*)crypto_pool_acquire(pool)) == NULL)
+    {
+        // Exhausted pools fall back to the allocator
+        pool = NULL;
+    }
+    if (result == NULL)
+    {
+        result = (CRYPTO_RECORD_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_RECORD_INFO));
+    }
+    if (result != NULL)
+    {
+        memset(result, 0, sizeof(CRYPTO_RECORD_INFO));
+        result->pool = pool;
+    }
+    return result;
+}
+
+static void release_record_info(CRYPTO_RECORD_INFO* record_info)
+{
+    if (record_info->pool != NULL)
+    {
+        crypto_pool_release(record_info->pool, record_info);
+    }
+    else
+    {
+        secure_zero(record_info, sizeof(CRYPTO_RECORD_INFO));
+        crypto_alloc_free(record_info);
+    }
+}
+
+static void write_header(unsigned char* record, unsigned char content_type, size_t length)
+{
+    record[0] = content_type;
+    record[1] = TLS_LEGACY_VERSION_MAJOR;
+    record[2] = TLS_LEGACY_VERSION_MINOR;
+    record[3] = (unsigned char)(length >> 8);
+    record[4] = (unsigned char)length;
+}
+
+// TLS 1.2 nonce is the salt followed by the explicit part carried in the record
+static void construct_tls12_nonce(const CRYPTO_RECORD_INFO* record_info, const unsigned char* explicit_nonce, unsigned char nonce[GCM_NONCE_SIZE])
+{
+    memcpy(nonce, record_info->write_iv, TLS12_SALT_SIZE);
+    memcpy(nonce + TLS12_SALT_SIZE, explicit_nonce, TLS12_EXPLICIT_NONCE_SIZE);
+}
+
+// TLS 1.3 nonce is the write iv xor'ed with the padded sequence number
+static void construct_tls13_nonce(const CRYPTO_RECORD_INFO* record_info, unsigned char nonce[GCM_NONCE_SIZE])
+{
+    unsigned char sequence[TLS12_EXPLICIT_NONCE_SIZE];
+    memcpy(nonce, record_info->write_iv, GCM_NONCE_SIZE);
+    store_be64(sequence, record_info->sequence_num);
+    xor_value(nonce + (GCM_NONCE_SIZE - sizeof(sequence)), sequence, sizeof(sequence));
+}
+
+// Sequence number, content type and version, the start of every TLS 1.2 mac or aad
+static void construct_seq_header(uint64_t sequence_num, const unsigned char* header, unsigned char seq_header[CBC_HMAC_SEQ_HEADER_SIZE])
+{
+    store_be64(seq_header, sequence_num);
+    seq_header[8] = header[0];
+    seq_header[9] = header[1];
+    seq_header[10] = header[2];
+}
+
+static void construct_tls12_aad(uint64_t sequence_num, const unsigned char* header, size_t payload_len, unsigned char aad[TLS12_AAD_SIZE])
+{
+    construct_seq_header(sequence_num, header, aad);
+    aad[11] = (unsigned char)(payload_len >> 8);
+    aad[12] = (unsigned char)payload_len;
+}
+
+static int seal_tls12_record(CRYPTO_RECORD_INFO* record_info, unsigned char content_type, unsigned char* record, size_t payload_len, size_t* record_len)
+{
+    int result;
+    unsigned char nonce[GCM_NONCE_SIZE];
+    unsigned char aad[TLS12_AAD_SIZE];
+    unsigned char* explicit_nonce = record + TLS_RECORD_HEADER_SIZE;
+    unsigned char* payload = record + record_info->headroom;
+    size_t fragment_len = TLS12_EXPLICIT_NONCE_SIZE + payload_len + GCM_TAG_SIZE;
+
+    write_header(record, content_type, fragment_len);
+    // The sequence number is unique per key so it doubles as the explicit nonce
+    store_be64(explicit_nonce, record_info->sequence_num);
+    construct_tls12_nonce(record_info, explicit_nonce, nonce);
+    construct_tls12_aad(record_info->sequence_num, record, payload_len, aad);
+
+    if (crypto_gcm_encrypt(&record_info->keys.gcm_key, nonce, aad, TLS12_AAD_SIZE, payload, payload_len, payload, payload + payload_len) != 0)
+    {
+        log_error("Failure encrypting record");
+        result = __LINE__;
+    }
+    else
+    {
+        *record_len = TLS_RECORD_HEADER_SIZE + fragment_len;
+        result = 0;
+    }
+    return result;
+}
+
+static int seal_tls13_record(CRYPTO_RECORD_INFO* record_info, unsigned char content_type, unsigned char* record, size_t payload_len, size_t* record_len)
+{
+    int result;
+    unsigned char nonce[GCM_NONCE_SIZE];
+    unsigned char* payload = record + record_info->headroom;
+    // Inner plain text carries the real content type after the payload
+    size_t inner_len = payload_len + 1;
+
+    payload[payload_len] = content_type;
+    write_header(record, TLS_CONTENT_APPLICATION, inner_len + GCM_TAG_SIZE);
+    construct_tls13_nonce(record_info, nonce);
+
+    if (crypto_gcm_encrypt(&record_info->keys.gcm_key, nonce, record, TLS_RECORD_HEADER_SIZE, payload, inner_len, payload, payload + inner_len) != 0)
+    {
+        log_error("Failure encrypting record");
+        result = __LINE__;
+    }
+    else
+    {
+        *record_len = TLS_RECORD_HEADER_SIZE + inner_len + GCM_TAG_SIZE;
+        result = 0;
+    }
+    return result;
+}
+
+static int seal_cbc_record(CRYPTO_RECORD_INFO* record_info, unsigned char content_type, unsigned char* record, size_t record_size, size_t payload_len, size_t* record_len)
+{
+    int result;
+    unsigned char seq_header[CBC_HMAC_SEQ_HEADER_SIZE];
+    unsigned char iv[AES_BLOCK_SIZE] = { 0 };
+    size_t fragment_len;
+
+    // Explicit iv is the encrypted sequence number, NIST SP 800-38A appendix C
+    store_be64(iv, record_info->sequence_num);
+    crypto_aes_block_encrypt(&record_info->keys.cbc_key.schedule, iv, iv);
+
+    // Header is written after sealing when the fragment length is known
+    write_header(record, content_type, 0);
+    construct_seq_header(record_info->sequence_num, record, seq_header);
+    if (crypto_cbc_hmac_seal(&record_info->keys.cbc_key, record_info->cbc_mode, iv, seq_header, record + record_info->headroom, payload_len,
+        record + TLS_RECORD_HEADER_SIZE, record_size - TLS_RECORD_HEADER_SIZE, &fragment_len) != 0)
+    {
+        log_error("Failure encrypting record");
+        result = __LINE__;
+    }
+    else
+    {
+        write_header(record, content_type, fragment_len);
+        *record_len = TLS_RECORD_HEADER_SIZE + fragment_len;
+        result = 0;
+    }
+    return result;
+}
+
+static int open_cbc_record(CRYPTO_RECORD_INFO* record_info, unsigned char* record, size_t fragment_len, unsigned char* content_type, unsigned char** payload, size_t* payload_len)
+{
+    int result;
+    if (fragment_len > TLS_MAX_PLAINTEXT_SIZE + TLS12_MAX_CIPHER_EXPANSION)
+    {
+        log_error("Invalid record fragment length %d", (int)fragment_len);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char seq_header[CBC_HMAC_SEQ_HEADER_SIZE];
+
+        construct_seq_header(record_info->sequence_num, record, seq_header);
+        if (crypto_cbc_hmac_open(&record_info->keys.cbc_key, record_info->cbc_mode, seq_header, record + TLS_RECORD_HEADER_SIZE, fragment_len, payload_len) != 0)
+        {
+            log_error("Failure authenticating record");
+            result = __LINE__;
+        }
+        else
+        {
+            *content_type = record[0];
+            *payload = record + record_info->headroom;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int open_tls12_record(CRYPTO_RECORD_INFO* record_info, unsigned char* record, size_t fragment_len, unsigned char* content_type, unsigned char** payload, size_t* payload_len)
+{
+    int result;
+    if (fragment_len < TLS12_EXPLICIT_NONCE_SIZE + GCM_TAG_SIZE || fragment_len > TLS_MAX_PLAINTEXT_SIZE + TLS12_MAX_CIPHER_EXPANSION)
+    {
+        log_error("Invalid record fragment length %d", (int)fragment_len);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char nonce[GCM_NONCE_SIZE];
+        unsigned char aad[TLS12_AAD_SIZE];
+        unsigned char* cipher_text = record + record_info->headroom;
+        size_t cipher_len = fragment_len - TLS12_EXPLICIT_NONCE_SIZE - GCM_TAG_SIZE;
+
+        construct_tls12_nonce(record_info, record + TLS_RECORD_HEADER_SIZE, nonce);
+        construct_tls12_aad(record_info->sequence_num, record, cipher_len, aad);
+        if (crypto_gcm_decrypt(&record_info->keys.gcm_key, nonce, aad, TLS12_AAD_SIZE, cipher_text, cipher_len, cipher_text, cipher_text + cipher_len) != 0)
+        {
+            log_error("Failure authenticating record");
+            result = __LINE__;
+        }
+        else
+        {
+            *content_type = record[0];
+            *payload = cipher_text;
+            *payload_len = cipher_len;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int open_tls13_record(CRYPTO_RECORD_INFO* record_info, unsigned char* record, size_t fragment_len, unsigned char* content_type, unsigned char** payload, size_t* payload_len)
+{
+    int result;
+    if (record[0] != TLS_CONTENT_APPLICATION)
+    {
+        log_error("Invalid protected record type %d", (int)record[0]);
+        result = __LINE__;
+    }
+    else if (fragment_len <= GCM_TAG_SIZE || fragment_len > TLS_MAX_PLAINTEXT_SIZE + TLS13_MAX_CIPHER_EXPANSION)
+    {
+        log_error("Invalid record fragment length %d", (int)fragment_len);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char nonce[GCM_NONCE_SIZE];
+        unsigned char* cipher_text = record + record_info->headroom;
+        size_t inner_len = fragment_len - GCM_TAG_SIZE;
+
+        construct_tls13_nonce(record_info, nonce);
+        if (crypto_gcm_decrypt(&record_info->keys.gcm_key, nonce, record, TLS_RECORD_HEADER_SIZE, cipher_text, inner_len, cipher_text, cipher_text + inner_len) != 0)
+        {
+            log_error("Failure authenticating record");
+            result = __LINE__;
+        }
+        else
+        {
+            // Strip the zero padding, the last non zero byte is the content type
+            while (inner_len > 0 && cipher_text[inner_len - 1] == 0)
+            {
+                inner_len--;
+            }
+            if (inner_len == 0)
+            {
+                log_error("Record does not contain a content type");
+                result = __LINE__;
+            }
+            else
+            {
+                *content_type = cipher_text[inner_len - 1];
+                *payload = cipher_text;
+                *payload_len = inner_len - 1;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+CRYPTO_RECORD_HANDLE crypto_record_create(CRYPTO_RECORD_VERSION version, CRYPTO_RECORD_CIPHER cipher,
+    const unsigned char* key, size_t key_len, const unsigned char* iv, size_t iv_len, CRYPTO_POOL_HANDLE pool)
+{
+    CRYPTO_RECORD_INFO* result;
+    size_t expected_key_len = cipher == CRYPTO_RECORD_AES_256_GCM ? AES_256_KEY_SIZE : AES_128_KEY_SIZE;
+    size_t expected_iv_len = version == CRYPTO_RECORD_TLS_1_2 ? TLS12_SALT_SIZE : GCM_NONCE_SIZE;
+    if (key == NULL || iv == NULL)
+    {
+        log_error("Failure invalid parameter specified key: %p, iv: %p", key, iv);
+        result = NULL;
+    }
+    else if ((version != CRYPTO_RECORD_TLS_1_2 && version != CRYPTO_RECORD_TLS_1_3) ||
+        (cipher != CRYPTO_RECORD_AES_128_GCM && cipher != CRYPTO_RECORD_AES_256_GCM))
+    {
+        log_error("Failure unsupported version %d or cipher %d", (int)version, (int)cipher);
+        result = NULL;
+    }
+    else if (key_len != expected_key_len || iv_len != expected_iv_len)
+    {
+        log_error("Failure invalid key length %d or iv length %d", (int)key_len, (int)iv_len);
+        result = NULL;
+    }
+    else if (pool != NULL && crypto_pool_get_slot_size(pool) < sizeof(CRYPTO_RECORD_INFO))
+    {
+        log_error("Failure pool items are smaller than a record context");
+        result = NULL;
+    }
+    else if ((result = allocate_record_info(pool)) == NULL)
+    {
+        log_error("Failure allocating record info");
+    }
+    else
+    {
+        if (crypto_gcm_key_init(&result->keys.gcm_key, key, key_len) != 0)
+        {
+            log_error("Failure initializing gcm key");
+            release_record_info(result);
+            result = NULL;
+        }
+        else
+        {
+            result->version = version;
+            memcpy(result->write_iv, iv, iv_len);
+            if (version == CRYPTO_RECORD_TLS_1_2)
+            {
+                result->headroom = TLS_RECORD_HEADER_SIZE + TLS12_EXPLICIT_NONCE_SIZE;
+                result->tailroom = GCM_TAG_SIZE;
+            }
+            else
+            {
+                result->headroom = TLS_RECORD_HEADER_SIZE;
+                // Inner content type plus the tag
+                result->tailroom = 1 + GCM_TAG_SIZE;
+            }
+        }
+    }
+    return result;
+}
+
+CRYPTO_RECORD_HANDLE crypto_record_create_cbc(CRYPTO_RECORD_CIPHER cipher, const unsigned char* enc_key, size_t enc_key_len,
+    const unsigned char* mac_key, size_t mac_key_len, bool encrypt_then_mac, CRYPTO_POOL_HANDLE pool)
+{
+    CRYPTO_RECORD_INFO* result;
+    size_t expected_key_len = cipher == CRYPTO_RECORD_AES_256_CBC_SHA256 ? AES_256_KEY_SIZE : AES_128_KEY_SIZE;
+    if (enc_key == NULL || mac_key == NULL)
+    {
+        log_error("Failure invalid parameter specified enc_key: %p, mac_key: %p", enc_key, mac_key);
+        result = NULL;
+    }
+    else if (cipher != CRYPTO_RECORD_AES_128_CBC_SHA256 && cipher != CRYPTO_RECORD_AES_256_CBC_SHA256)
+    {
+        log_error("Failure unsupported cbc cipher %d", (int)cipher);
+        result = NULL;
+    }
+    else if (enc_key_len != expected_key_len || mac_key_len != SHA256_DIGEST_SIZE)
+    {
+        log_error("Failure invalid key length %d or mac key length %d", (int)enc_key_len, (int)mac_key_len);
+        result = NULL;
+    }
+    else if (pool != NULL && crypto_pool_get_slot_size(pool) < sizeof(CRYPTO_RECORD_INFO))
+    {
+        log_error("Failure pool items are smaller than a record context");
+        result = NULL;
+    }
+    else if ((result = allocate_record_info(pool)) == NULL)
+    {
+        log_error("Failure allocating record info");
+    }
+    else
+    {
+        if (crypto_cbc_hmac_key_init(&result->keys.cbc_key, enc_key, enc_key_len, mac_key, mac_key_len) != 0)
+        {
+            log_error("Failure initializing cbc key");
+            release_record_info(result);
+            result = NULL;
+        }
+        else
+        {
+            result->version = CRYPTO_RECORD_TLS_1_2;
+            result->is_cbc = true;
+            result->cbc_mode = encrypt_then_mac ? CBC_HMAC_ENCRYPT_THEN_MAC : CBC_HMAC_MAC_THEN_ENCRYPT;
+            // Explicit iv in front, mac and padding behind
+            result->headroom = TLS_RECORD_HEADER_SIZE + AES_BLOCK_SIZE;
+            result->tailroom = CBC_HMAC_MAC_SIZE + AES_BLOCK_SIZE;
+        }
+    }
+    return result;
+}
+
+void crypto_record_destroy(CRYPTO_RECORD_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        release_record_info(handle);
+    }
+}
+
+size_t crypto_record_get_context_size(void)
+{
+    return sizeof(CRYPTO_RECORD_INFO);
+}
+
+size_t crypto_record_get_headroom(CRYPTO_RECORD_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->headroom;
+    }
+    return result;
+}
+
+size_t crypto_record_get_tailroom(CRYPTO_RECORD_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->tailroom;
+    }
+    return result;
+}
+
+size_t crypto_record_get_length(const unsigned char* data, size_t data_len)
+{
+    size_t result;
+    if (data == NULL || data_len < TLS_RECORD_HEADER_SIZE)
+    {
+        result = 0;
+    }
+    else
+    {
+        result = TLS_RECORD_HEADER_SIZE + (((size_t)data[3] << 8) | data[4]);
+    }
+    return result;
+}
+
+int crypto_record_seal(CRYPTO_RECORD_HANDLE handle, unsigned char content_type, unsigned char* record,
+    size_t record_size, size_t payload_len, size_t* record_len)
+{
+    int result;
+    if (handle == NULL || record == NULL || record_len == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, record: %p, record_len: %p", handle, record, record_len);
+        result = __LINE__;
+    }
+    else if (payload_len > TLS_MAX_PLAINTEXT_SIZE || record_size < handle->headroom + payload_len + handle->tailroom)
+    {
+        log_error("Failure payload length %d does not fit in the record size %d", (int)payload_len, (int)record_size);
+        result = __LINE__;
+    }
+    else if (handle->sequence_num == UINT64_MAX)
+    {
+        // Wrapping the sequence number would reuse a nonce
+        log_error("Failure sequence number exhausted, the key must be updated");
+        result = __LINE__;
+    }
+    else
+    {
+        if (handle->is_cbc)
+        {
+            result = seal_cbc_record(handle, content_type, record, record_size, payload_len, record_len);
+        }
+        else if (handle->version == CRYPTO_RECORD_TLS_1_2)
+        {
+            result = seal_tls12_record(handle, content_type, record, payload_len, record_len);
+        }
+        else
+        {
+            result = seal_tls13_record(handle, content_type, record, payload_len, record_len);
+        }
+        if (result == 0)
+        {
+            handle->sequence_num++;
+        }
+    }
+    return result;
+}
+
+int crypto_record_open(CRYPTO_RECORD_HANDLE handle, unsigned char* record, size_t record_len,
+    unsigned char* content_type, unsigned char** payload, size_t* payload_len)
+{
+    int result;
+    if (handle == NULL || record == NULL || content_type == NULL || payload == NULL || payload_len == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, record: %p, content_type: %p, payload: %p, payload_len: %p",
+            handle, record, content_type, payload, payload_len);
+        result = __LINE__;
+    }
+    else if (crypto_record_get_length(record, record_len) != record_len)
+    {
+        log_error("Failure record length %d does not match the record header", (int)record_len);
+        result = __LINE__;
+    }
+    else if (record[1] != TLS_LEGACY_VERSION_MAJOR || record[2] != TLS_LEGACY_VERSION_MINOR)
+    {
+        log_error("Failure invalid record version %d.%d", (int)record[1], (int)record[2]);
+        result = __LINE__;
+    }
+    else if (handle->sequence_num == UINT64_MAX)
+    {
+        log_error("Failure sequence number exhausted, the key must be updated");
+        result = __LINE__;
+    }
+    else
+    {
+        size_t fragment_len = record_len - TLS_RECORD_HEADER_SIZE;
+        if (handle->is_cbc)
+        {
+            result = open_cbc_record(handle, record, fragment_len, content_type, payload, payload_len);
+        }
+        else if (handle->version == CRYPTO_RECORD_TLS_1_2)
+        {
+            result = open_tls12_record(handle, record, fragment_len, content_type, payload, payload_len);
+        }
+        else
+        {
+            result = open_tls13_record(handle, record, fragment_len, content_type, payload, payload_len);
+        }
+        if (result == 0)
+        {
+            handle->sequence_num++;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,258 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_rotating_key.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+// A reader outside any operation
+#define READER_IDLE     0
+
+typedef struct CRYPTO_KEY_READER_INFO_TAG
+{
+    unsigned char pad_head[CRYPTO_CACHE_LINE_SIZE];
+    // Generation seen on entry, only written by the owning thread
+    uint64_t generation;
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+    struct CRYPTO_ROTATING_KEY_INFO_TAG* key;
+    struct CRYPTO_KEY_READER_INFO_TAG* next;
+} CRYPTO_KEY_READER_INFO;
+
+typedef struct CRYPTO_ROTATING_KEY_INFO_TAG
+{
+    // Guards the reader list and serializes rotations, readers never take it
+    pthread_mutex_t lock;
+    CRYPTO_KEY_READER_INFO* readers;
+    CRYPTO_CONTEXT_CIPHER cipher;
+    unsigned char pad_head[CRYPTO_CACHE_LINE_SIZE];
+    // Read by every enter, written once per rotation
+    CRYPTO_CIPHER_CONTEXT* current;
+    uint64_t generation;
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+} CRYPTO_ROTATING_KEY_INFO;
+
+static void free_context(CRYPTO_CIPHER_CONTEXT* context)
+{
+    secure_zero(context, sizeof(CRYPTO_CIPHER_CONTEXT));
+    crypto_alloc_free(context);
+}
+
+static CRYPTO_CIPHER_CONTEXT* expand_key(CRYPTO_CONTEXT_CIPHER cipher, const unsigned char* key, size_t key_len)
+{
+    CRYPTO_CIPHER_CONTEXT* result;
+    if ((result = (CRYPTO_CIPHER_CONTEXT*)crypto_alloc_malloc(sizeof(CRYPTO_CIPHER_CONTEXT))) == NULL)
+    {
+        log_error("Failure allocating cipher context");
+    }
+    else
+    {
+        int key_result;
+        memset(result, 0, sizeof(CRYPTO_CIPHER_CONTEXT));
+        result->cipher = cipher;
+        if (cipher == CRYPTO_CONTEXT_AES)
+        {
+            key_result = crypto_aes_key_init(&result->schedule.aes, key, key_len);
+        }
+        else
+        {
+            key_result = crypto_des_key_init(&result->schedule.des, key, key_len);
+        }
+
+        if (key_result != 0)
+        {
+            log_error("Failure initializing context key");
+            free_context(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+// Returns once no reader can still hold a context published before generation
+static void wait_for_readers(CRYPTO_ROTATING_KEY_INFO* key, uint64_t generation)
+{
+    for (CRYPTO_KEY_READER_INFO* reader = key->readers; reader != NULL; reader = reader->next)
+    {
+        uint64_t seen;
+        while ((seen = __atomic_load_n(&reader->generation, __ATOMIC_SEQ_CST)) != READER_IDLE && seen < generation)
+        {
+            (void)sched_yield();
+        }
+    }
+}
+
+CRYPTO_ROTATING_KEY_HANDLE crypto_rotating_key_create(CRYPTO_CONTEXT_CIPHER cipher, const unsigned char* key, size_t key_len)
+{
+    CRYPTO_ROTATING_KEY_INFO* result;
+    if (key == NULL || (cipher != CRYPTO_CONTEXT_AES && cipher != CRYPTO_CONTEXT_DES))
+    {
+        log_error("Failure invalid parameter specified key: %p, cipher: %d", key, (int)cipher);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_ROTATING_KEY_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_ROTATING_KEY_INFO))) == NULL)
+    {
+        log_error("Failure allocating rotating key");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_ROTATING_KEY_INFO));
+        result->cipher = cipher;
+        result->generation = 1;
+        if ((result->current = expand_key(cipher, key, key_len)) == NULL)
+        {
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (pthread_mutex_init(&result->lock, NULL) != 0)
+        {
+            log_error("Failure initializing rotating key lock");
+            free_context(result->current);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+void crypto_rotating_key_destroy(CRYPTO_ROTATING_KEY_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        if (handle->readers != NULL)
+        {
+            log_error("Failure destroying rotating key with readers still attached");
+        }
+        (void)pthread_mutex_destroy(&handle->lock);
+        free_context(handle->current);
+        crypto_alloc_free(handle);
+    }
+}
+
+int crypto_rotating_key_rotate(CRYPTO_ROTATING_KEY_HANDLE handle, const unsigned char* key, size_t key_len)
+{
+    int result;
+    CRYPTO_CIPHER_CONTEXT* context;
+    if (handle == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, key: %p", handle, key);
+        result = __LINE__;
+    }
+    else if ((context = expand_key(handle->cipher, key, key_len)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_CIPHER_CONTEXT* previous;
+        uint64_t generation;
+        (void)pthread_mutex_lock(&handle->lock);
+        previous = __atomic_exchange_n(&handle->current, context, __ATOMIC_SEQ_CST);
+        // Readers that entered under an older generation may hold previous
+        generation = __atomic_add_fetch(&handle->generation, 1, __ATOMIC_SEQ_CST);
+        wait_for_readers(handle, generation);
+        (void)pthread_mutex_unlock(&handle->lock);
+
+        free_context(previous);
+        result = 0;
+    }
+    return result;
+}
+
+uint64_t crypto_rotating_key_get_generation(CRYPTO_ROTATING_KEY_HANDLE handle)
+{
+    uint64_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = __atomic_load_n(&handle->generation, __ATOMIC_ACQUIRE);
+    }
+    return result;
+}
+
+CRYPTO_KEY_READER_HANDLE crypto_key_reader_create(CRYPTO_ROTATING_KEY_HANDLE handle)
+{
+    CRYPTO_KEY_READER_INFO* result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_KEY_READER_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_KEY_READER_INFO))) == NULL)
+    {
+        log_error("Failure allocating key reader");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_KEY_READER_INFO));
+        result->key = handle;
+        (void)pthread_mutex_lock(&handle->lock);
+        result->next = handle->readers;
+        handle->readers = result;
+        (void)pthread_mutex_unlock(&handle->lock);
+    }
+    return result;
+}
+
+void crypto_key_reader_destroy(CRYPTO_KEY_READER_HANDLE reader)
+{
+    if (reader != NULL)
+    {
+        CRYPTO_ROTATING_KEY_INFO* key = reader->key;
+        (void)pthread_mutex_lock(&key->lock);
+        for (CRYPTO_KEY_READER_INFO** link = &key->readers; *link != NULL; link = &(*link)->next)
+        {
+            if (*link == reader)
+            {
+                *link = reader->next;
+                break;
+            }
+        }
+        (void)pthread_mutex_unlock(&key->lock);
+        crypto_alloc_free(reader);
+    }
+}
+
+const CRYPTO_CIPHER_CONTEXT* crypto_key_reader_enter(CRYPTO_KEY_READER_HANDLE reader)
+{
+    const CRYPTO_CIPHER_CONTEXT* result;
+    if (reader == NULL)
+    {
+        log_error("Failure invalid parameter specified reader: NULL");
+        result = NULL;
+    }
+    else
+    {
+        // The generation has to be visible before current is read, or a
+        // rotation could miss this reader and free the context under it
+        __atomic_store_n(&reader->generation, __atomic_load_n(&reader->key->generation, __ATOMIC_ACQUIRE), __ATOMIC_SEQ_CST);
+        result = __atomic_load_n(&reader->key->current, __ATOMIC_SEQ_CST);
+    }
+    return result;
+}
+
+void crypto_key_reader_leave(CRYPTO_KEY_READER_HANDLE reader)
+{
+    if (reader == NULL)
+    {
+        log_error("Failure invalid parameter specified reader: NULL");
+    }
+    else
+    {
+        __atomic_store_n(&reader->generation, READER_IDLE, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,570 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_rsa.h"
+#include "cablelock/crypto_bignum.h"
+#include "cablelock/crypto_sha256.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+#define MAX_LIMBS           (RSA_MAX_MODULUS_SIZE / 8)
+#define MAX_PRIME_LIMBS     (MAX_LIMBS / 2)
+#define MAX_BLINDING_TRIES  16
+#define MAX_RANDOM_DRAWS    64
+
+// DER DigestInfo prefix for SHA-256 from RFC 8017 section 9.2
+static const unsigned char SHA256_DIGEST_INFO[] = {
+    0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+
+typedef struct RSA_KEY_INFO_TAG
+{
+    size_t modulus_size;
+    size_t limb_count;
+    size_t prime_limbs;
+    uint64_t public_exponent;
+    CRYPTO_MONT_CONTEXT modulus_context;
+    CRYPTO_MONT_CONTEXT prime1_context;
+    CRYPTO_MONT_CONTEXT prime2_context;
+    uint64_t exponent1[MAX_PRIME_LIMBS];
+    uint64_t exponent2[MAX_PRIME_LIMBS];
+    // q^-1 mod p in Montgomery form for p
+    uint64_t coefficient[MAX_PRIME_LIMBS];
+    // r^e and r^-1 mod n in Montgomery form for n.  Both are squared after
+    // every use, which keeps them a matching pair without a new inversion.
+    pthread_mutex_t blinding_lock;
+    uint64_t blind[MAX_LIMBS];
+    uint64_t unblind[MAX_LIMBS];
+} RSA_KEY_INFO;
+
+typedef struct VERIFY_CACHE_ENTRY_TAG
+{
+    bool used;
+    unsigned char key_hash[SHA256_DIGEST_SIZE];
+    CRYPTO_MONT_CONTEXT context;
+} VERIFY_CACHE_ENTRY;
+
+// Direct mapped on the hash of modulus and exponent.  A hit copies the
+// prepared context out under the lock, the exponentiation runs outside it.
+static pthread_mutex_t g_verify_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static VERIFY_CACHE_ENTRY g_verify_cache[RSA_VERIFY_CACHE_SLOTS];
+
+static void strip_leading_zeros(const unsigned char** bytes, size_t* bytes_len)
+{
+    while (*bytes_len > 0 && **bytes == 0)
+    {
+        (*bytes)++;
+        (*bytes_len)--;
+    }
+}
+
+static int decode_public_exponent(uint64_t* target, const unsigned char* bytes, size_t bytes_len)
+{
+    int result;
+    strip_leading_zeros(&bytes, &bytes_len);
+    if (bytes_len == 0 || bytes_len > sizeof(uint64_t))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t value = 0;
+        for (size_t index = 0; index < bytes_len; index++)
+        {
+            value = (value << 8) | bytes[index];
+        }
+        // e = 1 would make every signature its own message
+        result = (value < 3 || (value & 1) == 0) ? __LINE__ : 0;
+        *target = value;
+    }
+    return result;
+}
+
+// EM = 0x00 0x01 0xff .. 0xff 0x00 DigestInfo digest
+static void encode_pkcs1_sha256(unsigned char* encoded, size_t encoded_len, const unsigned char* digest)
+{
+    size_t padding_len = encoded_len - sizeof(SHA256_DIGEST_INFO) - SHA256_DIGEST_SIZE;
+    encoded[0] = 0x00;
+    encoded[1] = 0x01;
+    memset(encoded + 2, 0xff, padding_len - 3);
+    encoded[padding_len - 1] = 0x00;
+    memcpy(encoded + padding_len, SHA256_DIGEST_INFO, sizeof(SHA256_DIGEST_INFO));
+    memcpy(encoded + padding_len + sizeof(SHA256_DIGEST_INFO), digest, SHA256_DIGEST_SIZE);
+}
+
+// Garner's recombination, target = m2 + q * ((m1 - m2) * q^-1 mod p)
+static void crt_combine(const RSA_KEY_INFO* key, uint64_t* target, const uint64_t* m1, const uint64_t* m2)
+{
+    size_t prime_limbs = key->prime_limbs;
+    uint64_t wide[2 * MAX_PRIME_LIMBS] = { 0 };
+    uint64_t product[2 * MAX_PRIME_LIMBS];
+    uint64_t difference[MAX_PRIME_LIMBS];
+
+    // m2 < q < 2^(64 * prime_limbs), well inside the range the reduction takes
+    memcpy(wide, m2, prime_limbs * sizeof(uint64_t));
+    crypto_bignum_mod(&key->prime1_context, difference, wide);
+    crypto_bignum_mod_sub(&key->prime1_context, difference, m1, difference);
+    crypto_bignum_mont_mul(&key->prime1_context, difference, difference, key->coefficient);
+
+    crypto_bignum_mul(product, difference, prime_limbs, key->prime2_context.modulus, prime_limbs);
+    (void)crypto_bignum_add(product, product, wide, 2 * prime_limbs);
+    memcpy(target, product, key->limb_count * sizeof(uint64_t));
+
+    secure_zero(wide, sizeof(wide));
+    secure_zero(product, sizeof(product));
+    secure_zero(difference, sizeof(difference));
+}
+
+// value^d mod n from the two half size exponentiations
+static void crt_exponentiate(const RSA_KEY_INFO* key, uint64_t* target, const uint64_t* value)
+{
+    size_t prime_limbs = key->prime_limbs;
+    uint64_t wide[2 * MAX_PRIME_LIMBS] = { 0 };
+    uint64_t m1[MAX_PRIME_LIMBS];
+    uint64_t m2[MAX_PRIME_LIMBS];
+
+    memcpy(wide, value, key->limb_count * sizeof(uint64_t));
+    crypto_bignum_mod(&key->prime1_context, m1, wide);
+    crypto_bignum_mod(&key->prime2_context, m2, wide);
+    crypto_bignum_mod_exp(&key->prime1_context, m1, m1, key->exponent1, prime_limbs);
+    crypto_bignum_mod_exp(&key->prime2_context, m2, m2, key->exponent2, prime_limbs);
+    crt_combine(key, target, m1, m2);
+
+    secure_zero(wide, sizeof(wide));
+    secure_zero(m1, sizeof(m1));
+    secure_zero(m2, sizeof(m2));
+}
+
+// r^-1 mod n through Fermat's little theorem on each prime, so the inversion
+// runs in constant time without a gcd
+static void crt_invert(const RSA_KEY_INFO* key, uint64_t* target, const uint64_t* value)
+{
+    size_t prime_limbs = key->prime_limbs;
+    uint64_t wide[2 * MAX_PRIME_LIMBS] = { 0 };
+    uint64_t two[MAX_PRIME_LIMBS] = { 2 };
+    uint64_t exponent[MAX_PRIME_LIMBS];
+    uint64_t m1[MAX_PRIME_LIMBS];
+    uint64_t m2[MAX_PRIME_LIMBS];
+
+    memcpy(wide, value, key->limb_count * sizeof(uint64_t));
+    crypto_bignum_mod(&key->prime1_context, m1, wide);
+    crypto_bignum_mod(&key->prime2_context, m2, wide);
+    (void)crypto_bignum_sub(exponent, key->prime1_context.modulus, two, prime_limbs);
+    crypto_bignum_mod_exp(&key->prime1_context, m1, m1, exponent, prime_limbs);
+    (void)crypto_bignum_sub(exponent, key->prime2_context.modulus, two, prime_limbs);
+    crypto_bignum_mod_exp(&key->prime2_context, m2, m2, exponent, prime_limbs);
+    crt_combine(key, target, m1, m2);
+
+    secure_zero(wide, sizeof(wide));
+    secure_zero(m1, sizeof(m1));
+    secure_zero(m2, sizeof(m2));
+}
+
+static int random_below_modulus(const RSA_KEY_INFO* key, uint64_t* target)
+{
+    int result = __LINE__;
+    size_t top_index = key->modulus_size - 1;
+    unsigned int top_byte = (unsigned int)(key->modulus_context.modulus[top_index / 8] >> ((top_index % 8) * 8)) & 0xff;
+    // Clearing the bits above the modulus' top bit rejects less than half the draws
+    unsigned char top_mask = (unsigned char)(0xff >> (__builtin_clz(top_byte) - 24));
+    unsigned char bytes[RSA_MAX_MODULUS_SIZE];
+    uint64_t zero[MAX_LIMBS] = { 0 };
+    for (size_t attempt = 0; attempt < MAX_RANDOM_DRAWS && result != 0; attempt++)
+    {
+        if (crypto_drbg_random_bytes(bytes, key->modulus_size) != 0)
+        {
+            break;
+        }
+        bytes[0] &= top_mask;
+        (void)crypto_bignum_from_bytes(target, key->limb_count, bytes, key->modulus_size);
+        if (crypto_bignum_compare(target, key->modulus_context.modulus, key->limb_count) < 0 &&
+            crypto_bignum_compare(target, zero, key->limb_count) != 0)
+        {
+            result = 0;
+        }
+    }
+    secure_zero(bytes, sizeof(bytes));
+    return result;
+}
+
+static int init_blinding(RSA_KEY_INFO* key)
+{
+    int result = __LINE__;
+    size_t limb_count = key->limb_count;
+    const CRYPTO_MONT_CONTEXT* context = &key->modulus_context;
+    uint64_t random[MAX_LIMBS];
+    uint64_t inverse[MAX_LIMBS];
+    uint64_t check[MAX_LIMBS];
+    uint64_t one[MAX_LIMBS] = { 1 };
+    for (size_t attempt = 0; attempt < MAX_BLINDING_TRIES && result != 0; attempt++)
+    {
+        if (random_below_modulus(key, random) != 0)
+        {
+            log_error("Failure generating the blinding value");
+            break;
+        }
+        crt_invert(key, inverse, random);
+        // r sharing a factor with n has no inverse, try another
+        crypto_bignum_mont_mul(context, check, random, inverse);
+        crypto_bignum_mont_mul(context, check, check, context->rr);
+        if (crypto_bignum_compare(check, one, limb_count) == 0)
+        {
+            crypto_bignum_mod_exp_public(context, key->blind, random, key->public_exponent);
+            crypto_bignum_mont_mul(context, key->blind, key->blind, context->rr);
+            crypto_bignum_mont_mul(context, key->unblind, inverse, context->rr);
+            result = 0;
+        }
+    }
+    secure_zero(random, sizeof(random));
+    secure_zero(inverse, sizeof(inverse));
+    secure_zero(check, sizeof(check));
+    return result;
+}
+
+static int load_prime(CRYPTO_MONT_CONTEXT* context, size_t prime_limbs, const unsigned char* bytes, size_t bytes_len)
+{
+    int result;
+    uint64_t prime[MAX_PRIME_LIMBS];
+    if (bytes == NULL || crypto_bignum_from_bytes(prime, prime_limbs, bytes, bytes_len) != 0 ||
+        crypto_bignum_mont_init(context, prime, prime_limbs) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    secure_zero(prime, sizeof(prime));
+    return result;
+}
+
+static int load_key(RSA_KEY_INFO* key, const RSA_PRIVATE_KEY_PARTS* parts)
+{
+    int result;
+    const unsigned char* modulus = parts->modulus;
+    size_t modulus_len = parts->modulus_len;
+    const unsigned char* prime1 = parts->prime1;
+    size_t prime1_len = parts->prime1_len;
+    const unsigned char* prime2 = parts->prime2;
+    size_t prime2_len = parts->prime2_len;
+    uint64_t value[MAX_LIMBS];
+    uint64_t product[2 * MAX_PRIME_LIMBS] = { 0 };
+
+    if (modulus != NULL)
+    {
+        strip_leading_zeros(&modulus, &modulus_len);
+    }
+    if (prime1 != NULL && prime2 != NULL)
+    {
+        strip_leading_zeros(&prime1, &prime1_len);
+        strip_leading_zeros(&prime2, &prime2_len);
+    }
+    key->modulus_size = modulus_len;
+    key->limb_count = (modulus_len + 7) / 8;
+    key->prime_limbs = ((prime1_len > prime2_len ? prime1_len : prime2_len) + 7) / 8;
+
+    if (modulus == NULL || modulus_len < RSA_MIN_MODULUS_SIZE || modulus_len > RSA_MAX_MODULUS_SIZE ||
+        crypto_bignum_from_bytes(value, key->limb_count, modulus, modulus_len) != 0 ||
+        crypto_bignum_mont_init(&key->modulus_context, value, key->limb_count) != 0)
+    {
+        log_error("Failure invalid modulus of %d bytes", (int)modulus_len);
+        result = __LINE__;
+    }
+    else if (parts->public_exponent == NULL || decode_public_exponent(&key->public_exponent, parts->public_exponent, parts->public_exponent_len) != 0)
+    {
+        log_error("Failure invalid public exponent");
+        result = __LINE__;
+    }
+    else if (key->prime_limbs * 2 < key->limb_count || key->prime_limbs > MAX_PRIME_LIMBS ||
+        load_prime(&key->prime1_context, key->prime_limbs, prime1, prime1_len) != 0 ||
+        load_prime(&key->prime2_context, key->prime_limbs, prime2, prime2_len) != 0)
+    {
+        log_error("Failure invalid primes of %d and %d bytes", (int)prime1_len, (int)prime2_len);
+        result = __LINE__;
+    }
+    else if (parts->exponent1 == NULL || parts->exponent2 == NULL || parts->coefficient == NULL ||
+        crypto_bignum_from_bytes(key->exponent1, key->prime_limbs, parts->exponent1, parts->exponent1_len) != 0 ||
+        crypto_bignum_from_bytes(key->exponent2, key->prime_limbs, parts->exponent2, parts->exponent2_len) != 0 ||
+        crypto_bignum_from_bytes(key->coefficient, key->prime_limbs, parts->coefficient, parts->coefficient_len) != 0 ||
+        crypto_bignum_compare(key->coefficient, key->prime1_context.modulus, key->prime_limbs) >= 0)
+    {
+        log_error("Failure invalid CRT exponents or coefficient");
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t excess = 0;
+        crypto_bignum_mul(product, key->prime1_context.modulus, key->prime_limbs, key->prime2_context.modulus, key->prime_limbs);
+        for (size_t index = key->limb_count; index < 2 * key->prime_limbs; index++)
+        {
+            excess |= product[index];
+        }
+        if (excess != 0 || crypto_bignum_compare(product, value, key->limb_count) != 0)
+        {
+            log_error("Failure modulus is not the product of the primes");
+            result = __LINE__;
+        }
+        else
+        {
+            crypto_bignum_mont_mul(&key->prime1_context, key->coefficient, key->coefficient, key->prime1_context.rr);
+            result = init_blinding(key);
+        }
+    }
+    secure_zero(value, sizeof(value));
+    secure_zero(product, sizeof(product));
+    return result;
+}
+
+static int private_operation(RSA_KEY_INFO* key, uint64_t* value)
+{
+    int result;
+    const CRYPTO_MONT_CONTEXT* context = &key->modulus_context;
+    uint64_t blind[MAX_LIMBS];
+    uint64_t unblind[MAX_LIMBS];
+    uint64_t blinded[MAX_LIMBS];
+    uint64_t check[MAX_LIMBS];
+
+    (void)pthread_mutex_lock(&key->blinding_lock);
+    memcpy(blind, key->blind, sizeof(blind));
+    memcpy(unblind, key->unblind, sizeof(unblind));
+    crypto_bignum_mont_mul(context, key->blind, key->blind, key->blind);
+    crypto_bignum_mont_mul(context, key->unblind, key->unblind, key->unblind);
+    (void)pthread_mutex_unlock(&key->blinding_lock);
+
+    // (c * r^e)^d = c^d * r, so the exponentiations never see c itself
+    crypto_bignum_mont_mul(context, blinded, value, blind);
+    crt_exponentiate(key, value, blinded);
+
+    // A fault in either half would otherwise hand out a value that factors n
+    crypto_bignum_mod_exp_public(context, check, value, key->public_exponent);
+    if (crypto_bignum_compare(check, blinded, key->limb_count) != 0)
+    {
+        log_error("Failure private operation did not verify");
+        memset(value, 0, key->limb_count * sizeof(uint64_t));
+        result = __LINE__;
+    }
+    else
+    {
+        crypto_bignum_mont_mul(context, value, value, unblind);
+        result = 0;
+    }
+    secure_zero(blind, sizeof(blind));
+    secure_zero(unblind, sizeof(unblind));
+    secure_zero(blinded, sizeof(blinded));
+    secure_zero(check, sizeof(check));
+    return result;
+}
+
+// Finds or prepares the Montgomery context for a public key
+static int get_verify_context(CRYPTO_MONT_CONTEXT* context, const unsigned char* modulus, size_t modulus_len, uint64_t public_exponent)
+{
+    int result;
+    CRYPTO_SHA256 sha;
+    unsigned char key_hash[SHA256_DIGEST_SIZE];
+    unsigned char exponent_bytes[sizeof(uint64_t)];
+    VERIFY_CACHE_ENTRY* entry;
+
+    store_be64(exponent_bytes, public_exponent);
+    crypto_sha256_init(&sha);
+    crypto_sha256_update(&sha, modulus, modulus_len);
+    crypto_sha256_update(&sha, exponent_bytes, sizeof(exponent_bytes));
+    crypto_sha256_finish(&sha, key_hash);
+    entry = &g_verify_cache[load_be64(key_hash) % RSA_VERIFY_CACHE_SLOTS];
+
+    (void)pthread_mutex_lock(&g_verify_cache_lock);
+    if (entry->used && memcmp(entry->key_hash, key_hash, SHA256_DIGEST_SIZE) == 0)
+    {
+        *context = entry->context;
+        result = 0;
+    }
+    else
+    {
+        result = __LINE__;
+    }
+    (void)pthread_mutex_unlock(&g_verify_cache_lock);
+
+    if (result != 0)
+    {
+        uint64_t value[MAX_LIMBS];
+        size_t limb_count = (modulus_len + 7) / 8;
+        if (crypto_bignum_from_bytes(value, limb_count, modulus, modulus_len) != 0 ||
+            crypto_bignum_mont_init(context, value, limb_count) != 0)
+        {
+            log_error("Failure invalid modulus of %d bytes", (int)modulus_len);
+        }
+        else
+        {
+            (void)pthread_mutex_lock(&g_verify_cache_lock);
+            entry->used = true;
+            memcpy(entry->key_hash, key_hash, SHA256_DIGEST_SIZE);
+            entry->context = *context;
+            (void)pthread_mutex_unlock(&g_verify_cache_lock);
+            result = 0;
+        }
+    }
+    return result;
+}
+
+RSA_KEY_HANDLE crypto_rsa_key_create(const RSA_PRIVATE_KEY_PARTS* parts)
+{
+    RSA_KEY_INFO* result;
+    if (parts == NULL)
+    {
+        log_error("Failure invalid parameter specified parts: NULL");
+        result = NULL;
+    }
+    else if ((result = (RSA_KEY_INFO*)crypto_alloc_malloc(sizeof(RSA_KEY_INFO))) == NULL)
+    {
+        log_error("Failure allocating rsa key");
+    }
+    else
+    {
+        memset(result, 0, sizeof(RSA_KEY_INFO));
+        if (load_key(result, parts) != 0)
+        {
+            secure_zero(result, sizeof(RSA_KEY_INFO));
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (pthread_mutex_init(&result->blinding_lock, NULL) != 0)
+        {
+            log_error("Failure initializing blinding lock");
+            secure_zero(result, sizeof(RSA_KEY_INFO));
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+void crypto_rsa_key_destroy(RSA_KEY_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        (void)pthread_mutex_destroy(&handle->blinding_lock);
+        secure_zero(handle, sizeof(RSA_KEY_INFO));
+        crypto_alloc_free(handle);
+    }
+}
+
+size_t crypto_rsa_key_get_size(RSA_KEY_HANDLE handle)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: NULL");
+        result = 0;
+    }
+    else
+    {
+        result = handle->modulus_size;
+    }
+    return result;
+}
+
+int crypto_rsa_private_operation(RSA_KEY_HANDLE handle, const unsigned char* input, unsigned char* output)
+{
+    int result;
+    uint64_t value[MAX_LIMBS];
+    if (handle == NULL || input == NULL || output == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, input: %p, output: %p", handle, input, output);
+        result = __LINE__;
+    }
+    else if (crypto_bignum_from_bytes(value, handle->limb_count, input, handle->modulus_size) != 0 ||
+        crypto_bignum_compare(value, handle->modulus_context.modulus, handle->limb_count) >= 0)
+    {
+        log_error("Failure input is not below the modulus");
+        result = __LINE__;
+    }
+    else if (private_operation(handle, value) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = crypto_bignum_to_bytes(output, handle->modulus_size, value, handle->limb_count);
+    }
+    secure_zero(value, sizeof(value));
+    return result;
+}
+
+int crypto_rsa_sign_pkcs1_sha256(RSA_KEY_HANDLE handle, const unsigned char* digest, unsigned char* signature)
+{
+    int result;
+    if (handle == NULL || digest == NULL || signature == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, digest: %p, signature: %p", handle, digest, signature);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char encoded[RSA_MAX_MODULUS_SIZE];
+        encode_pkcs1_sha256(encoded, handle->modulus_size, digest);
+        result = crypto_rsa_private_operation(handle, encoded, signature);
+    }
+    return result;
+}
+
+int crypto_rsa_verify_pkcs1_sha256(const unsigned char* modulus, size_t modulus_len, const unsigned char* public_exponent, size_t public_exponent_len,
+    const unsigned char* digest, const unsigned char* signature, size_t signature_len)
+{
+    int result;
+    uint64_t exponent;
+    if (modulus != NULL)
+    {
+        // DER integers carry a zero byte ahead of a set top bit
+        strip_leading_zeros(&modulus, &modulus_len);
+    }
+    if (modulus == NULL || public_exponent == NULL || digest == NULL || signature == NULL)
+    {
+        log_error("Failure invalid parameter specified modulus: %p, public_exponent: %p, digest: %p, signature: %p", modulus, public_exponent, digest, signature);
+        result = __LINE__;
+    }
+    else if (modulus_len < RSA_MIN_MODULUS_SIZE || modulus_len > RSA_MAX_MODULUS_SIZE || signature_len != modulus_len)
+    {
+        log_error("Failure invalid modulus_len: %d or signature_len: %d", (int)modulus_len, (int)signature_len);
+        result = __LINE__;
+    }
+    else if (decode_public_exponent(&exponent, public_exponent, public_exponent_len) != 0)
+    {
+        log_error("Failure invalid public exponent");
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_MONT_CONTEXT context;
+        uint64_t value[MAX_LIMBS];
+        unsigned char recovered[RSA_MAX_MODULUS_SIZE];
+        unsigned char expected[RSA_MAX_MODULUS_SIZE];
+        size_t limb_count = (modulus_len + 7) / 8;
+        if (get_verify_context(&context, modulus, modulus_len, exponent) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (crypto_bignum_from_bytes(value, limb_count, signature, signature_len) != 0 ||
+            crypto_bignum_compare(value, context.modulus, limb_count) >= 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            crypto_bignum_mod_exp_public(&context, value, value, exponent);
+            (void)crypto_bignum_to_bytes(recovered, modulus_len, value, limb_count);
+            encode_pkcs1_sha256(expected, modulus_len, digest);
+            result = const_time_compare(recovered, expected, modulus_len) == 0 ? 0 : __LINE__;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,423 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_session_cache.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+// Reads retry while a writer holds the entry, writes move on to another
+// candidate when they lose the claim
+#define MAX_READ_ATTEMPTS       4
+#define MAX_WRITE_ATTEMPTS      4
+// The clock hand clears every reference bit within two sweeps
+#define CLOCK_MAX_STEPS         (2 * CRYPTO_SESSION_CACHE_WAYS)
+#define MAX_SHARD_COUNT         ((size_t)1 << 30)
+
+// Every entry is a seqlock: a writer claims it by moving the sequence from
+// even to odd with a CAS and publishes by making it even again.  Readers copy
+// and then check that the sequence was even and did not move.
+typedef struct SESSION_ENTRY_TAG
+{
+    uint32_t sequence;
+    // Set by hits, cleared by the clock hand
+    uint8_t referenced;
+    // 0 marks a free entry
+    uint8_t id_len;
+    uint32_t state_len;
+    // Monotonic seconds, 0 never expires
+    uint64_t expiry;
+    unsigned char id[CRYPTO_SESSION_ID_MAX_SIZE];
+    unsigned char state[];
+} SESSION_ENTRY;
+
+// Fills the first cache line of a shard, the entries follow
+typedef struct SESSION_SHARD_TAG
+{
+    uint32_t hand;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} SESSION_SHARD;
+
+typedef struct CRYPTO_SESSION_CACHE_INFO_TAG
+{
+    unsigned char* slab;
+    void* allocation;
+    size_t shard_count;
+    size_t shard_stride;
+    size_t entry_size;
+    size_t state_size;
+    uint32_t lifetime_seconds;
+    // Random per cache so peers cannot aim IDs at one shard
+    uint64_t hash_seed;
+} CRYPTO_SESSION_CACHE_INFO;
+
+static uint64_t now_seconds(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec;
+}
+
+static uint64_t mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+static uint64_t hash_session_id(const CRYPTO_SESSION_CACHE_INFO* cache, const unsigned char* session_id, size_t session_id_len)
+{
+    uint64_t hash = cache->hash_seed ^ ((uint64_t)session_id_len * 0x9e3779b97f4a7c15ULL);
+    size_t offset = 0;
+    for (; offset + 8 <= session_id_len; offset += 8)
+    {
+        hash = mix64(hash ^ load_le64(session_id + offset));
+    }
+    if (offset < session_id_len)
+    {
+        unsigned char tail[8] = { 0 };
+        memcpy(tail, session_id + offset, session_id_len - offset);
+        hash = mix64(hash ^ load_le64(tail));
+    }
+    return hash;
+}
+
+static SESSION_SHARD* shard_of(const CRYPTO_SESSION_CACHE_INFO* cache, uint64_t hash)
+{
+    return (SESSION_SHARD*)(cache->slab + ((size_t)(hash & (cache->shard_count - 1)) * cache->shard_stride));
+}
+
+static SESSION_ENTRY* entry_at(const CRYPTO_SESSION_CACHE_INFO* cache, SESSION_SHARD* shard, size_t way)
+{
+    return (SESSION_ENTRY*)((unsigned char*)shard + CRYPTO_CACHE_LINE_SIZE + (way * cache->entry_size));
+}
+
+static bool entry_live(const SESSION_ENTRY* entry, uint64_t now)
+{
+    return entry->id_len != 0 && (entry->expiry == 0 || now < entry->expiry);
+}
+
+static bool entry_matches(const SESSION_ENTRY* entry, const unsigned char* session_id, size_t session_id_len, uint64_t now)
+{
+    return entry->id_len == session_id_len && memcmp(entry->id, session_id, session_id_len) == 0 && entry_live(entry, now);
+}
+
+static bool claim_entry(SESSION_ENTRY* entry, uint32_t* sequence)
+{
+    bool result;
+    *sequence = __atomic_load_n(&entry->sequence, __ATOMIC_RELAXED);
+    if ((*sequence & 1) != 0)
+    {
+        result = false;
+    }
+    else
+    {
+        result = __atomic_compare_exchange_n(&entry->sequence, sequence, *sequence + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+    return result;
+}
+
+static void publish_entry(SESSION_ENTRY* entry, uint32_t sequence)
+{
+    __atomic_store_n(&entry->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Clears every live entry holding the ID, except the lowest way when
+// keep_first is set.  An entry another writer holds is skipped, that writer
+// runs this pass itself if it is storing the same ID.
+static void clear_matches(const CRYPTO_SESSION_CACHE_INFO* cache, SESSION_SHARD* shard, const unsigned char* session_id, size_t session_id_len,
+    uint64_t now, bool keep_first)
+{
+    for (size_t way = 0; way < CRYPTO_SESSION_CACHE_WAYS; way++)
+    {
+        SESSION_ENTRY* entry = entry_at(cache, shard, way);
+        uint32_t sequence;
+        if (entry_matches(entry, session_id, session_id_len, now) && claim_entry(entry, &sequence))
+        {
+            // Checked again now that no writer can change it
+            if (entry_matches(entry, session_id, session_id_len, now))
+            {
+                if (keep_first)
+                {
+                    keep_first = false;
+                }
+                else
+                {
+                    secure_zero(entry->state, entry->state_len);
+                    entry->state_len = 0;
+                    entry->id_len = 0;
+                }
+            }
+            publish_entry(entry, sequence);
+        }
+    }
+}
+
+// The entry already holding the ID, else a free or expired one, else the
+// first one the clock hand finds unreferenced.  Only a hint, the caller
+// claims the entry before trusting anything in it.
+static SESSION_ENTRY* choose_victim(const CRYPTO_SESSION_CACHE_INFO* cache, SESSION_SHARD* shard, const unsigned char* session_id, size_t session_id_len, uint64_t now)
+{
+    SESSION_ENTRY* result = NULL;
+    SESSION_ENTRY* free_entry = NULL;
+    for (size_t way = 0; way < CRYPTO_SESSION_CACHE_WAYS && result == NULL; way++)
+    {
+        SESSION_ENTRY* entry = entry_at(cache, shard, way);
+        if (entry_matches(entry, session_id, session_id_len, now))
+        {
+            result = entry;
+        }
+        else if (free_entry == NULL && !entry_live(entry, now))
+        {
+            free_entry = entry;
+        }
+    }
+    if (result == NULL)
+    {
+        result = free_entry;
+    }
+    for (size_t step = 0; step < CLOCK_MAX_STEPS && result == NULL; step++)
+    {
+        uint32_t hand = __atomic_fetch_add(&shard->hand, 1, __ATOMIC_RELAXED);
+        SESSION_ENTRY* entry = entry_at(cache, shard, hand % CRYPTO_SESSION_CACHE_WAYS);
+        if (__atomic_load_n(&entry->referenced, __ATOMIC_RELAXED) != 0)
+        {
+            __atomic_store_n(&entry->referenced, 0, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            result = entry;
+        }
+    }
+    if (result == NULL)
+    {
+        // Every entry was hit again while the hand swept, take the next one
+        result = entry_at(cache, shard, __atomic_fetch_add(&shard->hand, 1, __ATOMIC_RELAXED) % CRYPTO_SESSION_CACHE_WAYS);
+    }
+    return result;
+}
+
+CRYPTO_SESSION_CACHE_HANDLE crypto_session_cache_create(size_t capacity, size_t state_size, uint32_t lifetime_seconds)
+{
+    CRYPTO_SESSION_CACHE_INFO* result;
+    size_t entry_size = (sizeof(SESSION_ENTRY) + state_size + CRYPTO_CACHE_LINE_SIZE - 1) & ~((size_t)CRYPTO_CACHE_LINE_SIZE - 1);
+    size_t shard_stride = CRYPTO_CACHE_LINE_SIZE + (CRYPTO_SESSION_CACHE_WAYS * entry_size);
+    size_t shard_count = 1;
+    while (shard_count * CRYPTO_SESSION_CACHE_WAYS < capacity && shard_count < MAX_SHARD_COUNT)
+    {
+        shard_count *= 2;
+    }
+
+    if (capacity == 0 || state_size == 0 || state_size > UINT32_MAX || shard_count * CRYPTO_SESSION_CACHE_WAYS < capacity ||
+        shard_count > (SIZE_MAX - CRYPTO_CACHE_LINE_SIZE) / shard_stride)
+    {
+        log_error("Failure invalid parameter specified capacity: %d, state_size: %d", (int)capacity, (int)state_size);
+        result = NULL;
+    }
+    else if ((result = (CRYPTO_SESSION_CACHE_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_SESSION_CACHE_INFO))) == NULL)
+    {
+        log_error("Failure allocating session cache");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_SESSION_CACHE_INFO));
+        result->shard_count = shard_count;
+        result->shard_stride = shard_stride;
+        result->entry_size = entry_size;
+        result->state_size = state_size;
+        result->lifetime_seconds = lifetime_seconds;
+        if (crypto_drbg_random_bytes((unsigned char*)&result->hash_seed, sizeof(result->hash_seed)) != 0)
+        {
+            log_error("Failure generating hash seed");
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if ((result->allocation = crypto_alloc_malloc((shard_count * shard_stride) + CRYPTO_CACHE_LINE_SIZE - 1)) == NULL)
+        {
+            log_error("Failure allocating %d session cache shards", (int)shard_count);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else
+        {
+            uintptr_t slab_start = ((uintptr_t)result->allocation + CRYPTO_CACHE_LINE_SIZE - 1) & ~((uintptr_t)CRYPTO_CACHE_LINE_SIZE - 1);
+            result->slab = (unsigned char*)slab_start;
+            memset(result->slab, 0, shard_count * shard_stride);
+        }
+    }
+    return result;
+}
+
+void crypto_session_cache_destroy(CRYPTO_SESSION_CACHE_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        // Entries hold session secrets
+        secure_zero(handle->slab, handle->shard_count * handle->shard_stride);
+        crypto_alloc_free(handle->allocation);
+        crypto_alloc_free(handle);
+    }
+}
+
+int crypto_session_cache_insert(CRYPTO_SESSION_CACHE_HANDLE handle, const unsigned char* session_id, size_t session_id_len,
+    const unsigned char* state, size_t state_len)
+{
+    int result;
+    if (handle == NULL || session_id == NULL || session_id_len == 0 || session_id_len > CRYPTO_SESSION_ID_MAX_SIZE ||
+        state == NULL || state_len == 0 || state_len > handle->state_size)
+    {
+        log_error("Failure invalid parameter specified handle: %p, session_id: %p, session_id_len: %d, state: %p, state_len: %d",
+            handle, session_id, (int)session_id_len, state, (int)state_len);
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t now = now_seconds();
+        SESSION_SHARD* shard = shard_of(handle, hash_session_id(handle, session_id, session_id_len));
+        result = __LINE__;
+        for (size_t attempt = 0; attempt < MAX_WRITE_ATTEMPTS && result != 0; attempt++)
+        {
+            SESSION_ENTRY* entry = choose_victim(handle, shard, session_id, session_id_len, now);
+            uint32_t sequence;
+            if (claim_entry(entry, &sequence))
+            {
+                if (entry_live(entry, now) && !entry_matches(entry, session_id, session_id_len, now))
+                {
+                    __atomic_fetch_add(&shard->evictions, 1, __ATOMIC_RELAXED);
+                }
+                if (entry->state_len > state_len)
+                {
+                    secure_zero(entry->state + state_len, entry->state_len - state_len);
+                }
+                entry->id_len = (uint8_t)session_id_len;
+                memcpy(entry->id, session_id, session_id_len);
+                memcpy(entry->state, state, state_len);
+                entry->state_len = (uint32_t)state_len;
+                entry->expiry = handle->lifetime_seconds == 0 ? 0 : now + handle->lifetime_seconds;
+                // New sessions get one pass of the hand before they can go
+                __atomic_store_n(&entry->referenced, 1, __ATOMIC_RELAXED);
+                publish_entry(entry, sequence);
+                result = 0;
+            }
+        }
+        if (result == 0)
+        {
+            // Concurrent inserts of one ID can each claim a different victim,
+            // only one copy may stay or a stale one outlives the other
+            clear_matches(handle, shard, session_id, session_id_len, now, true);
+        }
+        else
+        {
+            log_error("Failure every candidate entry is being written");
+        }
+    }
+    return result;
+}
+
+int crypto_session_cache_lookup(CRYPTO_SESSION_CACHE_HANDLE handle, const unsigned char* session_id, size_t session_id_len,
+    unsigned char* state, size_t* state_len)
+{
+    int result;
+    if (handle == NULL || session_id == NULL || session_id_len == 0 || session_id_len > CRYPTO_SESSION_ID_MAX_SIZE || state == NULL || state_len == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, session_id: %p, session_id_len: %d, state: %p, state_len: %p",
+            handle, session_id, (int)session_id_len, state, state_len);
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t now = now_seconds();
+        SESSION_SHARD* shard = shard_of(handle, hash_session_id(handle, session_id, session_id_len));
+        result = __LINE__;
+        for (size_t way = 0; way < CRYPTO_SESSION_CACHE_WAYS && result != 0; way++)
+        {
+            SESSION_ENTRY* entry = entry_at(handle, shard, way);
+            for (size_t attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+            {
+                uint32_t sequence = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+                bool matches;
+                size_t copied = 0;
+                if ((sequence & 1) != 0)
+                {
+                    continue;
+                }
+                // The length can be torn mid write, the sequence check below catches it
+                matches = entry_matches(entry, session_id, session_id_len, now) && entry->state_len <= handle->state_size;
+                if (matches)
+                {
+                    copied = entry->state_len;
+                    memcpy(state, entry->state, copied);
+                }
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&entry->sequence, __ATOMIC_RELAXED) == sequence)
+                {
+                    if (matches)
+                    {
+                        // Only dirty the line when the bit actually changes
+                        if (__atomic_load_n(&entry->referenced, __ATOMIC_RELAXED) == 0)
+                        {
+                            __atomic_store_n(&entry->referenced, 1, __ATOMIC_RELAXED);
+                        }
+                        *state_len = copied;
+                        result = 0;
+                    }
+                    break;
+                }
+            }
+        }
+        __atomic_fetch_add(result == 0 ? &shard->hits : &shard->misses, 1, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+void crypto_session_cache_remove(CRYPTO_SESSION_CACHE_HANDLE handle, const unsigned char* session_id, size_t session_id_len)
+{
+    if (handle == NULL || session_id == NULL || session_id_len == 0 || session_id_len > CRYPTO_SESSION_ID_MAX_SIZE)
+    {
+        log_error("Failure invalid parameter specified handle: %p, session_id: %p, session_id_len: %d", handle, session_id, (int)session_id_len);
+    }
+    else
+    {
+        SESSION_SHARD* shard = shard_of(handle, hash_session_id(handle, session_id, session_id_len));
+        clear_matches(handle, shard, session_id, session_id_len, now_seconds(), false);
+    }
+}
+
+int crypto_session_cache_get_stats(CRYPTO_SESSION_CACHE_HANDLE handle, CRYPTO_SESSION_CACHE_STATS* stats)
+{
+    int result;
+    if (handle == NULL || stats == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, stats: %p", handle, stats);
+        result = __LINE__;
+    }
+    else
+    {
+        memset(stats, 0, sizeof(CRYPTO_SESSION_CACHE_STATS));
+        for (size_t index = 0; index < handle->shard_count; index++)
+        {
+            SESSION_SHARD* shard = (SESSION_SHARD*)(handle->slab + (index * handle->shard_stride));
+            stats->hits += __atomic_load_n(&shard->hits, __ATOMIC_RELAXED);
+            stats->misses += __atomic_load_n(&shard->misses, __ATOMIC_RELAXED);
+            stats->evictions += __atomic_load_n(&shard->evictions, __ATOMIC_RELAXED);
+        }
+        result = 0;
+    }
+    return result;
+}
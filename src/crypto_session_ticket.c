@@ -0,0 +1,237 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_session_ticket.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+// A slot only changes again after CRYPTO_TICKET_KEY_SLOTS - 1 more
+// rotations, so a reader retrying this often means rotation is being abused
+#define MAX_READ_ATTEMPTS       8
+
+#define TICKET_NONCE_OFFSET     CRYPTO_TICKET_KEY_NAME_SIZE
+#define TICKET_DATA_OFFSET      (TICKET_NONCE_OFFSET + GCM_NONCE_SIZE)
+
+// Every slot is a seqlock: rotation makes the sequence odd, rewrites the key
+// and makes it even again.  Readers use the key in place and only trust
+// their output when the sequence was even and unchanged around the use.
+typedef struct TICKET_KEY_TAG
+{
+    uint32_t sequence;
+    bool active;
+    unsigned char name[CRYPTO_TICKET_KEY_NAME_SIZE];
+    CRYPTO_GCM_KEY gcm_key;
+    // Keeps a slot being rewritten off the lines of its neighbours
+    unsigned char pad_tail[CRYPTO_CACHE_LINE_SIZE];
+} TICKET_KEY;
+
+typedef struct CRYPTO_TICKET_KEYS_INFO_TAG
+{
+    // Serializes rotations, readers never take it
+    pthread_mutex_t rotate_lock;
+    // Slot of the sealing key
+    uint32_t current;
+    unsigned char pad_current[CRYPTO_CACHE_LINE_SIZE];
+    TICKET_KEY keys[CRYPTO_TICKET_KEY_SLOTS];
+} CRYPTO_TICKET_KEYS_INFO;
+
+static uint32_t read_begin(const TICKET_KEY* key)
+{
+    return __atomic_load_n(&key->sequence, __ATOMIC_ACQUIRE);
+}
+
+static bool read_valid(const TICKET_KEY* key, uint32_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (sequence & 1) == 0 && __atomic_load_n(&key->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+static int install_key(CRYPTO_TICKET_KEYS_INFO* keys, const unsigned char* key_name, const unsigned char* key, size_t key_len)
+{
+    int result;
+    unsigned char random_name[CRYPTO_TICKET_KEY_NAME_SIZE];
+    unsigned char random_key[CRYPTO_TICKET_KEY_SIZE];
+    if (key_name == NULL && crypto_drbg_random_bytes(random_name, sizeof(random_name)) != 0)
+    {
+        log_error("Failure generating ticket key name");
+        result = __LINE__;
+    }
+    else if (key == NULL && crypto_drbg_random_bytes(random_key, sizeof(random_key)) != 0)
+    {
+        log_error("Failure generating ticket key");
+        result = __LINE__;
+    }
+    else
+    {
+        uint32_t next = (keys->current + 1) % CRYPTO_TICKET_KEY_SLOTS;
+        TICKET_KEY* slot = &keys->keys[next];
+        uint32_t sequence = slot->sequence;
+
+        __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(slot->name, key_name != NULL ? key_name : random_name, CRYPTO_TICKET_KEY_NAME_SIZE);
+        (void)crypto_gcm_key_init(&slot->gcm_key, key != NULL ? key : random_key, key != NULL ? key_len : sizeof(random_key));
+        slot->active = true;
+        __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+        __atomic_store_n(&keys->current, next, __ATOMIC_RELEASE);
+        result = 0;
+    }
+    secure_zero(random_key, sizeof(random_key));
+    return result;
+}
+
+CRYPTO_TICKET_KEYS_HANDLE crypto_ticket_keys_create(void)
+{
+    CRYPTO_TICKET_KEYS_INFO* result;
+    if ((result = (CRYPTO_TICKET_KEYS_INFO*)crypto_alloc_malloc(sizeof(CRYPTO_TICKET_KEYS_INFO))) == NULL)
+    {
+        log_error("Failure allocating ticket keys");
+    }
+    else
+    {
+        memset(result, 0, sizeof(CRYPTO_TICKET_KEYS_INFO));
+        // The first rotation fills slot 0
+        result->current = CRYPTO_TICKET_KEY_SLOTS - 1;
+        if (pthread_mutex_init(&result->rotate_lock, NULL) != 0)
+        {
+            log_error("Failure initializing rotate lock");
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+        else if (install_key(result, NULL, NULL, 0) != 0)
+        {
+            (void)pthread_mutex_destroy(&result->rotate_lock);
+            crypto_alloc_free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+void crypto_ticket_keys_destroy(CRYPTO_TICKET_KEYS_HANDLE handle)
+{
+    if (handle != NULL)
+    {
+        (void)pthread_mutex_destroy(&handle->rotate_lock);
+        secure_zero(handle, sizeof(CRYPTO_TICKET_KEYS_INFO));
+        crypto_alloc_free(handle);
+    }
+}
+
+int crypto_ticket_keys_rotate(CRYPTO_TICKET_KEYS_HANDLE handle, const unsigned char* key_name, const unsigned char* key, size_t key_len)
+{
+    int result;
+    if (handle == NULL || (key_name == NULL) != (key == NULL) || (key != NULL && key_len != CRYPTO_TICKET_KEY_SIZE))
+    {
+        log_error("Failure invalid parameter specified handle: %p, key_name: %p, key: %p, key_len: %d", handle, key_name, key, (int)key_len);
+        result = __LINE__;
+    }
+    else
+    {
+        (void)pthread_mutex_lock(&handle->rotate_lock);
+        result = install_key(handle, key_name, key, key_len);
+        (void)pthread_mutex_unlock(&handle->rotate_lock);
+    }
+    return result;
+}
+
+int crypto_ticket_seal(CRYPTO_TICKET_KEYS_HANDLE handle, const unsigned char* state, size_t state_len, unsigned char* ticket)
+{
+    int result;
+    if (handle == NULL || state == NULL || state_len == 0 || state_len > CRYPTO_TICKET_MAX_SIZE - CRYPTO_TICKET_OVERHEAD || ticket == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, state: %p, state_len: %d, ticket: %p", handle, state, (int)state_len, ticket);
+        result = __LINE__;
+    }
+    else if (crypto_drbg_random_bytes(ticket + TICKET_NONCE_OFFSET, GCM_NONCE_SIZE) != 0)
+    {
+        log_error("Failure generating ticket nonce");
+        result = __LINE__;
+    }
+    else
+    {
+        result = __LINE__;
+        for (size_t attempt = 0; attempt < MAX_READ_ATTEMPTS && result != 0; attempt++)
+        {
+            const TICKET_KEY* key = &handle->keys[__atomic_load_n(&handle->current, __ATOMIC_ACQUIRE)];
+            uint32_t sequence = read_begin(key);
+            memcpy(ticket, key->name, CRYPTO_TICKET_KEY_NAME_SIZE);
+            if (crypto_gcm_encrypt(&key->gcm_key, ticket + TICKET_NONCE_OFFSET, ticket, CRYPTO_TICKET_KEY_NAME_SIZE,
+                state, state_len, ticket + TICKET_DATA_OFFSET, ticket + TICKET_DATA_OFFSET + state_len) == 0 &&
+                read_valid(key, sequence))
+            {
+                result = 0;
+            }
+        }
+        if (result != 0)
+        {
+            log_error("Failure sealing ticket while keys rotate");
+        }
+    }
+    return result;
+}
+
+int crypto_ticket_open(CRYPTO_TICKET_KEYS_HANDLE handle, const unsigned char* ticket, size_t ticket_len, unsigned char* state, bool* renew)
+{
+    int result;
+    if (handle == NULL || ticket == NULL || ticket_len <= CRYPTO_TICKET_OVERHEAD || ticket_len > CRYPTO_TICKET_MAX_SIZE || state == NULL || renew == NULL)
+    {
+        log_error("Failure invalid parameter specified handle: %p, ticket: %p, ticket_len: %d, state: %p, renew: %p", handle, ticket, (int)ticket_len, state, renew);
+        result = __LINE__;
+    }
+    else
+    {
+        size_t state_len = ticket_len - CRYPTO_TICKET_OVERHEAD;
+        bool retry = true;
+        result = __LINE__;
+        for (size_t attempt = 0; attempt < MAX_READ_ATTEMPTS && retry; attempt++)
+        {
+            uint32_t current = __atomic_load_n(&handle->current, __ATOMIC_ACQUIRE);
+            retry = false;
+            for (uint32_t index = 0; index < CRYPTO_TICKET_KEY_SLOTS; index++)
+            {
+                const TICKET_KEY* key = &handle->keys[index];
+                uint32_t sequence = read_begin(key);
+                if (key->active && memcmp(key->name, ticket, CRYPTO_TICKET_KEY_NAME_SIZE) == 0)
+                {
+                    int opened = crypto_gcm_decrypt(&key->gcm_key, ticket + TICKET_NONCE_OFFSET, ticket, CRYPTO_TICKET_KEY_NAME_SIZE,
+                        ticket + TICKET_DATA_OFFSET, state_len, state, ticket + TICKET_DATA_OFFSET + state_len);
+                    if (!read_valid(key, sequence))
+                    {
+                        secure_zero(state, state_len);
+                        retry = true;
+                    }
+                    else
+                    {
+                        result = opened;
+                        *renew = index != current;
+                        retry = false;
+                    }
+                    break;
+                }
+                else if (!read_valid(key, sequence))
+                {
+                    retry = true;
+                }
+            }
+        }
+        if (result != 0)
+        {
+            // Unknown key names are the normal case after a key ages out
+            result = __LINE__;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,271 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_sha256.h"
+#include "cablelock/crypto_macro.h"
+
+#define HMAC_INNER_PAD      0x36
+#define HMAC_OUTER_PAD      0x5c
+#define SHA256_LENGTH_SIZE  8
+
+#define ROTATE_RIGHT(value, count)  (((value) >> (count)) | ((value) << (32 - (count))))
+#define CHOOSE(x, y, z)             (((x) & (y)) ^ (~(x) & (z)))
+#define MAJORITY(x, y, z)           (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define BIG_SIGMA0(x)               (ROTATE_RIGHT(x, 2) ^ ROTATE_RIGHT(x, 13) ^ ROTATE_RIGHT(x, 22))
+#define BIG_SIGMA1(x)               (ROTATE_RIGHT(x, 6) ^ ROTATE_RIGHT(x, 11) ^ ROTATE_RIGHT(x, 25))
+#define SMALL_SIGMA0(x)             (ROTATE_RIGHT(x, 7) ^ ROTATE_RIGHT(x, 18) ^ ((x) >> 3))
+#define SMALL_SIGMA1(x)             (ROTATE_RIGHT(x, 17) ^ ROTATE_RIGHT(x, 19) ^ ((x) >> 10))
+
+static const uint32_t initial_hash[SHA256_STATE_WORDS] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+void crypto_sha256_rounds_begin(CRYPTO_SHA256_ROUNDS* rounds, const uint32_t* state, const unsigned char* block)
+{
+    for (size_t index = 0; index < 16; index++)
+    {
+        rounds->schedule[index] = load_be32(block + (index * 4));
+    }
+    for (size_t index = 16; index < 64; index++)
+    {
+        rounds->schedule[index] = SMALL_SIGMA1(rounds->schedule[index - 2]) + rounds->schedule[index - 7] +
+            SMALL_SIGMA0(rounds->schedule[index - 15]) + rounds->schedule[index - 16];
+    }
+    memcpy(rounds->working, state, sizeof(rounds->working));
+}
+
+void crypto_sha256_rounds_run(CRYPTO_SHA256_ROUNDS* rounds, size_t first_round, size_t round_count)
+{
+    uint32_t a = rounds->working[0], b = rounds->working[1], c = rounds->working[2], d = rounds->working[3];
+    uint32_t e = rounds->working[4], f = rounds->working[5], g = rounds->working[6], h = rounds->working[7];
+
+    for (size_t index = first_round; index < first_round + round_count; index++)
+    {
+        uint32_t temp1 = h + BIG_SIGMA1(e) + CHOOSE(e, f, g) + round_constants[index] + rounds->schedule[index];
+        uint32_t temp2 = BIG_SIGMA0(a) + MAJORITY(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    rounds->working[0] = a;
+    rounds->working[1] = b;
+    rounds->working[2] = c;
+    rounds->working[3] = d;
+    rounds->working[4] = e;
+    rounds->working[5] = f;
+    rounds->working[6] = g;
+    rounds->working[7] = h;
+}
+
+void crypto_sha256_rounds_end(const CRYPTO_SHA256_ROUNDS* rounds, uint32_t* state)
+{
+    for (size_t index = 0; index < SHA256_STATE_WORDS; index++)
+    {
+        state[index] += rounds->working[index];
+    }
+}
+
+void crypto_sha256_compress(uint32_t* state, const unsigned char* block)
+{
+    CRYPTO_SHA256_ROUNDS rounds;
+    crypto_sha256_rounds_begin(&rounds, state, block);
+    crypto_sha256_rounds_run(&rounds, 0, 64);
+    crypto_sha256_rounds_end(&rounds, state);
+}
+
+void crypto_sha256_init(CRYPTO_SHA256* sha)
+{
+    memcpy(sha->state, initial_hash, sizeof(initial_hash));
+    sha->total_len = 0;
+    sha->buffer_len = 0;
+}
+
+void crypto_sha256_update(CRYPTO_SHA256* sha, const unsigned char* data, size_t data_len)
+{
+    sha->total_len += data_len;
+    if (sha->buffer_len > 0)
+    {
+        size_t fill = SHA256_BLOCK_SIZE - sha->buffer_len;
+        if (data_len < fill)
+        {
+            fill = data_len;
+        }
+        memcpy(sha->buffer + sha->buffer_len, data, fill);
+        sha->buffer_len += fill;
+        data += fill;
+        data_len -= fill;
+        if (sha->buffer_len == SHA256_BLOCK_SIZE)
+        {
+            crypto_sha256_compress(sha->state, sha->buffer);
+            sha->buffer_len = 0;
+        }
+    }
+    // Full blocks are compressed straight from the caller's buffer
+    while (data_len >= SHA256_BLOCK_SIZE)
+    {
+        crypto_sha256_compress(sha->state, data);
+        data += SHA256_BLOCK_SIZE;
+        data_len -= SHA256_BLOCK_SIZE;
+    }
+    if (data_len > 0)
+    {
+        memcpy(sha->buffer, data, data_len);
+        sha->buffer_len = data_len;
+    }
+}
+
+void crypto_sha256_finish(CRYPTO_SHA256* sha, unsigned char* digest)
+{
+    uint64_t bit_len = sha->total_len * 8;
+
+    sha->buffer[sha->buffer_len++] = 0x80;
+    if (sha->buffer_len > SHA256_BLOCK_SIZE - SHA256_LENGTH_SIZE)
+    {
+        memset(sha->buffer + sha->buffer_len, 0, SHA256_BLOCK_SIZE - sha->buffer_len);
+        crypto_sha256_compress(sha->state, sha->buffer);
+        sha->buffer_len = 0;
+    }
+    memset(sha->buffer + sha->buffer_len, 0, SHA256_BLOCK_SIZE - SHA256_LENGTH_SIZE - sha->buffer_len);
+    store_be64(sha->buffer + SHA256_BLOCK_SIZE - SHA256_LENGTH_SIZE, bit_len);
+    crypto_sha256_compress(sha->state, sha->buffer);
+
+    for (size_t index = 0; index < SHA256_STATE_WORDS; index++)
+    {
+        store_be32(digest + (index * 4), sha->state[index]);
+    }
+    secure_zero(sha, sizeof(CRYPTO_SHA256));
+}
+
+int crypto_sha256(const unsigned char* data, size_t data_len, unsigned char* digest)
+{
+    int result;
+    if ((data == NULL && data_len > 0) || digest == NULL)
+    {
+        log_error("Failure invalid parameter specified data: %p, digest: %p", data, digest);
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_SHA256 sha;
+        crypto_sha256_init(&sha);
+        crypto_sha256_update(&sha, data, data_len);
+        crypto_sha256_finish(&sha, digest);
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_hmac_sha256_key_init(CRYPTO_HMAC_SHA256_KEY* hmac_key, const unsigned char* key, size_t key_len)
+{
+    int result;
+    if (hmac_key == NULL || (key == NULL && key_len > 0))
+    {
+        log_error("Failure invalid parameter specified hmac_key: %p, key: %p", hmac_key, key);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char pad_block[SHA256_BLOCK_SIZE] = { 0 };
+
+        // Keys longer than a block are hashed first
+        if (key_len > SHA256_BLOCK_SIZE)
+        {
+            (void)crypto_sha256(key, key_len, pad_block);
+        }
+        else if (key_len > 0)
+        {
+            memcpy(pad_block, key, key_len);
+        }
+
+        for (size_t index = 0; index < SHA256_BLOCK_SIZE; index++)
+        {
+            pad_block[index] ^= HMAC_INNER_PAD;
+        }
+        memcpy(hmac_key->inner_state, initial_hash, sizeof(initial_hash));
+        crypto_sha256_compress(hmac_key->inner_state, pad_block);
+
+        for (size_t index = 0; index < SHA256_BLOCK_SIZE; index++)
+        {
+            pad_block[index] ^= HMAC_INNER_PAD ^ HMAC_OUTER_PAD;
+        }
+        memcpy(hmac_key->outer_state, initial_hash, sizeof(initial_hash));
+        crypto_sha256_compress(hmac_key->outer_state, pad_block);
+
+        secure_zero(pad_block, sizeof(pad_block));
+        result = 0;
+    }
+    return result;
+}
+
+void crypto_hmac_sha256_start(const CRYPTO_HMAC_SHA256_KEY* hmac_key, CRYPTO_SHA256* sha)
+{
+    memcpy(sha->state, hmac_key->inner_state, sizeof(sha->state));
+    sha->total_len = SHA256_BLOCK_SIZE;
+    sha->buffer_len = 0;
+}
+
+void crypto_hmac_sha256_finish(const CRYPTO_HMAC_SHA256_KEY* hmac_key, CRYPTO_SHA256* sha, unsigned char* mac)
+{
+    unsigned char inner_digest[SHA256_DIGEST_SIZE];
+
+    crypto_sha256_finish(sha, inner_digest);
+
+    memcpy(sha->state, hmac_key->outer_state, sizeof(sha->state));
+    sha->total_len = SHA256_BLOCK_SIZE;
+    sha->buffer_len = 0;
+    crypto_sha256_update(sha, inner_digest, SHA256_DIGEST_SIZE);
+    crypto_sha256_finish(sha, mac);
+    secure_zero(inner_digest, sizeof(inner_digest));
+}
+
+int crypto_hmac_sha256(const unsigned char* key, size_t key_len, const unsigned char* data, size_t data_len, unsigned char* mac)
+{
+    int result;
+    CRYPTO_HMAC_SHA256_KEY hmac_key;
+    if ((data == NULL && data_len > 0) || mac == NULL)
+    {
+        log_error("Failure invalid parameter specified data: %p, mac: %p", data, mac);
+        result = __LINE__;
+    }
+    else if (crypto_hmac_sha256_key_init(&hmac_key, key, key_len) != 0)
+    {
+        log_error("Failure initializing hmac key");
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_SHA256 sha;
+        crypto_hmac_sha256_start(&hmac_key, &sha);
+        crypto_sha256_update(&sha, data, data_len);
+        crypto_hmac_sha256_finish(&hmac_key, &sha, mac);
+        secure_zero(&hmac_key, sizeof(hmac_key));
+        result = 0;
+    }
+    return result;
+}
@@ -0,0 +1,564 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_tune.h"
+#include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_bignum.h"
+#include "cablelock/crypto_alloc.h"
+#include "cablelock/crypto_macro.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define TUNE_X86
+    #include <cpuid.h>
+#endif
+
+#define TUNE_MAGIC              "cablelock-tune"
+#define TUNE_HOST_SIZE          160
+#define TUNE_LINE_SIZE          256
+// mkstemp fills in the X's
+#define TUNE_TEMP_SUFFIX        ".XXXXXX"
+// Each measurement is the best of a few runs, the first ones pay for cold
+// caches and clock ramp up
+#define TUNE_SAMPLES            3
+
+// AES call sizes in blocks, each sample pushes the same number of bytes
+#define TUNE_SIZE_CLASSES       3
+#define TUNE_LARGEST_BLOCKS     4096
+#define TUNE_SAMPLE_BYTES       (TUNE_LARGEST_BLOCKS * AES_BLOCK_SIZE)
+#define TUNE_LEVELS             (CRYPTO_AES_ACCEL_VAES512 + 1)
+
+// Work sizes in bytes tried for the threading crossover
+#define TUNE_PARALLEL_STEPS     3
+#define TUNE_PARALLEL_LARGEST   (256 * 1024)
+
+#define TUNE_BIGNUM_LIMBS       32
+#define TUNE_BIGNUM_ROUNDS      1000
+
+static const size_t g_size_class_blocks[TUNE_SIZE_CLASSES] = { 16, 256, TUNE_LARGEST_BLOCKS };
+static const size_t g_parallel_bytes[TUNE_PARALLEL_STEPS] = { 16 * 1024, 64 * 1024, TUNE_PARALLEL_LARGEST };
+
+typedef struct TUNE_AES_WORK_TAG
+{
+    CRYPTO_AES_ACCEL level;
+    const AES_KEY_SCHEDULE* schedule;
+    const unsigned char* input;
+    unsigned char* output;
+    size_t block_count;
+} TUNE_AES_WORK;
+
+static uint64_t now_nanoseconds(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+static void fill_pattern(unsigned char* target, size_t length, unsigned char seed)
+{
+    for (size_t index = 0; index < length; index++)
+    {
+        target[index] = (unsigned char)(seed + (index * 131));
+    }
+}
+
+// Cpu model, cpu count and the features the kernels are picked from
+static void host_signature(char* signature, size_t signature_size)
+{
+    char brand[49] = "generic";
+    const char* trimmed = brand;
+#ifdef TUNE_X86
+    unsigned int words[12];
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004)
+    {
+        for (unsigned int leaf = 0; leaf < 3; leaf++)
+        {
+            (void)__get_cpuid(0x80000002 + leaf, &words[leaf * 4], &words[(leaf * 4) + 1], &words[(leaf * 4) + 2], &words[(leaf * 4) + 3]);
+        }
+        memcpy(brand, words, sizeof(words));
+        brand[sizeof(brand) - 1] = '\0';
+    }
+#endif
+    while (*trimmed == ' ')
+    {
+        trimmed++;
+    }
+    (void)snprintf(signature, signature_size, "aes=%d mulx=%d cpus=%ld %s", (int)crypto_aes_accel_detect(), crypto_bignum_detect_mulx() ? 1 : 0,
+        sysconf(_SC_NPROCESSORS_ONLN), trimmed);
+}
+
+// Candidates run through the kernel for level, never the global setting, so
+// calibrating cannot change what other threads are running.  Level NONE and
+// any blocks a kernel leaves go through the portable block cipher.
+static void aes_ctr(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* counter, const unsigned char* input,
+    unsigned char* output, size_t block_count)
+{
+    size_t done = crypto_aes_accel_ctr32_at_level(level, schedule, counter, input, output, block_count);
+    for (; done < block_count; done++)
+    {
+        unsigned char key_stream[AES_BLOCK_SIZE];
+        crypto_aes_block_encrypt(schedule, counter, key_stream);
+        store_be32(counter + 12, load_be32(counter + 12) + 1);
+        for (size_t index = 0; index < AES_BLOCK_SIZE; index++)
+        {
+            output[(done * AES_BLOCK_SIZE) + index] = input[(done * AES_BLOCK_SIZE) + index] ^ key_stream[index];
+        }
+    }
+}
+
+static void aes_cbc_decrypt(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* iv, const unsigned char* input,
+    unsigned char* output, size_t block_count)
+{
+    size_t done = crypto_aes_accel_cbc_decrypt_at_level(level, schedule, iv, input, output, block_count);
+    for (; done < block_count; done++)
+    {
+        crypto_aes_block_decrypt(schedule, input + (done * AES_BLOCK_SIZE), output + (done * AES_BLOCK_SIZE));
+        xor_value(output + (done * AES_BLOCK_SIZE), iv, AES_BLOCK_SIZE);
+        memcpy(iv, input + (done * AES_BLOCK_SIZE), AES_BLOCK_SIZE);
+    }
+}
+
+// CTR and CBC decrypt over TUNE_SAMPLE_BYTES in calls of block_count blocks
+static uint64_t time_aes(CRYPTO_AES_ACCEL level, const AES_KEY_SCHEDULE* schedule, unsigned char* input, unsigned char* output, size_t block_count)
+{
+    uint64_t result = UINT64_MAX;
+    size_t length = block_count * AES_BLOCK_SIZE;
+    for (size_t sample = 0; sample < TUNE_SAMPLES; sample++)
+    {
+        unsigned char counter[AES_BLOCK_SIZE] = { 0 };
+        unsigned char init_vector[AES_BLOCK_SIZE] = { 0 };
+        uint64_t start = now_nanoseconds();
+        uint64_t elapsed;
+        for (size_t offset = 0; offset < TUNE_SAMPLE_BYTES; offset += length)
+        {
+            aes_ctr(level, schedule, counter, input, output, block_count);
+            aes_cbc_decrypt(level, schedule, init_vector, input, output, block_count);
+        }
+        if ((elapsed = now_nanoseconds() - start) < result)
+        {
+            result = elapsed;
+        }
+    }
+    return result;
+}
+
+static int calibrate_aes(CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    unsigned char* buffer;
+    if ((buffer = (unsigned char*)crypto_alloc_malloc(2 * TUNE_SAMPLE_BYTES)) == NULL)
+    {
+        log_error("Failure allocating calibration buffer");
+        result = __LINE__;
+    }
+    else
+    {
+        uint64_t timings[TUNE_LEVELS][TUNE_SIZE_CLASSES];
+        unsigned char key[AES_128_KEY_SIZE];
+        AES_KEY_SCHEDULE schedule;
+        CRYPTO_AES_ACCEL detected = crypto_aes_accel_detect();
+
+        fill_pattern(key, sizeof(key), 0x5A);
+        fill_pattern(buffer, TUNE_SAMPLE_BYTES, 0x3C);
+        (void)crypto_aes_key_init(&schedule, key, sizeof(key));
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)detected; level++)
+        {
+            for (size_t size_class = 0; size_class < TUNE_SIZE_CLASSES; size_class++)
+            {
+                timings[level][size_class] = time_aes((CRYPTO_AES_ACCEL)level, &schedule, buffer, buffer + TUNE_SAMPLE_BYTES, g_size_class_blocks[size_class]);
+            }
+        }
+
+        // Bulk throughput picks the level
+        profile->aes_level = CRYPTO_AES_ACCEL_NONE;
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)detected; level++)
+        {
+            if (timings[level][TUNE_SIZE_CLASSES - 1] < timings[profile->aes_level][TUNE_SIZE_CLASSES - 1])
+            {
+                profile->aes_level = (CRYPTO_AES_ACCEL)level;
+            }
+        }
+
+        // Walking down from bulk, the wide kernels keep every size above the
+        // first class they lose
+        profile->aes_wide_threshold = 0;
+        if (profile->aes_level == CRYPTO_AES_ACCEL_VAES512)
+        {
+            for (size_t size_class = TUNE_SIZE_CLASSES - 1; size_class > 0; size_class--)
+            {
+                if (timings[CRYPTO_AES_ACCEL_VAES512][size_class - 1] > timings[CRYPTO_AES_ACCEL_AESNI][size_class - 1])
+                {
+                    profile->aes_wide_threshold = g_size_class_blocks[size_class];
+                    break;
+                }
+            }
+        }
+
+        secure_zero(&schedule, sizeof(schedule));
+        crypto_alloc_free(buffer);
+        result = 0;
+    }
+    return result;
+}
+
+// The kernel the profile would pick for a call of block_count blocks
+static CRYPTO_AES_ACCEL profile_level(const CRYPTO_TUNE_PROFILE* profile, size_t block_count)
+{
+    CRYPTO_AES_ACCEL result = profile->aes_level;
+    if (result == CRYPTO_AES_ACCEL_VAES512 && block_count < profile->aes_wide_threshold)
+    {
+        result = CRYPTO_AES_ACCEL_AESNI;
+    }
+    return result;
+}
+
+static void* aes_worker(void* parameter)
+{
+    TUNE_AES_WORK* work = (TUNE_AES_WORK*)parameter;
+    unsigned char counter[AES_BLOCK_SIZE] = { 0 };
+    aes_ctr(work->level, work->schedule, counter, work->input, work->output, work->block_count);
+    return NULL;
+}
+
+// CTR over block_count blocks in one call, or the second half on a fresh thread
+static uint64_t time_split(const CRYPTO_TUNE_PROFILE* profile, const AES_KEY_SCHEDULE* schedule, const unsigned char* input, unsigned char* output,
+    size_t block_count, bool split)
+{
+    uint64_t result = UINT64_MAX;
+    for (size_t sample = 0; sample < TUNE_SAMPLES; sample++)
+    {
+        uint64_t start = now_nanoseconds();
+        uint64_t elapsed;
+        if (split)
+        {
+            pthread_t thread;
+            size_t half = block_count / 2;
+            TUNE_AES_WORK work = { profile_level(profile, block_count - half), schedule, input + (half * AES_BLOCK_SIZE),
+                output + (half * AES_BLOCK_SIZE), block_count - half };
+            TUNE_AES_WORK own = { profile_level(profile, half), schedule, input, output, half };
+            if (pthread_create(&thread, NULL, aes_worker, &work) != 0)
+            {
+                // Cannot split here, so it never pays
+                break;
+            }
+            (void)aes_worker(&own);
+            (void)pthread_join(thread, NULL);
+        }
+        else
+        {
+            TUNE_AES_WORK own = { profile_level(profile, block_count), schedule, input, output, block_count };
+            (void)aes_worker(&own);
+        }
+        if ((elapsed = now_nanoseconds() - start) < result)
+        {
+            result = elapsed;
+        }
+    }
+    return result;
+}
+
+// Run after the AES kernels are picked, the crossover depends on them
+static int calibrate_parallel(CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    unsigned char* buffer;
+    profile->parallel_threshold = 0;
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+    {
+        result = 0;
+    }
+    else if ((buffer = (unsigned char*)crypto_alloc_malloc(2 * TUNE_PARALLEL_LARGEST)) == NULL)
+    {
+        log_error("Failure allocating calibration buffer");
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char key[AES_128_KEY_SIZE];
+        AES_KEY_SCHEDULE schedule;
+        fill_pattern(key, sizeof(key), 0xA5);
+        fill_pattern(buffer, TUNE_PARALLEL_LARGEST, 0x69);
+        (void)crypto_aes_key_init(&schedule, key, sizeof(key));
+
+        for (size_t step = 0; step < TUNE_PARALLEL_STEPS; step++)
+        {
+            size_t block_count = g_parallel_bytes[step] / AES_BLOCK_SIZE;
+            if (time_split(profile, &schedule, buffer, buffer + TUNE_PARALLEL_LARGEST, block_count, true) <
+                time_split(profile, &schedule, buffer, buffer + TUNE_PARALLEL_LARGEST, block_count, false))
+            {
+                profile->parallel_threshold = g_parallel_bytes[step];
+                break;
+            }
+        }
+
+        secure_zero(&schedule, sizeof(schedule));
+        crypto_alloc_free(buffer);
+        result = 0;
+    }
+    return result;
+}
+
+static uint64_t time_mont_mul(const CRYPTO_MONT_CONTEXT* context, uint64_t* value, const uint64_t* factor, bool mulx)
+{
+    uint64_t result = UINT64_MAX;
+    for (size_t sample = 0; sample < TUNE_SAMPLES; sample++)
+    {
+        uint64_t start = now_nanoseconds();
+        uint64_t elapsed;
+        for (size_t round = 0; round < TUNE_BIGNUM_ROUNDS; round++)
+        {
+            crypto_bignum_mont_mul_kernel(context, value, value, factor, mulx);
+        }
+        if ((elapsed = now_nanoseconds() - start) < result)
+        {
+            result = elapsed;
+        }
+    }
+    return result;
+}
+
+static void calibrate_bignum(CRYPTO_TUNE_PROFILE* profile)
+{
+    profile->bignum_mulx = false;
+    if (crypto_bignum_detect_mulx())
+    {
+        CRYPTO_MONT_CONTEXT context;
+        uint64_t modulus[TUNE_BIGNUM_LIMBS];
+        uint64_t value[TUNE_BIGNUM_LIMBS];
+        uint64_t factor[TUNE_BIGNUM_LIMBS];
+
+        // An odd 2048-bit modulus with both operands below it
+        for (size_t index = 0; index < TUNE_BIGNUM_LIMBS; index++)
+        {
+            modulus[index] = 0x9e3779b97f4a7c15ULL * (index + 1);
+            value[index] = modulus[index] >> 1;
+            factor[index] = modulus[index] >> 2;
+        }
+        modulus[0] |= 1;
+        modulus[TUNE_BIGNUM_LIMBS - 1] |= 0x8000000000000000ULL;
+        if (crypto_bignum_mont_init(&context, modulus, TUNE_BIGNUM_LIMBS) == 0)
+        {
+            uint64_t mulx_time = time_mont_mul(&context, value, factor, true);
+            profile->bignum_mulx = mulx_time < time_mont_mul(&context, value, factor, false);
+        }
+    }
+}
+
+int crypto_tune_calibrate(CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    if (profile == NULL)
+    {
+        log_error("Failure invalid parameter specified profile: NULL");
+        result = __LINE__;
+    }
+    else if (calibrate_aes(profile) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        calibrate_bignum(profile);
+        result = calibrate_parallel(profile);
+    }
+    return result;
+}
+
+int crypto_tune_apply(const CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    if (profile == NULL)
+    {
+        log_error("Failure invalid parameter specified profile: NULL");
+        result = __LINE__;
+    }
+    else if (crypto_aes_accel_set_level(profile->aes_level) != 0)
+    {
+        log_error("Failure applying aes level %d", (int)profile->aes_level);
+        result = __LINE__;
+    }
+    else if (crypto_bignum_set_mulx(profile->bignum_mulx) != 0)
+    {
+        log_error("Failure applying bignum mulx setting");
+        result = __LINE__;
+    }
+    else
+    {
+        crypto_aes_accel_set_wide_threshold(profile->aes_wide_threshold);
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_tune_load(const char* path, CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    FILE* file;
+    if (path == NULL || profile == NULL)
+    {
+        log_error("Failure invalid parameter specified path: %p, profile: %p", path, profile);
+        result = __LINE__;
+    }
+    else if ((file = fopen(path, "r")) == NULL)
+    {
+        log_info("No tune cache at %s", path);
+        result = __LINE__;
+    }
+    else
+    {
+        char line[TUNE_LINE_SIZE];
+        char host[TUNE_HOST_SIZE];
+        int version = 0;
+        int aes_level = -1;
+        int bignum_mulx = -1;
+        size_t wide_threshold = SIZE_MAX;
+        size_t parallel_threshold = SIZE_MAX;
+        bool host_matches = false;
+
+        host_signature(host, sizeof(host));
+        if (fgets(line, sizeof(line), file) != NULL && sscanf(line, TUNE_MAGIC " %d", &version) == 1 && version == CRYPTO_TUNE_VERSION)
+        {
+            while (fgets(line, sizeof(line), file) != NULL)
+            {
+                line[strcspn(line, "\r\n")] = '\0';
+                if (strncmp(line, "host ", 5) == 0)
+                {
+                    host_matches = strcmp(line + 5, host) == 0;
+                }
+                else
+                {
+                    // Each pattern only matches its own key
+                    (void)sscanf(line, "aes_level %d", &aes_level);
+                    (void)sscanf(line, "aes_wide_threshold %zu", &wide_threshold);
+                    (void)sscanf(line, "bignum_mulx %d", &bignum_mulx);
+                    (void)sscanf(line, "parallel_threshold %zu", &parallel_threshold);
+                }
+            }
+        }
+        (void)fclose(file);
+
+        if (version != CRYPTO_TUNE_VERSION || !host_matches)
+        {
+            log_info("Tune cache %s is from another version or host", path);
+            result = __LINE__;
+        }
+        else if (aes_level < CRYPTO_AES_ACCEL_NONE || aes_level > (int)crypto_aes_accel_detect() || (bignum_mulx != 0 && bignum_mulx != 1) ||
+            wide_threshold == SIZE_MAX || parallel_threshold == SIZE_MAX)
+        {
+            log_error("Failure parsing tune cache %s", path);
+            result = __LINE__;
+        }
+        else
+        {
+            profile->aes_level = (CRYPTO_AES_ACCEL)aes_level;
+            profile->aes_wide_threshold = wide_threshold;
+            profile->bignum_mulx = bignum_mulx == 1;
+            profile->parallel_threshold = parallel_threshold;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_tune_save(const char* path, const CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    char* temp_path;
+    if (path == NULL || profile == NULL)
+    {
+        log_error("Failure invalid parameter specified path: %p, profile: %p", path, profile);
+        result = __LINE__;
+    }
+    else if ((temp_path = (char*)crypto_alloc_malloc(strlen(path) + sizeof(TUNE_TEMP_SUFFIX))) == NULL)
+    {
+        log_error("Failure allocating tune cache path");
+        result = __LINE__;
+    }
+    else
+    {
+        int fd;
+        FILE* file;
+        char host[TUNE_HOST_SIZE];
+        host_signature(host, sizeof(host));
+        strcpy(temp_path, path);
+        strcat(temp_path, TUNE_TEMP_SUFFIX);
+        // A fresh name created with O_EXCL and mode 0600, an existing file or
+        // symlink is never opened
+        if ((fd = mkstemp(temp_path)) < 0)
+        {
+            log_error("Failure creating tune cache beside %s", path);
+            result = __LINE__;
+        }
+        else if ((file = fdopen(fd, "w")) == NULL)
+        {
+            log_error("Failure opening tune cache %s", temp_path);
+            (void)close(fd);
+            (void)unlink(temp_path);
+            result = __LINE__;
+        }
+        else
+        {
+            int written = fprintf(file, TUNE_MAGIC " %d\nhost %s\naes_level %d\naes_wide_threshold %zu\nbignum_mulx %d\nparallel_threshold %zu\n",
+                CRYPTO_TUNE_VERSION, host, (int)profile->aes_level, profile->aes_wide_threshold, profile->bignum_mulx ? 1 : 0, profile->parallel_threshold);
+            // On disk before the rename, so a crash leaves the old cache or the new one
+            bool synced = written >= 0 && fflush(file) == 0 && fsync(fd) == 0;
+            if (fclose(file) != 0 || !synced)
+            {
+                log_error("Failure writing tune cache %s", temp_path);
+                (void)unlink(temp_path);
+                result = __LINE__;
+            }
+            else if (rename(temp_path, path) != 0)
+            {
+                log_error("Failure replacing tune cache %s", path);
+                (void)unlink(temp_path);
+                result = __LINE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+        crypto_alloc_free(temp_path);
+    }
+    return result;
+}
+
+int crypto_tune_init(const char* cache_path, CRYPTO_TUNE_PROFILE* profile)
+{
+    int result;
+    CRYPTO_TUNE_PROFILE local_profile;
+    CRYPTO_TUNE_PROFILE* target = profile != NULL ? profile : &local_profile;
+    if (cache_path != NULL && crypto_tune_load(cache_path, target) == 0)
+    {
+        result = crypto_tune_apply(target);
+    }
+    else if (crypto_tune_calibrate(target) != 0)
+    {
+        log_error("Failure calibrating");
+        result = __LINE__;
+    }
+    else
+    {
+        // A cache that cannot be written only costs the next start a calibration
+        if (cache_path != NULL && crypto_tune_save(cache_path, target) != 0)
+        {
+            log_error("Failure saving tune cache, continuing with the calibrated values");
+        }
+        result = crypto_tune_apply(target);
+    }
+    return result;
+}
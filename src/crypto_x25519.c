@@ -0,0 +1,627 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_x25519.h"
+#include "cablelock/crypto_drbg.h"
+#include "cablelock/crypto_macro.h"
+
+// Field elements mod 2^255 - 19 in five 51-bit limbs.  Products run through
+// 128-bit multiplies, the top limb folds back into the bottom one times 19.
+#define LIMB_BITS           51
+#define LIMB_MASK           ((((uint64_t)1) << LIMB_BITS) - 1)
+#define LIMB_COUNT          5
+// (A - 2) / 4 for the curve constant A = 486662
+#define LADDER_A24          121665
+// The base table holds 1..8 times 16^(2i) times the base point for every
+// second radix-16 digit, the other digits reuse it after four doublings
+#define BASE_TABLE_ROWS     32
+#define BASE_TABLE_COLUMNS  8
+
+typedef unsigned __int128 uint128;
+typedef uint64_t FIELD_ELEMENT[LIMB_COUNT];
+
+// Points on the birationally equivalent Edwards curve, used only for the
+// fixed base multiply.  Extended coordinates x = X/Z, y = Y/Z, x * y = T/Z.
+typedef struct EDWARDS_POINT_TAG
+{
+    FIELD_ELEMENT x;
+    FIELD_ELEMENT y;
+    FIELD_ELEMENT z;
+    FIELD_ELEMENT t;
+} EDWARDS_POINT;
+
+// Sum of two points before its final multiplies ((X:Z), (Y:T))
+typedef struct EDWARDS_COMPLETED_TAG
+{
+    FIELD_ELEMENT x;
+    FIELD_ELEMENT y;
+    FIELD_ELEMENT z;
+    FIELD_ELEMENT t;
+} EDWARDS_COMPLETED;
+
+// Affine point stored as (y + x, y - x, 2 * d * x * y) so mixed addition
+// needs no inversion and negation is a swap
+typedef struct EDWARDS_PRECOMP_TAG
+{
+    FIELD_ELEMENT y_plus_x;
+    FIELD_ELEMENT y_minus_x;
+    FIELD_ELEMENT xy2d;
+} EDWARDS_PRECOMP;
+
+// Edwards form of the base point u = 9
+static const unsigned char BASE_POINT_X[X25519_KEY_SIZE] = {
+    0x1a, 0xd5, 0x25, 0x8f, 0x60, 0x2d, 0x56, 0xc9, 0xb2, 0xa7, 0x25, 0x95, 0x60, 0xc7, 0x2c, 0x69,
+    0x5c, 0xdc, 0xd6, 0xfd, 0x31, 0xe2, 0xa4, 0xc0, 0xfe, 0x53, 0x6e, 0xcd, 0xd3, 0x36, 0x69, 0x21
+};
+static const unsigned char BASE_POINT_Y[X25519_KEY_SIZE] = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+static pthread_once_t g_base_table_once = PTHREAD_ONCE_INIT;
+static EDWARDS_PRECOMP g_base_table[BASE_TABLE_ROWS][BASE_TABLE_COLUMNS];
+
+static void fe_zero(FIELD_ELEMENT h)
+{
+    memset(h, 0, sizeof(FIELD_ELEMENT));
+}
+
+static void fe_one(FIELD_ELEMENT h)
+{
+    fe_zero(h);
+    h[0] = 1;
+}
+
+static void fe_copy(FIELD_ELEMENT h, const FIELD_ELEMENT f)
+{
+    memcpy(h, f, sizeof(FIELD_ELEMENT));
+}
+
+// Brings every limb back under 2^51 plus a small carry into limb 0
+static void fe_carry(FIELD_ELEMENT h)
+{
+    uint64_t carry;
+    carry = h[0] >> LIMB_BITS; h[0] &= LIMB_MASK; h[1] += carry;
+    carry = h[1] >> LIMB_BITS; h[1] &= LIMB_MASK; h[2] += carry;
+    carry = h[2] >> LIMB_BITS; h[2] &= LIMB_MASK; h[3] += carry;
+    carry = h[3] >> LIMB_BITS; h[3] &= LIMB_MASK; h[4] += carry;
+    carry = h[4] >> LIMB_BITS; h[4] &= LIMB_MASK; h[0] += carry * 19;
+}
+
+// No carry, sums only ever feed a multiply or the subtrahend of fe_sub,
+// both of which take limbs up to 2^53
+static void fe_add(FIELD_ELEMENT h, const FIELD_ELEMENT f, const FIELD_ELEMENT g)
+{
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        h[index] = f[index] + g[index];
+    }
+}
+
+// Adds 4p first so no limb goes negative, then carries so the result can go
+// through another add
+static void fe_sub(FIELD_ELEMENT h, const FIELD_ELEMENT f, const FIELD_ELEMENT g)
+{
+    h[0] = (f[0] + 0x1FFFFFFFFFFFB4ULL) - g[0];
+    h[1] = (f[1] + 0x1FFFFFFFFFFFFCULL) - g[1];
+    h[2] = (f[2] + 0x1FFFFFFFFFFFFCULL) - g[2];
+    h[3] = (f[3] + 0x1FFFFFFFFFFFFCULL) - g[3];
+    h[4] = (f[4] + 0x1FFFFFFFFFFFFCULL) - g[4];
+    fe_carry(h);
+}
+
+static void fe_neg(FIELD_ELEMENT h, const FIELD_ELEMENT f)
+{
+    FIELD_ELEMENT zero;
+    fe_zero(zero);
+    fe_sub(h, zero, f);
+}
+
+static void fe_reduce_product(FIELD_ELEMENT h, uint128 r0, uint128 r1, uint128 r2, uint128 r3, uint128 r4)
+{
+    uint64_t carry;
+    r1 += (uint64_t)(r0 >> LIMB_BITS);
+    r2 += (uint64_t)(r1 >> LIMB_BITS);
+    r3 += (uint64_t)(r2 >> LIMB_BITS);
+    r4 += (uint64_t)(r3 >> LIMB_BITS);
+    carry = (uint64_t)(r4 >> LIMB_BITS);
+    h[0] = ((uint64_t)r0 & LIMB_MASK) + (carry * 19);
+    h[1] = (uint64_t)r1 & LIMB_MASK;
+    h[2] = (uint64_t)r2 & LIMB_MASK;
+    h[3] = (uint64_t)r3 & LIMB_MASK;
+    h[4] = (uint64_t)r4 & LIMB_MASK;
+    carry = h[0] >> LIMB_BITS;
+    h[0] &= LIMB_MASK;
+    h[1] += carry;
+}
+
+static void fe_mul(FIELD_ELEMENT h, const FIELD_ELEMENT f, const FIELD_ELEMENT g)
+{
+    uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    uint64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+    uint64_t g1_19 = g1 * 19, g2_19 = g2 * 19, g3_19 = g3 * 19, g4_19 = g4 * 19;
+
+    uint128 r0 = (uint128)f0 * g0 + (uint128)f1 * g4_19 + (uint128)f2 * g3_19 + (uint128)f3 * g2_19 + (uint128)f4 * g1_19;
+    uint128 r1 = (uint128)f0 * g1 + (uint128)f1 * g0 + (uint128)f2 * g4_19 + (uint128)f3 * g3_19 + (uint128)f4 * g2_19;
+    uint128 r2 = (uint128)f0 * g2 + (uint128)f1 * g1 + (uint128)f2 * g0 + (uint128)f3 * g4_19 + (uint128)f4 * g3_19;
+    uint128 r3 = (uint128)f0 * g3 + (uint128)f1 * g2 + (uint128)f2 * g1 + (uint128)f3 * g0 + (uint128)f4 * g4_19;
+    uint128 r4 = (uint128)f0 * g4 + (uint128)f1 * g3 + (uint128)f2 * g2 + (uint128)f3 * g1 + (uint128)f4 * g0;
+    fe_reduce_product(h, r0, r1, r2, r3, r4);
+}
+
+// Squaring shares the symmetric cross products, 15 multiplies instead of 25
+static void fe_sq(FIELD_ELEMENT h, const FIELD_ELEMENT f)
+{
+    uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    uint64_t f0_2 = f0 * 2, f1_2 = f1 * 2;
+    uint64_t f3_19 = f3 * 19, f4_19 = f4 * 19;
+
+    uint128 r0 = (uint128)f0 * f0 + (uint128)f1_2 * f4_19 + (uint128)(f2 * 2) * f3_19;
+    uint128 r1 = (uint128)f0_2 * f1 + (uint128)(f2 * 2) * f4_19 + (uint128)f3 * f3_19;
+    uint128 r2 = (uint128)f0_2 * f2 + (uint128)f1 * f1 + (uint128)(f3 * 2) * f4_19;
+    uint128 r3 = (uint128)f0_2 * f3 + (uint128)f1_2 * f2 + (uint128)f4 * f4_19;
+    uint128 r4 = (uint128)f0_2 * f4 + (uint128)f1_2 * f3 + (uint128)f2 * f2;
+    fe_reduce_product(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sq_times(FIELD_ELEMENT h, const FIELD_ELEMENT f, size_t count)
+{
+    fe_sq(h, f);
+    while (--count > 0)
+    {
+        fe_sq(h, h);
+    }
+}
+
+static void fe_mul_small(FIELD_ELEMENT h, const FIELD_ELEMENT f, uint64_t value)
+{
+    fe_reduce_product(h, (uint128)f[0] * value, (uint128)f[1] * value, (uint128)f[2] * value, (uint128)f[3] * value, (uint128)f[4] * value);
+}
+
+// f^(p - 2) through the usual chain of 254 squarings and 11 multiplies
+static void fe_invert(FIELD_ELEMENT h, const FIELD_ELEMENT f)
+{
+    FIELD_ELEMENT z2, z9, z11, z_5_0, z_10_0, z_20_0, z_50_0, z_100_0, t;
+
+    fe_sq(z2, f);
+    fe_sq_times(t, z2, 2);
+    fe_mul(z9, t, f);
+    fe_mul(z11, z9, z2);
+    fe_sq(t, z11);
+    fe_mul(z_5_0, t, z9);
+    fe_sq_times(t, z_5_0, 5);
+    fe_mul(z_10_0, t, z_5_0);
+    fe_sq_times(t, z_10_0, 10);
+    fe_mul(z_20_0, t, z_10_0);
+    fe_sq_times(t, z_20_0, 20);
+    fe_mul(t, t, z_20_0);
+    fe_sq_times(t, t, 10);
+    fe_mul(z_50_0, t, z_10_0);
+    fe_sq_times(t, z_50_0, 50);
+    fe_mul(z_100_0, t, z_50_0);
+    fe_sq_times(t, z_100_0, 100);
+    fe_mul(t, t, z_100_0);
+    fe_sq_times(t, t, 50);
+    fe_mul(t, t, z_50_0);
+    fe_sq_times(t, t, 5);
+    fe_mul(h, t, z11);
+}
+
+// Bit 255 is ignored as RFC 7748 asks
+static void fe_from_bytes(FIELD_ELEMENT h, const unsigned char* src)
+{
+    h[0] = load_le64(src) & LIMB_MASK;
+    h[1] = (load_le64(src + 6) >> 3) & LIMB_MASK;
+    h[2] = (load_le64(src + 12) >> 6) & LIMB_MASK;
+    h[3] = (load_le64(src + 19) >> 1) & LIMB_MASK;
+    h[4] = (load_le64(src + 24) >> 12) & LIMB_MASK;
+}
+
+// Fully reduced encoding, values in [p, 2^255) are brought below p
+static void fe_to_bytes(unsigned char* target, const FIELD_ELEMENT f)
+{
+    FIELD_ELEMENT h;
+    uint64_t q;
+    fe_copy(h, f);
+    fe_carry(h);
+    fe_carry(h);
+
+    // q is 1 exactly when h >= p
+    q = (h[0] + 19) >> LIMB_BITS;
+    q = (h[1] + q) >> LIMB_BITS;
+    q = (h[2] + q) >> LIMB_BITS;
+    q = (h[3] + q) >> LIMB_BITS;
+    q = (h[4] + q) >> LIMB_BITS;
+    h[0] += 19 * q;
+    h[1] += h[0] >> LIMB_BITS; h[0] &= LIMB_MASK;
+    h[2] += h[1] >> LIMB_BITS; h[1] &= LIMB_MASK;
+    h[3] += h[2] >> LIMB_BITS; h[2] &= LIMB_MASK;
+    h[4] += h[3] >> LIMB_BITS; h[3] &= LIMB_MASK;
+    h[4] &= LIMB_MASK;
+
+    store_le64(target, h[0] | (h[1] << 51));
+    store_le64(target + 8, (h[1] >> 13) | (h[2] << 38));
+    store_le64(target + 16, (h[2] >> 26) | (h[3] << 25));
+    store_le64(target + 24, (h[3] >> 39) | (h[4] << 12));
+}
+
+// Swaps f and g when swap is 1 without a branch or a secret dependent address
+static void fe_cswap(FIELD_ELEMENT f, FIELD_ELEMENT g, uint64_t swap)
+{
+    uint64_t mask = (uint64_t)0 - swap;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        uint64_t diff = mask & (f[index] ^ g[index]);
+        f[index] ^= diff;
+        g[index] ^= diff;
+    }
+}
+
+static void fe_cmov(FIELD_ELEMENT f, const FIELD_ELEMENT g, uint64_t move)
+{
+    uint64_t mask = (uint64_t)0 - move;
+    for (size_t index = 0; index < LIMB_COUNT; index++)
+    {
+        f[index] ^= mask & (f[index] ^ g[index]);
+    }
+}
+
+static void clamp_scalar(unsigned char scalar[X25519_KEY_SIZE], const unsigned char* private_key)
+{
+    memcpy(scalar, private_key, X25519_KEY_SIZE);
+    scalar[0] &= 248;
+    scalar[31] &= 127;
+    scalar[31] |= 64;
+}
+
+// RFC 7748 section 5, one differential add and one double per scalar bit
+static void montgomery_ladder(FIELD_ELEMENT result, const unsigned char scalar[X25519_KEY_SIZE], const FIELD_ELEMENT u)
+{
+    FIELD_ELEMENT x2, z2, x3, z3;
+    FIELD_ELEMENT a, aa, b, bb, e, c, d, da, cb;
+    uint64_t swap = 0;
+
+    fe_one(x2);
+    fe_zero(z2);
+    fe_copy(x3, u);
+    fe_one(z3);
+
+    for (size_t bit = 255; bit > 0; bit--)
+    {
+        uint64_t k_bit = (scalar[(bit - 1) / 8] >> ((bit - 1) % 8)) & 1;
+        swap ^= k_bit;
+        fe_cswap(x2, x3, swap);
+        fe_cswap(z2, z3, swap);
+        swap = k_bit;
+
+        fe_add(a, x2, z2);
+        fe_sq(aa, a);
+        fe_sub(b, x2, z2);
+        fe_sq(bb, b);
+        fe_sub(e, aa, bb);
+        fe_add(c, x3, z3);
+        fe_sub(d, x3, z3);
+        fe_mul(da, d, a);
+        fe_mul(cb, c, b);
+        fe_add(x3, da, cb);
+        fe_sq(x3, x3);
+        fe_sub(z3, da, cb);
+        fe_sq(z3, z3);
+        fe_mul(z3, z3, u);
+        fe_mul(x2, aa, bb);
+        fe_mul_small(z2, e, LADDER_A24);
+        fe_add(z2, z2, aa);
+        fe_mul(z2, z2, e);
+    }
+    fe_cswap(x2, x3, swap);
+    fe_cswap(z2, z3, swap);
+
+    fe_invert(z2, z2);
+    fe_mul(result, x2, z2);
+}
+
+static void edwards_identity(EDWARDS_POINT* point)
+{
+    fe_zero(point->x);
+    fe_one(point->y);
+    fe_one(point->z);
+    fe_zero(point->t);
+}
+
+static void precomp_identity(EDWARDS_PRECOMP* precomp)
+{
+    fe_one(precomp->y_plus_x);
+    fe_one(precomp->y_minus_x);
+    fe_zero(precomp->xy2d);
+}
+
+static void completed_to_projective(EDWARDS_POINT* result, const EDWARDS_COMPLETED* completed)
+{
+    fe_mul(result->x, completed->x, completed->t);
+    fe_mul(result->y, completed->y, completed->z);
+    fe_mul(result->z, completed->z, completed->t);
+}
+
+static void completed_to_extended(EDWARDS_POINT* result, const EDWARDS_COMPLETED* completed)
+{
+    completed_to_projective(result, completed);
+    fe_mul(result->t, completed->x, completed->y);
+}
+
+// Doubling ignores T, so it can chain on projective points
+static void edwards_double(EDWARDS_COMPLETED* result, const EDWARDS_POINT* point)
+{
+    FIELD_ELEMENT xx, yy, zz2, xy;
+    fe_sq(xx, point->x);
+    fe_sq(yy, point->y);
+    fe_sq(zz2, point->z);
+    fe_add(zz2, zz2, zz2);
+    fe_add(xy, point->x, point->y);
+    fe_sq(xy, xy);
+    fe_add(result->y, yy, xx);
+    fe_sub(result->z, yy, xx);
+    fe_sub(result->x, xy, result->y);
+    fe_sub(result->t, zz2, result->z);
+}
+
+static void edwards_add_precomp(EDWARDS_COMPLETED* result, const EDWARDS_POINT* point, const EDWARDS_PRECOMP* precomp)
+{
+    FIELD_ELEMENT a, b, c, d;
+    fe_add(result->x, point->y, point->x);
+    fe_sub(result->y, point->y, point->x);
+    fe_mul(a, result->x, precomp->y_plus_x);
+    fe_mul(b, result->y, precomp->y_minus_x);
+    fe_mul(c, precomp->xy2d, point->t);
+    fe_add(d, point->z, point->z);
+    fe_sub(result->x, a, b);
+    fe_add(result->y, a, b);
+    fe_add(result->z, d, c);
+    fe_sub(result->t, d, c);
+}
+
+static void edwards_to_precomp(EDWARDS_PRECOMP* result, const EDWARDS_POINT* point, const FIELD_ELEMENT d2)
+{
+    FIELD_ELEMENT z_inverse, x, y;
+    fe_invert(z_inverse, point->z);
+    fe_mul(x, point->x, z_inverse);
+    fe_mul(y, point->y, z_inverse);
+    fe_add(result->y_plus_x, y, x);
+    fe_sub(result->y_minus_x, y, x);
+    fe_mul(result->xy2d, x, y);
+    fe_mul(result->xy2d, result->xy2d, d2);
+}
+
+// Built once per process, about a millisecond of work that every later
+// public key skips
+static void build_base_table(void)
+{
+    FIELD_ELEMENT d2, numerator, denominator;
+    EDWARDS_POINT row_base;
+    EDWARDS_COMPLETED completed;
+
+    // d = -121665 / 121666, stored doubled as the addition uses it
+    fe_zero(numerator);
+    numerator[0] = 121665;
+    fe_neg(numerator, numerator);
+    fe_zero(denominator);
+    denominator[0] = 121666;
+    fe_invert(denominator, denominator);
+    fe_mul(d2, numerator, denominator);
+    fe_add(d2, d2, d2);
+
+    fe_from_bytes(row_base.x, BASE_POINT_X);
+    fe_from_bytes(row_base.y, BASE_POINT_Y);
+    fe_one(row_base.z);
+    fe_mul(row_base.t, row_base.x, row_base.y);
+
+    for (size_t row = 0; row < BASE_TABLE_ROWS; row++)
+    {
+        EDWARDS_POINT multiple = row_base;
+        edwards_to_precomp(&g_base_table[row][0], &row_base, d2);
+        for (size_t column = 1; column < BASE_TABLE_COLUMNS; column++)
+        {
+            edwards_add_precomp(&completed, &multiple, &g_base_table[row][0]);
+            completed_to_extended(&multiple, &completed);
+            edwards_to_precomp(&g_base_table[row][column], &multiple, d2);
+        }
+        // Next row starts at 256 times this one
+        for (size_t doubling = 0; doubling < 8; doubling++)
+        {
+            edwards_double(&completed, &row_base);
+            if (doubling < 7)
+            {
+                completed_to_projective(&row_base, &completed);
+            }
+            else
+            {
+                completed_to_extended(&row_base, &completed);
+            }
+        }
+    }
+}
+
+static uint64_t equal_mask(uint32_t left, uint32_t right)
+{
+    return (uint64_t)(((left ^ right) - 1) >> 31);
+}
+
+// Loads digit times the row base, digit in [-8, 8].  Every entry is read so
+// the access pattern does not depend on the digit.
+static void select_precomp(EDWARDS_PRECOMP* result, size_t row, signed char digit)
+{
+    EDWARDS_PRECOMP negated;
+    int32_t sign_mask = (int32_t)digit >> 31;
+    uint64_t negative = (uint64_t)(sign_mask & 1);
+    uint32_t magnitude = (uint32_t)((digit ^ sign_mask) - sign_mask);
+
+    precomp_identity(result);
+    for (size_t column = 0; column < BASE_TABLE_COLUMNS; column++)
+    {
+        uint64_t move = equal_mask(magnitude, (uint32_t)column + 1);
+        fe_cmov(result->y_plus_x, g_base_table[row][column].y_plus_x, move);
+        fe_cmov(result->y_minus_x, g_base_table[row][column].y_minus_x, move);
+        fe_cmov(result->xy2d, g_base_table[row][column].xy2d, move);
+    }
+    fe_copy(negated.y_plus_x, result->y_minus_x);
+    fe_copy(negated.y_minus_x, result->y_plus_x);
+    fe_neg(negated.xy2d, result->xy2d);
+    fe_cmov(result->y_plus_x, negated.y_plus_x, negative);
+    fe_cmov(result->y_minus_x, negated.y_minus_x, negative);
+    fe_cmov(result->xy2d, negated.xy2d, negative);
+}
+
+// Scalar times the base point on the Edwards curve, then mapped to the
+// Montgomery u = (1 + y) / (1 - y).  64 table additions and 4 doublings
+// replace the 255 ladder steps.
+static void base_multiply(FIELD_ELEMENT result, const unsigned char scalar[X25519_KEY_SIZE])
+{
+    signed char digits[2 * X25519_KEY_SIZE];
+    signed char carry = 0;
+    EDWARDS_POINT point;
+    EDWARDS_COMPLETED completed;
+    EDWARDS_PRECOMP precomp;
+    FIELD_ELEMENT numerator, denominator;
+
+    // Signed radix 16, every digit in [-8, 8]
+    for (size_t index = 0; index < X25519_KEY_SIZE; index++)
+    {
+        digits[2 * index] = (signed char)(scalar[index] & 15);
+        digits[(2 * index) + 1] = (signed char)((scalar[index] >> 4) & 15);
+    }
+    for (size_t index = 0; index < (2 * X25519_KEY_SIZE) - 1; index++)
+    {
+        digits[index] = (signed char)(digits[index] + carry);
+        carry = (signed char)((digits[index] + 8) >> 4);
+        digits[index] = (signed char)(digits[index] - (carry * 16));
+    }
+    digits[(2 * X25519_KEY_SIZE) - 1] = (signed char)(digits[(2 * X25519_KEY_SIZE) - 1] + carry);
+
+    edwards_identity(&point);
+    for (size_t index = 1; index < 2 * X25519_KEY_SIZE; index += 2)
+    {
+        select_precomp(&precomp, index / 2, digits[index]);
+        edwards_add_precomp(&completed, &point, &precomp);
+        completed_to_extended(&point, &completed);
+    }
+    for (size_t doubling = 0; doubling < 4; doubling++)
+    {
+        edwards_double(&completed, &point);
+        if (doubling < 3)
+        {
+            completed_to_projective(&point, &completed);
+        }
+        else
+        {
+            completed_to_extended(&point, &completed);
+        }
+    }
+    for (size_t index = 0; index < 2 * X25519_KEY_SIZE; index += 2)
+    {
+        select_precomp(&precomp, index / 2, digits[index]);
+        edwards_add_precomp(&completed, &point, &precomp);
+        completed_to_extended(&point, &completed);
+    }
+
+    fe_add(numerator, point.z, point.y);
+    fe_sub(denominator, point.z, point.y);
+    fe_invert(denominator, denominator);
+    fe_mul(result, numerator, denominator);
+    secure_zero(digits, sizeof(digits));
+}
+
+int crypto_x25519_public_key(unsigned char* public_key, const unsigned char* private_key)
+{
+    int result;
+    if (public_key == NULL || private_key == NULL)
+    {
+        log_error("Failure invalid parameter specified public_key: %p, private_key: %p", public_key, private_key);
+        result = __LINE__;
+    }
+    else if (pthread_once(&g_base_table_once, build_base_table) != 0)
+    {
+        log_error("Failure building base point table");
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char scalar[X25519_KEY_SIZE];
+        FIELD_ELEMENT u;
+        clamp_scalar(scalar, private_key);
+        base_multiply(u, scalar);
+        fe_to_bytes(public_key, u);
+        secure_zero(scalar, sizeof(scalar));
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_x25519_keypair(unsigned char* private_key, unsigned char* public_key)
+{
+    int result;
+    if (private_key == NULL || public_key == NULL)
+    {
+        log_error("Failure invalid parameter specified private_key: %p, public_key: %p", private_key, public_key);
+        result = __LINE__;
+    }
+    else if (crypto_drbg_random_bytes(private_key, X25519_KEY_SIZE) != 0)
+    {
+        log_error("Failure generating private key");
+        result = __LINE__;
+    }
+    else if (crypto_x25519_public_key(public_key, private_key) != 0)
+    {
+        secure_zero(private_key, X25519_KEY_SIZE);
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_x25519(unsigned char* shared_secret, const unsigned char* private_key, const unsigned char* peer_public_key)
+{
+    int result;
+    if (shared_secret == NULL || private_key == NULL || peer_public_key == NULL)
+    {
+        log_error("Failure invalid parameter specified shared_secret: %p, private_key: %p, peer_public_key: %p", shared_secret, private_key, peer_public_key);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char scalar[X25519_KEY_SIZE];
+        unsigned char zero_check = 0;
+        FIELD_ELEMENT u, shared;
+        clamp_scalar(scalar, private_key);
+        fe_from_bytes(u, peer_public_key);
+        montgomery_ladder(shared, scalar, u);
+        fe_to_bytes(shared_secret, shared);
+        secure_zero(scalar, sizeof(scalar));
+
+        for (size_t index = 0; index < X25519_KEY_SIZE; index++)
+        {
+            zero_check |= shared_secret[index];
+        }
+        if (zero_check == 0)
+        {
+            log_error("Failure peer public key is a low order point");
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
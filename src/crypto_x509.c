@@ -0,0 +1,679 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_x509.h"
+#include "cablelock/crypto_sha256.h"
+#include "cablelock/crypto_rsa.h"
+#include "cablelock/crypto_p256.h"
+
+#define DER_CONSTRUCTED             0x20
+#define DER_TAG_NUMBER_MASK         0x1F
+// Lengths past 4 bytes are larger than any certificate
+#define DER_MAX_LENGTH_BYTES        4
+
+#define TBS_TAG_VERSION             0xA0
+#define TBS_TAG_ISSUER_UNIQUE_ID    0x81
+#define TBS_TAG_SUBJECT_UNIQUE_ID   0x82
+#define TBS_TAG_EXTENSIONS          0xA3
+
+#define UTC_TIME_SIZE               13
+#define GENERALIZED_TIME_SIZE       15
+#define SECONDS_PER_DAY             86400
+
+// A cached verification only has to exist
+#define VERIFY_CACHE_STATE_SIZE     1
+
+static const unsigned char OID_RSA_ENCRYPTION[] = { 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01 };
+static const unsigned char OID_SHA256_WITH_RSA[] = { 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b };
+static const unsigned char OID_EC_PUBLIC_KEY[] = { 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01 };
+static const unsigned char OID_PRIME256V1[] = { 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07 };
+static const unsigned char OID_ECDSA_WITH_SHA256[] = { 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02 };
+
+// Expected tag of every TBS field up to the public key
+static const unsigned char TBS_FIELD_TAGS[X509_FIELD_EXTENSIONS] = {
+    TBS_TAG_VERSION, DER_TAG_INTEGER, DER_TAG_SEQUENCE, DER_TAG_SEQUENCE, DER_TAG_SEQUENCE, DER_TAG_SEQUENCE, DER_TAG_SEQUENCE
+};
+
+static const uint8_t DAYS_IN_MONTH[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static bool oid_equals(const DER_ELEMENT* element, const unsigned char* oid, size_t oid_len)
+{
+    return element->tag == DER_TAG_OID && element->value_len == oid_len && memcmp(element->value, oid, oid_len) == 0;
+}
+
+static int read_only_child(DER_ELEMENT* child, const DER_ELEMENT* parent, unsigned char tag)
+{
+    int result;
+    size_t offset = 0;
+    if (crypto_der_read_child(child, parent, &offset) != 0 || child->tag != tag || offset != parent->value_len)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+// The content of a BIT STRING that holds whole bytes
+static int bit_string_bytes(const DER_ELEMENT* element, const unsigned char** data, size_t* data_len)
+{
+    int result;
+    if (element->tag != DER_TAG_BIT_STRING || element->value_len < 2 || element->value[0] != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        *data = element->value + 1;
+        *data_len = element->value_len - 1;
+        result = 0;
+    }
+    return result;
+}
+
+// Files one TBS child under the next field it can be
+static void assign_tbs_child(X509_CERTIFICATE* certificate, const DER_ELEMENT* child)
+{
+    if (certificate->next_field == X509_FIELD_VERSION && child->tag != TBS_TAG_VERSION)
+    {
+        certificate->next_field = X509_FIELD_SERIAL_NUMBER;
+    }
+
+    if (certificate->next_field < X509_FIELD_EXTENSIONS)
+    {
+        if (child->tag != TBS_FIELD_TAGS[certificate->next_field])
+        {
+            certificate->tbs_invalid = true;
+        }
+        else
+        {
+            certificate->fields[certificate->next_field] = *child;
+            certificate->found_fields |= 1u << certificate->next_field;
+            certificate->next_field++;
+        }
+    }
+    else if (certificate->next_field == X509_FIELD_EXTENSIONS)
+    {
+        if (child->tag == TBS_TAG_ISSUER_UNIQUE_ID || child->tag == (TBS_TAG_ISSUER_UNIQUE_ID | DER_CONSTRUCTED) ||
+            child->tag == TBS_TAG_SUBJECT_UNIQUE_ID || child->tag == (TBS_TAG_SUBJECT_UNIQUE_ID | DER_CONSTRUCTED))
+        {
+            // Unique IDs are obsolete, step over them
+        }
+        else if (child->tag != TBS_TAG_EXTENSIONS ||
+            read_only_child(&certificate->fields[X509_FIELD_EXTENSIONS], child, DER_TAG_SEQUENCE) != 0)
+        {
+            certificate->tbs_invalid = true;
+        }
+        else
+        {
+            certificate->found_fields |= 1u << X509_FIELD_EXTENSIONS;
+            certificate->next_field = X509_FIELD_COUNT;
+        }
+    }
+    else
+    {
+        // Nothing may follow the extensions
+        certificate->tbs_invalid = true;
+    }
+}
+
+// Walks the TBS only as far as the field asked for
+static int locate_field(X509_CERTIFICATE* certificate, X509_FIELD field)
+{
+    int result;
+    while ((certificate->found_fields & (1u << field)) == 0 && !certificate->tbs_done && !certificate->tbs_invalid)
+    {
+        DER_ELEMENT child;
+        if (certificate->tbs_offset == certificate->tbs.value_len)
+        {
+            certificate->tbs_done = true;
+        }
+        else if (crypto_der_read_child(&child, &certificate->tbs, &certificate->tbs_offset) != 0)
+        {
+            certificate->tbs_invalid = true;
+        }
+        else
+        {
+            assign_tbs_child(certificate, &child);
+        }
+    }
+
+    if ((certificate->found_fields & (1u << field)) == 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static bool read_digits(const unsigned char* text, size_t count, uint32_t* value)
+{
+    bool result = true;
+    *value = 0;
+    for (size_t index = 0; index < count && result; index++)
+    {
+        if (text[index] < '0' || text[index] > '9')
+        {
+            result = false;
+        }
+        else
+        {
+            *value = (*value * 10) + (uint32_t)(text[index] - '0');
+        }
+    }
+    return result;
+}
+
+// Days between 1970-01-01 and a proleptic Gregorian date
+static int64_t days_from_civil(int64_t year, uint32_t month, uint32_t day)
+{
+    int64_t era;
+    int64_t year_of_era;
+    int64_t day_of_year;
+    int64_t day_of_era;
+    year -= month <= 2 ? 1 : 0;
+    era = (year >= 0 ? year : year - 399) / 400;
+    year_of_era = year - (era * 400);
+    day_of_year = ((153 * (int64_t)(month > 2 ? month - 3 : month + 9)) + 2) / 5 + day - 1;
+    day_of_era = (year_of_era * 365) + (year_of_era / 4) - (year_of_era / 100) + day_of_year;
+    return (era * 146097) + day_of_era - 719468;
+}
+
+// UTCTime YYMMDDHHMMSSZ or GeneralizedTime YYYYMMDDHHMMSSZ, as RFC 5280 requires
+static int parse_time(const DER_ELEMENT* element, int64_t* seconds)
+{
+    int result;
+    size_t year_digits = element->tag == DER_TAG_UTC_TIME ? 2 : 4;
+    uint32_t year;
+    uint32_t month;
+    uint32_t day;
+    uint32_t hour;
+    uint32_t minute;
+    uint32_t second;
+    if ((element->tag != DER_TAG_UTC_TIME || element->value_len != UTC_TIME_SIZE) &&
+        (element->tag != DER_TAG_GENERALIZED_TIME || element->value_len != GENERALIZED_TIME_SIZE))
+    {
+        result = __LINE__;
+    }
+    else if (element->value[element->value_len - 1] != 'Z' || !read_digits(element->value, year_digits, &year) ||
+        !read_digits(element->value + year_digits, 2, &month) || !read_digits(element->value + year_digits + 2, 2, &day) ||
+        !read_digits(element->value + year_digits + 4, 2, &hour) || !read_digits(element->value + year_digits + 6, 2, &minute) ||
+        !read_digits(element->value + year_digits + 8, 2, &second))
+    {
+        result = __LINE__;
+    }
+    else if (month < 1 || month > 12 || day < 1 || day > DAYS_IN_MONTH[month - 1] || hour > 23 || minute > 59 || second > 59)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        if (year_digits == 2)
+        {
+            year += year < 50 ? 2000 : 1900;
+        }
+        if (month == 2 && day == 29 && (year % 4 != 0 || (year % 100 == 0 && year % 400 != 0)))
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            *seconds = (days_from_civil(year, month, day) * SECONDS_PER_DAY) + (hour * 3600) + (minute * 60) + second;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+// A positive DER INTEGER into a fixed size big endian field
+static int integer_to_fixed(unsigned char* target, size_t target_len, const DER_ELEMENT* element)
+{
+    int result;
+    const unsigned char* value = element->value;
+    size_t value_len = element->value_len;
+    if (element->tag != DER_TAG_INTEGER || value_len == 0 || (value[0] & 0x80) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        while (value_len > 1 && value[0] == 0)
+        {
+            value++;
+            value_len--;
+        }
+        if (value_len > target_len)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            memset(target, 0, target_len - value_len);
+            memcpy(target + target_len - value_len, value, value_len);
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static int decode_ecdsa_signature(unsigned char* signature, const unsigned char* data, size_t data_len)
+{
+    int result;
+    DER_ELEMENT sequence;
+    DER_ELEMENT r;
+    DER_ELEMENT s;
+    size_t offset = 0;
+    if (crypto_der_read(&sequence, data, data_len) != 0 || sequence.tag != DER_TAG_SEQUENCE || sequence.encoding_len != data_len ||
+        crypto_der_read_child(&r, &sequence, &offset) != 0 || crypto_der_read_child(&s, &sequence, &offset) != 0 || offset != sequence.value_len)
+    {
+        result = __LINE__;
+    }
+    else if (integer_to_fixed(signature, P256_SIGNATURE_SIZE / 2, &r) != 0 ||
+        integer_to_fixed(signature + (P256_SIGNATURE_SIZE / 2), P256_SIGNATURE_SIZE / 2, &s) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_der_read(DER_ELEMENT* element, const unsigned char* data, size_t data_len)
+{
+    int result;
+    if (element == NULL || data == NULL)
+    {
+        log_error("Failure invalid parameter specified element: %p, data: %p", element, data);
+        result = __LINE__;
+    }
+    else if (data_len < 2 || (data[0] & DER_TAG_NUMBER_MASK) == DER_TAG_NUMBER_MASK)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        size_t header_len = 2;
+        size_t value_len = data[1];
+        result = 0;
+        if ((data[1] & 0x80) != 0)
+        {
+            size_t length_bytes = data[1] & 0x7F;
+            // Indefinite lengths, padded lengths and long forms of short lengths are BER only
+            if (length_bytes == 0 || length_bytes > DER_MAX_LENGTH_BYTES || length_bytes > data_len - 2 || data[2] == 0)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                value_len = 0;
+                for (size_t index = 0; index < length_bytes; index++)
+                {
+                    value_len = (value_len << 8) | data[2 + index];
+                }
+                header_len += length_bytes;
+                if (value_len < 0x80)
+                {
+                    result = __LINE__;
+                }
+            }
+        }
+        if (result == 0 && value_len > data_len - header_len)
+        {
+            result = __LINE__;
+        }
+        if (result == 0)
+        {
+            element->tag = data[0];
+            element->encoding = data;
+            element->encoding_len = header_len + value_len;
+            element->value = data + header_len;
+            element->value_len = value_len;
+        }
+    }
+    return result;
+}
+
+int crypto_der_read_child(DER_ELEMENT* child, const DER_ELEMENT* parent, size_t* offset)
+{
+    int result;
+    if (child == NULL || parent == NULL || offset == NULL)
+    {
+        log_error("Failure invalid parameter specified child: %p, parent: %p, offset: %p", child, parent, offset);
+        result = __LINE__;
+    }
+    else if ((parent->tag & DER_CONSTRUCTED) == 0 || *offset >= parent->value_len)
+    {
+        result = __LINE__;
+    }
+    else if ((result = crypto_der_read(child, parent->value + *offset, parent->value_len - *offset)) == 0)
+    {
+        *offset += child->encoding_len;
+    }
+    return result;
+}
+
+int crypto_x509_parse(X509_CERTIFICATE* certificate, const unsigned char* der, size_t der_len)
+{
+    int result;
+    if (certificate == NULL || der == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, der: %p", certificate, der);
+        result = __LINE__;
+    }
+    else
+    {
+        size_t offset = 0;
+        memset(certificate, 0, sizeof(X509_CERTIFICATE));
+        if (crypto_der_read(&certificate->certificate, der, der_len) != 0 || certificate->certificate.tag != DER_TAG_SEQUENCE ||
+            certificate->certificate.encoding_len != der_len)
+        {
+            result = __LINE__;
+        }
+        else if (crypto_der_read_child(&certificate->tbs, &certificate->certificate, &offset) != 0 || certificate->tbs.tag != DER_TAG_SEQUENCE ||
+            crypto_der_read_child(&certificate->signature_algorithm, &certificate->certificate, &offset) != 0 ||
+            certificate->signature_algorithm.tag != DER_TAG_SEQUENCE ||
+            crypto_der_read_child(&certificate->signature, &certificate->certificate, &offset) != 0 ||
+            certificate->signature.tag != DER_TAG_BIT_STRING || offset != certificate->certificate.value_len)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            certificate->next_field = X509_FIELD_VERSION;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_x509_get_field(X509_CERTIFICATE* certificate, X509_FIELD field, DER_ELEMENT* element)
+{
+    int result;
+    if (certificate == NULL || field >= X509_FIELD_COUNT || element == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, field: %d, element: %p", certificate, (int)field, element);
+        result = __LINE__;
+    }
+    else if ((result = locate_field(certificate, field)) == 0)
+    {
+        *element = certificate->fields[field];
+    }
+    return result;
+}
+
+int crypto_x509_get_validity(X509_CERTIFICATE* certificate, int64_t* not_before, int64_t* not_after)
+{
+    int result;
+    if (certificate == NULL || not_before == NULL || not_after == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, not_before: %p, not_after: %p", certificate, not_before, not_after);
+        result = __LINE__;
+    }
+    else if (locate_field(certificate, X509_FIELD_VALIDITY) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        DER_ELEMENT begin;
+        DER_ELEMENT end;
+        size_t offset = 0;
+        const DER_ELEMENT* validity = &certificate->fields[X509_FIELD_VALIDITY];
+        if (crypto_der_read_child(&begin, validity, &offset) != 0 || crypto_der_read_child(&end, validity, &offset) != 0 ||
+            offset != validity->value_len || parse_time(&begin, not_before) != 0 || parse_time(&end, not_after) != 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int crypto_x509_get_public_key(X509_CERTIFICATE* certificate, X509_PUBLIC_KEY* key)
+{
+    int result;
+    if (certificate == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, key: %p", certificate, key);
+        result = __LINE__;
+    }
+    else if (locate_field(certificate, X509_FIELD_PUBLIC_KEY_INFO) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        const DER_ELEMENT* key_info = &certificate->fields[X509_FIELD_PUBLIC_KEY_INFO];
+        DER_ELEMENT algorithm;
+        DER_ELEMENT key_bits;
+        DER_ELEMENT algorithm_oid;
+        DER_ELEMENT parameters;
+        const unsigned char* key_data;
+        size_t key_data_len;
+        size_t offset = 0;
+        size_t algorithm_offset = 0;
+        memset(key, 0, sizeof(X509_PUBLIC_KEY));
+        if (crypto_der_read_child(&algorithm, key_info, &offset) != 0 || algorithm.tag != DER_TAG_SEQUENCE ||
+            crypto_der_read_child(&key_bits, key_info, &offset) != 0 || offset != key_info->value_len ||
+            bit_string_bytes(&key_bits, &key_data, &key_data_len) != 0 ||
+            crypto_der_read_child(&algorithm_oid, &algorithm, &algorithm_offset) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (oid_equals(&algorithm_oid, OID_RSA_ENCRYPTION, sizeof(OID_RSA_ENCRYPTION)))
+        {
+            DER_ELEMENT rsa_key;
+            DER_ELEMENT modulus;
+            DER_ELEMENT exponent;
+            size_t key_offset = 0;
+            if (crypto_der_read(&rsa_key, key_data, key_data_len) != 0 || rsa_key.tag != DER_TAG_SEQUENCE || rsa_key.encoding_len != key_data_len ||
+                crypto_der_read_child(&modulus, &rsa_key, &key_offset) != 0 || modulus.tag != DER_TAG_INTEGER ||
+                crypto_der_read_child(&exponent, &rsa_key, &key_offset) != 0 || exponent.tag != DER_TAG_INTEGER || key_offset != rsa_key.value_len)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                key->type = X509_KEY_TYPE_RSA;
+                key->modulus = modulus.value;
+                key->modulus_len = modulus.value_len;
+                key->public_exponent = exponent.value;
+                key->public_exponent_len = exponent.value_len;
+                result = 0;
+            }
+        }
+        else if (oid_equals(&algorithm_oid, OID_EC_PUBLIC_KEY, sizeof(OID_EC_PUBLIC_KEY)))
+        {
+            if (crypto_der_read_child(&parameters, &algorithm, &algorithm_offset) != 0 || algorithm_offset != algorithm.value_len ||
+                !oid_equals(&parameters, OID_PRIME256V1, sizeof(OID_PRIME256V1)) || key_data_len != P256_PUBLIC_KEY_SIZE)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                key->type = X509_KEY_TYPE_P256;
+                key->point = key_data;
+                key->point_len = key_data_len;
+                result = 0;
+            }
+        }
+        else
+        {
+            result = __LINE__;
+        }
+    }
+    return result;
+}
+
+int crypto_x509_find_extension(X509_CERTIFICATE* certificate, const unsigned char* oid, size_t oid_len, DER_ELEMENT* extension, bool* critical)
+{
+    int result;
+    if (certificate == NULL || oid == NULL || oid_len == 0 || extension == NULL || critical == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, oid: %p, oid_len: %d, extension: %p, critical: %p",
+            certificate, oid, (int)oid_len, extension, critical);
+        result = __LINE__;
+    }
+    else if (locate_field(certificate, X509_FIELD_EXTENSIONS) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        const DER_ELEMENT* extensions = &certificate->fields[X509_FIELD_EXTENSIONS];
+        DER_ELEMENT entry;
+        size_t offset = 0;
+        result = __LINE__;
+        while (result != 0 && crypto_der_read_child(&entry, extensions, &offset) == 0)
+        {
+            DER_ELEMENT entry_oid;
+            DER_ELEMENT item;
+            size_t entry_offset = 0;
+            if (entry.tag == DER_TAG_SEQUENCE && crypto_der_read_child(&entry_oid, &entry, &entry_offset) == 0 &&
+                oid_equals(&entry_oid, oid, oid_len) && crypto_der_read_child(&item, &entry, &entry_offset) == 0)
+            {
+                // critical is DEFAULT FALSE, DER only encodes it when true
+                *critical = false;
+                if (item.tag == DER_TAG_BOOLEAN && item.value_len == 1 && item.value[0] == 0xFF &&
+                    crypto_der_read_child(&item, &entry, &entry_offset) == 0)
+                {
+                    *critical = true;
+                }
+                if (item.tag == DER_TAG_OCTET_STRING && entry_offset == entry.value_len)
+                {
+                    *extension = item;
+                    result = 0;
+                }
+                else
+                {
+                    // A matching but malformed extension, stop looking
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+int crypto_x509_verify_signature(X509_CERTIFICATE* certificate, X509_CERTIFICATE* issuer)
+{
+    int result;
+    if (certificate == NULL || issuer == NULL)
+    {
+        log_error("Failure invalid parameter specified certificate: %p, issuer: %p", certificate, issuer);
+        result = __LINE__;
+    }
+    else
+    {
+        DER_ELEMENT algorithm_oid;
+        X509_PUBLIC_KEY key;
+        const unsigned char* signature;
+        size_t signature_len;
+        size_t offset = 0;
+        unsigned char digest[SHA256_DIGEST_SIZE];
+        const DER_ELEMENT* inner_algorithm = &certificate->fields[X509_FIELD_SIGNATURE_ALGORITHM];
+        if (locate_field(certificate, X509_FIELD_SIGNATURE_ALGORITHM) != 0 ||
+            inner_algorithm->encoding_len != certificate->signature_algorithm.encoding_len ||
+            memcmp(inner_algorithm->encoding, certificate->signature_algorithm.encoding, inner_algorithm->encoding_len) != 0)
+        {
+            // The signed copy of the algorithm has to match the outer one
+            result = __LINE__;
+        }
+        else if (crypto_der_read_child(&algorithm_oid, &certificate->signature_algorithm, &offset) != 0 ||
+            bit_string_bytes(&certificate->signature, &signature, &signature_len) != 0 ||
+            crypto_x509_get_public_key(issuer, &key) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (crypto_sha256(certificate->tbs.encoding, certificate->tbs.encoding_len, digest) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (oid_equals(&algorithm_oid, OID_SHA256_WITH_RSA, sizeof(OID_SHA256_WITH_RSA)) && key.type == X509_KEY_TYPE_RSA)
+        {
+            result = crypto_rsa_verify_pkcs1_sha256(key.modulus, key.modulus_len, key.public_exponent, key.public_exponent_len,
+                digest, signature, signature_len);
+        }
+        else if (oid_equals(&algorithm_oid, OID_ECDSA_WITH_SHA256, sizeof(OID_ECDSA_WITH_SHA256)) && key.type == X509_KEY_TYPE_P256)
+        {
+            unsigned char raw_signature[P256_SIGNATURE_SIZE];
+            if (decode_ecdsa_signature(raw_signature, signature, signature_len) != 0)
+            {
+                result = __LINE__;
+            }
+            else
+            {
+                result = crypto_p256_verify(key.point, digest, sizeof(digest), raw_signature);
+            }
+        }
+        else
+        {
+            result = __LINE__;
+        }
+    }
+    return result;
+}
+
+CRYPTO_SESSION_CACHE_HANDLE crypto_x509_verify_cache_create(size_t capacity, uint32_t lifetime_seconds)
+{
+    return crypto_session_cache_create(capacity, VERIFY_CACHE_STATE_SIZE, lifetime_seconds);
+}
+
+int crypto_x509_verify_cached(CRYPTO_SESSION_CACHE_HANDLE cache, X509_CERTIFICATE* certificate, X509_CERTIFICATE* issuer)
+{
+    int result;
+    if (cache == NULL || certificate == NULL || issuer == NULL)
+    {
+        log_error("Failure invalid parameter specified cache: %p, certificate: %p, issuer: %p", cache, certificate, issuer);
+        result = __LINE__;
+    }
+    else if (locate_field(issuer, X509_FIELD_PUBLIC_KEY_INFO) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        CRYPTO_SHA256 sha;
+        unsigned char cache_key[SHA256_DIGEST_SIZE];
+        unsigned char state[VERIFY_CACHE_STATE_SIZE] = { 1 };
+        size_t state_len;
+        const DER_ELEMENT* issuer_key = &issuer->fields[X509_FIELD_PUBLIC_KEY_INFO];
+
+        // The issuer key is part of the name, a certificate is only trusted
+        // again under the key that verified it
+        crypto_sha256_init(&sha);
+        crypto_sha256_update(&sha, certificate->certificate.encoding, certificate->certificate.encoding_len);
+        crypto_sha256_update(&sha, issuer_key->encoding, issuer_key->encoding_len);
+        crypto_sha256_finish(&sha, cache_key);
+
+        if (crypto_session_cache_lookup(cache, cache_key, sizeof(cache_key), state, &state_len) == 0)
+        {
+            result = 0;
+        }
+        else if ((result = crypto_x509_verify_signature(certificate, issuer)) == 0)
+        {
+            // Losing the insert only costs the next handshake a signature check
+            (void)crypto_session_cache_insert(cache, cache_key, sizeof(cache_key), state, sizeof(state));
+        }
+    }
+    return result;
+}
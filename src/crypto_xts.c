@@ -0,0 +1,225 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lib-util-c/sys_debug_shim.h"
+#include "lib-util-c/app_logging.h"
+
+#include "cablelock/crypto_xts.h"
+#include "cablelock/crypto_macro.h"
+
+// Blocks whitened and ciphered per batch, the blocks of a batch are
+// independent so the ECB kernels run a whole VAES group at once
+#define XTS_BATCH_BLOCKS    16
+// Reduction of x^128 in the XTS field, x^7 + x^2 + x + 1
+#define XTS_REDUCTION       0x87
+
+// Tweak held as two little endian 64-bit halves
+typedef struct XTS_TWEAK_TAG
+{
+    uint64_t low;
+    uint64_t high;
+} XTS_TWEAK;
+
+static void tweak_double(XTS_TWEAK* tweak)
+{
+    uint64_t carry = tweak->high >> 63;
+    tweak->high = (tweak->high << 1) | (tweak->low >> 63);
+    tweak->low = (tweak->low << 1) ^ ((0 - carry) & XTS_REDUCTION);
+}
+
+// Fill a batch of consecutive tweaks and leave current at the one after it
+static void compute_tweak_batch(XTS_TWEAK tweaks[XTS_BATCH_BLOCKS], XTS_TWEAK* current, size_t count)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        tweaks[index] = *current;
+        tweak_double(current);
+    }
+}
+
+// XORs each block with its tweak, input and output may be the same buffer
+static void xts_whiten(const XTS_TWEAK* tweaks, const unsigned char* input, unsigned char* output, size_t count)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        size_t offset = index * AES_BLOCK_SIZE;
+        store_le64(output + offset, load_le64(input + offset) ^ tweaks[index].low);
+        store_le64(output + offset + 8, load_le64(input + offset + 8) ^ tweaks[index].high);
+    }
+}
+
+static void xts_block(const AES_KEY_SCHEDULE* schedule, bool encrypt, const XTS_TWEAK* tweak, const unsigned char* input, unsigned char* output)
+{
+    unsigned char block[AES_BLOCK_SIZE];
+
+    store_le64(block, load_le64(input) ^ tweak->low);
+    store_le64(block + 8, load_le64(input + 8) ^ tweak->high);
+    if (encrypt)
+    {
+        crypto_aes_block_encrypt(schedule, block, block);
+    }
+    else
+    {
+        crypto_aes_block_decrypt(schedule, block, block);
+    }
+    store_le64(output, load_le64(block) ^ tweak->low);
+    store_le64(output + 8, load_le64(block + 8) ^ tweak->high);
+}
+
+static void xts_data_unit(const CRYPTO_XTS_KEY* xts_key, bool encrypt, const unsigned char tweak_value[XTS_TWEAK_SIZE],
+    const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    XTS_TWEAK tweaks[XTS_BATCH_BLOCKS];
+    XTS_TWEAK current;
+    unsigned char encrypted_tweak[XTS_TWEAK_SIZE];
+    size_t remainder = input_len % AES_BLOCK_SIZE;
+    // The last full block takes part in ciphertext stealing
+    size_t full_blocks = input_len / AES_BLOCK_SIZE - (remainder != 0 ? 1 : 0);
+
+    crypto_aes_block_encrypt(&xts_key->tweak_key, tweak_value, encrypted_tweak);
+    current.low = load_le64(encrypted_tweak);
+    current.high = load_le64(encrypted_tweak + 8);
+
+    for (size_t block_index = 0; block_index < full_blocks; block_index += XTS_BATCH_BLOCKS)
+    {
+        size_t count = full_blocks - block_index < XTS_BATCH_BLOCKS ? full_blocks - block_index : XTS_BATCH_BLOCKS;
+        size_t offset = block_index * AES_BLOCK_SIZE;
+        compute_tweak_batch(tweaks, &current, count);
+        // The whitened batch is ciphered in the output buffer
+        xts_whiten(tweaks, input + offset, output + offset, count);
+        if (encrypt)
+        {
+            (void)crypto_aes_ecb_encrypt_blocks(&xts_key->data_key, output + offset, output + offset, count);
+        }
+        else
+        {
+            (void)crypto_aes_ecb_decrypt_blocks(&xts_key->data_key, output + offset, output + offset, count);
+        }
+        xts_whiten(tweaks, output + offset, output + offset, count);
+    }
+
+    if (remainder != 0)
+    {
+        size_t offset = full_blocks * AES_BLOCK_SIZE;
+        unsigned char last_block[AES_BLOCK_SIZE];
+        unsigned char partial_block[AES_BLOCK_SIZE];
+        XTS_TWEAK next = current;
+        tweak_double(&next);
+
+        // Copied first as in place operation overwrites it below
+        memcpy(partial_block, input + offset + AES_BLOCK_SIZE, remainder);
+        // Decryption of the stolen block uses the later tweak first
+        xts_block(&xts_key->data_key, encrypt, encrypt ? &current : &next, input + offset, last_block);
+        memcpy(output + offset + AES_BLOCK_SIZE, last_block, remainder);
+        memcpy(last_block, partial_block, remainder);
+        xts_block(&xts_key->data_key, encrypt, encrypt ? &next : &current, last_block, output + offset);
+        secure_zero(last_block, sizeof(last_block));
+        secure_zero(partial_block, sizeof(partial_block));
+    }
+}
+
+static int xts_operation(bool encrypt, const CRYPTO_XTS_KEY* xts_key, const unsigned char* tweak, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    int result;
+    if (xts_key == NULL || tweak == NULL || input == NULL || output == NULL)
+    {
+        log_error("Failure invalid parameter specified xts_key: %p, tweak: %p, input: %p, output: %p", xts_key, tweak, input, output);
+        result = __LINE__;
+    }
+    else if (input_len < AES_BLOCK_SIZE)
+    {
+        log_error("Failure data unit length %d is smaller than a block", (int)input_len);
+        result = __LINE__;
+    }
+    else
+    {
+        xts_data_unit(xts_key, encrypt, tweak, input, input_len, output);
+        result = 0;
+    }
+    return result;
+}
+
+static int xts_sector_operation(bool encrypt, const CRYPTO_XTS_KEY* xts_key, uint64_t sector_num, size_t sector_size,
+    const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    int result;
+    if (xts_key == NULL || input == NULL || output == NULL)
+    {
+        log_error("Failure invalid parameter specified xts_key: %p, input: %p, output: %p", xts_key, input, output);
+        result = __LINE__;
+    }
+    else if (sector_size < AES_BLOCK_SIZE || input_len % sector_size != 0)
+    {
+        log_error("Failure invalid sector size %d for length %d", (int)sector_size, (int)input_len);
+        result = __LINE__;
+    }
+    else
+    {
+        unsigned char tweak[XTS_TWEAK_SIZE] = { 0 };
+        for (size_t offset = 0; offset < input_len; offset += sector_size)
+        {
+            store_le64(tweak, sector_num++);
+            xts_data_unit(xts_key, encrypt, tweak, input + offset, sector_size, output + offset);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_xts_key_init(CRYPTO_XTS_KEY* xts_key, const unsigned char* key, size_t key_len)
+{
+    int result;
+    if (xts_key == NULL || key == NULL)
+    {
+        log_error("Failure invalid parameter specified xts_key: %p, key: %p", xts_key, key);
+        result = __LINE__;
+    }
+    else if (key_len != XTS_AES_128_KEY_SIZE && key_len != XTS_AES_256_KEY_SIZE)
+    {
+        log_error("Failure invalid xts key length %d", (int)key_len);
+        result = __LINE__;
+    }
+    else if (memcmp(key, key + (key_len / 2), key_len / 2) == 0)
+    {
+        // Equal halves make the tweak predictable, rejected per IEEE 1619
+        log_error("Failure xts data and tweak keys are identical");
+        result = __LINE__;
+    }
+    else if (crypto_aes_key_init(&xts_key->data_key, key, key_len / 2) != 0 ||
+        crypto_aes_key_init(&xts_key->tweak_key, key + (key_len / 2), key_len / 2) != 0)
+    {
+        log_error("Failure initializing xts key schedules");
+        result = __LINE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int crypto_xts_encrypt(const CRYPTO_XTS_KEY* xts_key, const unsigned char* tweak, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    return xts_operation(true, xts_key, tweak, input, input_len, output);
+}
+
+int crypto_xts_decrypt(const CRYPTO_XTS_KEY* xts_key, const unsigned char* tweak, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    return xts_operation(false, xts_key, tweak, input, input_len, output);
+}
+
+int crypto_xts_encrypt_sectors(const CRYPTO_XTS_KEY* xts_key, uint64_t sector_num, size_t sector_size, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    return xts_sector_operation(true, xts_key, sector_num, sector_size, input, input_len, output);
+}
+
+int crypto_xts_decrypt_sectors(const CRYPTO_XTS_KEY* xts_key, uint64_t sector_num, size_t sector_size, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    return xts_sector_operation(false, xts_key, sector_num, sector_size, input, input_len, output);
+}
@@ -0,0 +1,406 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_aes_accel.h"
+#include "cablelock/crypto_aes_core.h"
+#include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_gcm.h"
+
+// SP800-38A F.5.1 and F.2.2
+static const unsigned char TEST_KEY_DATA[] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char TEST_PLAIN_DATA[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const unsigned char TEST_COUNTER_DATA[] = {
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const unsigned char TEST_CTR_CIPHER_DATA[] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+static const unsigned char TEST_IV_DATA[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const unsigned char TEST_CBC_CIPHER_DATA[] = {
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+    0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+    0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+    0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+// Long enough for a full wide group plus a tail and a partial block
+#define TEST_LONG_SIZE          ((37 * AES_BLOCK_SIZE) + 5)
+
+static void fill_pattern(unsigned char* data, size_t length)
+{
+    for (size_t index = 0; index < length; index++)
+    {
+        data[index] = (unsigned char)((index * 29) + 7);
+    }
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_aes_accel_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+        (void)crypto_aes_accel_set_level(crypto_aes_accel_detect());
+        crypto_aes_accel_set_wide_threshold(0);
+    }
+
+    CTEST_FUNCTION(crypto_aes_accel_set_level_invalid_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)(CRYPTO_AES_ACCEL_VAES512 + 1));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, crypto_aes_accel_detect(), crypto_aes_accel_get_level());
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_accel_set_level_none_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char counter[AES_BLOCK_SIZE] = { 0 };
+        unsigned char output[AES_BLOCK_SIZE];
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_aes_accel_set_level(CRYPTO_AES_ACCEL_NONE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, CRYPTO_AES_ACCEL_NONE, crypto_aes_accel_get_level());
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_aes_accel_ctr32(&schedule, counter, TEST_PLAIN_DATA, output, 1));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_ctr_xor_vector_every_level_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char counter[AES_BLOCK_SIZE];
+            unsigned char output[sizeof(TEST_PLAIN_DATA)];
+            memcpy(counter, TEST_COUNTER_DATA, AES_BLOCK_SIZE);
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int result = crypto_aes_ctr_xor(&schedule, counter, TEST_PLAIN_DATA, sizeof(TEST_PLAIN_DATA), output);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CTR_CIPHER_DATA, sizeof(TEST_CTR_CIPHER_DATA)));
+            CTEST_ASSERT_ARE_EQUAL(int, 0x03, counter[AES_BLOCK_SIZE - 1]);
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_ctr_xor_carry_every_level_succeed)
+    {
+        // arrange
+        static const unsigned char start[AES_BLOCK_SIZE] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x07, 0xff, 0xff, 0xff, 0xfa
+        };
+        unsigned char input[TEST_LONG_SIZE];
+        unsigned char expected[TEST_LONG_SIZE];
+        unsigned char expected_counter[AES_BLOCK_SIZE];
+        AES_KEY_SCHEDULE schedule;
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        fill_pattern(input, sizeof(input));
+
+        // The portable path is the reference, the carry lands in the middle of a group
+        (void)crypto_aes_accel_set_level(CRYPTO_AES_ACCEL_NONE);
+        memcpy(expected_counter, start, AES_BLOCK_SIZE);
+        (void)crypto_aes_ctr_xor(&schedule, expected_counter, input, sizeof(input), expected);
+        CTEST_ASSERT_ARE_EQUAL(int, 0x08, expected_counter[11]);
+
+        for (int level = CRYPTO_AES_ACCEL_AESNI; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char counter[AES_BLOCK_SIZE];
+            unsigned char output[TEST_LONG_SIZE];
+            memcpy(counter, start, AES_BLOCK_SIZE);
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int result = crypto_aes_ctr_xor(&schedule, counter, input, sizeof(input), output);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, expected, sizeof(expected)));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(counter, expected_counter, AES_BLOCK_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_cbc_decrypt_vector_every_level_succeed)
+    {
+        // arrange
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char output[sizeof(TEST_CBC_CIPHER_DATA)];
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int result = crypto_aes_decrypt_128(TEST_CBC_CIPHER_DATA, sizeof(TEST_CBC_CIPHER_DATA), output, sizeof(output), TEST_KEY_DATA, TEST_IV_DATA, false);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_PLAIN_DATA, sizeof(TEST_PLAIN_DATA)));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_cbc_decrypt_in_place_every_level_succeed)
+    {
+        // arrange
+        const size_t length = TEST_LONG_SIZE - (TEST_LONG_SIZE % AES_BLOCK_SIZE);
+        unsigned char plain[TEST_LONG_SIZE];
+        unsigned char cipher[TEST_LONG_SIZE];
+        fill_pattern(plain, length);
+        (void)crypto_aes_encrypt_128(plain, length, cipher, length, TEST_KEY_DATA, TEST_IV_DATA, false);
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char buffer[TEST_LONG_SIZE];
+            memcpy(buffer, cipher, length);
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int result = crypto_aes_decrypt_128(buffer, length, buffer, length, TEST_KEY_DATA, TEST_IV_DATA, false);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, plain, length));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_ecb_blocks_levels_agree_succeed)
+    {
+        // arrange
+        const size_t block_count = TEST_LONG_SIZE / AES_BLOCK_SIZE;
+        AES_KEY_SCHEDULE schedule;
+        unsigned char plain[TEST_LONG_SIZE];
+        unsigned char expected[TEST_LONG_SIZE];
+        fill_pattern(plain, block_count * AES_BLOCK_SIZE);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        for (size_t index = 0; index < block_count; index++)
+        {
+            crypto_aes_block_encrypt(&schedule, plain + (index * AES_BLOCK_SIZE), expected + (index * AES_BLOCK_SIZE));
+        }
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char buffer[TEST_LONG_SIZE];
+            memcpy(buffer, plain, block_count * AES_BLOCK_SIZE);
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int encrypt_result = crypto_aes_ecb_encrypt_blocks(&schedule, buffer, buffer, block_count);
+            int compare_result = memcmp(buffer, expected, block_count * AES_BLOCK_SIZE);
+            int decrypt_result = crypto_aes_ecb_decrypt_blocks(&schedule, buffer, buffer, block_count);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, encrypt_result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, compare_result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, decrypt_result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, plain, block_count * AES_BLOCK_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_aes_accel_at_level_ignores_global_level_succeed)
+    {
+        // arrange
+        const size_t block_count = TEST_LONG_SIZE / AES_BLOCK_SIZE;
+        AES_KEY_SCHEDULE schedule;
+        unsigned char input[TEST_LONG_SIZE];
+        unsigned char ctr_expected[TEST_LONG_SIZE];
+        unsigned char cbc_expected[TEST_LONG_SIZE];
+        unsigned char counter[AES_BLOCK_SIZE] = { 0 };
+        unsigned char iv[AES_BLOCK_SIZE] = { 0 };
+        fill_pattern(input, block_count * AES_BLOCK_SIZE);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        (void)crypto_aes_accel_set_level(CRYPTO_AES_ACCEL_NONE);
+        (void)crypto_aes_ctr_xor(&schedule, counter, input, block_count * AES_BLOCK_SIZE, ctr_expected);
+        for (size_t index = 0; index < block_count; index++)
+        {
+            crypto_aes_block_decrypt(&schedule, input + (index * AES_BLOCK_SIZE), cbc_expected + (index * AES_BLOCK_SIZE));
+            for (size_t offset = 0; offset < AES_BLOCK_SIZE; offset++)
+            {
+                cbc_expected[(index * AES_BLOCK_SIZE) + offset] ^= index == 0 ? 0 : input[((index - 1) * AES_BLOCK_SIZE) + offset];
+            }
+        }
+
+        // Level NONE leaves everything to the portable code
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            size_t expected_done = level == CRYPTO_AES_ACCEL_NONE ? 0 : block_count;
+            unsigned char ctr_output[TEST_LONG_SIZE];
+            unsigned char cbc_output[TEST_LONG_SIZE];
+            memcpy(ctr_output, ctr_expected, sizeof(ctr_output));
+            memcpy(cbc_output, cbc_expected, sizeof(cbc_output));
+            memset(counter, 0, sizeof(counter));
+            memset(iv, 0, sizeof(iv));
+
+            // act
+            size_t ctr_done = crypto_aes_accel_ctr32_at_level((CRYPTO_AES_ACCEL)level, &schedule, counter, input, ctr_output, block_count);
+            size_t cbc_done = crypto_aes_accel_cbc_decrypt_at_level((CRYPTO_AES_ACCEL)level, &schedule, iv, input, cbc_output, block_count);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(size_t, expected_done, ctr_done);
+            CTEST_ASSERT_ARE_EQUAL(size_t, expected_done, cbc_done);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(ctr_output, ctr_expected, block_count * AES_BLOCK_SIZE));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(cbc_output, cbc_expected, block_count * AES_BLOCK_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(int, CRYPTO_AES_ACCEL_NONE, crypto_aes_accel_get_level());
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_gcm_encrypt_levels_agree_succeed)
+    {
+        // arrange
+        static const unsigned char nonce[GCM_NONCE_SIZE] = { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88 };
+        unsigned char input[TEST_LONG_SIZE];
+        unsigned char expected[TEST_LONG_SIZE];
+        unsigned char expected_tag[GCM_TAG_SIZE];
+        CRYPTO_GCM_KEY gcm_key;
+        (void)crypto_gcm_key_init(&gcm_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        fill_pattern(input, sizeof(input));
+        (void)crypto_aes_accel_set_level(CRYPTO_AES_ACCEL_NONE);
+        (void)crypto_gcm_encrypt(&gcm_key, nonce, TEST_IV_DATA, sizeof(TEST_IV_DATA), input, sizeof(input), expected, expected_tag);
+
+        for (int level = CRYPTO_AES_ACCEL_AESNI; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            unsigned char output[TEST_LONG_SIZE];
+            unsigned char tag[GCM_TAG_SIZE];
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+
+            // act
+            int result = crypto_gcm_encrypt(&gcm_key, nonce, TEST_IV_DATA, sizeof(TEST_IV_DATA), input, sizeof(input), output, tag);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, expected, sizeof(expected)));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tag, expected_tag, GCM_TAG_SIZE));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_gcm_decrypt(&gcm_key, nonce, TEST_IV_DATA, sizeof(TEST_IV_DATA), output, sizeof(output), output, tag));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, input, sizeof(input)));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_gcm_encrypt_wide_threshold_agrees_succeed)
+    {
+        // arrange
+        static const unsigned char nonce[GCM_NONCE_SIZE] = { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88 };
+        unsigned char input[TEST_LONG_SIZE];
+        unsigned char expected[TEST_LONG_SIZE];
+        unsigned char output[TEST_LONG_SIZE];
+        unsigned char expected_tag[GCM_TAG_SIZE];
+        unsigned char tag[GCM_TAG_SIZE];
+        CRYPTO_GCM_KEY gcm_key;
+        (void)crypto_gcm_key_init(&gcm_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        fill_pattern(input, sizeof(input));
+        (void)crypto_gcm_encrypt(&gcm_key, nonce, TEST_IV_DATA, sizeof(TEST_IV_DATA), input, sizeof(input), expected, expected_tag);
+
+        // act
+        crypto_aes_accel_set_wide_threshold((TEST_LONG_SIZE / AES_BLOCK_SIZE) + 1);
+        int result = crypto_gcm_encrypt(&gcm_key, nonce, TEST_IV_DATA, sizeof(TEST_IV_DATA), input, sizeof(input), output, tag);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, (TEST_LONG_SIZE / AES_BLOCK_SIZE) + 1, crypto_aes_accel_get_wide_threshold());
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, expected, sizeof(expected)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tag, expected_tag, GCM_TAG_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_aes_accel_ut)
@@ -0,0 +1,11 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "ctest.h"
+
+int main(void)
+{
+    size_t failedTestCount = 0;
+    CTEST_RUN_TEST_SUITE(crypto_aes_accel_ut, failedTestCount);
+    return failedTestCount;
+}
@@ -0,0 +1,276 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_alloc.h"
+
+#define TEST_ITEM_SIZE      100
+#define TEST_ITEM_COUNT     3
+
+static size_t g_hook_malloc_count;
+static size_t g_hook_free_count;
+static void* g_hook_context = (void*)0x1234;
+
+static void* test_hook_malloc(void* context, size_t size)
+{
+    CTEST_ASSERT_ARE_EQUAL(void_ptr, g_hook_context, context);
+    g_hook_malloc_count++;
+    return malloc(size);
+}
+
+static void test_hook_free(void* context, void* ptr)
+{
+    CTEST_ASSERT_ARE_EQUAL(void_ptr, g_hook_context, context);
+    g_hook_free_count++;
+    free(ptr);
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_alloc_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+        g_hook_malloc_count = 0;
+        g_hook_free_count = 0;
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+        (void)crypto_alloc_set_functions(NULL, NULL, NULL);
+    }
+
+    CTEST_FUNCTION(crypto_alloc_set_functions_free_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_alloc_set_functions(test_hook_malloc, NULL, g_hook_context);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_alloc_malloc_default_succeed)
+    {
+        // arrange
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mem_shim_free(IGNORED_PTR_ARG));
+
+        // act
+        void* result = crypto_alloc_malloc(TEST_ITEM_SIZE);
+        crypto_alloc_free(result);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_alloc_malloc_hooks_succeed)
+    {
+        // arrange
+        int result = crypto_alloc_set_functions(test_hook_malloc, test_hook_free, g_hook_context);
+
+        // act
+        void* item = crypto_alloc_malloc(TEST_ITEM_SIZE);
+        crypto_alloc_free(item);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_NOT_NULL(item);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 1, g_hook_malloc_count);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 1, g_hook_free_count);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pool_create_item_count_0_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, 0);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pool_create_succeed)
+    {
+        // arrange
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, TEST_ITEM_COUNT);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_pool_acquire_aligned_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, TEST_ITEM_COUNT);
+        umock_c_reset_all_calls();
+
+        // act
+        void* first = crypto_pool_acquire(handle);
+        void* second = crypto_pool_acquire(handle);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(first);
+        CTEST_ASSERT_IS_NOT_NULL(second);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, (size_t)((uintptr_t)first % CRYPTO_CACHE_LINE_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, (size_t)((uintptr_t)second % CRYPTO_CACHE_LINE_SIZE));
+        CTEST_ASSERT_IS_TRUE((size_t)((unsigned char*)second - (unsigned char*)first) >= TEST_ITEM_SIZE);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_pool_acquire_exhausted_fail)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, TEST_ITEM_COUNT);
+        for (size_t index = 0; index < TEST_ITEM_COUNT; index++)
+        {
+            (void)crypto_pool_acquire(handle);
+        }
+        umock_c_reset_all_calls();
+
+        // act
+        void* result = crypto_pool_acquire(handle);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_pool_release_reacquire_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, TEST_ITEM_COUNT);
+        unsigned char* item = (unsigned char*)crypto_pool_acquire(handle);
+        memset(item, 0xaa, TEST_ITEM_SIZE);
+        umock_c_reset_all_calls();
+
+        // act
+        crypto_pool_release(handle, item);
+        unsigned char* result = (unsigned char*)crypto_pool_acquire(handle);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(void_ptr, item, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result[TEST_ITEM_SIZE - 1]);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_pool_owns_foreign_item_fail)
+    {
+        // arrange
+        unsigned char foreign[TEST_ITEM_SIZE];
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(TEST_ITEM_SIZE, TEST_ITEM_COUNT);
+        unsigned char* item = (unsigned char*)crypto_pool_acquire(handle);
+        umock_c_reset_all_calls();
+
+        // act
+        bool result = crypto_pool_owns(handle, foreign);
+
+        // assert
+        CTEST_ASSERT_IS_FALSE(result);
+        CTEST_ASSERT_IS_TRUE(crypto_pool_owns(handle, item));
+        CTEST_ASSERT_IS_FALSE(crypto_pool_owns(handle, item + 1));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_pool_get_slot_size_rounds_up_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE handle = crypto_pool_create(CRYPTO_CACHE_LINE_SIZE + 1, TEST_ITEM_COUNT);
+        umock_c_reset_all_calls();
+
+        // act
+        size_t result = crypto_pool_get_slot_size(handle);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, 2 * CRYPTO_CACHE_LINE_SIZE, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_pool_get_slot_size(NULL));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(handle);
+    }
+
+CTEST_END_TEST_SUITE(crypto_alloc_ut)
@@ -0,0 +1,299 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_async.h"
+#include "cablelock/crypto_aes_core.h"
+
+// SP800-38A F.1.1 first block
+static const unsigned char TEST_KEY_DATA[] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char TEST_PLAIN_DATA[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a
+};
+static const unsigned char TEST_CIPHER_DATA[] = {
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+#define TEST_THREAD_COUNT       2
+#define TEST_QUEUE_DEPTH        8
+
+static size_t g_process_calls;
+
+static void my_process_func(void* context, CRYPTO_ASYNC_JOB** jobs, size_t job_count)
+{
+    __atomic_fetch_add(&g_process_calls, 1, __ATOMIC_RELAXED);
+    crypto_async_software_process(context, jobs, job_count);
+}
+
+static void on_job_complete(void* context, CRYPTO_ASYNC_JOB* job)
+{
+    (void)job;
+    __atomic_store_n((int*)context, 1, __ATOMIC_RELEASE);
+}
+
+static void initialize_job(CRYPTO_ASYNC_JOB* job, const AES_KEY_SCHEDULE* schedule, unsigned char* output)
+{
+    memset(job, 0, sizeof(CRYPTO_ASYNC_JOB));
+    job->cipher = CRYPTO_ASYNC_AES_ECB;
+    job->encrypt = true;
+    job->key = schedule;
+    job->input = TEST_PLAIN_DATA;
+    job->input_len = sizeof(TEST_PLAIN_DATA);
+    job->output = output;
+}
+
+static CRYPTO_ASYNC_JOB* wait_for_job(CRYPTO_ASYNC_HANDLE handle)
+{
+    CRYPTO_ASYNC_JOB* result = NULL;
+    while (crypto_async_poll(handle, &result, 1) == 0)
+    {
+    }
+    return result;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_async_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+        g_process_calls = 0;
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_async_create_config_NULL_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_async_create_no_threads_fail)
+    {
+        // arrange
+        CRYPTO_ASYNC_CONFIG config = { 0, TEST_QUEUE_DEPTH, NULL, NULL };
+
+        // act
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_async_create_succeed)
+    {
+        // arrange
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, TEST_QUEUE_DEPTH, NULL, NULL };
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_async_get_in_flight(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_async_submit_job_NULL_fail)
+    {
+        // arrange
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, TEST_QUEUE_DEPTH, NULL, NULL };
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_async_submit(handle, NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_async_submit_poll_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        CRYPTO_ASYNC_JOB job;
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, TEST_QUEUE_DEPTH, NULL, NULL };
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        initialize_job(&job, &schedule, output);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_async_submit(handle, &job);
+        CRYPTO_ASYNC_JOB* completed = wait_for_job(handle);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(completed == &job);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, job.result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_async_get_in_flight(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_async_submit_invalid_job_reports_result)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        CRYPTO_ASYNC_JOB job;
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, TEST_QUEUE_DEPTH, NULL, NULL };
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        initialize_job(&job, &schedule, output);
+        job.input_len = AES_BLOCK_SIZE - 1;
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_async_submit(handle, &job);
+        CRYPTO_ASYNC_JOB* completed = wait_for_job(handle);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(completed == &job);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, job.result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_async_submit_queue_full_fail)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        CRYPTO_ASYNC_JOB job[2];
+        unsigned char output[2][AES_BLOCK_SIZE];
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, 1, NULL, NULL };
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        initialize_job(&job[0], &schedule, output[0]);
+        initialize_job(&job[1], &schedule, output[1]);
+        (void)crypto_async_submit(handle, &job[0]);
+        umock_c_reset_all_calls();
+
+        // act
+        // The first job counts until it is polled, even once it is done
+        int result = crypto_async_submit(handle, &job[1]);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(wait_for_job(handle) == &job[0]);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_async_submit_on_complete_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        CRYPTO_ASYNC_JOB job;
+        unsigned char output[AES_BLOCK_SIZE];
+        int complete = 0;
+        CRYPTO_ASYNC_CONFIG config = { TEST_THREAD_COUNT, TEST_QUEUE_DEPTH, my_process_func, NULL };
+        CRYPTO_ASYNC_HANDLE handle = crypto_async_create(&config);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        initialize_job(&job, &schedule, output);
+        job.on_complete = on_job_complete;
+        job.complete_context = &complete;
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_async_submit(handle, &job);
+        while (crypto_async_get_in_flight(handle) > 0)
+        {
+        }
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 1, __atomic_load_n(&complete, __ATOMIC_ACQUIRE));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 1, g_process_calls);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_async_poll(handle, NULL, 0));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_async_destroy(handle);
+    }
+
+CTEST_END_TEST_SUITE(crypto_async_ut)
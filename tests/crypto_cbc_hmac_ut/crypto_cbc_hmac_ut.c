@@ -0,0 +1,299 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_cbc_hmac.h"
+
+// The module is built into the test with its hash calls renamed so the work
+// done while opening a record can be counted
+static void counted_sha256_update(CRYPTO_SHA256* sha, const unsigned char* data, size_t data_len);
+static void counted_sha256_compress(uint32_t* state, const unsigned char* block);
+static void counted_sha256_rounds_begin(CRYPTO_SHA256_ROUNDS* rounds, const uint32_t* state, const unsigned char* block);
+
+#define crypto_sha256_update        counted_sha256_update
+#define crypto_sha256_compress      counted_sha256_compress
+#define crypto_sha256_rounds_begin  counted_sha256_rounds_begin
+#include "../../src/crypto_cbc_hmac.c"
+#undef crypto_sha256_update
+#undef crypto_sha256_compress
+#undef crypto_sha256_rounds_begin
+
+static size_t g_update_bytes;
+static size_t g_compress_count;
+
+static void counted_sha256_update(CRYPTO_SHA256* sha, const unsigned char* data, size_t data_len)
+{
+    g_update_bytes += data_len;
+    crypto_sha256_update(sha, data, data_len);
+}
+
+static void counted_sha256_compress(uint32_t* state, const unsigned char* block)
+{
+    g_compress_count++;
+    crypto_sha256_compress(state, block);
+}
+
+static void counted_sha256_rounds_begin(CRYPTO_SHA256_ROUNDS* rounds, const uint32_t* state, const unsigned char* block)
+{
+    g_compress_count++;
+    crypto_sha256_rounds_begin(rounds, state, block);
+}
+
+static const unsigned char TEST_KEY_DATA[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const unsigned char TEST_MAC_KEY_DATA[] = {
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f
+};
+static const unsigned char TEST_IV_DATA[] = {
+    0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf
+};
+static const unsigned char TEST_SEQ_HEADER[CBC_HMAC_SEQ_HEADER_SIZE] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x17, 0x03, 0x03
+};
+#define TEST_CIPHER_LEN         512
+#define TEST_SHORT_CIPHER_LEN   (CBC_HMAC_MAC_SIZE + AES_BLOCK_SIZE)
+#define TEST_MAX_PADDING        255
+#define TEST_MAX_FRAGMENT_LEN   (AES_BLOCK_SIZE + TEST_CIPHER_LEN)
+
+// Builds iv || AES-CBC(data || mac || padding) with padding_count bytes of
+// padding_value, so the padding can be anything the record allows
+static size_t build_record(const CRYPTO_CBC_HMAC_KEY* cbc_key, size_t data_len, size_t padding_count, unsigned char padding_value, unsigned char* fragment)
+{
+    CRYPTO_SHA256 sha;
+    unsigned char length[2];
+    unsigned char* plain = fragment + AES_BLOCK_SIZE;
+    size_t cipher_len = data_len + CBC_HMAC_MAC_SIZE + padding_count;
+
+    memcpy(fragment, TEST_IV_DATA, AES_BLOCK_SIZE);
+    for (size_t index = 0; index < data_len; index++)
+    {
+        plain[index] = (unsigned char)index;
+    }
+    length[0] = (unsigned char)(data_len >> 8);
+    length[1] = (unsigned char)data_len;
+    crypto_hmac_sha256_start(&cbc_key->mac_key, &sha);
+    crypto_sha256_update(&sha, TEST_SEQ_HEADER, sizeof(TEST_SEQ_HEADER));
+    crypto_sha256_update(&sha, length, sizeof(length));
+    crypto_sha256_update(&sha, plain, data_len);
+    crypto_hmac_sha256_finish(&cbc_key->mac_key, &sha, plain + data_len);
+    memset(plain + data_len + CBC_HMAC_MAC_SIZE, padding_value, padding_count);
+
+    for (size_t offset = 0; offset < cipher_len; offset += AES_BLOCK_SIZE)
+    {
+        xor_value(plain + offset, fragment + offset, AES_BLOCK_SIZE);
+        crypto_aes_block_encrypt(&cbc_key->schedule, plain + offset, plain + offset);
+    }
+    return AES_BLOCK_SIZE + cipher_len;
+}
+
+static int open_counted(const CRYPTO_CBC_HMAC_KEY* cbc_key, unsigned char* fragment, size_t fragment_len, size_t* plain_len)
+{
+    g_update_bytes = 0;
+    g_compress_count = 0;
+    return crypto_cbc_hmac_open(cbc_key, CBC_HMAC_MAC_THEN_ENCRYPT, TEST_SEQ_HEADER, fragment, fragment_len, plain_len);
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_cbc_hmac_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_cbc_hmac_open_mac_then_encrypt_all_lengths_succeed)
+    {
+        // arrange
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+        unsigned char input[300];
+        unsigned char fragment[AES_BLOCK_SIZE + sizeof(input) + CBC_HMAC_MAX_OVERHEAD];
+        (void)crypto_cbc_hmac_key_init(&cbc_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA));
+        for (size_t index = 0; index < sizeof(input); index++)
+        {
+            input[index] = (unsigned char)(index * 7);
+        }
+
+        // act
+        for (size_t input_len = 0; input_len <= sizeof(input); input_len++)
+        {
+            size_t fragment_len;
+            size_t plain_len = 0;
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_cbc_hmac_seal(&cbc_key, CBC_HMAC_MAC_THEN_ENCRYPT, TEST_IV_DATA, TEST_SEQ_HEADER, input, input_len, fragment, sizeof(fragment), &fragment_len));
+            int result = crypto_cbc_hmac_open(&cbc_key, CBC_HMAC_MAC_THEN_ENCRYPT, TEST_SEQ_HEADER, fragment, fragment_len, &plain_len);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(size_t, input_len, plain_len);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(input, fragment + AES_BLOCK_SIZE, input_len));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_hmac_open_mac_then_encrypt_padding_extremes_same_work_succeed)
+    {
+        // arrange
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+        unsigned char fragment[TEST_MAX_FRAGMENT_LEN];
+        size_t fragment_len;
+        size_t no_padding_len = 0;
+        size_t max_padding_len = 0;
+        (void)crypto_cbc_hmac_key_init(&cbc_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA));
+
+        // act
+        fragment_len = build_record(&cbc_key, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 1, 1, 0, fragment);
+        int no_padding_result = open_counted(&cbc_key, fragment, fragment_len, &no_padding_len);
+        size_t no_padding_updates = g_update_bytes;
+        size_t no_padding_compresses = g_compress_count;
+
+        fragment_len = build_record(&cbc_key, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - TEST_MAX_PADDING - 1, TEST_MAX_PADDING + 1, TEST_MAX_PADDING, fragment);
+        int max_padding_result = open_counted(&cbc_key, fragment, fragment_len, &max_padding_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, no_padding_result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, max_padding_result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 1, no_padding_len);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - TEST_MAX_PADDING - 1, max_padding_len);
+        CTEST_ASSERT_ARE_EQUAL(size_t, no_padding_updates, g_update_bytes);
+        CTEST_ASSERT_ARE_EQUAL(size_t, no_padding_compresses, g_compress_count);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_hmac_open_mac_then_encrypt_bad_padding_same_work_fail)
+    {
+        // arrange
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+        unsigned char fragment[TEST_MAX_FRAGMENT_LEN];
+        size_t fragment_len;
+        size_t plain_len = 0;
+        (void)crypto_cbc_hmac_key_init(&cbc_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA));
+
+        fragment_len = build_record(&cbc_key, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 1, 1, 0, fragment);
+        (void)open_counted(&cbc_key, fragment, fragment_len, &plain_len);
+        size_t good_updates = g_update_bytes;
+        size_t good_compresses = g_compress_count;
+
+        // Claims 255 bytes of padding but only the length byte holds that value
+        fragment_len = build_record(&cbc_key, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - TEST_MAX_PADDING - 1, TEST_MAX_PADDING + 1, 0, fragment);
+        fragment[fragment_len - 1 - AES_BLOCK_SIZE] ^= TEST_MAX_PADDING;
+
+        // act
+        int result = open_counted(&cbc_key, fragment, fragment_len, &plain_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, good_updates, g_update_bytes);
+        CTEST_ASSERT_ARE_EQUAL(size_t, good_compresses, g_compress_count);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_hmac_open_mac_then_encrypt_padding_past_record_same_work_fail)
+    {
+        // arrange
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+        unsigned char fragment[TEST_MAX_FRAGMENT_LEN];
+        size_t fragment_len;
+        size_t plain_len = 0;
+        (void)crypto_cbc_hmac_key_init(&cbc_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA));
+
+        fragment_len = build_record(&cbc_key, TEST_SHORT_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 1, 1, 0, fragment);
+        (void)open_counted(&cbc_key, fragment, fragment_len, &plain_len);
+        size_t good_updates = g_update_bytes;
+        size_t good_compresses = g_compress_count;
+
+        // Padding bytes all hold 255 in a record far too short for them
+        fragment_len = build_record(&cbc_key, 0, TEST_SHORT_CIPHER_LEN - CBC_HMAC_MAC_SIZE, TEST_MAX_PADDING, fragment);
+
+        // act
+        int result = open_counted(&cbc_key, fragment, fragment_len, &plain_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, good_updates, g_update_bytes);
+        CTEST_ASSERT_ARE_EQUAL(size_t, good_compresses, g_compress_count);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_hmac_open_mac_then_encrypt_tampered_mac_fail)
+    {
+        // arrange
+        CRYPTO_CBC_HMAC_KEY cbc_key;
+        unsigned char fragment[TEST_MAX_FRAGMENT_LEN];
+        size_t fragment_len;
+        size_t plain_len = 0;
+        (void)crypto_cbc_hmac_key_init(&cbc_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA));
+        fragment_len = build_record(&cbc_key, 300, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 300, TEST_CIPHER_LEN - CBC_HMAC_MAC_SIZE - 301, fragment);
+        fragment[AES_BLOCK_SIZE + 300] ^= 0x01;
+
+        // act
+        int result = crypto_cbc_hmac_open(&cbc_key, CBC_HMAC_MAC_THEN_ENCRYPT, TEST_SEQ_HEADER, fragment, fragment_len, &plain_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_cbc_hmac_ut)
@@ -0,0 +1,188 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_ccm.h"
+
+// RFC 3610 packet vector #1
+static const unsigned char TEST_KEY_DATA[] = {
+    0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+static const unsigned char TEST_NONCE_DATA[] = { 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 };
+static const unsigned char TEST_AAD_DATA[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+static const unsigned char TEST_PLAIN_DATA[] = {
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e
+};
+static const unsigned char TEST_CIPHER_DATA[] = {
+    0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2, 0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+    0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84
+};
+static const unsigned char TEST_TAG_DATA[] = { 0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0 };
+#define TEST_DATA_LEN           23
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_ccm_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_ccm_encrypt_nonce_len_invalid_fail)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char output[TEST_DATA_LEN];
+        unsigned char tag[CCM_SHORT_TAG_SIZE];
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_ccm_encrypt(&schedule, TEST_NONCE_DATA, CCM_MIN_NONCE_SIZE - 1, TEST_AAD_DATA, sizeof(TEST_AAD_DATA),
+            TEST_PLAIN_DATA, TEST_DATA_LEN, output, tag, CCM_SHORT_TAG_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_ccm_encrypt_tag_len_odd_fail)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char output[TEST_DATA_LEN];
+        unsigned char tag[CCM_TAG_SIZE];
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_ccm_encrypt(&schedule, TEST_NONCE_DATA, sizeof(TEST_NONCE_DATA), TEST_AAD_DATA, sizeof(TEST_AAD_DATA),
+            TEST_PLAIN_DATA, TEST_DATA_LEN, output, tag, CCM_SHORT_TAG_SIZE + 1);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_ccm_encrypt_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char output[TEST_DATA_LEN];
+        unsigned char tag[CCM_SHORT_TAG_SIZE];
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_ccm_encrypt(&schedule, TEST_NONCE_DATA, sizeof(TEST_NONCE_DATA), TEST_AAD_DATA, sizeof(TEST_AAD_DATA),
+            TEST_PLAIN_DATA, TEST_DATA_LEN, output, tag, CCM_SHORT_TAG_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tag, TEST_TAG_DATA, CCM_SHORT_TAG_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_ccm_decrypt_in_place_succeed)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char data[TEST_DATA_LEN];
+        memcpy(data, TEST_CIPHER_DATA, TEST_DATA_LEN);
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_ccm_decrypt(&schedule, TEST_NONCE_DATA, sizeof(TEST_NONCE_DATA), TEST_AAD_DATA, sizeof(TEST_AAD_DATA),
+            data, TEST_DATA_LEN, data, TEST_TAG_DATA, CCM_SHORT_TAG_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(data, TEST_PLAIN_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_ccm_decrypt_tag_mismatch_fail)
+    {
+        // arrange
+        AES_KEY_SCHEDULE schedule;
+        unsigned char output[TEST_DATA_LEN];
+        unsigned char tag[CCM_SHORT_TAG_SIZE];
+        memcpy(tag, TEST_TAG_DATA, CCM_SHORT_TAG_SIZE);
+        tag[CCM_SHORT_TAG_SIZE - 1] ^= 0x01;
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_ccm_decrypt(&schedule, TEST_NONCE_DATA, sizeof(TEST_NONCE_DATA), TEST_AAD_DATA, sizeof(TEST_AAD_DATA),
+            TEST_CIPHER_DATA, TEST_DATA_LEN, output, tag, CCM_SHORT_TAG_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        for (size_t index = 0; index < TEST_DATA_LEN; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, output[index]);
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_ccm_ut)
@@ -0,0 +1,225 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_cmac.h"
+
+// RFC 4493 section 4 examples
+static const unsigned char TEST_KEY_DATA[] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char TEST_MESSAGE_DATA[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const unsigned char TEST_SUBKEY1_DATA[] = { 0xfb, 0xee, 0xd6, 0x18, 0x35, 0x71, 0x33, 0x66, 0x7c, 0x85, 0xe0, 0x8f, 0x72, 0x36, 0xa8, 0xde };
+static const unsigned char TEST_SUBKEY2_DATA[] = { 0xf7, 0xdd, 0xac, 0x30, 0x6a, 0xe2, 0x66, 0xcc, 0xf9, 0x0b, 0xc1, 0x1e, 0xe4, 0x6d, 0x51, 0x3b };
+static const size_t TEST_MESSAGE_LENS[] = { 0, 16, 40, 64 };
+static const unsigned char TEST_TAG_DATA[][CMAC_TAG_SIZE] = {
+    { 0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46 },
+    { 0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c },
+    { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 },
+    { 0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe }
+};
+// The 16 byte example encrypted under the key, also its one block CBC-MAC
+static const unsigned char TEST_CBC_MAC_DATA[] = { 0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97 };
+#define TEST_MESSAGE_COUNT      4
+// More messages than lanes so finished lanes are refilled
+#define TEST_BATCH_COUNT        (3 * TEST_MESSAGE_COUNT)
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_cmac_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_cmac_key_init_key_NULL_fail)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+
+        // act
+        int result = crypto_cmac_key_init(&cmac_key, NULL, sizeof(TEST_KEY_DATA));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cmac_key_init_succeed)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+
+        // act
+        int result = crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(cmac_key.subkey1, TEST_SUBKEY1_DATA, AES_BLOCK_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(cmac_key.subkey2, TEST_SUBKEY2_DATA, AES_BLOCK_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cmac_compute_tag_NULL_fail)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+        (void)crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_cmac_compute(&cmac_key, TEST_MESSAGE_DATA, sizeof(TEST_MESSAGE_DATA), NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cmac_compute_succeed)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+        unsigned char tag[CMAC_TAG_SIZE];
+        (void)crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        for (size_t index = 0; index < TEST_MESSAGE_COUNT; index++)
+        {
+            // act
+            int result = crypto_cmac_compute(&cmac_key, TEST_MESSAGE_DATA, TEST_MESSAGE_LENS[index], tag);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tag, TEST_TAG_DATA[index], CMAC_TAG_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cmac_compute_batch_succeed)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+        CRYPTO_MAC_MESSAGE messages[TEST_BATCH_COUNT];
+        unsigned char tags[TEST_BATCH_COUNT][CMAC_TAG_SIZE];
+        for (size_t index = 0; index < TEST_BATCH_COUNT; index++)
+        {
+            // Mixed lengths so lanes finish at different steps
+            messages[index].data = TEST_MESSAGE_DATA;
+            messages[index].data_len = TEST_MESSAGE_LENS[(index * 3) % TEST_MESSAGE_COUNT];
+            messages[index].tag = tags[index];
+        }
+        (void)crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_cmac_compute_batch(&cmac_key, messages, TEST_BATCH_COUNT);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        for (size_t index = 0; index < TEST_BATCH_COUNT; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tags[index], TEST_TAG_DATA[(index * 3) % TEST_MESSAGE_COUNT], CMAC_TAG_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_mac_compute_partial_block_fail)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+        unsigned char tag[CMAC_TAG_SIZE];
+        (void)crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_cbc_mac_compute(&cmac_key.schedule, TEST_MESSAGE_DATA, TEST_MESSAGE_LENS[2], tag);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_cbc_mac_compute_succeed)
+    {
+        // arrange
+        CRYPTO_CMAC_KEY cmac_key;
+        unsigned char tag[CMAC_TAG_SIZE];
+        (void)crypto_cmac_key_init(&cmac_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_cbc_mac_compute(&cmac_key.schedule, TEST_MESSAGE_DATA, AES_BLOCK_SIZE, tag);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(tag, TEST_CBC_MAC_DATA, CMAC_TAG_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_cmac_ut)
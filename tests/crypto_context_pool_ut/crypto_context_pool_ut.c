@@ -0,0 +1,327 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+#include <pthread.h>
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_context_pool.h"
+#include "cablelock/crypto_alloc.h"
+
+// SP800-38A F.1.1 first block
+static const unsigned char TEST_KEY_DATA[] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char TEST_PLAIN_DATA[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a
+};
+static const unsigned char TEST_CIPHER_DATA[] = {
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+static const unsigned char TEST_DES_KEY_DATA[] = {
+    0x13, 0x34, 0x57, 0x79, 0x9b, 0xbc, 0xdf, 0xf1
+};
+#define TEST_CONTEXT_COUNT      8
+#define TEST_CACHE_SIZE         4
+#define TEST_THREAD_COUNT       4
+#define TEST_THREAD_LOOPS       2000
+
+typedef struct TEST_THREAD_INFO_TAG
+{
+    CRYPTO_CONTEXT_POOL_HANDLE pool;
+    int failures;
+} TEST_THREAD_INFO;
+
+static void* stress_thread(void* parameter)
+{
+    TEST_THREAD_INFO* info = (TEST_THREAD_INFO*)parameter;
+    CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(info->pool, 2);
+    CRYPTO_CIPHER_CONTEXT* held[2];
+    unsigned char output[AES_BLOCK_SIZE];
+
+    for (size_t index = 0; index < TEST_THREAD_LOOPS; index++)
+    {
+        held[0] = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        held[1] = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        for (size_t slot = 0; slot < 2; slot++)
+        {
+            if (held[slot] == NULL)
+            {
+                info->failures++;
+                continue;
+            }
+            crypto_aes_block_encrypt(&held[slot]->schedule.aes, TEST_PLAIN_DATA, output);
+            if (memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE) != 0)
+            {
+                info->failures++;
+            }
+        }
+        for (size_t slot = 0; slot < 2; slot++)
+        {
+            if (held[slot] != NULL)
+            {
+                crypto_context_release(cache, held[slot]);
+            }
+        }
+    }
+    crypto_context_cache_destroy(cache);
+    return NULL;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_context_pool_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_context_pool_create_zero_count_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(0);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(pool);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_context_pool_create_succeed)
+    {
+        // arrange
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_CONTEXT_COUNT);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(pool);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CONTEXT_COUNT, crypto_context_pool_get_free(pool));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_cache_create_too_large_fail)
+    {
+        // arrange
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_CONTEXT_COUNT);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, TEST_CONTEXT_COUNT + 1);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(cache);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_acquire_aes_succeed)
+    {
+        // arrange
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_CONTEXT_COUNT);
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, TEST_CACHE_SIZE);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_CIPHER_CONTEXT* context = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(context);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, (size_t)((uintptr_t)context % CRYPTO_CACHE_LINE_SIZE));
+        crypto_aes_block_encrypt(&context->schedule.aes, TEST_PLAIN_DATA, output);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE));
+        // Half the cache was refilled from the pool
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CONTEXT_COUNT - TEST_CACHE_SIZE / 2, crypto_context_pool_get_free(pool));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_release(cache, context);
+        crypto_context_cache_destroy(cache);
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_acquire_invalid_key_fail)
+    {
+        // arrange
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_CONTEXT_COUNT);
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, TEST_CACHE_SIZE);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_CIPHER_CONTEXT* context = crypto_context_acquire(cache, CRYPTO_CONTEXT_DES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // assert
+        CTEST_ASSERT_IS_NULL(context);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_cache_destroy(cache);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CONTEXT_COUNT, crypto_context_pool_get_free(pool));
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_release_wipes_schedule_succeed)
+    {
+        // arrange
+        static const unsigned char zero_block[sizeof(DES_KEY_SCHEDULE)] = { 0 };
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(1);
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, 1);
+        CRYPTO_CIPHER_CONTEXT* context = crypto_context_acquire(cache, CRYPTO_CONTEXT_DES, TEST_DES_KEY_DATA, sizeof(TEST_DES_KEY_DATA));
+        umock_c_reset_all_calls();
+
+        // act
+        crypto_context_release(cache, context);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(&context->schedule, zero_block, sizeof(context->schedule)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_cache_destroy(cache);
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_acquire_exhausted_fail)
+    {
+        // arrange
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(1);
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, 1);
+        CRYPTO_CIPHER_CONTEXT* first = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_CIPHER_CONTEXT* second = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(first);
+        CTEST_ASSERT_IS_NULL(second);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_release(cache, first);
+        crypto_context_cache_destroy(cache);
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_release_full_cache_spills_to_pool)
+    {
+        // arrange
+        CRYPTO_CIPHER_CONTEXT* held[TEST_CONTEXT_COUNT];
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_CONTEXT_COUNT);
+        CRYPTO_CONTEXT_CACHE_HANDLE cache = crypto_context_cache_create(pool, TEST_CACHE_SIZE);
+        for (size_t index = 0; index < TEST_CONTEXT_COUNT; index++)
+        {
+            held[index] = crypto_context_acquire(cache, CRYPTO_CONTEXT_AES, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        }
+        umock_c_reset_all_calls();
+
+        // act
+        for (size_t index = 0; index < TEST_CONTEXT_COUNT; index++)
+        {
+            crypto_context_release(cache, held[index]);
+        }
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CONTEXT_COUNT / 2, crypto_context_pool_get_free(pool));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_context_cache_destroy(cache);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_CONTEXT_COUNT, crypto_context_pool_get_free(pool));
+        crypto_context_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_context_acquire_release_threads_succeed)
+    {
+        // arrange
+        pthread_t threads[TEST_THREAD_COUNT];
+        TEST_THREAD_INFO info[TEST_THREAD_COUNT];
+        CRYPTO_CONTEXT_POOL_HANDLE pool = crypto_context_pool_create(TEST_THREAD_COUNT * 2);
+        umock_c_reset_all_calls();
+
+        // act
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            info[index].pool = pool;
+            info[index].failures = 0;
+            (void)pthread_create(&threads[index], NULL, stress_thread, &info[index]);
+        }
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            (void)pthread_join(threads[index], NULL);
+        }
+
+        // assert
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, info[index].failures);
+        }
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_THREAD_COUNT * 2, crypto_context_pool_get_free(pool));
+
+        // cleanup
+        umock_c_reset_all_calls();
+        crypto_context_pool_destroy(pool);
+    }
+
+CTEST_END_TEST_SUITE(crypto_context_pool_ut)
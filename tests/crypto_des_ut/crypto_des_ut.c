@@ -32,6 +32,7 @@ static void my_mem_shim_free(void* ptr)
 #undef ENABLE_MOCKS
 
 #include "cablelock/crypto_ciphers.h"
+#include "cablelock/crypto_des_core.h"
 
 static const char* TEST_ENCRYPT_DATA = "abcdefghijklmnop";
 static const char* TEST_KEY_DATA = "password";
@@ -277,6 +278,36 @@ CTEST_BEGIN_TEST_SUITE(crypto_des_ut)
         // cleanup
     }
 
+    CTEST_FUNCTION(crypto_3des_encrypt_result_len_too_small_fail)
+    {
+        // arrange
+        unsigned char output[TEST_ENCRYPT_DATA_LEN];
+
+        // act
+        int result = crypto_3des_encrypt(TEST_ENCRYPT_DATA, TEST_ENCRYPT_DATA_LEN, output, TEST_ENCRYPT_DATA_LEN - 1, TEST_3DES_KEY_DATA, TEST_INITIAL_VECTOR, false);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_3des_encrypt_partial_block_no_padding_fail)
+    {
+        // arrange
+        unsigned char output[TEST_ENCRYPT_DATA_LEN];
+
+        // act
+        int result = crypto_3des_encrypt(TEST_ENCRYPT_DATA, TEST_ENCRYPT_DATA_LEN - 1, output, TEST_ENCRYPT_DATA_LEN, TEST_3DES_KEY_DATA, TEST_INITIAL_VECTOR, false);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
     CTEST_FUNCTION(crypto_3des_encrypt_succeed)
     {
         // arrange
@@ -386,4 +417,85 @@ CTEST_BEGIN_TEST_SUITE(crypto_des_ut)
         // cleanup
     }
 
+    CTEST_FUNCTION(crypto_des_ecb_encrypt_blocks_schedule_NULL_fail)
+    {
+        // arrange
+        unsigned char output[TEST_ENCRYPT_DATA_LEN];
+
+        // act
+        int result = crypto_des_ecb_encrypt_blocks(NULL, (const unsigned char*)TEST_ENCRYPT_DATA, output, TEST_ENCRYPT_DATA_LEN/DES_BLOCK_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_des_ecb_encrypt_blocks_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_ENCRYPT_DATA_LEN];
+        DES_KEY_SCHEDULE schedule;
+        (void)crypto_des_key_init(&schedule, (const unsigned char*)TEST_KEY_DATA, DES_KEY_SIZE);
+
+        // act
+        int result = crypto_des_ecb_encrypt_blocks(&schedule, (const unsigned char*)TEST_ENCRYPT_DATA, output, TEST_ENCRYPT_DATA_LEN/DES_BLOCK_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_NO_INIT_CIPHER_DATA, TEST_ENCRYPT_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_des_ecb_decrypt_blocks_3des_in_place_succeed)
+    {
+        // arrange
+        unsigned char buffer[TEST_ENCRYPT_DATA_LEN];
+        DES_KEY_SCHEDULE schedule;
+        (void)crypto_des_key_init(&schedule, (const unsigned char*)TEST_3DES_KEY_DATA, DES3_KEY_SIZE);
+        memcpy(buffer, TEST_3DES_NO_INIT_CIPHER_DATA, TEST_ENCRYPT_DATA_LEN);
+
+        // act
+        int result = crypto_des_ecb_decrypt_blocks(&schedule, buffer, buffer, TEST_ENCRYPT_DATA_LEN/DES_BLOCK_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, TEST_ENCRYPT_DATA, TEST_ENCRYPT_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_des_ecb_encrypt_blocks_3des_past_batch_width_succeed)
+    {
+        // arrange
+        const size_t block_count = DES_BATCH_WIDTH + 3;
+        unsigned char input[(DES_BATCH_WIDTH + 3) * DES_BLOCK_SIZE];
+        unsigned char expected[(DES_BATCH_WIDTH + 3) * DES_BLOCK_SIZE];
+        unsigned char output[(DES_BATCH_WIDTH + 3) * DES_BLOCK_SIZE];
+        DES_KEY_SCHEDULE schedule;
+        (void)crypto_des_key_init(&schedule, (const unsigned char*)TEST_3DES_KEY_DATA, DES3_KEY_SIZE);
+        for (size_t index = 0; index < sizeof(input); index++)
+        {
+            input[index] = (unsigned char)(index * 29);
+        }
+        for (size_t index = 0; index < block_count; index++)
+        {
+            crypto_des_block_encrypt(&schedule, input + (index * DES_BLOCK_SIZE), expected + (index * DES_BLOCK_SIZE));
+        }
+
+        // act
+        int result = crypto_des_ecb_encrypt_blocks(&schedule, input, output, block_count);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, expected, sizeof(expected)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
 CTEST_END_TEST_SUITE(crypto_des_ut)
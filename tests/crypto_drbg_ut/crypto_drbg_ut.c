@@ -0,0 +1,293 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_drbg.h"
+
+#define TEST_OUTPUT_SIZE    64
+#define TEST_NONCE_SIZE     12
+
+// Entropy 00..2f, personalization a0..af and additional input 60..8f, the
+// expected output comes from the OpenSSL CTR-DRBG (AES-256-CTR, no df)
+static const unsigned char TEST_FIRST_OUTPUT[] = {
+    0xbc, 0x48, 0x69, 0xc6, 0xa1, 0x62, 0x1e, 0xda, 0x89, 0xc1, 0x56, 0x78,
+    0x69, 0x18, 0x3e, 0xc1, 0x4e, 0x63, 0x65, 0x60, 0x53, 0xb4, 0x25, 0xbe,
+    0x91, 0x65, 0x0e, 0xae, 0xe6, 0xb9, 0xe4, 0x4e, 0x6c, 0x32, 0x2c, 0xf1,
+    0x93, 0xc1, 0x74, 0x17, 0x5c, 0x45, 0x0f, 0x91, 0x8f, 0x9b, 0x74, 0xf7,
+    0x21, 0xce, 0x8c, 0x84, 0x23, 0x91, 0xf8, 0x5f, 0x11, 0x6b, 0x07, 0x89,
+    0x95, 0x71, 0x80, 0x68
+};
+static const unsigned char TEST_SECOND_OUTPUT[] = {
+    0x97, 0x27, 0xed, 0x26, 0xc6, 0x6d, 0x19, 0x9a, 0xe1, 0xbf, 0xf8, 0xa2,
+    0xdd, 0x45, 0x09, 0xe7, 0xfb, 0x49, 0xd8, 0xd3, 0xbb, 0xe9, 0xf4, 0xb2,
+    0x00, 0xd3, 0x1c, 0x9d, 0x25, 0x62, 0x4b, 0x18, 0xbe, 0x99, 0x08, 0x91,
+    0x64, 0x96, 0x14, 0x54, 0x55, 0x20, 0x11, 0xd3, 0x0c, 0x69, 0x61, 0x24,
+    0xc7, 0x5c, 0x99, 0x5b, 0x47, 0x00, 0x61, 0x50, 0x76, 0x16, 0xfc, 0xcb,
+    0x3b, 0xe3, 0x42, 0x4b
+};
+
+static unsigned char g_entropy[CRYPTO_DRBG_SEED_SIZE];
+static unsigned char g_personalization[16];
+static unsigned char g_additional[CRYPTO_DRBG_SEED_SIZE];
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_drbg_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+
+        for (size_t index = 0; index < sizeof(g_entropy); index++)
+        {
+            g_entropy[index] = (unsigned char)index;
+            g_additional[index] = (unsigned char)(0x60 + index);
+        }
+        for (size_t index = 0; index < sizeof(g_personalization); index++)
+        {
+            g_personalization[index] = (unsigned char)(0xa0 + index);
+        }
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_drbg_create_seeded_entropy_len_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_DRBG_HANDLE handle = crypto_drbg_create_seeded(g_entropy, CRYPTO_DRBG_SEED_SIZE - 1, NULL, 0);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_drbg_create_personalization_too_long_fail)
+    {
+        // arrange
+        unsigned char personalization[CRYPTO_DRBG_SEED_SIZE + 1] = { 0 };
+
+        // act
+        CRYPTO_DRBG_HANDLE handle = crypto_drbg_create(personalization, sizeof(personalization));
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_drbg_generate_known_answer_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_OUTPUT_SIZE];
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        CRYPTO_DRBG_HANDLE handle = crypto_drbg_create_seeded(g_entropy, sizeof(g_entropy), g_personalization, sizeof(g_personalization));
+
+        // act
+        int first = crypto_drbg_generate(handle, NULL, 0, output, sizeof(output));
+        int first_cmp = memcmp(output, TEST_FIRST_OUTPUT, sizeof(output));
+        int second = crypto_drbg_generate(handle, g_additional, sizeof(g_additional), output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, first);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, first_cmp);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, second);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_SECOND_OUTPUT, sizeof(output)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_drbg_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_drbg_generate_request_too_large_fail)
+    {
+        // arrange
+        unsigned char* output = (unsigned char*)malloc(CRYPTO_DRBG_MAX_REQUEST + 1);
+        CRYPTO_DRBG_HANDLE handle = crypto_drbg_create_seeded(g_entropy, sizeof(g_entropy), NULL, 0);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_drbg_generate(handle, NULL, 0, output, CRYPTO_DRBG_MAX_REQUEST + 1);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_drbg_destroy(handle);
+        free(output);
+    }
+
+    CTEST_FUNCTION(crypto_drbg_reseed_changes_output_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_OUTPUT_SIZE];
+        CRYPTO_DRBG_HANDLE handle = crypto_drbg_create_seeded(g_entropy, sizeof(g_entropy), g_personalization, sizeof(g_personalization));
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_drbg_reseed(handle, g_additional, sizeof(g_additional));
+        (void)crypto_drbg_generate(handle, NULL, 0, output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(output, TEST_FIRST_OUTPUT, sizeof(output)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_drbg_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_drbg_random_bytes_output_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_drbg_random_bytes(NULL, TEST_NONCE_SIZE);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_drbg_random_bytes_nonces_differ_succeed)
+    {
+        // arrange
+        unsigned char first[TEST_NONCE_SIZE];
+        unsigned char second[TEST_NONCE_SIZE];
+
+        // act
+        int result = crypto_drbg_random_bytes(first, sizeof(first));
+        result |= crypto_drbg_random_bytes(second, sizeof(second));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(first, second, sizeof(first)));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_drbg_random_bytes_crosses_buffer_succeed)
+    {
+        // arrange
+        size_t total = (CRYPTO_DRBG_BUFFER_SIZE * 2) + CRYPTO_DRBG_MAX_REQUEST;
+        unsigned char* output = (unsigned char*)calloc(1, total);
+        size_t zero_blocks = 0;
+        int result = 0;
+
+        // act
+        // Odd sized draws walk across refills, the last one bypasses the buffer
+        for (size_t offset = 0; offset < CRYPTO_DRBG_BUFFER_SIZE * 2; offset += 13)
+        {
+            size_t length = (CRYPTO_DRBG_BUFFER_SIZE * 2) - offset < 13 ? (CRYPTO_DRBG_BUFFER_SIZE * 2) - offset : 13;
+            result |= crypto_drbg_random_bytes(output + offset, length);
+        }
+        result |= crypto_drbg_random_bytes(output + (CRYPTO_DRBG_BUFFER_SIZE * 2), CRYPTO_DRBG_MAX_REQUEST);
+
+        // assert
+        for (size_t offset = 0; offset + 8 <= total; offset += 8)
+        {
+            static const unsigned char zero[8] = { 0 };
+            zero_blocks += memcmp(output + offset, zero, 8) == 0 ? 1 : 0;
+        }
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, zero_blocks);
+
+        // cleanup
+        free(output);
+    }
+
+    CTEST_FUNCTION(crypto_drbg_random_bytes_forked_child_differs_succeed)
+    {
+        // arrange
+        unsigned char parent_bytes[TEST_NONCE_SIZE];
+        unsigned char child_bytes[TEST_NONCE_SIZE] = { 0 };
+        int pipe_fds[2];
+        int status = -1;
+        // Leaves buffered output behind for the child to inherit
+        (void)crypto_drbg_random_bytes(parent_bytes, sizeof(parent_bytes));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, pipe(pipe_fds));
+
+        // act
+        pid_t child = fork();
+        if (child == 0)
+        {
+            int result = crypto_drbg_random_bytes(child_bytes, sizeof(child_bytes));
+            _exit(result == 0 && write(pipe_fds[1], child_bytes, sizeof(child_bytes)) == (ssize_t)sizeof(child_bytes) ? 0 : 1);
+        }
+        (void)crypto_drbg_random_bytes(parent_bytes, sizeof(parent_bytes));
+        (void)waitpid(child, &status, 0);
+        ssize_t received = read(pipe_fds[0], child_bytes, sizeof(child_bytes));
+
+        // assert
+        CTEST_ASSERT_IS_TRUE(WIFEXITED(status));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, WEXITSTATUS(status));
+        CTEST_ASSERT_ARE_EQUAL(int, (int)sizeof(child_bytes), (int)received);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(parent_bytes, child_bytes, sizeof(child_bytes)));
+
+        // cleanup
+        (void)close(pipe_fds[0]);
+        (void)close(pipe_fds[1]);
+    }
+
+CTEST_END_TEST_SUITE(crypto_drbg_ut)
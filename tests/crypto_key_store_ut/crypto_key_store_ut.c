@@ -0,0 +1,288 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_key_store.h"
+#include "cablelock/crypto_alloc.h"
+
+// FIPS-197 C.1
+static const unsigned char TEST_AES_KEY_DATA[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const unsigned char TEST_PLAIN_DATA[] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const unsigned char TEST_CIPHER_DATA[] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+static const unsigned char TEST_DES_KEY_DATA[] = "twentyfourcharacterinput";
+#define TEST_AES_KEY_ID         42
+#define TEST_DES_KEY_ID         7
+#define TEST_UNKNOWN_KEY_ID     1000
+
+static char g_store_name[64];
+
+static void initialize_entries(CRYPTO_KEY_STORE_ENTRY entries[2])
+{
+    entries[0].key_id = TEST_AES_KEY_ID;
+    entries[0].cipher = CRYPTO_KEY_STORE_AES;
+    entries[0].key = TEST_AES_KEY_DATA;
+    entries[0].key_len = sizeof(TEST_AES_KEY_DATA);
+    entries[1].key_id = TEST_DES_KEY_ID;
+    entries[1].cipher = CRYPTO_KEY_STORE_DES;
+    entries[1].key = TEST_DES_KEY_DATA;
+    entries[1].key_len = DES3_KEY_SIZE;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_key_store_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+
+        // Unique per run so parallel test runs do not collide
+        (void)snprintf(g_store_name, sizeof(g_store_name), "/cablelock-ut-%d", (int)getpid());
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+        (void)crypto_key_store_unlink(g_store_name);
+    }
+
+    CTEST_FUNCTION(crypto_key_store_publish_entries_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_key_store_publish(g_store_name, NULL, 2);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_store_publish_duplicate_id_fail)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        initialize_entries(entries);
+        entries[1].key_id = TEST_AES_KEY_ID;
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mem_shim_free(IGNORED_PTR_ARG));
+
+        // act
+        int result = crypto_key_store_publish(g_store_name, entries, 2);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_NULL(crypto_key_store_open(g_store_name));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_store_publish_invalid_key_removes_segment)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        initialize_entries(entries);
+        entries[0].key_len = 5;
+
+        // act
+        int result = crypto_key_store_publish(g_store_name, entries, 2);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_NULL(crypto_key_store_open(g_store_name));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_store_publish_existing_name_fail)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        initialize_entries(entries);
+        (void)crypto_key_store_publish(g_store_name, entries, 2);
+
+        // act
+        int result = crypto_key_store_publish(g_store_name, entries, 2);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_store_open_missing_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_KEY_STORE_HANDLE handle = crypto_key_store_open(g_store_name);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_store_find_aes_succeed)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        unsigned char output[AES_BLOCK_SIZE];
+        initialize_entries(entries);
+        (void)crypto_key_store_publish(g_store_name, entries, 2);
+        CRYPTO_KEY_STORE_HANDLE handle = crypto_key_store_open(g_store_name);
+        umock_c_reset_all_calls();
+
+        // act
+        const AES_KEY_SCHEDULE* schedule = crypto_key_store_find_aes(handle, TEST_AES_KEY_ID);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(schedule);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, (size_t)((uintptr_t)schedule % CRYPTO_CACHE_LINE_SIZE));
+        crypto_aes_block_encrypt(schedule, TEST_PLAIN_DATA, output);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 2, crypto_key_store_get_count(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_key_store_close(handle);
+    }
+
+    CTEST_FUNCTION(crypto_key_store_find_des_succeed)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        DES_KEY_SCHEDULE expected;
+        initialize_entries(entries);
+        (void)crypto_des_key_init(&expected, TEST_DES_KEY_DATA, DES3_KEY_SIZE);
+        (void)crypto_key_store_publish(g_store_name, entries, 2);
+        CRYPTO_KEY_STORE_HANDLE handle = crypto_key_store_open(g_store_name);
+        umock_c_reset_all_calls();
+
+        // act
+        const DES_KEY_SCHEDULE* schedule = crypto_key_store_find_des(handle, TEST_DES_KEY_ID);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(schedule);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(schedule, &expected, sizeof(expected)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_key_store_close(handle);
+    }
+
+    CTEST_FUNCTION(crypto_key_store_find_unknown_or_other_cipher_fail)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        initialize_entries(entries);
+        (void)crypto_key_store_publish(g_store_name, entries, 2);
+        CRYPTO_KEY_STORE_HANDLE handle = crypto_key_store_open(g_store_name);
+        umock_c_reset_all_calls();
+
+        // act
+        const AES_KEY_SCHEDULE* unknown = crypto_key_store_find_aes(handle, TEST_UNKNOWN_KEY_ID);
+        const AES_KEY_SCHEDULE* other = crypto_key_store_find_aes(handle, TEST_DES_KEY_ID);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(unknown);
+        CTEST_ASSERT_IS_NULL(other);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_key_store_close(handle);
+    }
+
+    CTEST_FUNCTION(crypto_key_store_open_from_forked_worker_succeed)
+    {
+        // arrange
+        CRYPTO_KEY_STORE_ENTRY entries[2];
+        int status = -1;
+        initialize_entries(entries);
+        (void)crypto_key_store_publish(g_store_name, entries, 2);
+
+        // act
+        pid_t worker = fork();
+        if (worker == 0)
+        {
+            unsigned char output[AES_BLOCK_SIZE];
+            CRYPTO_KEY_STORE_HANDLE handle = crypto_key_store_open(g_store_name);
+            const AES_KEY_SCHEDULE* schedule = crypto_key_store_find_aes(handle, TEST_AES_KEY_ID);
+            if (schedule != NULL)
+            {
+                crypto_aes_block_encrypt(schedule, TEST_PLAIN_DATA, output);
+            }
+            _exit(schedule != NULL && memcmp(output, TEST_CIPHER_DATA, AES_BLOCK_SIZE) == 0 ? 0 : 1);
+        }
+        (void)waitpid(worker, &status, 0);
+
+        // assert
+        CTEST_ASSERT_IS_TRUE(WIFEXITED(status));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, WEXITSTATUS(status));
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_key_store_ut)
@@ -0,0 +1,234 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_keystream.h"
+
+// NIST SP 800-38A F.5.1 and F.4.1, first block
+static const unsigned char TEST_KEY_DATA[] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+static const unsigned char TEST_COUNTER_DATA[] = { 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+static const unsigned char TEST_OFB_IV_DATA[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+static const unsigned char TEST_PLAIN_DATA[] = { 0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a };
+static const unsigned char TEST_CTR_CIPHER_DATA[] = { 0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce };
+static const unsigned char TEST_OFB_CIPHER_DATA[] = { 0x3b, 0x3f, 0xd9, 0x2e, 0xb7, 0x2d, 0xad, 0x20, 0x33, 0x34, 0x49, 0xf8, 0xe8, 0x3c, 0xfb, 0x4a };
+#define TEST_DATA_LEN       16
+#define TEST_SPLIT_LEN      5
+#define TEST_DEPTH          40
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_keystream_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_keystream_create_config_NULL_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_keystream_create_low_water_above_depth_fail)
+    {
+        // arrange
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, TEST_DEPTH + 1 };
+
+        // act
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, &config);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_keystream_create_succeed)
+    {
+        // arrange
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, 0 };
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, &config);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_keystream_get_available(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_keystream_refill_rounds_to_blocks_succeed)
+    {
+        // arrange
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, 0 };
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, &config);
+        umock_c_reset_all_calls();
+
+        // act
+        size_t result = crypto_keystream_refill(handle);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, 48, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_keystream_xor_ctr_precomputed_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_DATA_LEN];
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, 0 };
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, &config);
+        (void)crypto_keystream_refill(handle);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_keystream_xor(handle, TEST_PLAIN_DATA, TEST_SPLIT_LEN, output);
+        result |= crypto_keystream_xor(handle, TEST_PLAIN_DATA + TEST_SPLIT_LEN, TEST_DATA_LEN - TEST_SPLIT_LEN, output + TEST_SPLIT_LEN);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CTR_CIPHER_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 32, crypto_keystream_get_available(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_keystream_xor_ctr_inline_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_DATA_LEN];
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, 0 };
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_COUNTER_DATA, &config);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_keystream_xor(handle, TEST_PLAIN_DATA, TEST_SPLIT_LEN, output);
+        result |= crypto_keystream_xor(handle, TEST_PLAIN_DATA + TEST_SPLIT_LEN, TEST_DATA_LEN - TEST_SPLIT_LEN, output + TEST_SPLIT_LEN);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CTR_CIPHER_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, crypto_keystream_get_available(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_keystream_xor_ofb_low_water_refill_succeed)
+    {
+        // arrange
+        unsigned char output[TEST_DATA_LEN];
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, TEST_DEPTH };
+        CRYPTO_KEYSTREAM_HANDLE handle = crypto_keystream_create(CRYPTO_KEYSTREAM_AES, CRYPTO_KEYSTREAM_OFB, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_OFB_IV_DATA, &config);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_keystream_xor(handle, TEST_PLAIN_DATA, TEST_DATA_LEN, output);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_OFB_CIPHER_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 48, crypto_keystream_get_available(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_keystream_xor_des_round_trip_succeed)
+    {
+        // arrange
+        unsigned char data[TEST_DATA_LEN];
+        unsigned char iv[8] = { 0 };
+        CRYPTO_KEYSTREAM_CONFIG config = { TEST_DEPTH, 0 };
+        CRYPTO_KEYSTREAM_HANDLE writer = crypto_keystream_create(CRYPTO_KEYSTREAM_DES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, 8, iv, &config);
+        CRYPTO_KEYSTREAM_HANDLE reader = crypto_keystream_create(CRYPTO_KEYSTREAM_DES, CRYPTO_KEYSTREAM_CTR, TEST_KEY_DATA, 8, iv, &config);
+        (void)crypto_keystream_refill(writer);
+        (void)crypto_keystream_xor(writer, TEST_PLAIN_DATA, TEST_DATA_LEN, data);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_keystream_xor(reader, data, TEST_DATA_LEN, data);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(data, TEST_PLAIN_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_keystream_destroy(writer);
+        crypto_keystream_destroy(reader);
+    }
+
+CTEST_END_TEST_SUITE(crypto_keystream_ut)
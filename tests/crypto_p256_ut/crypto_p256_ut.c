@@ -0,0 +1,283 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_p256.h"
+
+// Generated with openssl ecparam -name prime256v1, the signature with
+// openssl pkeyutl -sign over the digest
+static const unsigned char TEST_ALICE_PRIVATE[] = {
+    0xa9, 0x6d, 0xf2, 0xc7, 0xa1, 0x31, 0x80, 0x55, 0x55, 0xc2, 0xfd, 0xb3, 0x45, 0xa0, 0x4b, 0x23,
+    0xfd, 0x55, 0x87, 0x80, 0xfb, 0x49, 0xcb, 0x24, 0xc4, 0x56, 0x65, 0x7e, 0x4f, 0x51, 0x5c, 0x09
+};
+static const unsigned char TEST_ALICE_PUBLIC[] = {
+    0x04, 0xfa, 0x18, 0x93, 0x82, 0xa1, 0x5a, 0x22, 0x07, 0x10, 0xc2, 0x55, 0x73, 0xa7, 0x18, 0x02,
+    0xc7, 0x64, 0xbb, 0x98, 0xc4, 0xb3, 0x6b, 0xf7, 0x23, 0xd4, 0xad, 0xc4, 0x94, 0xb8, 0x1a, 0xbd,
+    0xd8, 0x39, 0xd7, 0xad, 0xda, 0xe1, 0x14, 0x9c, 0xf3, 0xbe, 0x53, 0xdc, 0x20, 0x9b, 0x41, 0x81,
+    0xe6, 0xf8, 0x98, 0x6e, 0x39, 0xf3, 0xdc, 0x8b, 0xb7, 0xb9, 0xdb, 0xbc, 0x0a, 0x4a, 0xb8, 0xf5,
+    0xbc
+};
+static const unsigned char TEST_BOB_PRIVATE[] = {
+    0xfc, 0x61, 0x3b, 0x24, 0xba, 0x5e, 0xdd, 0xe5, 0x2e, 0x9e, 0xcc, 0x61, 0xee, 0x45, 0x89, 0x10,
+    0x00, 0x18, 0xb6, 0xbd, 0x1b, 0x3d, 0x8a, 0xa8, 0x5c, 0x21, 0xa6, 0x16, 0xb2, 0x09, 0x92, 0xc8
+};
+static const unsigned char TEST_BOB_PUBLIC[] = {
+    0x04, 0xa7, 0xec, 0x92, 0xb5, 0x07, 0x7b, 0xf8, 0x77, 0x7e, 0x08, 0xe4, 0x82, 0xe3, 0xcf, 0x42,
+    0x1a, 0xd9, 0x47, 0x41, 0xf3, 0xf4, 0xae, 0x67, 0x64, 0xe0, 0xd9, 0xf0, 0x5b, 0x21, 0x6f, 0x20,
+    0x01, 0xde, 0x31, 0x5d, 0x00, 0x9a, 0xc6, 0xf8, 0x7b, 0xf3, 0x03, 0xc1, 0x13, 0x30, 0xb4, 0x7a,
+    0xdf, 0x2d, 0x21, 0xa0, 0x26, 0x7e, 0x57, 0x6e, 0x39, 0xbb, 0x26, 0xa8, 0x99, 0x14, 0xcf, 0x07,
+    0xcb
+};
+static const unsigned char TEST_SHARED_SECRET[] = {
+    0x9f, 0x84, 0xb4, 0x3a, 0xc3, 0xd8, 0x96, 0x29, 0xc9, 0x86, 0x42, 0x61, 0x70, 0x1a, 0x0a, 0x16,
+    0xe5, 0xc5, 0x36, 0x69, 0x34, 0x7c, 0xde, 0xab, 0x76, 0x67, 0x23, 0xeb, 0x8f, 0xbe, 0x5a, 0x97
+};
+// SHA-256("abc")
+static const unsigned char TEST_DIGEST[] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+static const unsigned char TEST_SIGNATURE[] = {
+    0xda, 0xef, 0xa3, 0x2f, 0x38, 0x51, 0xc4, 0x5b, 0x3f, 0x28, 0x3b, 0x6e, 0xc3, 0x9d, 0x53, 0xfe,
+    0x0a, 0x8e, 0x34, 0xa2, 0xf1, 0x87, 0x86, 0xcd, 0x95, 0x1f, 0xe8, 0xef, 0xe4, 0xa3, 0x32, 0x0a,
+    0xcb, 0x88, 0xf2, 0x6b, 0x64, 0xbf, 0xa0, 0xe2, 0x08, 0x74, 0x92, 0x5b, 0x06, 0x24, 0x40, 0xcb,
+    0x46, 0x30, 0xb5, 0xc1, 0x3d, 0x57, 0x7f, 0xf1, 0xd1, 0xf0, 0x29, 0x04, 0xee, 0xab, 0xad, 0x95
+};
+// The group order n, one past the largest valid private key
+static const unsigned char TEST_GROUP_ORDER[] = {
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84, 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51
+};
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_p256_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_p256_public_key_NULL_fail)
+    {
+        // arrange
+        unsigned char public_key[P256_PUBLIC_KEY_SIZE];
+
+        // act
+        int result = crypto_p256_public_key(public_key, NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_public_key_out_of_range_fail)
+    {
+        // arrange
+        unsigned char public_key[P256_PUBLIC_KEY_SIZE];
+        unsigned char zero_key[P256_PRIVATE_KEY_SIZE] = { 0 };
+
+        // act
+        int zero_result = crypto_p256_public_key(public_key, zero_key);
+        int order_result = crypto_p256_public_key(public_key, TEST_GROUP_ORDER);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, zero_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, order_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_public_key_succeed)
+    {
+        // arrange
+        unsigned char alice_public[P256_PUBLIC_KEY_SIZE];
+        unsigned char bob_public[P256_PUBLIC_KEY_SIZE];
+
+        // act
+        int result = crypto_p256_public_key(alice_public, TEST_ALICE_PRIVATE);
+        result |= crypto_p256_public_key(bob_public, TEST_BOB_PRIVATE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(alice_public, TEST_ALICE_PUBLIC, P256_PUBLIC_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(bob_public, TEST_BOB_PUBLIC, P256_PUBLIC_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_ecdh_succeed)
+    {
+        // arrange
+        unsigned char alice_shared[P256_SHARED_SECRET_SIZE];
+        unsigned char bob_shared[P256_SHARED_SECRET_SIZE];
+
+        // act
+        int result = crypto_p256_ecdh(alice_shared, TEST_ALICE_PRIVATE, TEST_BOB_PUBLIC);
+        result |= crypto_p256_ecdh(bob_shared, TEST_BOB_PRIVATE, TEST_ALICE_PUBLIC);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(alice_shared, TEST_SHARED_SECRET, P256_SHARED_SECRET_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(bob_shared, TEST_SHARED_SECRET, P256_SHARED_SECRET_SIZE));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_ecdh_off_curve_fail)
+    {
+        // arrange
+        unsigned char shared[P256_SHARED_SECRET_SIZE];
+        unsigned char bad_point[P256_PUBLIC_KEY_SIZE];
+        unsigned char compressed_point[P256_PUBLIC_KEY_SIZE];
+        memcpy(bad_point, TEST_BOB_PUBLIC, P256_PUBLIC_KEY_SIZE);
+        bad_point[P256_PUBLIC_KEY_SIZE - 1] ^= 1;
+        memcpy(compressed_point, TEST_BOB_PUBLIC, P256_PUBLIC_KEY_SIZE);
+        compressed_point[0] = 0x02;
+
+        // act
+        int bad_result = crypto_p256_ecdh(shared, TEST_ALICE_PRIVATE, bad_point);
+        int compressed_result = crypto_p256_ecdh(shared, TEST_ALICE_PRIVATE, compressed_point);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, bad_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, compressed_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_verify_known_signature_succeed)
+    {
+        // arrange
+
+        // act
+        int result = crypto_p256_verify(TEST_ALICE_PUBLIC, TEST_DIGEST, sizeof(TEST_DIGEST), TEST_SIGNATURE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_verify_tampered_fail)
+    {
+        // arrange
+        unsigned char signature[P256_SIGNATURE_SIZE];
+        unsigned char digest[sizeof(TEST_DIGEST)];
+        memcpy(signature, TEST_SIGNATURE, P256_SIGNATURE_SIZE);
+        signature[P256_SIGNATURE_SIZE - 1] ^= 0x80;
+        memcpy(digest, TEST_DIGEST, sizeof(digest));
+        digest[0] ^= 1;
+
+        // act
+        int signature_result = crypto_p256_verify(TEST_ALICE_PUBLIC, TEST_DIGEST, sizeof(TEST_DIGEST), signature);
+        int digest_result = crypto_p256_verify(TEST_ALICE_PUBLIC, digest, sizeof(digest), TEST_SIGNATURE);
+        int key_result = crypto_p256_verify(TEST_BOB_PUBLIC, TEST_DIGEST, sizeof(TEST_DIGEST), TEST_SIGNATURE);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, signature_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, digest_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, key_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_sign_verify_succeed)
+    {
+        // arrange
+        unsigned char private_key[P256_PRIVATE_KEY_SIZE];
+        unsigned char public_key[P256_PUBLIC_KEY_SIZE];
+        unsigned char first[P256_SIGNATURE_SIZE];
+        unsigned char second[P256_SIGNATURE_SIZE];
+
+        // act
+        int result = crypto_p256_keypair(private_key, public_key);
+        result |= crypto_p256_sign(first, private_key, TEST_DIGEST, sizeof(TEST_DIGEST));
+        result |= crypto_p256_sign(second, private_key, TEST_DIGEST, sizeof(TEST_DIGEST));
+        result |= crypto_p256_verify(public_key, TEST_DIGEST, sizeof(TEST_DIGEST), first);
+        result |= crypto_p256_verify(public_key, TEST_DIGEST, sizeof(TEST_DIGEST), second);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        // Fresh nonces each time
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(first, second, P256_SIGNATURE_SIZE));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_p256_keypair_agrees_succeed)
+    {
+        // arrange
+        unsigned char private_a[P256_PRIVATE_KEY_SIZE], public_a[P256_PUBLIC_KEY_SIZE], shared_a[P256_SHARED_SECRET_SIZE];
+        unsigned char private_b[P256_PRIVATE_KEY_SIZE], public_b[P256_PUBLIC_KEY_SIZE], shared_b[P256_SHARED_SECRET_SIZE];
+
+        // act
+        int result = crypto_p256_keypair(private_a, public_a);
+        result |= crypto_p256_keypair(private_b, public_b);
+        result |= crypto_p256_ecdh(shared_a, private_a, public_b);
+        result |= crypto_p256_ecdh(shared_b, private_b, public_a);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(private_a, private_b, P256_PRIVATE_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(shared_a, shared_b, P256_SHARED_SECRET_SIZE));
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_p256_ut)
@@ -0,0 +1,334 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+
+#include "cablelock/crypto_pbkdf2.h"
+
+// RFC 7914 section 11
+static const unsigned char TEST_PASSWD[] = "passwd";
+static const unsigned char TEST_SALT[] = "salt";
+static const unsigned char TEST_PASSWD_KEY[] = {
+    0x55, 0xac, 0x04, 0x6e, 0x56, 0xe3, 0x08, 0x9f, 0xec, 0x16, 0x91, 0xc2, 0x25, 0x44, 0xb6, 0x05,
+    0xf9, 0x41, 0x85, 0x21, 0x6d, 0xde, 0x04, 0x65, 0xe6, 0x8b, 0x9d, 0x57, 0xc2, 0x0d, 0xac, 0xbc,
+    0x49, 0xca, 0x9c, 0xcc, 0xf1, 0x79, 0xb6, 0x45, 0x99, 0x16, 0x64, 0xb3, 0x9d, 0x77, 0xef, 0x31,
+    0x7c, 0x71, 0xb8, 0x45, 0xb1, 0xe3, 0x0b, 0xd5, 0x09, 0x11, 0x20, 0x41, 0xd3, 0xa1, 0x97, 0x83
+};
+static const unsigned char TEST_PASSWORD[] = "Password";
+static const unsigned char TEST_NACL[] = "NaCl";
+static const uint32_t TEST_PASSWORD_ITERATIONS = 80000;
+static const unsigned char TEST_PASSWORD_KEY[] = {
+    0x4d, 0xdc, 0xd8, 0xf6, 0x0b, 0x98, 0xbe, 0x21, 0x83, 0x0c, 0xee, 0x5e, 0xf2, 0x27, 0x01, 0xf9,
+    0x64, 0x1a, 0x44, 0x18, 0xd0, 0x4c, 0x04, 0x14, 0xae, 0xff, 0x08, 0x87, 0x6b, 0x34, 0xab, 0x56,
+    0xa1, 0xd4, 0x25, 0xa1, 0x22, 0x58, 0x33, 0x54, 0x9a, 0xdb, 0x84, 0x1b, 0x51, 0xc9, 0xb3, 0x17,
+    0x6a, 0x27, 0x2b, 0xde, 0xbb, 0xa1, 0xd0, 0x78, 0x47, 0x8f, 0x62, 0xb3, 0x97, 0xf3, 0x3c, 0x8d
+};
+// The 40 byte case from the PBKDF2-HMAC-SHA256 test vectors, ending mid block
+static const unsigned char TEST_LONG_PASSWORD[] = "passwordPASSWORDpassword";
+static const unsigned char TEST_LONG_SALT[] = "saltSALTsaltSALTsaltSALTsaltSALTsalt";
+static const uint32_t TEST_LONG_ITERATIONS = 4096;
+static const unsigned char TEST_LONG_KEY[] = {
+    0x34, 0x8c, 0x89, 0xdb, 0xcb, 0xd3, 0x2b, 0x2f, 0x32, 0xd8, 0x14, 0xb8, 0x11, 0x6e, 0x84, 0xcf,
+    0x2b, 0x17, 0x34, 0x7e, 0xbc, 0x18, 0x00, 0x18, 0x1c, 0x4e, 0x2a, 0x1f, 0xb8, 0xdd, 0x53, 0xe1,
+    0xc6, 0x35, 0x51, 0x8c, 0x7d, 0xac, 0x47, 0xe9
+};
+
+#define TEST_STRING_LEN(value)      (sizeof(value) - 1)
+#define TEST_KEY_SIZE               32
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_pbkdf2_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+        (void)crypto_pbkdf2_set_kernel(CRYPTO_PBKDF2_KERNEL_AUTO);
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_output_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 1, NULL, sizeof(TEST_PASSWD_KEY));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_invalid_length_fail)
+    {
+        // arrange
+        unsigned char output[TEST_KEY_SIZE];
+
+        // act
+        int empty_result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 1, output, 0);
+        int password_result = crypto_pbkdf2_sha256(NULL, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 1, output, sizeof(output));
+        int salt_result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), NULL, TEST_STRING_LEN(TEST_SALT), 1, output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, empty_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, password_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, salt_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_zero_iterations_fail)
+    {
+        // arrange
+        unsigned char output[TEST_KEY_SIZE];
+
+        // act
+        int result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 0, output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_batch_invalid_job_fail)
+    {
+        // arrange
+        unsigned char output[TEST_KEY_SIZE];
+        CRYPTO_PBKDF2_JOB jobs[2] = {
+            { TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), output, sizeof(output) },
+            { TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), NULL, sizeof(output) }
+        };
+
+        // act
+        int null_result = crypto_pbkdf2_sha256_batch(NULL, 1, 1);
+        int empty_result = crypto_pbkdf2_sha256_batch(jobs, 0, 1);
+        int job_result = crypto_pbkdf2_sha256_batch(jobs, 2, 1);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, null_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, empty_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, job_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_one_iteration_succeed)
+    {
+        // arrange
+        unsigned char output[sizeof(TEST_PASSWD_KEY)];
+
+        // act
+        int result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 1, output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_PASSWD_KEY, sizeof(output)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_many_iterations_succeed)
+    {
+        // arrange
+        unsigned char output[sizeof(TEST_PASSWORD_KEY)];
+
+        // act
+        int result = crypto_pbkdf2_sha256(TEST_PASSWORD, TEST_STRING_LEN(TEST_PASSWORD), TEST_NACL, TEST_STRING_LEN(TEST_NACL), TEST_PASSWORD_ITERATIONS,
+            output, sizeof(output));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_PASSWORD_KEY, sizeof(output)));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_partial_block_succeed)
+    {
+        // arrange
+        unsigned char output[sizeof(TEST_LONG_KEY) + 1];
+        output[sizeof(TEST_LONG_KEY)] = 0xA5;
+
+        // act
+        int result = crypto_pbkdf2_sha256(TEST_LONG_PASSWORD, TEST_STRING_LEN(TEST_LONG_PASSWORD), TEST_LONG_SALT, TEST_STRING_LEN(TEST_LONG_SALT),
+            TEST_LONG_ITERATIONS, output, sizeof(TEST_LONG_KEY));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_LONG_KEY, sizeof(TEST_LONG_KEY)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0xA5, output[sizeof(TEST_LONG_KEY)]);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_batch_matches_single_succeed)
+    {
+        // arrange
+        unsigned char passwd_output[sizeof(TEST_PASSWD_KEY)];
+        unsigned char passwd_expected[sizeof(passwd_output)];
+        unsigned char long_output[sizeof(TEST_LONG_KEY)];
+        // Thirteen blocks in all, so one group is full and the next is not
+        unsigned char wide_output[(9 * TEST_KEY_SIZE) - 7];
+        unsigned char wide_expected[sizeof(wide_output)];
+        CRYPTO_PBKDF2_JOB jobs[3] = {
+            { TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), passwd_output, sizeof(passwd_output) },
+            { TEST_LONG_PASSWORD, TEST_STRING_LEN(TEST_LONG_PASSWORD), TEST_LONG_SALT, TEST_STRING_LEN(TEST_LONG_SALT), long_output, sizeof(long_output) },
+            { TEST_PASSWORD, TEST_STRING_LEN(TEST_PASSWORD), TEST_NACL, TEST_STRING_LEN(TEST_NACL), wide_output, sizeof(wide_output) }
+        };
+        int result = crypto_pbkdf2_sha256(TEST_PASSWORD, TEST_STRING_LEN(TEST_PASSWORD), TEST_NACL, TEST_STRING_LEN(TEST_NACL), TEST_LONG_ITERATIONS,
+            wide_expected, sizeof(wide_expected));
+        result |= crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), TEST_LONG_ITERATIONS,
+            passwd_expected, sizeof(passwd_expected));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        umock_c_reset_all_calls();
+
+        // act
+        result = crypto_pbkdf2_sha256_batch(jobs, 3, TEST_LONG_ITERATIONS);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(passwd_output, passwd_expected, sizeof(passwd_output)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(long_output, TEST_LONG_KEY, sizeof(long_output)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(wide_output, wide_expected, sizeof(wide_output)));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_set_kernel_invalid_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_pbkdf2_set_kernel((CRYPTO_PBKDF2_KERNEL)(CRYPTO_PBKDF2_KERNEL_LANES + 1));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, CRYPTO_PBKDF2_KERNEL_AUTO, crypto_pbkdf2_get_kernel());
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_each_kernel_vectors_succeed)
+    {
+        for (int kernel = CRYPTO_PBKDF2_KERNEL_SINGLE; kernel <= CRYPTO_PBKDF2_KERNEL_LANES; kernel++)
+        {
+            // arrange
+            unsigned char passwd_output[sizeof(TEST_PASSWD_KEY)];
+            unsigned char password_output[sizeof(TEST_PASSWORD_KEY)];
+            unsigned char long_output[sizeof(TEST_LONG_KEY)];
+            int result = crypto_pbkdf2_set_kernel((CRYPTO_PBKDF2_KERNEL)kernel);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, kernel, crypto_pbkdf2_get_kernel());
+
+            // act
+            result = crypto_pbkdf2_sha256(TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), 1,
+                passwd_output, sizeof(passwd_output));
+            result |= crypto_pbkdf2_sha256(TEST_PASSWORD, TEST_STRING_LEN(TEST_PASSWORD), TEST_NACL, TEST_STRING_LEN(TEST_NACL), TEST_PASSWORD_ITERATIONS,
+                password_output, sizeof(password_output));
+            // A single 32 byte block, which only reaches the lanes when forced
+            result |= crypto_pbkdf2_sha256(TEST_LONG_PASSWORD, TEST_STRING_LEN(TEST_LONG_PASSWORD), TEST_LONG_SALT, TEST_STRING_LEN(TEST_LONG_SALT),
+                TEST_LONG_ITERATIONS, long_output, TEST_KEY_SIZE);
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(passwd_output, TEST_PASSWD_KEY, sizeof(passwd_output)));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(password_output, TEST_PASSWORD_KEY, sizeof(password_output)));
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(long_output, TEST_LONG_KEY, TEST_KEY_SIZE));
+        }
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_pbkdf2_sha256_batch_lanes_match_single_succeed)
+    {
+        // arrange
+        unsigned char single_output[3][(9 * TEST_KEY_SIZE) - 7];
+        unsigned char lanes_output[3][sizeof(single_output[0])];
+        CRYPTO_PBKDF2_JOB single_jobs[3] = {
+            { TEST_PASSWD, TEST_STRING_LEN(TEST_PASSWD), TEST_SALT, TEST_STRING_LEN(TEST_SALT), single_output[0], sizeof(single_output[0]) },
+            { TEST_LONG_PASSWORD, TEST_STRING_LEN(TEST_LONG_PASSWORD), TEST_LONG_SALT, TEST_STRING_LEN(TEST_LONG_SALT), single_output[1], sizeof(TEST_LONG_KEY) },
+            { TEST_PASSWORD, TEST_STRING_LEN(TEST_PASSWORD), TEST_NACL, TEST_STRING_LEN(TEST_NACL), single_output[2], sizeof(single_output[2]) }
+        };
+        CRYPTO_PBKDF2_JOB lanes_jobs[3];
+        int result;
+        memcpy(lanes_jobs, single_jobs, sizeof(lanes_jobs));
+        for (size_t index = 0; index < 3; index++)
+        {
+            lanes_jobs[index].output = lanes_output[index];
+        }
+
+        // act
+        result = crypto_pbkdf2_set_kernel(CRYPTO_PBKDF2_KERNEL_SINGLE);
+        result |= crypto_pbkdf2_sha256_batch(single_jobs, 3, TEST_LONG_ITERATIONS);
+        result |= crypto_pbkdf2_set_kernel(CRYPTO_PBKDF2_KERNEL_LANES);
+        result |= crypto_pbkdf2_sha256_batch(lanes_jobs, 3, TEST_LONG_ITERATIONS);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(single_output[1], TEST_LONG_KEY, sizeof(TEST_LONG_KEY)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(lanes_output[1], TEST_LONG_KEY, sizeof(TEST_LONG_KEY)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(lanes_output[0], single_output[0], sizeof(single_output[0])));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(lanes_output[2], single_output[2], sizeof(single_output[2])));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_pbkdf2_ut)
@@ -0,0 +1,543 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_record.h"
+
+static const unsigned char TEST_KEY_DATA[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+static const unsigned char TEST_MAC_KEY_DATA[] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f
+};
+static const unsigned char TEST_IV_DATA[] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab };
+static const char* TEST_PAYLOAD_DATA = "abcdefghijklmnop";
+static const size_t TEST_PAYLOAD_DATA_LEN = 16;
+#define TEST_TLS12_SALT_LEN     4
+#define TEST_TLS13_IV_LEN       12
+#define TEST_RECORD_BUFFER_LEN  128
+
+static const unsigned char TEST_TLS12_RECORD[] = {
+    0x17, 0x03, 0x03, 0x00, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xeb, 0x3f, 0xad,
+    0xf9, 0x22, 0xe9, 0x53, 0x07, 0x3a, 0xac, 0x41, 0x4f, 0x1c, 0xa4, 0x14, 0xd0, 0xb3, 0x0e, 0x68,
+    0x35, 0xfd, 0xf2, 0x6a, 0xd0, 0x60, 0x7d, 0x0e, 0xcf, 0x55, 0x8d, 0xb0, 0xf9
+};
+static const unsigned char TEST_TLS13_RECORD[] = {
+    0x17, 0x03, 0x03, 0x00, 0x21, 0xcb, 0xe4, 0x5b, 0xdf, 0x1b, 0xef, 0x54, 0x62, 0xe3, 0x12, 0xde,
+    0x6c, 0x2b, 0x7c, 0xdf, 0x10, 0x44, 0x62, 0x35, 0x28, 0x1d, 0x9f, 0x79, 0xcf, 0xfb, 0x32, 0x30,
+    0x36, 0xa4, 0x74, 0x48, 0xd6, 0x1b
+};
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+static size_t seal_test_payload(CRYPTO_RECORD_HANDLE handle, unsigned char* record)
+{
+    size_t record_len = 0;
+    memcpy(record + crypto_record_get_headroom(handle), TEST_PAYLOAD_DATA, TEST_PAYLOAD_DATA_LEN);
+    (void)crypto_record_seal(handle, TLS_CONTENT_APPLICATION, record, TEST_RECORD_BUFFER_LEN, TEST_PAYLOAD_DATA_LEN, &record_len);
+    return record_len;
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_record_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_record_create_key_NULL_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, NULL, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_create_invalid_iv_len_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_2, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_create_invalid_key_len_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_256_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_create_succeed)
+    {
+        // arrange
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 5, crypto_record_get_headroom(handle));
+        CTEST_ASSERT_ARE_EQUAL(size_t, 17, crypto_record_get_tailroom(handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_destroy_handle_NULL_succeed)
+    {
+        // arrange
+
+        // act
+        crypto_record_destroy(NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_get_length_partial_header_succeed)
+    {
+        // arrange
+
+        // act
+        size_t result = crypto_record_get_length(TEST_TLS13_RECORD, 4);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(TEST_TLS13_RECORD), crypto_record_get_length(TEST_TLS13_RECORD, sizeof(TEST_TLS13_RECORD)));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_handle_NULL_fail)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        size_t record_len;
+
+        // act
+        int result = crypto_record_seal(NULL, TLS_CONTENT_APPLICATION, record, sizeof(record), TEST_PAYLOAD_DATA_LEN, &record_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_no_tailroom_fail)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        size_t record_len;
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_seal(handle, TLS_CONTENT_APPLICATION, record, crypto_record_get_headroom(handle) + TEST_PAYLOAD_DATA_LEN, TEST_PAYLOAD_DATA_LEN, &record_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_tls12_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_2, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS12_SALT_LEN, NULL);
+        umock_c_reset_all_calls();
+
+        // act
+        size_t record_len = seal_test_payload(handle, record);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(TEST_TLS12_RECORD), record_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(record, TEST_TLS12_RECORD, record_len));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_tls13_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        umock_c_reset_all_calls();
+
+        // act
+        size_t record_len = seal_test_payload(handle, record);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(TEST_TLS13_RECORD), record_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(record, TEST_TLS13_RECORD, record_len));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_open_tls12_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_2, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS12_SALT_LEN, NULL);
+        memcpy(record, TEST_TLS12_RECORD, sizeof(TEST_TLS12_RECORD));
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(handle, record, sizeof(TEST_TLS12_RECORD), &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, TLS_CONTENT_APPLICATION, content_type);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_PAYLOAD_DATA_LEN, payload_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(payload, TEST_PAYLOAD_DATA, payload_len));
+        CTEST_ASSERT_IS_TRUE(payload > record && payload < record + sizeof(TEST_TLS12_RECORD));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_open_tls13_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        memcpy(record, TEST_TLS13_RECORD, sizeof(TEST_TLS13_RECORD));
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(handle, record, sizeof(TEST_TLS13_RECORD), &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, TLS_CONTENT_APPLICATION, content_type);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_PAYLOAD_DATA_LEN, payload_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(payload, TEST_PAYLOAD_DATA, payload_len));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_open_tampered_record_fail)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        memcpy(record, TEST_TLS13_RECORD, sizeof(TEST_TLS13_RECORD));
+        record[TLS_RECORD_HEADER_SIZE] ^= 0x01;
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(handle, record, sizeof(TEST_TLS13_RECORD), &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_open_length_mismatch_fail)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        memcpy(record, TEST_TLS13_RECORD, sizeof(TEST_TLS13_RECORD));
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(handle, record, sizeof(TEST_TLS13_RECORD) - 1, &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_open_sequence_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE writer = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        CRYPTO_RECORD_HANDLE reader = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, NULL);
+        size_t record_len = seal_test_payload(writer, record);
+        (void)crypto_record_open(reader, record, record_len, &content_type, &payload, &payload_len);
+        record_len = seal_test_payload(writer, record);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(reader, record, record_len, &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(payload, TEST_PAYLOAD_DATA, payload_len));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(writer);
+        crypto_record_destroy(reader);
+    }
+
+    CTEST_FUNCTION(crypto_record_create_cbc_invalid_mac_key_len_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, 20, false, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_create_cbc_gcm_cipher_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), false, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_record_seal_open_cbc_mac_then_encrypt_succeed)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE writer = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), false, NULL);
+        CRYPTO_RECORD_HANDLE reader = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), false, NULL);
+        size_t record_len = seal_test_payload(writer, record);
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(reader, record, record_len, &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, TLS_CONTENT_APPLICATION, content_type);
+        CTEST_ASSERT_ARE_EQUAL(size_t, TEST_PAYLOAD_DATA_LEN, payload_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(payload, TEST_PAYLOAD_DATA, payload_len));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(writer);
+        crypto_record_destroy(reader);
+    }
+
+    CTEST_FUNCTION(crypto_record_open_cbc_encrypt_then_mac_tampered_fail)
+    {
+        // arrange
+        unsigned char record[TEST_RECORD_BUFFER_LEN];
+        unsigned char content_type;
+        unsigned char* payload;
+        size_t payload_len;
+        CRYPTO_RECORD_HANDLE writer = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), true, NULL);
+        CRYPTO_RECORD_HANDLE reader = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), true, NULL);
+        size_t record_len = seal_test_payload(writer, record);
+        record[TLS_RECORD_HEADER_SIZE + 20] ^= 0x01;
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_record_open(reader, record, record_len, &content_type, &payload, &payload_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(writer);
+        crypto_record_destroy(reader);
+    }
+
+    CTEST_FUNCTION(crypto_record_create_from_pool_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE pool = crypto_pool_create(crypto_record_get_context_size(), 1);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, pool);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_IS_TRUE(crypto_pool_owns(pool, handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+        crypto_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_record_create_pool_exhausted_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE pool = crypto_pool_create(crypto_record_get_context_size(), 1);
+        CRYPTO_RECORD_HANDLE pooled = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, pool);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(mem_shim_malloc(IGNORED_NUM_ARG));
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, pool);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_IS_FALSE(crypto_pool_owns(pool, handle));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(handle);
+        crypto_record_destroy(pooled);
+        crypto_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_record_create_small_pool_fail)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE pool = crypto_pool_create(CRYPTO_CACHE_LINE_SIZE, 1);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_RECORD_HANDLE handle = crypto_record_create(CRYPTO_RECORD_TLS_1_3, CRYPTO_RECORD_AES_128_GCM, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_IV_DATA, TEST_TLS13_IV_LEN, pool);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_pool_destroy(pool);
+    }
+
+    CTEST_FUNCTION(crypto_record_create_cbc_separate_pools_succeed)
+    {
+        // arrange
+        CRYPTO_POOL_HANDLE first_pool = crypto_pool_create(crypto_record_get_context_size(), 1);
+        CRYPTO_POOL_HANDLE second_pool = crypto_pool_create(crypto_record_get_context_size(), 1);
+        umock_c_reset_all_calls();
+
+        // act
+        CRYPTO_RECORD_HANDLE first = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), false, first_pool);
+        CRYPTO_RECORD_HANDLE second = crypto_record_create_cbc(CRYPTO_RECORD_AES_128_CBC_SHA256, TEST_KEY_DATA, sizeof(TEST_KEY_DATA), TEST_MAC_KEY_DATA, sizeof(TEST_MAC_KEY_DATA), false, second_pool);
+
+        // assert
+        CTEST_ASSERT_IS_TRUE(crypto_pool_owns(first_pool, first));
+        CTEST_ASSERT_IS_TRUE(crypto_pool_owns(second_pool, second));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        crypto_record_destroy(first);
+        crypto_record_destroy(second);
+        crypto_pool_destroy(first_pool);
+        crypto_pool_destroy(second_pool);
+    }
+
+CTEST_END_TEST_SUITE(crypto_record_ut)
@@ -0,0 +1,308 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include <unistd.h>
+#include <sys/types.h>
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "cablelock/crypto_rotating_key.h"
+
+#define TEST_THREAD_COUNT   4
+#define TEST_ROTATIONS      200
+
+// FIPS-197 appendix C.1 and the same block under a second key
+static const unsigned char TEST_KEY_A[AES_128_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const unsigned char TEST_KEY_B[AES_128_KEY_SIZE] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char TEST_PLAIN[AES_BLOCK_SIZE] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const unsigned char TEST_CIPHER_A[AES_BLOCK_SIZE] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+static unsigned char g_cipher_b[AES_BLOCK_SIZE];
+
+typedef struct TEST_READER_TAG
+{
+    CRYPTO_ROTATING_KEY_HANDLE key;
+    bool stop;
+    bool rotated;
+    size_t bad_blocks;
+} TEST_READER;
+
+static void encrypt_with(const CRYPTO_CIPHER_CONTEXT* context, unsigned char* output)
+{
+    crypto_aes_block_encrypt(&context->schedule.aes, TEST_PLAIN, output);
+}
+
+static void* rotate_worker(void* context)
+{
+    TEST_READER* test = (TEST_READER*)context;
+    (void)crypto_rotating_key_rotate(test->key, TEST_KEY_B, sizeof(TEST_KEY_B));
+    __atomic_store_n(&test->rotated, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void* reader_worker(void* context)
+{
+    TEST_READER* test = (TEST_READER*)context;
+    CRYPTO_KEY_READER_HANDLE reader = crypto_key_reader_create(test->key);
+    size_t bad_blocks = 0;
+    while (!__atomic_load_n(&test->stop, __ATOMIC_ACQUIRE))
+    {
+        unsigned char output[AES_BLOCK_SIZE];
+        const CRYPTO_CIPHER_CONTEXT* cipher_context = crypto_key_reader_enter(reader);
+        encrypt_with(cipher_context, output);
+        // A wiped or half written schedule matches neither key
+        if (memcmp(output, TEST_CIPHER_A, AES_BLOCK_SIZE) != 0 && memcmp(output, g_cipher_b, AES_BLOCK_SIZE) != 0)
+        {
+            bad_blocks++;
+        }
+        crypto_key_reader_leave(reader);
+    }
+    crypto_key_reader_destroy(reader);
+    __atomic_fetch_add(&test->bad_blocks, bad_blocks, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_rotating_key_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        AES_KEY_SCHEDULE schedule;
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+
+        (void)crypto_aes_key_init(&schedule, TEST_KEY_B, sizeof(TEST_KEY_B));
+        crypto_aes_block_encrypt(&schedule, TEST_PLAIN, g_cipher_b);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_rotating_key_create_key_NULL_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_ROTATING_KEY_HANDLE handle = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, NULL, AES_128_KEY_SIZE);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_reader_enter_NULL_fail)
+    {
+        // arrange
+
+        // act
+        const CRYPTO_CIPHER_CONTEXT* context = crypto_key_reader_enter(NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(context);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_key_reader_enter_succeed)
+    {
+        // arrange
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_ROTATING_KEY_HANDLE handle = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, TEST_KEY_A, sizeof(TEST_KEY_A));
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CRYPTO_KEY_READER_HANDLE reader = crypto_key_reader_create(handle);
+        CTEST_ASSERT_IS_NOT_NULL(reader);
+
+        // act
+        const CRYPTO_CIPHER_CONTEXT* context = crypto_key_reader_enter(reader);
+        encrypt_with(context, output);
+        crypto_key_reader_leave(reader);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, CRYPTO_CONTEXT_AES, context->cipher);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_A, AES_BLOCK_SIZE));
+        CTEST_ASSERT_IS_TRUE(crypto_rotating_key_get_generation(handle) == 1);
+
+        // cleanup
+        crypto_key_reader_destroy(reader);
+        crypto_rotating_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rotating_key_rotate_succeed)
+    {
+        // arrange
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_ROTATING_KEY_HANDLE handle = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, TEST_KEY_A, sizeof(TEST_KEY_A));
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CRYPTO_KEY_READER_HANDLE reader = crypto_key_reader_create(handle);
+        CTEST_ASSERT_IS_NOT_NULL(reader);
+
+        // act
+        int result = crypto_rotating_key_rotate(handle, TEST_KEY_B, sizeof(TEST_KEY_B));
+        encrypt_with(crypto_key_reader_enter(reader), output);
+        crypto_key_reader_leave(reader);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, g_cipher_b, AES_BLOCK_SIZE));
+        CTEST_ASSERT_IS_TRUE(crypto_rotating_key_get_generation(handle) == 2);
+
+        // cleanup
+        crypto_key_reader_destroy(reader);
+        crypto_rotating_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rotating_key_rotate_bad_key_fail)
+    {
+        // arrange
+        unsigned char output[AES_BLOCK_SIZE];
+        CRYPTO_ROTATING_KEY_HANDLE handle = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, TEST_KEY_A, sizeof(TEST_KEY_A));
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CRYPTO_KEY_READER_HANDLE reader = crypto_key_reader_create(handle);
+        CTEST_ASSERT_IS_NOT_NULL(reader);
+
+        // act
+        int result = crypto_rotating_key_rotate(handle, TEST_KEY_B, sizeof(TEST_KEY_B) - 1);
+        encrypt_with(crypto_key_reader_enter(reader), output);
+        crypto_key_reader_leave(reader);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_A, AES_BLOCK_SIZE));
+        CTEST_ASSERT_IS_TRUE(crypto_rotating_key_get_generation(handle) == 1);
+
+        // cleanup
+        crypto_key_reader_destroy(reader);
+        crypto_rotating_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rotating_key_rotate_waits_for_reader_succeed)
+    {
+        // arrange
+        pthread_t thread;
+        unsigned char output[AES_BLOCK_SIZE];
+        TEST_READER test = { 0 };
+        test.key = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, TEST_KEY_A, sizeof(TEST_KEY_A));
+        CTEST_ASSERT_IS_NOT_NULL(test.key);
+        CRYPTO_KEY_READER_HANDLE reader = crypto_key_reader_create(test.key);
+        CTEST_ASSERT_IS_NOT_NULL(reader);
+        const CRYPTO_CIPHER_CONTEXT* context = crypto_key_reader_enter(reader);
+
+        // act
+        CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_create(&thread, NULL, rotate_worker, &test));
+        while (crypto_rotating_key_get_generation(test.key) == 1)
+        {
+            (void)sched_yield();
+        }
+        usleep(20000);
+        // The new key is published but the old context is still intact
+        encrypt_with(context, output);
+        bool rotated_while_inside = __atomic_load_n(&test.rotated, __ATOMIC_ACQUIRE);
+        crypto_key_reader_leave(reader);
+        (void)pthread_join(thread, NULL);
+
+        // assert
+        CTEST_ASSERT_IS_FALSE(rotated_while_inside);
+        CTEST_ASSERT_IS_TRUE(__atomic_load_n(&test.rotated, __ATOMIC_ACQUIRE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_A, AES_BLOCK_SIZE));
+
+        // cleanup
+        crypto_key_reader_destroy(reader);
+        crypto_rotating_key_destroy(test.key);
+    }
+
+    CTEST_FUNCTION(crypto_rotating_key_rotate_under_load_succeed)
+    {
+        // arrange
+        pthread_t threads[TEST_THREAD_COUNT];
+        TEST_READER test = { 0 };
+        int result = 0;
+        test.key = crypto_rotating_key_create(CRYPTO_CONTEXT_AES, TEST_KEY_A, sizeof(TEST_KEY_A));
+        CTEST_ASSERT_IS_NOT_NULL(test.key);
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_create(&threads[index], NULL, reader_worker, &test));
+        }
+
+        // act
+        for (size_t rotation = 0; rotation < TEST_ROTATIONS; rotation++)
+        {
+            result |= crypto_rotating_key_rotate(test.key, (rotation % 2) == 0 ? TEST_KEY_B : TEST_KEY_A, AES_128_KEY_SIZE);
+        }
+        __atomic_store_n(&test.stop, true, __ATOMIC_RELEASE);
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            (void)pthread_join(threads[index], NULL);
+        }
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, test.bad_blocks);
+        CTEST_ASSERT_IS_TRUE(crypto_rotating_key_get_generation(test.key) == TEST_ROTATIONS + 1);
+
+        // cleanup
+        crypto_rotating_key_destroy(test.key);
+    }
+
+CTEST_END_TEST_SUITE(crypto_rotating_key_ut)
@@ -0,0 +1,358 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_rsa.h"
+#include "cablelock/crypto_bignum.h"
+
+// RSA-2048 key from openssl genpkey, the signature from openssl pkeyutl
+// -sign -pkeyopt digest:sha256.  The modulus keeps its DER sign byte.
+static const unsigned char TEST_MODULUS[] = {
+    0x00, 0x88, 0x54, 0x9f, 0xf0, 0x54, 0x20, 0x76, 0x09, 0x94, 0xef, 0x05, 0x01, 0x7b, 0x5c, 0xef,
+    0xb1, 0x7b, 0xae, 0xc3, 0x09, 0x3a, 0x6b, 0xdb, 0x81, 0x80, 0x34, 0x3d, 0xad, 0x77, 0xae, 0x15,
+    0x9b, 0x78, 0x2b, 0xf6, 0x2f, 0xd3, 0x6a, 0xae, 0xde, 0x80, 0x3c, 0xcb, 0x55, 0xc7, 0xee, 0x16,
+    0x33, 0xab, 0x29, 0x88, 0x09, 0xfe, 0x1d, 0xd0, 0xc7, 0xac, 0x24, 0x37, 0x88, 0xe2, 0x01, 0xc1,
+    0xcf, 0xbd, 0xd8, 0xdf, 0x2c, 0xce, 0xd1, 0xef, 0x2b, 0x71, 0x05, 0xaa, 0xc6, 0x1c, 0x2a, 0x29,
+    0x8b, 0xd0, 0x27, 0x27, 0xa5, 0x3f, 0x47, 0x94, 0xf0, 0x9d, 0xb9, 0xfc, 0x55, 0xa3, 0xa9, 0x29,
+    0x68, 0x04, 0x91, 0x88, 0xd7, 0x77, 0x9f, 0x0b, 0x5c, 0xb8, 0x10, 0x55, 0x34, 0x02, 0x9d, 0x97,
+    0x86, 0xd2, 0x7e, 0xea, 0xee, 0xba, 0x80, 0x2e, 0x55, 0x8c, 0x42, 0xe9, 0x43, 0x28, 0x4e, 0x79,
+    0x80, 0xf1, 0xf5, 0x14, 0xed, 0xce, 0xe6, 0x31, 0x17, 0x85, 0x69, 0x05, 0x82, 0xdc, 0x3a, 0xce,
+    0x62, 0xcd, 0x07, 0xb9, 0x73, 0x9d, 0xde, 0x4f, 0xd4, 0x27, 0xda, 0x7b, 0xd8, 0xf2, 0x22, 0xb4,
+    0xc4, 0x8f, 0x93, 0x80, 0x58, 0xb8, 0xd3, 0xcf, 0x28, 0x52, 0xd4, 0x85, 0x55, 0xd8, 0x0d, 0x7d,
+    0x7b, 0x1d, 0xd4, 0x39, 0x72, 0x0d, 0x47, 0x98, 0x4a, 0x80, 0x49, 0x3c, 0x2c, 0xa2, 0x15, 0xec,
+    0xc8, 0x7a, 0xf9, 0x74, 0x53, 0x40, 0x1f, 0xbc, 0xf1, 0xff, 0xc4, 0x9f, 0xd0, 0x2c, 0x27, 0x86,
+    0x3f, 0x7b, 0x92, 0x7b, 0x9c, 0xb7, 0x6c, 0x2f, 0x5c, 0xc1, 0x08, 0x40, 0x45, 0xf0, 0xeb, 0xe6,
+    0xcf, 0x02, 0x20, 0x70, 0xa1, 0x6c, 0x63, 0xc0, 0xc3, 0xf1, 0xf9, 0x0f, 0xc1, 0xac, 0x59, 0xe6,
+    0x30, 0x84, 0xb5, 0x8b, 0xb4, 0x2c, 0x6c, 0xaf, 0xb0, 0x32, 0xbb, 0xcc, 0x1b, 0xe1, 0x3f, 0x47,
+    0x87
+};
+static const unsigned char TEST_PUBLIC_EXPONENT[] = {
+    0x01, 0x00, 0x01
+};
+static const unsigned char TEST_PRIME1[] = {
+    0x00, 0xbd, 0xdb, 0x08, 0x8f, 0x7e, 0x37, 0x0e, 0xc2, 0xa0, 0xb8, 0x2c, 0x61, 0x75, 0xdc, 0x72,
+    0x4f, 0x4f, 0x62, 0xdf, 0x6e, 0x1e, 0x78, 0x3b, 0x65, 0xa0, 0x63, 0x29, 0xa6, 0x19, 0xed, 0x6a,
+    0x42, 0xce, 0x25, 0xdf, 0xff, 0xf4, 0x23, 0x71, 0x69, 0x08, 0x90, 0x1e, 0x2e, 0xb3, 0xa1, 0xf1,
+    0x9f, 0xa1, 0x10, 0x11, 0xd8, 0x61, 0xef, 0x95, 0xb6, 0xf8, 0x84, 0x5b, 0xd0, 0x4c, 0x9d, 0x16,
+    0x8d, 0x48, 0x71, 0x93, 0x78, 0x4e, 0xa5, 0xd4, 0x77, 0x05, 0xac, 0x11, 0x06, 0x2e, 0x79, 0xc6,
+    0xa2, 0x8c, 0x88, 0x25, 0x9e, 0x72, 0xf9, 0x59, 0x07, 0x85, 0xa2, 0xa7, 0x75, 0x33, 0x0f, 0xd4,
+    0xef, 0x0b, 0x92, 0x58, 0xa5, 0x01, 0xe8, 0xc2, 0x0d, 0x4e, 0xd8, 0x2f, 0xca, 0xa9, 0xee, 0xc1,
+    0x43, 0xc7, 0x2c, 0x4f, 0x35, 0x5d, 0x7c, 0xd2, 0x3d, 0xf2, 0xb4, 0xec, 0xee, 0x6b, 0x09, 0xc9,
+    0x73
+};
+static const unsigned char TEST_PRIME2[] = {
+    0x00, 0xb7, 0xd3, 0xc3, 0xe7, 0xba, 0xb5, 0xe8, 0x77, 0x89, 0x7f, 0xe4, 0x7f, 0x48, 0x08, 0xc6,
+    0x1a, 0x11, 0xf9, 0x42, 0x6f, 0x4a, 0x0a, 0x7b, 0xd4, 0x72, 0xcf, 0x6f, 0xb7, 0xaa, 0x1e, 0xd3,
+    0xa7, 0xbd, 0x3c, 0x4c, 0xbb, 0xf0, 0x3e, 0x88, 0xfe, 0xe7, 0x26, 0xfb, 0x47, 0x06, 0xef, 0xaa,
+    0x50, 0x7a, 0x87, 0x81, 0x4c, 0xcd, 0x06, 0xb9, 0x13, 0x64, 0x8d, 0xe3, 0x65, 0xf2, 0xf3, 0xdb,
+    0xc9, 0xfa, 0x7e, 0x4e, 0x4d, 0x06, 0x4f, 0x66, 0xad, 0x4b, 0xad, 0x7e, 0x7b, 0x2f, 0xce, 0xdf,
+    0x68, 0x23, 0x46, 0x91, 0x9d, 0x77, 0x68, 0x1f, 0x02, 0x97, 0xed, 0x52, 0x9e, 0xe8, 0xc9, 0xd3,
+    0xae, 0x99, 0xc6, 0xbe, 0xd9, 0x26, 0xbb, 0xdd, 0x21, 0x44, 0x49, 0xef, 0x26, 0x7b, 0x6f, 0x2e,
+    0x3d, 0x0e, 0x5c, 0x8a, 0xb6, 0xfb, 0xf7, 0xe5, 0x50, 0xc1, 0x2e, 0xe8, 0x6c, 0x6c, 0x07, 0x54,
+    0x9d
+};
+static const unsigned char TEST_EXPONENT1[] = {
+    0x00, 0x92, 0x69, 0xd1, 0x6f, 0x3f, 0xc9, 0xdc, 0x03, 0x32, 0x88, 0xf6, 0x08, 0xef, 0x28, 0xe3,
+    0xaa, 0xd0, 0x31, 0x12, 0xd7, 0xcc, 0x7d, 0xb2, 0x68, 0xcc, 0x48, 0xcc, 0xfc, 0xc0, 0xaf, 0xfc,
+    0x2b, 0xaa, 0xe9, 0x40, 0x97, 0x16, 0x43, 0x23, 0x19, 0xfa, 0x35, 0x92, 0x61, 0x37, 0xbc, 0xe3,
+    0x26, 0xd4, 0xc2, 0x1c, 0xd0, 0xff, 0xae, 0x11, 0x8a, 0x7a, 0x9b, 0x30, 0x67, 0x32, 0x3e, 0x4e,
+    0xff, 0x03, 0xe8, 0x3a, 0xef, 0x23, 0xcf, 0xf5, 0x4b, 0x18, 0xbf, 0xba, 0x9d, 0x46, 0xc8, 0x38,
+    0xec, 0x70, 0x6e, 0x2a, 0x7c, 0xc8, 0x74, 0x0d, 0x39, 0xa4, 0xd0, 0x6c, 0x4e, 0x10, 0xe3, 0xdb,
+    0xb5, 0xc1, 0xf9, 0xc9, 0x8c, 0xef, 0x2c, 0xfe, 0x41, 0xdf, 0x15, 0x0f, 0xbe, 0x3e, 0x50, 0xd7,
+    0x10, 0x9b, 0x10, 0x4b, 0xc1, 0x7e, 0xe8, 0x5d, 0x06, 0xd3, 0x1e, 0xbe, 0x3d, 0x9b, 0xa4, 0x7f,
+    0x8b
+};
+static const unsigned char TEST_EXPONENT2[] = {
+    0x0b, 0x27, 0xbd, 0xa6, 0xad, 0x4c, 0xe6, 0xab, 0x82, 0x5b, 0x91, 0x79, 0x2b, 0xdc, 0xe4, 0x70,
+    0xa6, 0x90, 0x92, 0xb8, 0x80, 0x2c, 0xbc, 0xb0, 0xfa, 0xba, 0x9d, 0xd3, 0xee, 0x6d, 0xea, 0x78,
+    0x2e, 0x62, 0x9f, 0x61, 0x74, 0x45, 0xc7, 0x38, 0x78, 0xbc, 0x83, 0xd9, 0x1e, 0x91, 0xa2, 0xab,
+    0x39, 0x94, 0x49, 0x83, 0x68, 0x99, 0xb4, 0xd7, 0x79, 0x6d, 0xa6, 0xd4, 0x03, 0xf7, 0x4a, 0x6a,
+    0x2a, 0x5a, 0x49, 0xd4, 0x20, 0xc2, 0xe6, 0xbf, 0x33, 0x6d, 0x76, 0xd4, 0x70, 0xe5, 0x43, 0xe7,
+    0x64, 0xe4, 0x9e, 0x67, 0x88, 0xdc, 0x77, 0xad, 0x47, 0x9c, 0xee, 0x3b, 0x98, 0x72, 0xce, 0xf6,
+    0xb4, 0x7c, 0x3c, 0x0e, 0x9f, 0x6c, 0x1d, 0x12, 0x2c, 0xbb, 0xb3, 0xd8, 0x88, 0xfb, 0x09, 0x3a,
+    0x49, 0x49, 0xd2, 0x5d, 0x22, 0x53, 0x3b, 0xc6, 0x37, 0xc2, 0xe9, 0xf5, 0xd2, 0x64, 0x6b, 0x7d
+};
+static const unsigned char TEST_COEFFICIENT[] = {
+    0x6f, 0x0b, 0x69, 0x55, 0x0f, 0xc9, 0x9e, 0xaf, 0x70, 0xb2, 0x17, 0x39, 0xa6, 0xb3, 0x22, 0x7c,
+    0x98, 0x0e, 0x87, 0xf4, 0xd1, 0x33, 0x6b, 0x29, 0x82, 0x90, 0x80, 0xd7, 0x07, 0x4d, 0x51, 0xd2,
+    0xb4, 0xd9, 0x6b, 0x15, 0x5b, 0xfa, 0xf7, 0xf4, 0xe8, 0xaa, 0x5f, 0x10, 0xdb, 0xe0, 0xba, 0xc4,
+    0x66, 0xe1, 0x56, 0x30, 0x49, 0x62, 0x9b, 0x6e, 0x52, 0xd4, 0x9f, 0x2b, 0x52, 0x81, 0xed, 0x53,
+    0x74, 0x65, 0x35, 0xde, 0x87, 0x28, 0x0c, 0x97, 0xea, 0x98, 0x70, 0x11, 0xa7, 0xab, 0xc7, 0x94,
+    0x0a, 0x1e, 0xc1, 0xc8, 0xa5, 0x46, 0x72, 0xa9, 0x3d, 0x6f, 0x6f, 0x94, 0x52, 0x25, 0x8d, 0xa3,
+    0xa0, 0xa7, 0xab, 0x2c, 0x3a, 0xdd, 0x22, 0x53, 0x02, 0xed, 0x53, 0xb4, 0x14, 0x72, 0x96, 0xe5,
+    0x45, 0x3c, 0x7b, 0x6d, 0x6f, 0x55, 0xe6, 0xcb, 0x55, 0xb8, 0x13, 0x3b, 0xa8, 0x34, 0xd5, 0xb7
+};
+// SHA-256("abc")
+static const unsigned char TEST_DIGEST[] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+static const unsigned char TEST_SIGNATURE[] = {
+    0x3f, 0x0f, 0x82, 0xf2, 0x62, 0x66, 0xfa, 0x73, 0x44, 0x4e, 0x4a, 0x0a, 0xa9, 0x9a, 0xfe, 0x29,
+    0xce, 0xdd, 0x06, 0x22, 0x19, 0x23, 0x94, 0x44, 0xaa, 0xe6, 0x92, 0xe8, 0xdd, 0x4c, 0x86, 0xb3,
+    0x14, 0xa7, 0x74, 0xae, 0xcd, 0x61, 0x6e, 0x67, 0x82, 0x39, 0xa6, 0x65, 0x0f, 0xd1, 0x01, 0xc1,
+    0x34, 0xda, 0xd1, 0xb6, 0x3f, 0xbf, 0xf7, 0x02, 0xbc, 0xf1, 0x0f, 0x19, 0xdf, 0x04, 0xd9, 0xd4,
+    0x09, 0x00, 0x80, 0xe2, 0xbc, 0x67, 0x15, 0xe3, 0x37, 0x99, 0x16, 0x97, 0x61, 0xe4, 0xcf, 0x2a,
+    0x4d, 0xc7, 0x3d, 0x21, 0x1d, 0x73, 0xa1, 0xd6, 0x94, 0xe4, 0x88, 0x67, 0x42, 0xcb, 0xf1, 0xb9,
+    0x24, 0xc2, 0x17, 0x6b, 0xea, 0xea, 0x7b, 0xc4, 0x48, 0xc2, 0x77, 0x26, 0x6f, 0x76, 0x56, 0x26,
+    0xbd, 0x05, 0x6b, 0x73, 0x94, 0xe2, 0xb5, 0xce, 0x04, 0x44, 0x12, 0x4f, 0x9a, 0x5c, 0xf1, 0xad,
+    0x87, 0xd0, 0x2e, 0xb4, 0x82, 0xa1, 0xfa, 0x49, 0xb7, 0xee, 0xb1, 0xfe, 0xf6, 0x49, 0x15, 0xd1,
+    0x0b, 0x6a, 0x9e, 0xbc, 0x0a, 0x9e, 0xa0, 0xaa, 0x2d, 0x93, 0xb0, 0x3b, 0x00, 0x2f, 0x21, 0xf0,
+    0x4c, 0x89, 0xef, 0x79, 0xe5, 0xa3, 0x17, 0xed, 0xb4, 0x1f, 0xd4, 0x48, 0x3c, 0xad, 0x06, 0x0d,
+    0x9a, 0x38, 0xf8, 0xc1, 0x2b, 0x49, 0x90, 0xd0, 0x47, 0x5c, 0x67, 0x66, 0xaa, 0xa4, 0x2f, 0x55,
+    0x45, 0x55, 0x14, 0x92, 0x2e, 0x43, 0x08, 0x24, 0x84, 0x8c, 0x52, 0x04, 0x08, 0x9a, 0x4d, 0x7a,
+    0xa1, 0x1b, 0xd8, 0xd9, 0xd8, 0x72, 0x7f, 0x9f, 0xa3, 0xef, 0xc9, 0x44, 0x09, 0x7d, 0x64, 0x1b,
+    0x12, 0x61, 0xf0, 0x23, 0x2f, 0xf6, 0xc9, 0xc1, 0x06, 0x15, 0x96, 0xff, 0x6e, 0x11, 0xf2, 0x1c,
+    0xc1, 0x5e, 0x2b, 0x7e, 0x96, 0xad, 0x13, 0xca, 0x29, 0xab, 0x5b, 0x5c, 0xc6, 0xd3, 0x70, 0x68
+};
+
+static RSA_PRIVATE_KEY_PARTS get_test_parts(void)
+{
+    RSA_PRIVATE_KEY_PARTS parts;
+    parts.modulus = TEST_MODULUS;
+    parts.modulus_len = sizeof(TEST_MODULUS);
+    parts.public_exponent = TEST_PUBLIC_EXPONENT;
+    parts.public_exponent_len = sizeof(TEST_PUBLIC_EXPONENT);
+    parts.prime1 = TEST_PRIME1;
+    parts.prime1_len = sizeof(TEST_PRIME1);
+    parts.prime2 = TEST_PRIME2;
+    parts.prime2_len = sizeof(TEST_PRIME2);
+    parts.exponent1 = TEST_EXPONENT1;
+    parts.exponent1_len = sizeof(TEST_EXPONENT1);
+    parts.exponent2 = TEST_EXPONENT2;
+    parts.exponent2_len = sizeof(TEST_EXPONENT2);
+    parts.coefficient = TEST_COEFFICIENT;
+    parts.coefficient_len = sizeof(TEST_COEFFICIENT);
+    return parts;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_rsa_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_rsa_key_create_NULL_fail)
+    {
+        // arrange
+
+        // act
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(NULL);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_rsa_key_create_wrong_modulus_fail)
+    {
+        // arrange
+        unsigned char modulus[sizeof(TEST_MODULUS)];
+        RSA_PRIVATE_KEY_PARTS parts = get_test_parts();
+        memcpy(modulus, TEST_MODULUS, sizeof(modulus));
+        modulus[sizeof(modulus) - 1] ^= 0x02;
+        parts.modulus = modulus;
+
+        // act
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(&parts);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_rsa_key_create_succeed)
+    {
+        // arrange
+        RSA_PRIVATE_KEY_PARTS parts = get_test_parts();
+
+        // act
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(&parts);
+
+        // assert
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(TEST_SIGNATURE), crypto_rsa_key_get_size(handle));
+
+        // cleanup
+        crypto_rsa_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rsa_sign_known_answer_succeed)
+    {
+        // arrange
+        unsigned char signature[sizeof(TEST_SIGNATURE)];
+        RSA_PRIVATE_KEY_PARTS parts = get_test_parts();
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(&parts);
+
+        // act
+        int result = crypto_rsa_sign_pkcs1_sha256(handle, TEST_DIGEST, signature);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(signature, TEST_SIGNATURE, sizeof(TEST_SIGNATURE)));
+
+        // cleanup
+        crypto_rsa_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rsa_sign_portable_matches_mulx_succeed)
+    {
+        // arrange
+        unsigned char portable[sizeof(TEST_SIGNATURE)];
+        unsigned char accelerated[sizeof(TEST_SIGNATURE)];
+        RSA_PRIVATE_KEY_PARTS parts = get_test_parts();
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(&parts);
+        bool has_mulx = crypto_bignum_set_mulx(true) == 0;
+
+        // act
+        int result = crypto_rsa_sign_pkcs1_sha256(handle, TEST_DIGEST, accelerated);
+        (void)crypto_bignum_set_mulx(false);
+        result |= crypto_rsa_sign_pkcs1_sha256(handle, TEST_DIGEST, portable);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(portable, TEST_SIGNATURE, sizeof(TEST_SIGNATURE)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(accelerated, TEST_SIGNATURE, sizeof(TEST_SIGNATURE)));
+
+        // cleanup
+        (void)crypto_bignum_set_mulx(has_mulx);
+        crypto_rsa_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rsa_private_operation_input_too_large_fail)
+    {
+        // arrange
+        unsigned char input[sizeof(TEST_SIGNATURE)];
+        unsigned char output[sizeof(TEST_SIGNATURE)];
+        RSA_PRIVATE_KEY_PARTS parts = get_test_parts();
+        RSA_KEY_HANDLE handle = crypto_rsa_key_create(&parts);
+        memset(input, 0xff, sizeof(input));
+
+        // act
+        int result = crypto_rsa_private_operation(handle, input, output);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_rsa_key_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_rsa_verify_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_rsa_verify_pkcs1_sha256(NULL, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            TEST_DIGEST, TEST_SIGNATURE, sizeof(TEST_SIGNATURE));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_rsa_verify_succeed)
+    {
+        // arrange
+
+        // act
+        // The second call finds the public key in the cache
+        int first = crypto_rsa_verify_pkcs1_sha256(TEST_MODULUS, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            TEST_DIGEST, TEST_SIGNATURE, sizeof(TEST_SIGNATURE));
+        int second = crypto_rsa_verify_pkcs1_sha256(TEST_MODULUS, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            TEST_DIGEST, TEST_SIGNATURE, sizeof(TEST_SIGNATURE));
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, first);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, second);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_rsa_verify_tampered_fail)
+    {
+        // arrange
+        unsigned char signature[sizeof(TEST_SIGNATURE)];
+        unsigned char digest[sizeof(TEST_DIGEST)];
+        memcpy(signature, TEST_SIGNATURE, sizeof(signature));
+        signature[sizeof(signature) / 2] ^= 0x10;
+        memcpy(digest, TEST_DIGEST, sizeof(digest));
+        digest[sizeof(digest) - 1] ^= 0x01;
+
+        // act
+        int signature_result = crypto_rsa_verify_pkcs1_sha256(TEST_MODULUS, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            TEST_DIGEST, signature, sizeof(signature));
+        int digest_result = crypto_rsa_verify_pkcs1_sha256(TEST_MODULUS, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            digest, TEST_SIGNATURE, sizeof(TEST_SIGNATURE));
+        int length_result = crypto_rsa_verify_pkcs1_sha256(TEST_MODULUS, sizeof(TEST_MODULUS), TEST_PUBLIC_EXPONENT, sizeof(TEST_PUBLIC_EXPONENT),
+            TEST_DIGEST, TEST_SIGNATURE + 1, sizeof(TEST_SIGNATURE) - 1);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, signature_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, digest_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, length_result);
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_rsa_ut)
@@ -0,0 +1,396 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include <pthread.h>
+
+#include "cablelock/crypto_session_cache.h"
+
+#define TEST_STATE_SIZE     48
+#define TEST_THREAD_COUNT   4
+#define TEST_THREAD_ROUNDS  20000
+#define TEST_SAME_ID_ROUNDS 200
+
+static const unsigned char TEST_SESSION_ID[CRYPTO_SESSION_ID_MAX_SIZE] = {
+    0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf6, 0x07, 0x18, 0x29, 0x3a, 0x4b, 0x5c, 0x6d, 0x7e, 0x8f, 0x90,
+    0x01, 0x12, 0x23, 0x34, 0x45, 0x56, 0x67, 0x78, 0x89, 0x9a, 0xab, 0xbc, 0xcd, 0xde, 0xef, 0xf0
+};
+
+// Session ID and state both derive from the number, so a torn read shows up as a mismatch
+static void make_session(uint32_t number, unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE], unsigned char state[TEST_STATE_SIZE])
+{
+    memset(session_id, 0, CRYPTO_SESSION_ID_MAX_SIZE);
+    memcpy(session_id, &number, sizeof(number));
+    memset(state, (int)(number & 0xFF), TEST_STATE_SIZE);
+    memcpy(state, &number, sizeof(number));
+}
+
+static void* concurrent_worker(void* context)
+{
+    CRYPTO_SESSION_CACHE_HANDLE handle = (CRYPTO_SESSION_CACHE_HANDLE)context;
+    unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+    unsigned char state[TEST_STATE_SIZE];
+    unsigned char found[TEST_STATE_SIZE];
+    size_t found_len;
+    size_t torn = 0;
+    for (uint32_t round = 0; round < TEST_THREAD_ROUNDS; round++)
+    {
+        uint32_t number = round % 64;
+        make_session(number, session_id, state);
+        if (round % 3 == 0)
+        {
+            (void)crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, sizeof(state));
+        }
+        else if (crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len) == 0 &&
+            (found_len != sizeof(state) || memcmp(found, state, sizeof(state)) != 0))
+        {
+            torn++;
+        }
+    }
+    return (void*)torn;
+}
+
+typedef struct TEST_SAME_ID_TAG
+{
+    CRYPTO_SESSION_CACHE_HANDLE handle;
+    pthread_barrier_t start;
+} TEST_SAME_ID;
+
+// Every thread stores TEST_SESSION_ID at once into a full shard without it
+static void* same_id_worker(void* context)
+{
+    TEST_SAME_ID* test = (TEST_SAME_ID*)context;
+    unsigned char state[TEST_STATE_SIZE];
+    memset(state, 0x5A, sizeof(state));
+    (void)pthread_barrier_wait(&test->start);
+    (void)crypto_session_cache_insert(test->handle, TEST_SESSION_ID, sizeof(TEST_SESSION_ID), state, sizeof(state));
+    return NULL;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_session_cache_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_create_capacity_0_fail)
+    {
+        // arrange
+
+        // act
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(0, TEST_STATE_SIZE, 0);
+
+        // assert
+        CTEST_ASSERT_IS_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_insert_state_too_large_fail)
+    {
+        // arrange
+        unsigned char state[TEST_STATE_SIZE + 1] = { 0 };
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(64, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        int result = crypto_session_cache_insert(handle, TEST_SESSION_ID, sizeof(TEST_SESSION_ID), state, sizeof(state));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_insert_lookup_succeed)
+    {
+        // arrange
+        unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        unsigned char found[TEST_STATE_SIZE];
+        size_t found_len = 0;
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(64, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        make_session(7, session_id, state);
+
+        // act
+        int result = crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, sizeof(state));
+        result |= crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(state), found_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(found, state, sizeof(state)));
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_lookup_miss_fail)
+    {
+        // arrange
+        unsigned char found[TEST_STATE_SIZE];
+        size_t found_len;
+        CRYPTO_SESSION_CACHE_STATS stats;
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(64, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        int result = crypto_session_cache_lookup(handle, TEST_SESSION_ID, sizeof(TEST_SESSION_ID), found, &found_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(handle, &stats));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, (int)stats.hits);
+        CTEST_ASSERT_ARE_EQUAL(int, 1, (int)stats.misses);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_insert_replace_succeed)
+    {
+        // arrange
+        unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        unsigned char found[TEST_STATE_SIZE];
+        size_t found_len = 0;
+        CRYPTO_SESSION_CACHE_STATS stats;
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(8, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        make_session(1, session_id, state);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, sizeof(state)));
+        state[10] ^= 0xFF;
+
+        // act
+        int result = crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, 16);
+        result |= crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 16, found_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(found, state, 16));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(handle, &stats));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, (int)stats.evictions);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_remove_succeed)
+    {
+        // arrange
+        unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        unsigned char found[TEST_STATE_SIZE];
+        size_t found_len;
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(64, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        make_session(3, session_id, state);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, sizeof(state)));
+
+        // act
+        crypto_session_cache_remove(handle, session_id, sizeof(session_id));
+        int result = crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_eviction_bounded_succeed)
+    {
+        // arrange
+        unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        unsigned char found[TEST_STATE_SIZE];
+        size_t found_len;
+        size_t live = 0;
+        CRYPTO_SESSION_CACHE_STATS stats;
+        // A single shard, every insert past the eighth evicts
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(CRYPTO_SESSION_CACHE_WAYS, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        for (uint32_t number = 0; number < 3 * CRYPTO_SESSION_CACHE_WAYS; number++)
+        {
+            make_session(number, session_id, state);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_insert(handle, session_id, sizeof(session_id), state, sizeof(state)));
+        }
+        for (uint32_t number = 0; number < 3 * CRYPTO_SESSION_CACHE_WAYS; number++)
+        {
+            make_session(number, session_id, state);
+            if (crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len) == 0)
+            {
+                CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(found, state, sizeof(state)));
+                live++;
+            }
+        }
+
+        // assert
+        make_session(3 * CRYPTO_SESSION_CACHE_WAYS - 1, session_id, state);
+        CTEST_ASSERT_ARE_EQUAL(size_t, CRYPTO_SESSION_CACHE_WAYS, live);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(handle, &stats));
+        CTEST_ASSERT_ARE_EQUAL(int, 2 * CRYPTO_SESSION_CACHE_WAYS, (int)stats.evictions);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_lookup(handle, session_id, sizeof(session_id), found, &found_len));
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_get_stats_NULL_fail)
+    {
+        // arrange
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(64, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        int result = crypto_session_cache_get_stats(handle, NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_concurrent_succeed)
+    {
+        // arrange
+        pthread_t threads[TEST_THREAD_COUNT];
+        size_t torn = 0;
+        // Fewer entries than sessions so writers keep evicting under the readers
+        CRYPTO_SESSION_CACHE_HANDLE handle = crypto_session_cache_create(32, TEST_STATE_SIZE, 0);
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_create(&threads[index], NULL, concurrent_worker, handle));
+        }
+        for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+        {
+            void* thread_torn;
+            (void)pthread_join(threads[index], &thread_torn);
+            torn += (size_t)thread_torn;
+        }
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(size_t, 0, torn);
+
+        // cleanup
+        crypto_session_cache_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_session_cache_concurrent_same_id_one_copy_succeed)
+    {
+        for (size_t round = 0; round < TEST_SAME_ID_ROUNDS; round++)
+        {
+            // arrange
+            pthread_t threads[TEST_THREAD_COUNT];
+            unsigned char session_id[CRYPTO_SESSION_ID_MAX_SIZE];
+            unsigned char state[TEST_STATE_SIZE];
+            CRYPTO_SESSION_CACHE_STATS before;
+            CRYPTO_SESSION_CACHE_STATS after;
+            TEST_SAME_ID test;
+            test.handle = crypto_session_cache_create(CRYPTO_SESSION_CACHE_WAYS, TEST_STATE_SIZE, 0);
+            CTEST_ASSERT_IS_NOT_NULL(test.handle);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_barrier_init(&test.start, NULL, TEST_THREAD_COUNT));
+            for (uint32_t number = 0; number < CRYPTO_SESSION_CACHE_WAYS; number++)
+            {
+                make_session(number, session_id, state);
+                CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_insert(test.handle, session_id, sizeof(session_id), state, sizeof(state)));
+            }
+            for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+            {
+                CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_create(&threads[index], NULL, same_id_worker, &test));
+            }
+            for (size_t index = 0; index < TEST_THREAD_COUNT; index++)
+            {
+                (void)pthread_join(threads[index], NULL);
+            }
+            // Only the ID is left, the other ways are free unless one holds a second copy
+            for (uint32_t number = 0; number < CRYPTO_SESSION_CACHE_WAYS; number++)
+            {
+                make_session(number, session_id, state);
+                crypto_session_cache_remove(test.handle, session_id, sizeof(session_id));
+            }
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(test.handle, &before));
+
+            // act
+            for (uint32_t number = 1000; number < 1000 + CRYPTO_SESSION_CACHE_WAYS - 1; number++)
+            {
+                make_session(number, session_id, state);
+                CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_insert(test.handle, session_id, sizeof(session_id), state, sizeof(state)));
+            }
+
+            // assert
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(test.handle, &after));
+            CTEST_ASSERT_ARE_EQUAL(int, (int)before.evictions, (int)after.evictions);
+
+            // cleanup
+            (void)pthread_barrier_destroy(&test.start);
+            crypto_session_cache_destroy(test.handle);
+        }
+    }
+
+CTEST_END_TEST_SUITE(crypto_session_cache_ut)
@@ -0,0 +1,248 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_session_ticket.h"
+#include "cablelock/crypto_gcm.h"
+
+static const unsigned char TEST_KEY_NAME[CRYPTO_TICKET_KEY_NAME_SIZE] = {
+    0x6b, 0x65, 0x79, 0x2d, 0x6e, 0x61, 0x6d, 0x65, 0x2d, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x31
+};
+static const unsigned char TEST_KEY[CRYPTO_TICKET_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+static const unsigned char TEST_STATE[] = "resumption master secret and cipher suite";
+
+#define TEST_STATE_SIZE     sizeof(TEST_STATE)
+#define TEST_TICKET_SIZE    (TEST_STATE_SIZE + CRYPTO_TICKET_OVERHEAD)
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_session_ticket_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_ticket_seal_handle_NULL_fail)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+
+        // act
+        int result = crypto_ticket_seal(NULL, TEST_STATE, TEST_STATE_SIZE, ticket);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_ticket_keys_rotate_key_len_fail)
+    {
+        // arrange
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        int result = crypto_ticket_keys_rotate(handle, TEST_KEY_NAME, TEST_KEY, CRYPTO_TICKET_KEY_SIZE - 1);
+        result = result != 0 ? crypto_ticket_keys_rotate(handle, TEST_KEY_NAME, NULL, 0) : 0;
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_seal_open_succeed)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        bool renew = true;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+
+        // act
+        int result = crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket);
+        result |= crypto_ticket_open(handle, ticket, sizeof(ticket), state, &renew);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_FALSE(renew);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(state, TEST_STATE, TEST_STATE_SIZE));
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_seal_format_succeed)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        CRYPTO_GCM_KEY gcm_key;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_keys_rotate(handle, TEST_KEY_NAME, TEST_KEY, sizeof(TEST_KEY)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_gcm_key_init(&gcm_key, TEST_KEY, sizeof(TEST_KEY)));
+
+        // act
+        int result = crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(ticket, TEST_KEY_NAME, CRYPTO_TICKET_KEY_NAME_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_gcm_decrypt(&gcm_key, ticket + CRYPTO_TICKET_KEY_NAME_SIZE, ticket, CRYPTO_TICKET_KEY_NAME_SIZE,
+            ticket + CRYPTO_TICKET_KEY_NAME_SIZE + GCM_NONCE_SIZE, TEST_STATE_SIZE, state, ticket + TEST_TICKET_SIZE - GCM_TAG_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(state, TEST_STATE, TEST_STATE_SIZE));
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_open_renew_after_rotate_succeed)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        bool renew = false;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_keys_rotate(handle, NULL, NULL, 0));
+
+        // act
+        int result = crypto_ticket_open(handle, ticket, sizeof(ticket), state, &renew);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(renew);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(state, TEST_STATE, TEST_STATE_SIZE));
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_open_retired_key_fail)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        bool renew;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket));
+        for (size_t index = 0; index < CRYPTO_TICKET_KEY_SLOTS; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_keys_rotate(handle, NULL, NULL, 0));
+        }
+
+        // act
+        int result = crypto_ticket_open(handle, ticket, sizeof(ticket), state, &renew);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_open_tampered_fail)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        bool renew;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket));
+        ticket[CRYPTO_TICKET_KEY_NAME_SIZE + GCM_NONCE_SIZE + 3] ^= 0x01;
+
+        // act
+        int result = crypto_ticket_open(handle, ticket, sizeof(ticket), state, &renew);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+    CTEST_FUNCTION(crypto_ticket_open_short_ticket_fail)
+    {
+        // arrange
+        unsigned char ticket[TEST_TICKET_SIZE];
+        unsigned char state[TEST_STATE_SIZE];
+        bool renew;
+        CRYPTO_TICKET_KEYS_HANDLE handle = crypto_ticket_keys_create();
+        CTEST_ASSERT_IS_NOT_NULL(handle);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_ticket_seal(handle, TEST_STATE, TEST_STATE_SIZE, ticket));
+
+        // act
+        int result = crypto_ticket_open(handle, ticket, CRYPTO_TICKET_OVERHEAD, state, &renew);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+        crypto_ticket_keys_destroy(handle);
+    }
+
+CTEST_END_TEST_SUITE(crypto_session_ticket_ut)
@@ -0,0 +1,348 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+
+#include "cablelock/crypto_tune.h"
+#include "cablelock/crypto_bignum.h"
+
+#define TEST_CACHE_PATH     "crypto_tune_ut.cache"
+#define TEST_VICTIM_PATH    "crypto_tune_ut.victim"
+#define TEST_VICTIM_TEXT    "not a tune cache\n"
+
+typedef struct TEST_WATCH_TAG
+{
+    int stop;
+    int changed;
+} TEST_WATCH;
+
+static void write_cache(const char* contents)
+{
+    FILE* file = fopen(TEST_CACHE_PATH, "w");
+    CTEST_ASSERT_IS_NOT_NULL(file);
+    (void)fputs(contents, file);
+    (void)fclose(file);
+}
+
+static CRYPTO_TUNE_PROFILE make_profile(void)
+{
+    CRYPTO_TUNE_PROFILE result;
+    result.aes_level = crypto_aes_accel_detect();
+    result.aes_wide_threshold = 256;
+    result.bignum_mulx = crypto_bignum_detect_mulx();
+    result.parallel_threshold = 65536;
+    return result;
+}
+
+// Stands in for another thread using the library while calibration runs
+static void* watch_settings(void* parameter)
+{
+    TEST_WATCH* watch = (TEST_WATCH*)parameter;
+    CRYPTO_AES_ACCEL level = crypto_aes_accel_get_level();
+    size_t threshold = crypto_aes_accel_get_wide_threshold();
+    bool mulx = crypto_bignum_get_mulx();
+    while (__atomic_load_n(&watch->stop, __ATOMIC_RELAXED) == 0)
+    {
+        if (crypto_aes_accel_get_level() != level || crypto_aes_accel_get_wide_threshold() != threshold || crypto_bignum_get_mulx() != mulx)
+        {
+            __atomic_store_n(&watch->changed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_tune_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+        (void)remove(TEST_CACHE_PATH);
+        (void)remove(TEST_CACHE_PATH ".tmp");
+        (void)remove(TEST_VICTIM_PATH);
+        (void)crypto_aes_accel_set_level(crypto_aes_accel_detect());
+        crypto_aes_accel_set_wide_threshold(0);
+        (void)crypto_bignum_set_mulx(crypto_bignum_detect_mulx());
+    }
+
+    CTEST_FUNCTION(crypto_tune_calibrate_profile_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_tune_calibrate(NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_apply_profile_NULL_fail)
+    {
+        // arrange
+
+        // act
+        int result = crypto_tune_apply(NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_load_missing_file_fail)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile;
+
+        // act
+        int null_result = crypto_tune_load(NULL, &profile);
+        int missing_result = crypto_tune_load(TEST_CACHE_PATH, &profile);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, null_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, missing_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_save_load_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile = make_profile();
+        CRYPTO_TUNE_PROFILE loaded;
+        memset(&loaded, 0, sizeof(loaded));
+
+        // act
+        int result = crypto_tune_save(TEST_CACHE_PATH, &profile);
+        result |= crypto_tune_load(TEST_CACHE_PATH, &loaded);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, (int)profile.aes_level, (int)loaded.aes_level);
+        CTEST_ASSERT_ARE_EQUAL(size_t, profile.aes_wide_threshold, loaded.aes_wide_threshold);
+        CTEST_ASSERT_ARE_EQUAL(bool, profile.bignum_mulx, loaded.bignum_mulx);
+        CTEST_ASSERT_ARE_EQUAL(size_t, profile.parallel_threshold, loaded.parallel_threshold);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_save_private_file_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile = make_profile();
+        struct stat cache_stat;
+        FILE* file;
+        char victim[sizeof(TEST_VICTIM_TEXT)] = { 0 };
+        // The name an attacker could plant when the temporary file was fixed
+        write_cache(TEST_VICTIM_TEXT);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, rename(TEST_CACHE_PATH, TEST_VICTIM_PATH));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, symlink(TEST_VICTIM_PATH, TEST_CACHE_PATH ".tmp"));
+
+        // act
+        int result = crypto_tune_save(TEST_CACHE_PATH, &profile);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, lstat(TEST_CACHE_PATH, &cache_stat));
+        CTEST_ASSERT_IS_TRUE(S_ISREG(cache_stat.st_mode));
+        CTEST_ASSERT_ARE_EQUAL(int, 0600, (int)(cache_stat.st_mode & 0777));
+        file = fopen(TEST_VICTIM_PATH, "r");
+        CTEST_ASSERT_IS_NOT_NULL(file);
+        (void)fread(victim, 1, sizeof(victim) - 1, file);
+        (void)fclose(file);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, TEST_VICTIM_TEXT, victim);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_load_other_host_fail)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile;
+        write_cache("cablelock-tune 1\nhost aes=0 mulx=0 cpus=0 another cpu\naes_level 0\naes_wide_threshold 0\nbignum_mulx 0\nparallel_threshold 0\n");
+
+        // act
+        int result = crypto_tune_load(TEST_CACHE_PATH, &profile);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_load_truncated_fail)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile = make_profile();
+        FILE* file;
+        char contents[512];
+        size_t contents_len;
+        int result = crypto_tune_save(TEST_CACHE_PATH, &profile);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        file = fopen(TEST_CACHE_PATH, "r");
+        CTEST_ASSERT_IS_NOT_NULL(file);
+        contents_len = fread(contents, 1, sizeof(contents) - 1, file);
+        (void)fclose(file);
+        // Drop the last line
+        contents[contents_len - 1] = '\0';
+        *strrchr(contents, '\n') = '\0';
+        write_cache(contents);
+
+        // act
+        result = crypto_tune_load(TEST_CACHE_PATH, &profile);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_apply_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile = make_profile();
+        profile.aes_level = CRYPTO_AES_ACCEL_NONE;
+        profile.bignum_mulx = false;
+
+        // act
+        int result = crypto_tune_apply(&profile);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, (int)CRYPTO_AES_ACCEL_NONE, (int)crypto_aes_accel_get_level());
+        CTEST_ASSERT_ARE_EQUAL(size_t, profile.aes_wide_threshold, crypto_aes_accel_get_wide_threshold());
+        CTEST_ASSERT_IS_FALSE(crypto_bignum_get_mulx());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_calibrate_keeps_settings_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile;
+        crypto_aes_accel_set_wide_threshold(16);
+
+        // act
+        int result = crypto_tune_calibrate(&profile);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(profile.aes_level <= crypto_aes_accel_detect());
+        CTEST_ASSERT_IS_TRUE(!profile.bignum_mulx || crypto_bignum_detect_mulx());
+        CTEST_ASSERT_ARE_EQUAL(int, (int)crypto_aes_accel_detect(), (int)crypto_aes_accel_get_level());
+        CTEST_ASSERT_ARE_EQUAL(size_t, 16, crypto_aes_accel_get_wide_threshold());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_calibrate_settings_stable_across_threads_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE profile;
+        TEST_WATCH watch = { 0, 0 };
+        pthread_t thread;
+        (void)crypto_aes_accel_set_level(CRYPTO_AES_ACCEL_NONE);
+        crypto_aes_accel_set_wide_threshold(16);
+        (void)crypto_bignum_set_mulx(false);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, pthread_create(&thread, NULL, watch_settings, &watch));
+
+        // act
+        int result = crypto_tune_calibrate(&profile);
+        __atomic_store_n(&watch.stop, 1, __ATOMIC_RELAXED);
+        (void)pthread_join(thread, NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, watch.changed);
+        CTEST_ASSERT_IS_TRUE(profile.aes_level <= crypto_aes_accel_detect());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_tune_init_writes_cache_succeed)
+    {
+        // arrange
+        CRYPTO_TUNE_PROFILE calibrated;
+        CRYPTO_TUNE_PROFILE cached;
+        CRYPTO_TUNE_PROFILE loaded;
+
+        // act
+        int result = crypto_tune_init(TEST_CACHE_PATH, &calibrated);
+        result |= crypto_tune_load(TEST_CACHE_PATH, &loaded);
+        result |= crypto_tune_init(TEST_CACHE_PATH, &cached);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, (int)calibrated.aes_level, (int)loaded.aes_level);
+        CTEST_ASSERT_ARE_EQUAL(int, (int)calibrated.aes_level, (int)cached.aes_level);
+        CTEST_ASSERT_ARE_EQUAL(size_t, calibrated.aes_wide_threshold, cached.aes_wide_threshold);
+        CTEST_ASSERT_ARE_EQUAL(bool, calibrated.bignum_mulx, cached.bignum_mulx);
+        CTEST_ASSERT_ARE_EQUAL(int, (int)calibrated.aes_level, (int)crypto_aes_accel_get_level());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_tune_ut)
@@ -0,0 +1,234 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_x25519.h"
+
+// RFC 7748 sections 5.2 and 6.1
+static const unsigned char TEST_ALICE_PRIVATE[] = {
+    0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d, 0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+    0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a, 0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a
+};
+static const unsigned char TEST_ALICE_PUBLIC[] = {
+    0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54, 0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+    0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4, 0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a
+};
+static const unsigned char TEST_BOB_PRIVATE[] = {
+    0x5d, 0xab, 0x08, 0x7e, 0x62, 0x4a, 0x8a, 0x4b, 0x79, 0xe1, 0x7f, 0x8b, 0x83, 0x80, 0x0e, 0xe6,
+    0x6f, 0x3b, 0xb1, 0x29, 0x26, 0x18, 0xb6, 0xfd, 0x1c, 0x2f, 0x8b, 0x27, 0xff, 0x88, 0xe0, 0xeb
+};
+static const unsigned char TEST_BOB_PUBLIC[] = {
+    0xde, 0x9e, 0xdb, 0x7d, 0x7b, 0x7d, 0xc1, 0xb4, 0xd3, 0x5b, 0x61, 0xc2, 0xec, 0xe4, 0x35, 0x37,
+    0x3f, 0x83, 0x43, 0xc8, 0x5b, 0x78, 0x67, 0x4d, 0xad, 0xfc, 0x7e, 0x14, 0x6f, 0x88, 0x2b, 0x4f
+};
+static const unsigned char TEST_SHARED_SECRET[] = {
+    0x4a, 0x5d, 0x9d, 0x5b, 0xa4, 0xce, 0x2d, 0xe1, 0x72, 0x8e, 0x3b, 0xf4, 0x80, 0x35, 0x0f, 0x25,
+    0xe0, 0x7e, 0x21, 0xc9, 0x47, 0xd1, 0x9e, 0x33, 0x76, 0xf0, 0x9b, 0x3c, 0x1e, 0x16, 0x17, 0x42
+};
+static const unsigned char TEST_SCALAR[] = {
+    0xa5, 0x46, 0xe3, 0x6b, 0xf0, 0x52, 0x7c, 0x9d, 0x3b, 0x16, 0x15, 0x4b, 0x82, 0x46, 0x5e, 0xdd,
+    0x62, 0x14, 0x4c, 0x0a, 0xc1, 0xfc, 0x5a, 0x18, 0x50, 0x6a, 0x22, 0x44, 0xba, 0x44, 0x9a, 0xc4
+};
+static const unsigned char TEST_INPUT_U[] = {
+    0xe6, 0xdb, 0x68, 0x67, 0x58, 0x30, 0x30, 0xdb, 0x35, 0x94, 0xc1, 0xa4, 0x24, 0xb1, 0x5f, 0x7c,
+    0x72, 0x66, 0x24, 0xec, 0x26, 0xb3, 0x35, 0x3b, 0x10, 0xa9, 0x03, 0xa6, 0xd0, 0xab, 0x1c, 0x4c
+};
+static const unsigned char TEST_OUTPUT_U[] = {
+    0xc3, 0xda, 0x55, 0x37, 0x9d, 0xe9, 0xc6, 0x90, 0x8e, 0x94, 0xea, 0x4d, 0xf2, 0x8d, 0x08, 0x4f,
+    0x32, 0xec, 0xcf, 0x03, 0x49, 0x1c, 0x71, 0xf7, 0x54, 0xb4, 0x07, 0x55, 0x77, 0xa2, 0x85, 0x52
+};
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_x25519_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_x25519_public_key_NULL_fail)
+    {
+        // arrange
+        unsigned char public_key[X25519_KEY_SIZE];
+
+        // act
+        int result = crypto_x25519_public_key(public_key, NULL);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_public_key_succeed)
+    {
+        // arrange
+        unsigned char alice_public[X25519_KEY_SIZE];
+        unsigned char bob_public[X25519_KEY_SIZE];
+
+        // act
+        int result = crypto_x25519_public_key(alice_public, TEST_ALICE_PRIVATE);
+        result |= crypto_x25519_public_key(bob_public, TEST_BOB_PRIVATE);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(alice_public, TEST_ALICE_PUBLIC, X25519_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(bob_public, TEST_BOB_PUBLIC, X25519_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_known_answer_succeed)
+    {
+        // arrange
+        unsigned char output[X25519_KEY_SIZE];
+
+        // act
+        int result = crypto_x25519(output, TEST_SCALAR, TEST_INPUT_U);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_OUTPUT_U, X25519_KEY_SIZE));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_shared_secret_succeed)
+    {
+        // arrange
+        unsigned char alice_shared[X25519_KEY_SIZE];
+        unsigned char bob_shared[X25519_KEY_SIZE];
+
+        // act
+        int result = crypto_x25519(alice_shared, TEST_ALICE_PRIVATE, TEST_BOB_PUBLIC);
+        result |= crypto_x25519(bob_shared, TEST_BOB_PRIVATE, TEST_ALICE_PUBLIC);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(alice_shared, TEST_SHARED_SECRET, X25519_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(bob_shared, TEST_SHARED_SECRET, X25519_KEY_SIZE));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_low_order_point_fail)
+    {
+        // arrange
+        unsigned char output[X25519_KEY_SIZE];
+        unsigned char zero_point[X25519_KEY_SIZE] = { 0 };
+        // u = 1 is another small order input, the clamped scalar sends it to zero
+        unsigned char order_four_point[X25519_KEY_SIZE] = { 1 };
+
+        // act
+        int zero_result = crypto_x25519(output, TEST_ALICE_PRIVATE, zero_point);
+        int order_four_result = crypto_x25519(output, TEST_ALICE_PRIVATE, order_four_point);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, zero_result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, order_four_result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_keypair_agrees_succeed)
+    {
+        // arrange
+        unsigned char private_a[X25519_KEY_SIZE], public_a[X25519_KEY_SIZE], shared_a[X25519_KEY_SIZE];
+        unsigned char private_b[X25519_KEY_SIZE], public_b[X25519_KEY_SIZE], shared_b[X25519_KEY_SIZE];
+
+        // act
+        int result = crypto_x25519_keypair(private_a, public_a);
+        result |= crypto_x25519_keypair(private_b, public_b);
+        result |= crypto_x25519(shared_a, private_a, public_b);
+        result |= crypto_x25519(shared_b, private_b, public_a);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(private_a, private_b, X25519_KEY_SIZE));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(shared_a, shared_b, X25519_KEY_SIZE));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x25519_base_table_matches_ladder_succeed)
+    {
+        // arrange
+        unsigned char base_point[X25519_KEY_SIZE] = { 9 };
+        unsigned char private_key[X25519_KEY_SIZE];
+        unsigned char from_table[X25519_KEY_SIZE];
+        unsigned char from_ladder[X25519_KEY_SIZE];
+        int mismatches = 0;
+
+        // act
+        // Scalars with every digit at the extremes of the signed radix-16 range
+        for (size_t index = 0; index < 64; index++)
+        {
+            memset(private_key, index % 2 == 0 ? 0x88 : 0x77, sizeof(private_key));
+            private_key[index % X25519_KEY_SIZE] = (unsigned char)(index * 37);
+            (void)crypto_x25519_public_key(from_table, private_key);
+            (void)crypto_x25519(from_ladder, private_key, base_point);
+            mismatches += memcmp(from_table, from_ladder, X25519_KEY_SIZE) != 0 ? 1 : 0;
+        }
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, mismatches);
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_x25519_ut)
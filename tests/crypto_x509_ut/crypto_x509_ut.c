@@ -0,0 +1,381 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_x509.h"
+
+// Self signed, sha256WithRSAEncryption over a 2048-bit key, valid
+// 2025-01-01 to 2035-01-01 as UTCTime
+static const unsigned char TEST_RSA_ROOT[] = {
+    0x30, 0x82, 0x02, 0xf8, 0x30, 0x82, 0x01, 0xe0, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x02, 0x10,
+    0x00, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00,
+    0x30, 0x1d, 0x31, 0x1b, 0x30, 0x19, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x12, 0x63, 0x61, 0x62,
+    0x6c, 0x65, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x72, 0x73, 0x61, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x30,
+    0x1e, 0x17, 0x0d, 0x32, 0x35, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a,
+    0x17, 0x0d, 0x33, 0x35, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a, 0x30,
+    0x1d, 0x31, 0x1b, 0x30, 0x19, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x12, 0x63, 0x61, 0x62, 0x6c,
+    0x65, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x72, 0x73, 0x61, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x30, 0x82,
+    0x01, 0x22, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05,
+    0x00, 0x03, 0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82, 0x01, 0x01, 0x00, 0xd7,
+    0xf0, 0x7f, 0x25, 0xa6, 0x62, 0x6d, 0x4b, 0x95, 0xde, 0x58, 0x55, 0x86, 0xec, 0xe6, 0x1a, 0xde,
+    0x7f, 0x66, 0x04, 0x85, 0x2d, 0x9b, 0x0e, 0x72, 0x1f, 0x88, 0xe9, 0x7e, 0x46, 0x48, 0x90, 0x0d,
+    0x80, 0x0f, 0x4f, 0xb7, 0x3c, 0x9c, 0x7e, 0x6a, 0xb3, 0xe0, 0x23, 0xcf, 0xfa, 0xf7, 0x1e, 0xd3,
+    0x20, 0xaa, 0xa0, 0xbb, 0x32, 0x09, 0x58, 0xb7, 0x21, 0x29, 0x92, 0xe4, 0xa8, 0xee, 0xd6, 0x6d,
+    0x88, 0xc1, 0x72, 0x51, 0x0c, 0x0e, 0x5c, 0x0b, 0xfe, 0xfe, 0x2a, 0x24, 0xc9, 0x73, 0x8c, 0x5d,
+    0x7c, 0x0e, 0x8d, 0x05, 0xbe, 0x72, 0x8c, 0xd7, 0x27, 0x66, 0x85, 0x0a, 0xa5, 0x8b, 0x2f, 0xb7,
+    0x7b, 0x7a, 0xd3, 0x40, 0xd4, 0x26, 0x81, 0xc8, 0xde, 0x85, 0x32, 0xb2, 0xa1, 0xdd, 0x5d, 0x3c,
+    0xc4, 0x4e, 0x43, 0x23, 0xeb, 0xd6, 0xfc, 0x08, 0x87, 0xfa, 0x74, 0x22, 0xb5, 0xf0, 0x46, 0x47,
+    0x29, 0x23, 0xd6, 0x5e, 0x2d, 0x5f, 0x8e, 0x57, 0xe8, 0xcd, 0x67, 0xff, 0x1a, 0x0a, 0x00, 0x46,
+    0x11, 0x0e, 0xce, 0x56, 0x6f, 0x35, 0x4d, 0x11, 0x53, 0x68, 0xb7, 0x6a, 0x3f, 0xae, 0x6e, 0x29,
+    0xb0, 0x6d, 0xd6, 0x0a, 0x3e, 0x1c, 0x4f, 0x8d, 0xe9, 0xdf, 0x04, 0xea, 0x42, 0x27, 0xe4, 0xe7,
+    0x63, 0xa3, 0x5c, 0x36, 0x91, 0x9a, 0xe7, 0x8f, 0xb9, 0x54, 0x67, 0x84, 0xf0, 0x08, 0x92, 0xb3,
+    0xbf, 0x41, 0xc3, 0x7b, 0x1f, 0x85, 0xcd, 0xdb, 0xa1, 0x21, 0x79, 0x8c, 0x2e, 0xef, 0x8c, 0x2d,
+    0x3a, 0xc8, 0x8b, 0x68, 0x0e, 0x97, 0x1f, 0x93, 0xf0, 0x66, 0x0d, 0x54, 0xcc, 0xb0, 0xa6, 0x1d,
+    0xa2, 0xfc, 0xc5, 0x5a, 0xf0, 0xd0, 0x83, 0x56, 0x86, 0x19, 0x84, 0x56, 0xa4, 0xe3, 0x15, 0x5b,
+    0x26, 0x3b, 0x2e, 0x2c, 0x1b, 0x69, 0x26, 0x30, 0x1e, 0xfc, 0xe7, 0x94, 0x67, 0x2c, 0x6f, 0x02,
+    0x03, 0x01, 0x00, 0x01, 0xa3, 0x42, 0x30, 0x40, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01,
+    0x01, 0xff, 0x04, 0x05, 0x30, 0x03, 0x01, 0x01, 0xff, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f,
+    0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x02, 0x04, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e,
+    0x04, 0x16, 0x04, 0x14, 0x10, 0x33, 0xc2, 0xf7, 0x67, 0xc7, 0x06, 0x8c, 0xa3, 0xe0, 0x73, 0x57,
+    0x60, 0x44, 0xf3, 0x5e, 0xa3, 0x06, 0xe3, 0x0d, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86,
+    0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x03, 0x82, 0x01, 0x01, 0x00, 0xa6, 0x7b, 0x6d, 0x84,
+    0x52, 0x9c, 0xc5, 0x17, 0xcf, 0xb8, 0x90, 0x7c, 0x73, 0x3b, 0xdb, 0x44, 0x40, 0x47, 0x68, 0x85,
+    0x3e, 0x8d, 0x87, 0x52, 0x09, 0xcd, 0xf7, 0xbe, 0x53, 0x11, 0x8a, 0xbd, 0xef, 0xff, 0xd2, 0x47,
+    0x1d, 0xae, 0xd1, 0x21, 0x19, 0x95, 0x9d, 0x1c, 0x43, 0xb5, 0x33, 0x15, 0x82, 0x7c, 0xfc, 0x74,
+    0x98, 0xfc, 0xa8, 0x74, 0x41, 0x8e, 0xf0, 0xd0, 0xd2, 0x6a, 0x7c, 0x99, 0x3e, 0x71, 0xd1, 0x4d,
+    0x20, 0x53, 0xce, 0x4d, 0x86, 0x4a, 0xfb, 0x00, 0x23, 0xd9, 0x03, 0x55, 0xeb, 0x0d, 0x2b, 0x4a,
+    0x51, 0x9d, 0xd8, 0xa7, 0x62, 0xda, 0x0f, 0x09, 0x73, 0xa7, 0x70, 0x62, 0xed, 0x3b, 0xce, 0xa6,
+    0x4e, 0x6e, 0x22, 0xdc, 0xc0, 0x71, 0x96, 0xac, 0x3f, 0x6b, 0x3f, 0xd7, 0xc7, 0x2c, 0x46, 0x92,
+    0x9d, 0xdd, 0xfb, 0x12, 0xe3, 0x61, 0x50, 0xf1, 0x58, 0x22, 0xda, 0xe7, 0x4b, 0x73, 0x33, 0x8b,
+    0x0c, 0xde, 0x03, 0x55, 0x16, 0xe4, 0x72, 0x2e, 0xce, 0x89, 0xe4, 0xe4, 0xc9, 0x91, 0x27, 0xb4,
+    0xfd, 0xbc, 0xba, 0xb2, 0x38, 0x43, 0x77, 0x47, 0x1c, 0x04, 0x7b, 0x40, 0x54, 0x19, 0xfa, 0x4e,
+    0x0a, 0x39, 0x40, 0x24, 0x7d, 0x67, 0x10, 0x94, 0x54, 0x92, 0xeb, 0x99, 0x9f, 0x75, 0x12, 0x6b,
+    0x15, 0x8e, 0x31, 0xb3, 0xb0, 0x73, 0xe0, 0x2a, 0xaf, 0x2b, 0xd3, 0xda, 0xd6, 0x97, 0x75, 0x03,
+    0x14, 0xbf, 0xec, 0xfe, 0x34, 0x6d, 0x56, 0x67, 0xf6, 0x86, 0x68, 0xf6, 0xf9, 0xbf, 0xeb, 0xc7,
+    0x93, 0x96, 0x40, 0x3f, 0x40, 0xe3, 0x3e, 0xa9, 0xa7, 0x6f, 0x93, 0x5f, 0xb4, 0xd2, 0xd9, 0x13,
+    0x7c, 0x87, 0x98, 0x0c, 0xf4, 0x68, 0x14, 0x82, 0x24, 0x5a, 0x32, 0xb0, 0x44, 0x7a, 0x13, 0x62,
+    0x44, 0xbc, 0x0f, 0x99, 0x6e, 0xd0, 0x70, 0x96, 0xf4, 0x7e, 0xd2, 0x9a
+};
+// Self signed, ecdsa-with-SHA256 over a P-256 key, valid 2025-01-01 to
+// 2050-12-31T23:59:59 with the end as GeneralizedTime
+static const unsigned char TEST_EC_ROOT[] = {
+    0x30, 0x82, 0x01, 0x6c, 0x30, 0x82, 0x01, 0x12, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x02, 0x10,
+    0x01, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x1c, 0x31,
+    0x1a, 0x30, 0x18, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x11, 0x63, 0x61, 0x62, 0x6c, 0x65, 0x6c,
+    0x6f, 0x63, 0x6b, 0x20, 0x65, 0x63, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x30, 0x20, 0x17, 0x0d, 0x32,
+    0x35, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a, 0x18, 0x0f, 0x32, 0x30,
+    0x35, 0x30, 0x31, 0x32, 0x33, 0x31, 0x32, 0x33, 0x35, 0x39, 0x35, 0x39, 0x5a, 0x30, 0x1c, 0x31,
+    0x1a, 0x30, 0x18, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x11, 0x63, 0x61, 0x62, 0x6c, 0x65, 0x6c,
+    0x6f, 0x63, 0x6b, 0x20, 0x65, 0x63, 0x20, 0x72, 0x6f, 0x6f, 0x74, 0x30, 0x59, 0x30, 0x13, 0x06,
+    0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03,
+    0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x3d, 0xbf, 0xc6, 0xa1, 0xac, 0x86, 0xb2, 0x3f, 0x58, 0xdd,
+    0xf8, 0x03, 0x1c, 0x3b, 0xd3, 0x9b, 0xc8, 0x65, 0x86, 0xf7, 0xdc, 0x66, 0x01, 0x72, 0x46, 0xb4,
+    0x6a, 0x46, 0x73, 0x3a, 0xa9, 0x94, 0xac, 0x63, 0x9f, 0x2e, 0xd8, 0xc2, 0xf5, 0x26, 0x94, 0xd9,
+    0xae, 0x68, 0x1b, 0xc0, 0xdd, 0x27, 0x14, 0xc8, 0xfb, 0xf6, 0x37, 0xe4, 0x0e, 0x89, 0x68, 0xb6,
+    0x0c, 0xa0, 0x44, 0xaa, 0x3b, 0x43, 0xa3, 0x42, 0x30, 0x40, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x1d,
+    0x13, 0x01, 0x01, 0xff, 0x04, 0x05, 0x30, 0x03, 0x01, 0x01, 0xff, 0x30, 0x0e, 0x06, 0x03, 0x55,
+    0x1d, 0x0f, 0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x02, 0x04, 0x30, 0x1d, 0x06, 0x03, 0x55,
+    0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x6d, 0xe4, 0x1f, 0x4a, 0x7a, 0xc4, 0x17, 0xbc, 0x3e, 0x99,
+    0x82, 0x30, 0xf3, 0x87, 0x2b, 0xce, 0x55, 0xe8, 0xdc, 0xa7, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86,
+    0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x21, 0x00, 0xb6, 0x4a,
+    0x18, 0xde, 0xc2, 0x23, 0x65, 0xfd, 0x22, 0x62, 0x68, 0x42, 0x20, 0x71, 0xa3, 0x3a, 0x71, 0x55,
+    0x7c, 0x9e, 0xa8, 0x47, 0xd2, 0xde, 0x76, 0x69, 0xa6, 0x72, 0x82, 0x19, 0x44, 0x64, 0x02, 0x20,
+    0x2c, 0xf1, 0xf7, 0xf2, 0x9c, 0x82, 0x0b, 0xc3, 0x75, 0x9e, 0x02, 0xe2, 0x60, 0x0b, 0xb8, 0x51,
+    0x23, 0xb1, 0x45, 0xdd, 0xb1, 0x64, 0x91, 0xea, 0x8c, 0xa4, 0x1c, 0x53, 0x7d, 0xa7, 0x17, 0x52
+};
+
+static const unsigned char TEST_OID_KEY_USAGE[] = { 0x55, 0x1d, 0x0f };
+static const unsigned char TEST_OID_SUBJECT_KEY_ID[] = { 0x55, 0x1d, 0x0e };
+static const unsigned char TEST_EC_SUBJECT_KEY_ID[] = {
+    0x04, 0x14, 0x6d, 0xe4, 0x1f, 0x4a, 0x7a, 0xc4, 0x17, 0xbc, 0x3e, 0x99, 0x82, 0x30, 0xf3, 0x87, 0x2b, 0xce, 0x55, 0xe8, 0xdc, 0xa7
+};
+
+#define TEST_2025_01_01         1735689600
+#define TEST_2035_01_01         2051222400
+#define TEST_2050_12_31_END     2556143999
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_x509_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_x509_parse_NULL_fail)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+
+        // act
+        int result = crypto_x509_parse(&certificate, NULL, sizeof(TEST_RSA_ROOT));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_parse_trailing_data_fail)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+        unsigned char der[sizeof(TEST_EC_ROOT) + 1] = { 0 };
+        memcpy(der, TEST_EC_ROOT, sizeof(TEST_EC_ROOT));
+
+        // act
+        int result = crypto_x509_parse(&certificate, der, sizeof(der));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_der_read_non_minimal_length_fail)
+    {
+        // arrange
+        static const unsigned char long_form_short_length[] = { DER_TAG_OCTET_STRING, 0x81, 0x02, 0xaa, 0xbb };
+        static const unsigned char indefinite_length[] = { DER_TAG_SEQUENCE, 0x80, 0x05, 0x00, 0x00, 0x00 };
+        static const unsigned char past_end[] = { DER_TAG_OCTET_STRING, 0x03, 0xaa, 0xbb };
+        DER_ELEMENT element;
+
+        // act
+        int result_long = crypto_der_read(&element, long_form_short_length, sizeof(long_form_short_length));
+        int result_indefinite = crypto_der_read(&element, indefinite_length, sizeof(indefinite_length));
+        int result_past_end = crypto_der_read(&element, past_end, sizeof(past_end));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_long);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_indefinite);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_past_end);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_get_field_lazy_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+        DER_ELEMENT serial;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&certificate, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+
+        // act
+        int result = crypto_x509_get_field(&certificate, X509_FIELD_SERIAL_NUMBER, &serial);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 2, serial.value_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0x10, serial.value[0]);
+        CTEST_ASSERT_ARE_EQUAL(int, 0x00, serial.value[1]);
+        // Nothing past the serial number has been looked at
+        CTEST_ASSERT_ARE_EQUAL(int, (1 << X509_FIELD_VERSION) | (1 << X509_FIELD_SERIAL_NUMBER), (int)certificate.found_fields);
+        CTEST_ASSERT_IS_TRUE(serial.value > TEST_RSA_ROOT && serial.value < TEST_RSA_ROOT + sizeof(TEST_RSA_ROOT));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_get_validity_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE rsa_root;
+        X509_CERTIFICATE ec_root;
+        int64_t rsa_not_before = 0;
+        int64_t rsa_not_after = 0;
+        int64_t ec_not_before = 0;
+        int64_t ec_not_after = 0;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&rsa_root, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&ec_root, TEST_EC_ROOT, sizeof(TEST_EC_ROOT)));
+
+        // act
+        int result = crypto_x509_get_validity(&rsa_root, &rsa_not_before, &rsa_not_after);
+        result |= crypto_x509_get_validity(&ec_root, &ec_not_before, &ec_not_after);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(rsa_not_before == TEST_2025_01_01);
+        CTEST_ASSERT_IS_TRUE(rsa_not_after == TEST_2035_01_01);
+        CTEST_ASSERT_IS_TRUE(ec_not_before == TEST_2025_01_01);
+        CTEST_ASSERT_IS_TRUE(ec_not_after == TEST_2050_12_31_END);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_get_public_key_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE rsa_root;
+        X509_CERTIFICATE ec_root;
+        X509_PUBLIC_KEY rsa_key;
+        X509_PUBLIC_KEY ec_key;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&rsa_root, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&ec_root, TEST_EC_ROOT, sizeof(TEST_EC_ROOT)));
+
+        // act
+        int result = crypto_x509_get_public_key(&rsa_root, &rsa_key);
+        result |= crypto_x509_get_public_key(&ec_root, &ec_key);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, X509_KEY_TYPE_RSA, rsa_key.type);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 257, rsa_key.modulus_len);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 3, rsa_key.public_exponent_len);
+        CTEST_ASSERT_ARE_EQUAL(int, X509_KEY_TYPE_P256, ec_key.type);
+        CTEST_ASSERT_ARE_EQUAL(size_t, 65, ec_key.point_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0x04, ec_key.point[0]);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_find_extension_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+        DER_ELEMENT key_usage;
+        DER_ELEMENT key_id;
+        bool key_usage_critical = false;
+        bool key_id_critical = true;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&certificate, TEST_EC_ROOT, sizeof(TEST_EC_ROOT)));
+
+        // act
+        int result = crypto_x509_find_extension(&certificate, TEST_OID_KEY_USAGE, sizeof(TEST_OID_KEY_USAGE), &key_usage, &key_usage_critical);
+        result |= crypto_x509_find_extension(&certificate, TEST_OID_SUBJECT_KEY_ID, sizeof(TEST_OID_SUBJECT_KEY_ID), &key_id, &key_id_critical);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_IS_TRUE(key_usage_critical);
+        CTEST_ASSERT_IS_FALSE(key_id_critical);
+        CTEST_ASSERT_ARE_EQUAL(size_t, sizeof(TEST_EC_SUBJECT_KEY_ID), key_id.value_len);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(key_id.value, TEST_EC_SUBJECT_KEY_ID, sizeof(TEST_EC_SUBJECT_KEY_ID)));
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_verify_signature_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE rsa_root;
+        X509_CERTIFICATE ec_root;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&rsa_root, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&ec_root, TEST_EC_ROOT, sizeof(TEST_EC_ROOT)));
+
+        // act
+        int result = crypto_x509_verify_signature(&rsa_root, &rsa_root);
+        result |= crypto_x509_verify_signature(&ec_root, &ec_root);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_verify_signature_tampered_fail)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+        X509_CERTIFICATE issuer;
+        X509_CERTIFICATE rsa_root;
+        unsigned char der[sizeof(TEST_EC_ROOT)];
+        memcpy(der, TEST_EC_ROOT, sizeof(TEST_EC_ROOT));
+        // Inside the issuer common name
+        der[48] ^= 0x01;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&certificate, der, sizeof(der)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&issuer, TEST_EC_ROOT, sizeof(TEST_EC_ROOT)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&rsa_root, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+
+        // act
+        int result_tampered = crypto_x509_verify_signature(&certificate, &issuer);
+        int result_wrong_issuer = crypto_x509_verify_signature(&issuer, &rsa_root);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_tampered);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_wrong_issuer);
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_x509_verify_cached_succeed)
+    {
+        // arrange
+        X509_CERTIFICATE certificate;
+        X509_CERTIFICATE tampered;
+        CRYPTO_SESSION_CACHE_STATS stats;
+        unsigned char der[sizeof(TEST_RSA_ROOT)];
+        CRYPTO_SESSION_CACHE_HANDLE cache = crypto_x509_verify_cache_create(64, 0);
+        CTEST_ASSERT_IS_NOT_NULL(cache);
+        memcpy(der, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT));
+        der[sizeof(der) - 1] ^= 0x01;
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&certificate, TEST_RSA_ROOT, sizeof(TEST_RSA_ROOT)));
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_x509_parse(&tampered, der, sizeof(der)));
+
+        // act
+        int result = crypto_x509_verify_cached(cache, &certificate, &certificate);
+        result |= crypto_x509_verify_cached(cache, &certificate, &certificate);
+        int result_tampered = crypto_x509_verify_cached(cache, &tampered, &certificate);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result_tampered);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, crypto_session_cache_get_stats(cache, &stats));
+        CTEST_ASSERT_ARE_EQUAL(int, 1, (int)stats.hits);
+        CTEST_ASSERT_ARE_EQUAL(int, 2, (int)stats.misses);
+
+        // cleanup
+        crypto_session_cache_destroy(cache);
+    }
+
+CTEST_END_TEST_SUITE(crypto_x509_ut)
@@ -0,0 +1,410 @@
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_mem_shim_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_mem_shim_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "ctest.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "lib-util-c/sys_debug_shim.h"
+#undef ENABLE_MOCKS
+
+#include "cablelock/crypto_xts.h"
+#include "cablelock/crypto_aes_accel.h"
+
+// IEEE 1619-2007 test vectors 2 and 15
+static const unsigned char TEST_KEY_DATA[] = {
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22
+};
+static const unsigned char TEST_TWEAK_DATA[] = { 0x33, 0x33, 0x33, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+static const unsigned char TEST_CIPHER_DATA[] = {
+    0xc4, 0x54, 0x18, 0x5e, 0x6a, 0x16, 0x93, 0x6e, 0x39, 0x33, 0x40, 0x38, 0xac, 0xef, 0x83, 0x8b,
+    0xfb, 0x18, 0x6f, 0xff, 0x74, 0x80, 0xad, 0xc4, 0x28, 0x93, 0x82, 0xec, 0xd6, 0xd3, 0x94, 0xf0
+};
+#define TEST_PLAIN_BYTE         0x44
+#define TEST_DATA_LEN           32
+
+static const unsigned char TEST_STEAL_KEY_DATA[] = {
+    0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+    0xbf, 0xbe, 0xbd, 0xbc, 0xbb, 0xba, 0xb9, 0xb8, 0xb7, 0xb6, 0xb5, 0xb4, 0xb3, 0xb2, 0xb1, 0xb0
+};
+static const unsigned char TEST_STEAL_TWEAK_DATA[] = { 0x9a, 0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+static const unsigned char TEST_STEAL_CIPHER_DATA[] = {
+    0x6c, 0x16, 0x25, 0xdb, 0x46, 0x71, 0x52, 0x2d, 0x3d, 0x75, 0x99, 0x60, 0x1d, 0xe7, 0xca, 0x09, 0xed
+};
+#define TEST_STEAL_DATA_LEN     17
+#define TEST_SECTOR_SIZE        40
+#define TEST_SECTOR_COUNT       3
+
+// Unit lengths around the 16 block batches, some with a partial last block
+static const size_t TEST_BATCH_LENGTHS[] = { 16, 112, 128, 240, 256, 257, 272, 287, 504, 528, 531 };
+#define TEST_MAX_BATCH_LEN      531
+
+// One block at a time straight from IEEE 1619, used to check the batched code
+static void reference_xts_block(const CRYPTO_XTS_KEY* xts_key, bool encrypt, const unsigned char* tweak, const unsigned char* input, unsigned char* output)
+{
+    unsigned char block[AES_BLOCK_SIZE];
+    for (size_t index = 0; index < AES_BLOCK_SIZE; index++)
+    {
+        block[index] = input[index] ^ tweak[index];
+    }
+    if (encrypt)
+    {
+        crypto_aes_block_encrypt(&xts_key->data_key, block, block);
+    }
+    else
+    {
+        crypto_aes_block_decrypt(&xts_key->data_key, block, block);
+    }
+    for (size_t index = 0; index < AES_BLOCK_SIZE; index++)
+    {
+        output[index] = block[index] ^ tweak[index];
+    }
+}
+
+static void reference_tweak_double(unsigned char* tweak)
+{
+    unsigned char carry = tweak[AES_BLOCK_SIZE - 1] >> 7;
+    for (size_t index = AES_BLOCK_SIZE - 1; index > 0; index--)
+    {
+        tweak[index] = (unsigned char)((tweak[index] << 1) | (tweak[index - 1] >> 7));
+    }
+    tweak[0] = (unsigned char)((tweak[0] << 1) ^ (carry ? 0x87 : 0));
+}
+
+static void reference_xts(const CRYPTO_XTS_KEY* xts_key, bool encrypt, const unsigned char* tweak_value, const unsigned char* input, size_t input_len, unsigned char* output)
+{
+    unsigned char tweak[AES_BLOCK_SIZE];
+    unsigned char next[AES_BLOCK_SIZE];
+    unsigned char block[AES_BLOCK_SIZE];
+    size_t remainder = input_len % AES_BLOCK_SIZE;
+    size_t full_blocks = input_len / AES_BLOCK_SIZE - (remainder != 0 ? 1 : 0);
+
+    crypto_aes_block_encrypt(&xts_key->tweak_key, tweak_value, tweak);
+    for (size_t index = 0; index < full_blocks; index++)
+    {
+        reference_xts_block(xts_key, encrypt, tweak, input + (index * AES_BLOCK_SIZE), output + (index * AES_BLOCK_SIZE));
+        reference_tweak_double(tweak);
+    }
+    if (remainder != 0)
+    {
+        const unsigned char* last_input = input + (full_blocks * AES_BLOCK_SIZE);
+        unsigned char* last_output = output + (full_blocks * AES_BLOCK_SIZE);
+        memcpy(next, tweak, AES_BLOCK_SIZE);
+        reference_tweak_double(next);
+        reference_xts_block(xts_key, encrypt, encrypt ? tweak : next, last_input, block);
+        memcpy(last_output + AES_BLOCK_SIZE, block, remainder);
+        memcpy(block, last_input + AES_BLOCK_SIZE, remainder);
+        reference_xts_block(xts_key, encrypt, encrypt ? next : tweak, block, last_output);
+    }
+}
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    CTEST_ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+CTEST_BEGIN_TEST_SUITE(crypto_xts_ut)
+
+    CTEST_SUITE_INITIALIZE()
+    {
+        (void)umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_malloc, my_mem_shim_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mem_shim_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(mem_shim_free, my_mem_shim_free);
+    }
+
+    CTEST_SUITE_CLEANUP()
+    {
+        umock_c_deinit();
+    }
+
+    CTEST_FUNCTION_INITIALIZE()
+    {
+        umock_c_reset_all_calls();
+    }
+
+    CTEST_FUNCTION_CLEANUP()
+    {
+    }
+
+    CTEST_FUNCTION(crypto_xts_key_init_invalid_key_len_fail)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+
+        // act
+        int result = crypto_xts_key_init(&xts_key, TEST_KEY_DATA, 24);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_key_init_equal_halves_fail)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char key[XTS_AES_128_KEY_SIZE];
+        memcpy(key, TEST_KEY_DATA, AES_128_KEY_SIZE);
+        memcpy(key + AES_128_KEY_SIZE, TEST_KEY_DATA, AES_128_KEY_SIZE);
+
+        // act
+        int result = crypto_xts_key_init(&xts_key, key, sizeof(key));
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_short_input_fail)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char input[TEST_DATA_LEN];
+        unsigned char output[TEST_DATA_LEN];
+        memset(input, TEST_PLAIN_BYTE, TEST_DATA_LEN);
+        (void)crypto_xts_key_init(&xts_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_xts_encrypt(&xts_key, TEST_TWEAK_DATA, input, AES_BLOCK_SIZE - 1, output);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char input[TEST_DATA_LEN];
+        unsigned char output[TEST_DATA_LEN];
+        memset(input, TEST_PLAIN_BYTE, TEST_DATA_LEN);
+        (void)crypto_xts_key_init(&xts_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_xts_encrypt(&xts_key, TEST_TWEAK_DATA, input, TEST_DATA_LEN, output);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, TEST_CIPHER_DATA, TEST_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_ciphertext_stealing_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char data[TEST_STEAL_DATA_LEN];
+        for (size_t index = 0; index < TEST_STEAL_DATA_LEN; index++)
+        {
+            data[index] = (unsigned char)index;
+        }
+        (void)crypto_xts_key_init(&xts_key, TEST_STEAL_KEY_DATA, sizeof(TEST_STEAL_KEY_DATA));
+
+        // act
+        int result = crypto_xts_encrypt(&xts_key, TEST_STEAL_TWEAK_DATA, data, TEST_STEAL_DATA_LEN, data);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(data, TEST_STEAL_CIPHER_DATA, TEST_STEAL_DATA_LEN));
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_decrypt_ciphertext_stealing_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char output[TEST_STEAL_DATA_LEN];
+        (void)crypto_xts_key_init(&xts_key, TEST_STEAL_KEY_DATA, sizeof(TEST_STEAL_KEY_DATA));
+
+        // act
+        int result = crypto_xts_decrypt(&xts_key, TEST_STEAL_TWEAK_DATA, TEST_STEAL_CIPHER_DATA, TEST_STEAL_DATA_LEN, output);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        for (size_t index = 0; index < TEST_STEAL_DATA_LEN; index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, (int)index, output[index]);
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_batch_lengths_every_level_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char input[TEST_MAX_BATCH_LEN];
+        unsigned char expected[TEST_MAX_BATCH_LEN];
+        unsigned char output[TEST_MAX_BATCH_LEN];
+        for (size_t index = 0; index < TEST_MAX_BATCH_LEN; index++)
+        {
+            input[index] = (unsigned char)(index * 13);
+        }
+        (void)crypto_xts_key_init(&xts_key, TEST_STEAL_KEY_DATA, sizeof(TEST_STEAL_KEY_DATA));
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+            for (size_t length_index = 0; length_index < sizeof(TEST_BATCH_LENGTHS) / sizeof(TEST_BATCH_LENGTHS[0]); length_index++)
+            {
+                size_t input_len = TEST_BATCH_LENGTHS[length_index];
+                reference_xts(&xts_key, true, TEST_STEAL_TWEAK_DATA, input, input_len, expected);
+
+                // act
+                int result = crypto_xts_encrypt(&xts_key, TEST_STEAL_TWEAK_DATA, input, input_len, output);
+
+                // assert
+                CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+                CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(output, expected, input_len));
+            }
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        (void)crypto_aes_accel_set_level(crypto_aes_accel_detect());
+    }
+
+    CTEST_FUNCTION(crypto_xts_decrypt_batch_lengths_in_place_every_level_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char input[TEST_MAX_BATCH_LEN];
+        unsigned char data[TEST_MAX_BATCH_LEN];
+        for (size_t index = 0; index < TEST_MAX_BATCH_LEN; index++)
+        {
+            input[index] = (unsigned char)(index * 13);
+        }
+        (void)crypto_xts_key_init(&xts_key, TEST_STEAL_KEY_DATA, sizeof(TEST_STEAL_KEY_DATA));
+
+        for (int level = CRYPTO_AES_ACCEL_NONE; level <= (int)crypto_aes_accel_detect(); level++)
+        {
+            (void)crypto_aes_accel_set_level((CRYPTO_AES_ACCEL)level);
+            for (size_t length_index = 0; length_index < sizeof(TEST_BATCH_LENGTHS) / sizeof(TEST_BATCH_LENGTHS[0]); length_index++)
+            {
+                size_t input_len = TEST_BATCH_LENGTHS[length_index];
+                reference_xts(&xts_key, true, TEST_STEAL_TWEAK_DATA, input, input_len, data);
+
+                // act
+                int result = crypto_xts_decrypt(&xts_key, TEST_STEAL_TWEAK_DATA, data, input_len, data);
+
+                // assert
+                CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+                CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(data, input, input_len));
+            }
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        (void)crypto_aes_accel_set_level(crypto_aes_accel_detect());
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_sectors_invalid_length_fail)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char data[TEST_SECTOR_SIZE * TEST_SECTOR_COUNT] = { 0 };
+        (void)crypto_xts_key_init(&xts_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+
+        // act
+        int result = crypto_xts_encrypt_sectors(&xts_key, 0, TEST_SECTOR_SIZE, data, sizeof(data) - 1, data);
+
+        // assert
+        CTEST_ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_encrypt_sectors_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char data[TEST_SECTOR_SIZE * TEST_SECTOR_COUNT];
+        unsigned char expected[TEST_SECTOR_SIZE];
+        unsigned char tweak[XTS_TWEAK_SIZE] = { 0 };
+        memset(data, TEST_PLAIN_BYTE, sizeof(data));
+        (void)crypto_xts_key_init(&xts_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        umock_c_reset_all_calls();
+
+        // act
+        int result = crypto_xts_encrypt_sectors(&xts_key, 0x3333333333, TEST_SECTOR_SIZE, data, sizeof(data), data);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        for (size_t index = 0; index < TEST_SECTOR_COUNT; index++)
+        {
+            unsigned char input[TEST_SECTOR_SIZE];
+            memset(input, TEST_PLAIN_BYTE, TEST_SECTOR_SIZE);
+            memcpy(tweak, TEST_TWEAK_DATA, sizeof(tweak));
+            tweak[0] += (unsigned char)index;
+            (void)crypto_xts_encrypt(&xts_key, tweak, input, TEST_SECTOR_SIZE, expected);
+            CTEST_ASSERT_ARE_EQUAL(int, 0, memcmp(data + (index * TEST_SECTOR_SIZE), expected, TEST_SECTOR_SIZE));
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+    CTEST_FUNCTION(crypto_xts_decrypt_sectors_succeed)
+    {
+        // arrange
+        CRYPTO_XTS_KEY xts_key;
+        unsigned char data[TEST_SECTOR_SIZE * TEST_SECTOR_COUNT];
+        memset(data, TEST_PLAIN_BYTE, sizeof(data));
+        (void)crypto_xts_key_init(&xts_key, TEST_KEY_DATA, sizeof(TEST_KEY_DATA));
+        (void)crypto_xts_encrypt_sectors(&xts_key, 7, TEST_SECTOR_SIZE, data, sizeof(data), data);
+
+        // act
+        int result = crypto_xts_decrypt_sectors(&xts_key, 7, TEST_SECTOR_SIZE, data, sizeof(data), data);
+
+        // assert
+        CTEST_ASSERT_ARE_EQUAL(int, 0, result);
+        for (size_t index = 0; index < sizeof(data); index++)
+        {
+            CTEST_ASSERT_ARE_EQUAL(int, TEST_PLAIN_BYTE, data[index]);
+        }
+        CTEST_ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+    }
+
+CTEST_END_TEST_SUITE(crypto_xts_ut)